@@ -101,6 +101,9 @@ __all__ = [
     'FROM_INFO',
     'FROM_INFO_SIGNED',
     #
+    'INFO_FLOAT64',
+    'INFO_INT64',
+    #
     'HAPLODIPLOID',
     'ALL_AVAIL',
     'UNSPECIFIED',
@@ -114,6 +117,7 @@ __all__ = [
     'Individual',
     'Simulator',
     'Pedigree',
+    'PedigreeReader',
     # splitters
     'SexSplitter',
     'AffectionSplitter',
@@ -226,6 +230,8 @@ __all__ = [
     'NoneOp',
     'Dumper',
     'SavePopulation',
+    'SavePlink',
+    'SaveVCF',
     'IfElse',
     'Pause',
     'TicToc',
@@ -275,6 +281,7 @@ __all__ = [
     'closeOutput',
     'describeEvolProcess',
     'loadPopulation',
+    'loadVCF',
     'loadPedigree',
     'moduleInfo',
     'turnOffDebug',
@@ -515,6 +522,17 @@ def dvars(self, *args, **kwargs):
 Population.dvars = dvars
 Simulator.dvars = dvars
 
+# the view returned by Population.infoArray keeps the population alive
+_infoArray = Population.infoArray
+
+def _info_array(self, *args, **kwargs):
+    view = _infoArray(self, *args, **kwargs)
+    view.obj.owner = self
+    return view
+
+_info_array.__doc__ = _infoArray.__doc__
+Population.infoArray = _info_array
+
 # expose the clone() method to Python copy module.
 def _deepcopy(self, memo):
     return self.clone()
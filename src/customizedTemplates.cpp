@@ -1361,6 +1361,78 @@ bool is_carrayobject_template<LineageIterator>(PyObject * op)
 }
 
 
+/* Buffer protocol (PEP 3118). The buffer points directly to the underlying
+   genotype or lineage of a population so that it can be wrapped, for example,
+   by numpy.asarray() without copying. Like the carray object itself, the
+   buffer becomes invalid once the population is resized or reallocated. */
+
+/// CPPONLY
+template <typename T>
+int fill_carray_buffer(struct arrayobject_template<T> * self, Py_buffer * view, int flags,
+                       void * buf, Py_ssize_t * strides, const char * format)
+{
+	// items are contiguous so the stride of the only dimension is the item size
+	Py_ssize_t itemsize = strides[0];
+
+	view->obj = (PyObject *)self;
+	Py_INCREF(self);
+	view->buf = buf;
+	view->len = Py_SIZE(self) * itemsize;
+	view->readonly = 0;
+	view->itemsize = itemsize;
+	view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? (char *)format : NULL;
+	view->ndim = 1;
+	view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &((PyVarObject *)self)->ob_size : NULL;
+	view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? strides : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	return 0;
+}
+
+
+/// CPPONLY
+template <typename T>
+int array_getbuffer_template(struct arrayobject_template<T> * self, Py_buffer * view, int flags)
+{
+	view->obj = NULL;
+	PyErr_SetString(PyExc_BufferError, "Buffer protocol is not supported for this type.");
+	return -1;
+}
+
+
+/// CPPONLY
+template <>
+int array_getbuffer_template<GenoIterator>(struct arrayobject_template<GenoIterator> * self, Py_buffer * view, int flags)
+{
+#  if defined(BINARYALLELE) || defined(MUTANTALLELE)
+	(void)self;
+	(void)flags;
+	view->obj = NULL;
+	PyErr_SetString(PyExc_BufferError, "Genotypes of binary and mutant modules are not stored as "
+		                               "contiguous arrays and cannot be exported through the buffer protocol.");
+	return -1;
+#  else
+	static char buf0 = 0;
+	static Py_ssize_t strides[1] = { sizeof(Allele) };
+	return fill_carray_buffer<GenoIterator>(self, view, flags,
+		Py_SIZE(self) == 0 ? (void *)&buf0 : (void *)&*self->ob_iter,
+		strides, sizeof(Allele) == sizeof(unsigned char) ? "B" : "L");
+#  endif
+}
+
+
+/// CPPONLY
+template <>
+int array_getbuffer_template<LineageIterator>(struct arrayobject_template<LineageIterator> * self, Py_buffer * view, int flags)
+{
+	static char buf0 = 0;
+	static Py_ssize_t strides[1] = { sizeof(long) };
+
+	return fill_carray_buffer<LineageIterator>(self, view, flags,
+		Py_SIZE(self) == 0 ? (void *)&buf0 : (void *)&*self->ob_iter, strides, "l");
+}
+
+
 template <>
 int
 array_ass_subscr_template(struct arrayobject_template<GenoIterator> * self, PyObject * item, PyObject * value)
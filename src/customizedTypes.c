@@ -977,6 +977,19 @@ PyObject * array_new(PyTypeObject * type, PyObject * args, PyObject * kwds)
 }
 
 
+int
+array_getbuffer(arrayobject * self, Py_buffer * view, int flags)
+{
+	return array_getbuffer_template<GenoIterator>(self, view, flags);
+}
+
+
+PyBufferProcs array_as_buffer = {
+	(getbufferproc)array_getbuffer,
+	(releasebufferproc)0
+};
+
+
 PyDoc_STRVAR(arraytype_doc,
 	" \n\
 \n\
@@ -1023,7 +1036,7 @@ PyTypeObject Arraytype = {
 	0,                                          /* tp_str */
 	PyObject_GenericGetAttr,                    /* tp_getattro */
 	0,                                          /* tp_setattro */
-	0,                                          /* tp_as_buffer*/
+	&array_as_buffer,                           /* tp_as_buffer*/
 	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,   /* tp_flags */
 	arraytype_doc,                              /* tp_doc */
 	0,                                          /* tp_traverse */
@@ -1227,6 +1240,19 @@ PyObject * array_new_lineage(PyTypeObject * type, PyObject * args, PyObject * kw
 }
 
 
+int
+array_getbuffer_lineage(arrayobject_lineage * self, Py_buffer * view, int flags)
+{
+	return array_getbuffer_template<LineageIterator>(self, view, flags);
+}
+
+
+PyBufferProcs array_as_buffer_lineage = {
+	(getbufferproc)array_getbuffer_lineage,
+	(releasebufferproc)0
+};
+
+
 PyDoc_STRVAR(arraytype_doc_lineage,
 	" \n\
 \n\
@@ -1273,7 +1299,7 @@ PyTypeObject LineageArraytype = {
 	0,                                          /* tp_str */
 	PyObject_GenericGetAttr,                    /* tp_getattro */
 	0,                                          /* tp_setattro */
-	0,                                          /* tp_as_buffer*/
+	&array_as_buffer_lineage,                   /* tp_as_buffer*/
 	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,   /* tp_flags */
 	arraytype_doc_lineage,                              /* tp_doc */
 	0,                                          /* tp_traverse */
@@ -1511,11 +1537,118 @@ PyObject * PyDefDict_New()
 }
 
 
+/* An object that exports information fields of a population through the
+   buffer protocol. It holds a reference to the Python object that owns the
+   information fields (the population) so that memoryviews of it keep the
+   population alive. */
+
+/// CPPONLY
+typedef struct
+{
+	PyObject_HEAD
+	// Python object that owns the memory
+	PyObject * owner;
+	double * buf;
+	Py_ssize_t shape[2];
+	Py_ssize_t strides[2];
+} infobufferobject;
+
+
+/// CPPONLY
+static void infobuffer_dealloc(infobufferobject * self)
+{
+	Py_XDECREF(self->owner);
+	PyObject_Del(self);
+}
+
+
+/// CPPONLY
+static int infobuffer_getbuffer(infobufferobject * self, Py_buffer * view, int flags)
+{
+	view->obj = (PyObject *)self;
+	Py_INCREF(self);
+	view->buf = self->buf;
+	view->len = self->shape[0] * self->shape[1] * sizeof(double);
+	view->readonly = 0;
+	view->itemsize = sizeof(double);
+	view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? (char *)"d" : NULL;
+	view->ndim = 2;
+	view->shape = (flags & PyBUF_ND) == PyBUF_ND ? self->shape : NULL;
+	view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : NULL;
+	view->suboffsets = NULL;
+	view->internal = NULL;
+	return 0;
+}
+
+
+static PyBufferProcs infobuffer_as_buffer = {
+	(getbufferproc)infobuffer_getbuffer,
+	(releasebufferproc)0,
+};
+
+static PyMemberDef infobuffer_members[] = {
+	{ (char *)"owner", T_OBJECT, offsetof(infobufferobject, owner), 0,
+	  (char *)"Python object that owns the exported information fields" },
+	{ NULL }
+};
+
+PyTypeObject InfoBuffertype = {
+	PyVarObject_HEAD_INIT(NULL, 0)
+	"simuPOP.infobuffer",
+	sizeof(infobufferobject),
+	0,
+	(destructor)infobuffer_dealloc,             /* tp_dealloc */
+	0,                                          /* tp_print */
+	0,                                          /* tp_getattr */
+	0,                                          /* tp_setattr */
+	0,                                          /* tp_reserved */
+	0,                                          /* tp_repr */
+	0,                                          /* tp_as_number*/
+	0,                                          /* tp_as_sequence*/
+	0,                                          /* tp_as_mapping*/
+	0,                                          /* tp_hash */
+	0,                                          /* tp_call */
+	0,                                          /* tp_str */
+	PyObject_GenericGetAttr,                    /* tp_getattro */
+	PyObject_GenericSetAttr,                    /* tp_setattro */
+	&infobuffer_as_buffer,                      /* tp_as_buffer*/
+	Py_TPFLAGS_DEFAULT,                         /* tp_flags */
+	"Information fields of a population",       /* tp_doc */
+	0,                                          /* tp_traverse */
+	0,                                          /* tp_clear */
+	0,                                          /* tp_richcompare */
+	0,                                          /* tp_weaklistoffset */
+	0,                                          /* tp_iter */
+	0,                                          /* tp_iternext */
+	0,                                          /* tp_methods */
+	infobuffer_members,                         /* tp_members */
+};
+
+
+/// CPPONLY
+PyObject * newinfobufferobject(double * buf, size_t rows, size_t cols)
+{
+	infobufferobject * op = PyObject_New(infobufferobject, &InfoBuffertype);
+
+	if (op == NULL)
+		return NULL;
+	op->owner = NULL;
+	op->buf = buf;
+	op->shape[0] = rows;
+	op->shape[1] = cols;
+	op->strides[0] = cols * sizeof(double);
+	op->strides[1] = sizeof(double);
+	return (PyObject *)op;
+}
+
+
 int initCustomizedTypes(PyObject * m)
 {
 	Py_TYPE(&Arraytype) = &PyType_Type;
 	if (PyType_Ready(&Arraytype) < 0)
 		return -1;
+	if (PyType_Ready(&InfoBuffertype) < 0)
+		return -1;
 	//
 	Py_TYPE(&defdict_type) = &PyType_Type;
 	defdict_type.tp_base = &PyDict_Type;
@@ -79,7 +79,9 @@ from simuOpt import simuOptions
 
 from simuPOP import Population, PyEval, RandomSelection, \
     ALL_AVAIL, Stat, stat, Migrator, InitSex, PyOperator, \
-    MergeSubPops, SplitSubPops, ResizeSubPops
+    MergeSubPops, SplitSubPops, ResizeSubPops, BaseOperator, \
+    NativeGrowthModel, NativeInstantChangeModel, NativeMultiStageModel, \
+    NativeEventBasedModel
 
 from simuPOP.utils import migrIslandRates, migrHierarchicalIslandRates, \
     migrSteppingStoneRates
@@ -97,14 +99,16 @@ try:
 except ImportError:
     has_plotter = False
 
-def migr2DSteppingStoneRates(r, m, n, diagonal=False, circular=False):
+def migr2DSteppingStoneRates(r, m, n, diagonal=False, circular=False, sparse=False):
     '''migration rate matrix for 2D stepping stone model, with or without
     diagonal neighbors (4 or 8 neighbors for central patches). The boundaries
     are connected if circular is True. Otherwise individuals from corner and
     bounary patches will migrate to their neighbors with higher probability.
+    If sparse is True, a sparse matrix in the form of a list of dictionaries
+    with non-zero migration rates to neighboring patches is returned.
     '''
     if n < 2 and n < 2:
-        return [[1]]
+        return [{}] if sparse else [[1]]
     rates = []
     n = int(n)
     m = int(m)
@@ -125,6 +129,9 @@ def migr2DSteppingStoneRates(r, m, n, diagonal=False, circular=False):
             #
             # the neighbors might overlap or cover the cell if the dimension is small
             neighbors = set(neighbors) - set([(row, col)])
+            if sparse:
+                rates.append(dict([(x[0] * n + x[1], r * 1.0 / len(neighbors)) for x in neighbors]))
+                continue
             # itself
             rates.append([0]*(m*n))
             rates[-1][row * n + col] = 1. - r
@@ -190,8 +197,12 @@ class DemographicModel:
         #
         # history
         self.size_cache = {}
+        # native implementation of the model, created after the model is
+        # applied for the first time
+        self._native = None
 
     def _reset(self):
+        self._native = None
         if hasattr(self, '_start_gen'):
             del self._start_gen
 
@@ -530,6 +541,28 @@ class DemographicModel:
             raise RuntimeError('Failed to determine size for generation {}'
                     .format(gen))
 
+    def _nativeSize(self, pop):
+        # return size determined by the native model, or None if the model
+        # has no native implementation or the native model has ended.
+        if self._native is None:
+            return None
+        if self._native.isReset():
+            self._reset()
+            return None
+        return self._native.subPopSizes(pop)
+
+    def _setNative(self, sz, nativeModel, *args):
+        # Create a native model after the model is applied for the first
+        # time so that mating schemes can determine the size of subsequent
+        # generations without calling this model. This is only possible if
+        # all operators are simuPOP operators.
+        if self._use_cached or self._gen != 0 or not sz or \
+            not all([isinstance(op, BaseOperator) for op in self.ops]):
+            return sz
+        self._native = nativeModel(self, self._start_gen, self.num_gens,
+            sz, self.ops, *args)
+        return sz
+
     def __call__(self, pop):
         # When calling the demographic function, there are two quite separate scenarios
         #
@@ -652,6 +685,10 @@ class ExponentialGrowthModel(DemographicModel):
                 'is expected')
 
     def __call__(self, pop):
+        sz = self._nativeSize(pop)
+        if sz is not None:
+            return sz
+        #
         if not DemographicModel.__call__(self, pop):
            return []
         #
@@ -661,13 +698,15 @@ class ExponentialGrowthModel(DemographicModel):
         if self._gen == self.num_gens:
             return []
         elif self.r is None:
-            return self._save_size(pop.dvars().gen, 
+            sz = self._save_size(pop.dvars().gen, 
                 [self._expIntepolate(n0, nt, self.num_gens, self._gen)
                 for (n0, nt) in zip(self.init_size, self.NT)])
         else:
             # with r ...
-            return self._save_size(pop.dvars().gen, [min(int(round(nt)), int(round(n0 * math.exp(r * (self._gen + 1)))))
+            sz = self._save_size(pop.dvars().gen, [min(int(round(nt)), int(round(n0 * math.exp(r * (self._gen + 1)))))
                 for (n0, nt, r) in zip(self.init_size, self.NT, self.r)])
+        return self._setNative(sz, NativeGrowthModel, self.init_size, self.NT,
+            [] if self.r is None else self.r, True)
 
 
 class LinearGrowthModel(DemographicModel):
@@ -741,6 +780,10 @@ class LinearGrowthModel(DemographicModel):
                 'is expected')
 
     def __call__(self, pop):
+        sz = self._nativeSize(pop)
+        if sz is not None:
+            return sz
+        #
         if not DemographicModel.__call__(self, pop):
             return []
         #
@@ -751,12 +794,14 @@ class LinearGrowthModel(DemographicModel):
             return []
         elif self.r is None:
             # no r use intepolation
-            return self._save_size(pop.dvars().gen, [self._linearIntepolate(n0, nt, self.num_gens, self._gen)
+            sz = self._save_size(pop.dvars().gen, [self._linearIntepolate(n0, nt, self.num_gens, self._gen)
                 for (n0, nt) in zip(self.init_size, self.NT)])
         else:
             # with r ...
-            return self._save_size(pop.dvars().gen, [min(nt, int(n0 + n0 * (self._gen + 1.) * r))
+            sz = self._save_size(pop.dvars().gen, [min(nt, int(n0 + n0 * (self._gen + 1.) * r))
                 for (n0, nt, r) in zip(self.init_size, self.NT, self.r)])
+        return self._setNative(sz, NativeGrowthModel, self.init_size, self.NT,
+            [] if self.r is None else self.r, False)
 
 
 class InstantChangeModel(DemographicModel):
@@ -798,6 +843,9 @@ class InstantChangeModel(DemographicModel):
         self.removeEmptySubPops = removeEmptySubPops
 
     def __call__(self, pop):
+        sz = self._nativeSize(pop)
+        if sz is not None:
+            return sz
         # this one fixes N0... (self.init_size)
         if not DemographicModel.__call__(self, pop):
             return []
@@ -811,7 +859,8 @@ class InstantChangeModel(DemographicModel):
         if self.removeEmptySubPops:
             pop.removeSubPops([idx for idx,x in enumerate(pop.subPopSizes()) if x==0])
         sz = pop.subPopSizes()
-        return self._save_size(pop.dvars().gen, sz)
+        return self._setNative(self._save_size(pop.dvars().gen, sz),
+            NativeInstantChangeModel, self.G, self.removeEmptySubPops)
 
 
 
@@ -950,9 +999,11 @@ class MultiStageModel(DemographicModel):
     def _reset(self):
         self._model_idx = 0
         self._model_start_gen = 0
+        self._native = None
         if hasattr(self, '_start_gen'):
             del self._start_gen
         for m in self.models:
+            m._native = None
             if hasattr(m, '_start_gen'):
                 del m._start_gen
   
@@ -981,6 +1032,10 @@ class MultiStageModel(DemographicModel):
         # so that the starting gen is after the current gen. We will
         # need to handle this case.
         # determines generation number internally as self.gen
+        sz = self._nativeSize(pop)
+        if sz is not None:
+            return sz
+        #
         if not DemographicModel.__call__(self, pop):
             return []
         #
@@ -1010,7 +1065,11 @@ class MultiStageModel(DemographicModel):
             sz = self._advance(pop)
         elif self.models[self._model_idx].num_gens <= self._gen - self._model_start_gen:
             sz = self._advance(pop)
-        return self._save_size(pop.dvars().gen, sz)
+        if not hasattr(self, '_start_gen'):
+            # the model has been reset
+            return self._save_size(pop.dvars().gen, sz)
+        return self._setNative(self._save_size(pop.dvars().gen, sz),
+            NativeMultiStageModel, self._model_idx, self._model_start_gen)
 
 
         
@@ -1032,6 +1091,24 @@ class EventBasedModel(DemographicModel):
         DemographicModel.__init__(self, numGens=T, initSize=N0,
             ops=ops + events, infoFields=infoFields)
 
+    def __call__(self, pop):
+        sz = self._nativeSize(pop)
+        if sz is not None:
+            return sz
+        #
+        sz = DemographicModel.__call__(self, pop)
+        if self._use_cached or self._gen != 0 or not sz:
+            return sz
+        # events are applied by the native model after other operators
+        nEvents = len([x for x in self.ops if isinstance(x, DemographicEvent)])
+        ops = self.ops[:len(self.ops) - nEvents]
+        events = self.ops[len(self.ops) - nEvents:]
+        if all([isinstance(op, BaseOperator) for op in ops]) and \
+            all([isinstance(e, DemographicEvent) for e in events]):
+            self._native = NativeEventBasedModel(self, self._start_gen,
+                self.num_gens, sz, ops, events)
+        return sz
+
 
 class DemographicEvent:
     '''A demographic events that will be applied to one or more populations at
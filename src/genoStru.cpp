@@ -36,11 +36,11 @@ namespace simuPOP {
 
 GenoStructure::GenoStructure(UINT ploidy, const vectoru & loci, const vectoru & chromTypes, bool haplodiploid,
 	const vectorf & lociPos, const vectorstr & chromNames, const matrixstr & alleleNames,
-	const vectorstr & lociNames, const vectorstr & infoFields)
+	const vectorstr & lociNames, const vectorstr & infoFields, const vectorstr & intInfoFields)
 	: m_ploidy(ploidy), m_numLoci(loci), m_chromTypes(),
 	m_haplodiploid(haplodiploid), m_lociPos(lociPos), m_chromIndex(loci.size() + 1),
 	m_chromNames(chromNames), m_alleleNames(alleleNames), m_lociNames(lociNames),
-	m_infoFields(infoFields), m_lociPosMap(), m_refCount(0)
+	m_infoFields(infoFields), m_intInfoFields(), m_intInfo(), m_lociPosMap(), m_refCount(0)
 {
 	DBG_ASSERT(ploidy >= 1, ValueError,
 		(boost::format("Ploidy must be >= 1. Given %1%") % ploidy).str());
@@ -174,6 +174,7 @@ GenoStructure::GenoStructure(UINT ploidy, const vectoru & loci, const vectoru &
 		m_infoFields.clear();
 		std::copy(infoMap.begin(), infoMap.end(), std::back_inserter(m_infoFields));
 	}
+	setIntInfoFields(intInfoFields);
 	// shrink allele names
 	for (size_t i = 0; i < m_alleleNames.size(); ++i)
 		if (!m_alleleNames[i].empty() && static_cast<UINT>(m_alleleNames[i].size() - 1) > ModuleMaxAllele)
@@ -215,7 +216,8 @@ bool GenoStructure::operator==(const GenoStructure & rhs)
 	                     (m_chromNames == rhs.m_chromNames) &&
 	                     (m_alleleNames == rhs.m_alleleNames) &&
 	                     (m_lociNames == rhs.m_lociNames) &&
-	                     (m_infoFields == rhs.m_infoFields)
+	                     (m_infoFields == rhs.m_infoFields) &&
+	                     (m_intInfoFields == rhs.m_intInfoFields)
 	                     ))
 		return true;
 	else
@@ -223,6 +225,24 @@ bool GenoStructure::operator==(const GenoStructure & rhs)
 }
 
 
+void GenoStructure::setIntInfoFields(const vectorstr & fields)
+{
+	// keep fields in the order of information fields so that structures
+	// with the same integer fields compare equal
+	m_intInfoFields.clear();
+	m_intInfo.clear();
+	for (size_t i = 0; i < m_infoFields.size(); ++i)
+		if (std::find(fields.begin(), fields.end(), m_infoFields[i]) != fields.end())
+			m_intInfoFields.push_back(m_infoFields[i]);
+	if (m_intInfoFields.empty())
+		return;
+	m_intInfo.resize(m_infoFields.size(), false);
+	for (size_t i = 0; i < m_infoFields.size(); ++i)
+		m_intInfo[i] = std::find(m_intInfoFields.begin(), m_intInfoFields.end(),
+			m_infoFields[i]) != m_intInfoFields.end();
+}
+
+
 void GenoStructure::setChromTypes(const vectoru & chromTypes)
 {
 	DBG_ASSERT(chromTypes.empty() || chromTypes.size() == m_numLoci.size(),
@@ -358,10 +378,11 @@ size_t GenoStruTrait::lociCovered(size_t loc, double dist) const
 
 void GenoStruTrait::setGenoStructure(UINT ploidy, const vectoru & loci, const vectoru & chromTypes, bool haplodiploid,
                                      const vectorf & lociPos, const vectorstr & chromNames, const matrixstr & alleleNames,
-                                     const vectorstr & lociNames, const vectorstr & infoFields)
+                                     const vectorstr & lociNames, const vectorstr & infoFields,
+                                     const vectorstr & intInfoFields)
 {
 	GenoStructure tmp = GenoStructure(ploidy, loci, chromTypes, haplodiploid,
-		lociPos, chromNames, alleleNames, lociNames, infoFields);
+		lociPos, chromNames, alleleNames, lociNames, infoFields, intInfoFields);
 
 	setGenoStructure(tmp);
 }
@@ -466,7 +487,7 @@ const GenoStructure GenoStruTrait::gsAddChromFromStru(size_t idx) const
 	chromTypes.insert(chromTypes.end(), gs2.m_chromTypes.begin(), gs2.m_chromTypes.end());
 	//
 	return GenoStructure(gs1.m_ploidy, numLoci, chromTypes, gs1.m_haplodiploid, lociPos,
-		chromNames, alleleNames, lociNames, gs1.m_infoFields);
+		chromNames, alleleNames, lociNames, gs1.m_infoFields, gs1.m_intInfoFields);
 }
 
 
@@ -582,7 +603,7 @@ const GenoStructure GenoStruTrait::gsAddLociFromStru(size_t idx, vectoru & index
 
 	//
 	GenoStructure ret = GenoStructure(gs1.m_ploidy, loci, chromTypes, gs1.m_haplodiploid, lociPos,
-		chromNames, alleleNames, lociNames, gs1.m_infoFields);
+		chromNames, alleleNames, lociNames, gs1.m_infoFields, gs1.m_intInfoFields);
 	index1.clear();
 	UINT locIdx = 0;
 	for (size_t ch = 0; ch < gs1.m_numLoci.size(); ++ch) {
@@ -738,7 +759,7 @@ const GenoStructure GenoStruTrait::gsAddLociByNameFromStru(size_t idx, vectoru &
 
 	//
 	GenoStructure ret = GenoStructure(gs1.m_ploidy, loci, chromTypes, gs1.m_haplodiploid, lociPos,
-		chromNames, alleleNames, lociNames, gs1.m_infoFields);
+		chromNames, alleleNames, lociNames, gs1.m_infoFields, gs1.m_intInfoFields);
 	//
 	// for index 1, chromosomes have kept their original order
 	index1.clear();
@@ -792,7 +813,7 @@ const GenoStructure GenoStruTrait::gsRemoveLoci(const vectoru & kept)
 	if (alleleNames.empty() && gs.m_alleleNames.size() == 1)
 		alleleNames = gs.m_alleleNames;
 	return GenoStructure(gs.m_ploidy, numLoci, gs.m_chromTypes, isHaplodiploid(),
-		lociPos, gs.m_chromNames, alleleNames, lociNames, gs.m_infoFields);
+		lociPos, gs.m_chromNames, alleleNames, lociNames, gs.m_infoFields, gs.m_intInfoFields);
 }
 
 
@@ -853,7 +874,7 @@ const GenoStructure GenoStruTrait::gsAddChrom(const vectorf & lociPos, const vec
 	newChromTypes.push_back(chromType);
 
 	return GenoStructure(gs.m_ploidy, newLoci, newChromTypes, gs.m_haplodiploid,
-		newLociPos, newChromNames, newAlleleNames, newLociNames, gs.m_infoFields);
+		newLociPos, newChromNames, newAlleleNames, newLociNames, gs.m_infoFields, gs.m_intInfoFields);
 }
 
 
@@ -864,7 +885,7 @@ const GenoStructure GenoStruTrait::gsSetAlleleNames(const lociList & loci_, cons
 	// if alleleNames is used totally redefined ...
 	if (loci_.allAvail())
 		return GenoStructure(gs.m_ploidy, gs.m_numLoci, gs.m_chromTypes, gs.m_haplodiploid,
-			gs.m_lociPos, gs.m_chromNames, alleleNames, gs.m_lociNames, gs.m_infoFields);
+			gs.m_lociPos, gs.m_chromNames, alleleNames, gs.m_lociNames, gs.m_infoFields, gs.m_intInfoFields);
 
 	const vectoru & loci = loci_.elems(this);
 	matrixstr names = gs.m_alleleNames;
@@ -900,7 +921,7 @@ const GenoStructure GenoStruTrait::gsSetAlleleNames(const lociList & loci_, cons
 	}
 	// replace common alleles
 	return GenoStructure(gs.m_ploidy, gs.m_numLoci, gs.m_chromTypes, gs.m_haplodiploid,
-		gs.m_lociPos, gs.m_chromNames, names, gs.m_lociNames, gs.m_infoFields);
+		gs.m_lociPos, gs.m_chromNames, names, gs.m_lociNames, gs.m_infoFields, gs.m_intInfoFields);
 }
 
 
@@ -981,7 +1002,7 @@ const GenoStructure GenoStruTrait::gsAddLoci(const vectoru & chrom, const vector
 
 	// set newIndex
 	GenoStructure ret = GenoStructure(gs.m_ploidy, newLoci, gs.m_chromTypes, gs.m_haplodiploid,
-		newLociPos, gs.m_chromNames, newAlleleNames, newLociNames, gs.m_infoFields);
+		newLociPos, gs.m_chromNames, newAlleleNames, newLociNames, gs.m_infoFields, gs.m_intInfoFields);
 	newIndex.clear();
 	for (size_t i = 0; i < lociPos.size(); ++i) {
 		size_t ch = chrom[i];
@@ -1128,17 +1149,33 @@ size_t GenoStruTrait::infoIdx(const string & name) const
 }
 
 
-const GenoStructure GenoStruTrait::gsAddInfoFields(const vectorstr & fields)
+int GenoStruTrait::infoType(const uintString & field) const
+{
+	size_t idx = field.empty() ? field.value() : infoIdx(field.name());
+
+	CHECKRANGEINFO(idx);
+	return isIntInfoField(idx) ? INFO_INT64 : INFO_FLOAT64;
+}
+
+
+const GenoStructure GenoStruTrait::gsAddInfoFields(const vectorstr & fields, int type)
 {
 	GenoStructure gs = GenoStructure(s_genoStruRepository[m_genoStruIdx]);
 
 	vectorstr::const_iterator it = fields.begin();
 	vectorstr::const_iterator it_end = fields.end();
 
+	vectorstr intFields = gs.m_intInfoFields;
 	for (; it != it_end; ++it) {
 		if (std::find(gs.m_infoFields.begin(), gs.m_infoFields.end(), *it) == gs.m_infoFields.end())
 			gs.m_infoFields.push_back(*it);
+		vectorstr::iterator intIt = std::find(intFields.begin(), intFields.end(), *it);
+		if (type == INFO_INT64 && intIt == intFields.end())
+			intFields.push_back(*it);
+		else if (type != INFO_INT64 && intIt != intFields.end())
+			intFields.erase(intIt);
 	}
+	gs.setIntInfoFields(intFields);
 	gs.m_refCount = 0;
 	return gs;
 }
@@ -1155,6 +1192,8 @@ const GenoStructure GenoStruTrait::gsSetInfoFields(const vectorstr & fields)
 		if (std::find(gs.m_infoFields.begin(), gs.m_infoFields.end(), *it) == gs.m_infoFields.end())
 			gs.m_infoFields.push_back(*it);
 	}
+	// fields that are kept keep their types
+	gs.setIntInfoFields(vectorstr(gs.m_intInfoFields));
 	gs.m_refCount = 0;
 	return gs;
 }
@@ -71,8 +71,8 @@ public:
 	GenoStructure() : m_ploidy(2), m_totNumLoci(0),
 		m_numLoci(0), m_chromTypes(), m_chromX(-1), m_chromY(-1), m_mitochondrial(-1), m_customized(),
 		m_haplodiploid(false), m_lociPos(0), m_chromIndex(0),
-		m_chromNames(), m_alleleNames(), m_lociNames(), m_lociNameMap(), m_infoFields(0), m_lociPosMap(),
-		m_refCount(0)
+		m_chromNames(), m_alleleNames(), m_lociNames(), m_lociNameMap(), m_infoFields(0),
+		m_intInfoFields(), m_intInfo(), m_lociPosMap(), m_refCount(0)
 	{
 	}
 
@@ -87,10 +87,12 @@ public:
 	   \param alleleNames allele names
 	   \param lociNames name of loci
 	   \param length of info field
+	   \param intInfoFields information fields that store 64-bit integers
 	 */
 	GenoStructure(UINT ploidy, const vectoru & loci, const vectoru & chromTypes, bool haplodiploid,
 		const vectorf & lociPos, const vectorstr & chromNames, const matrixstr & alleleNames,
-		const vectorstr & lociNames, const vectorstr & infoFields);
+		const vectorstr & lociNames, const vectorstr & infoFields,
+		const vectorstr & intInfoFields = vectorstr());
 
 	bool operator==(const GenoStructure & rhs);
 
@@ -128,6 +130,9 @@ public:
 	/// CPPONLY
 	void setChromTypes(const vectoru & chromTypes);
 
+	/// CPPONLY set information fields that store 64-bit integers
+	void setIntInfoFields(const vectorstr & fields);
+
 private:
 	friend class boost::serialization::access;
 
@@ -143,12 +148,13 @@ private:
 		ar & m_alleleNames;
 		ar & m_lociNames;
 		ar & m_infoFields;
+		ar & m_intInfoFields;
 		/// do not save load chromosome map
 	}
 
 
 	template<class Archive>
-	void load(Archive & ar, const UINT /* version */)
+	void load(Archive & ar, const UINT version)
 	{
 
 		ar & m_ploidy;
@@ -166,6 +172,11 @@ private:
 		ar & m_alleleNames;
 		ar & m_lociNames;
 		ar & m_infoFields;
+		// integer information fields are introduced in version 1
+		vectorstr intInfoFields;
+		if (version >= 1)
+			ar & intInfoFields;
+		setIntInfoFields(intInfoFields);
 
 		m_lociNameMap.clear();
 		if (!m_lociNames.empty()) {
@@ -236,6 +247,12 @@ private:
 	/// name of the information field
 	vectorstr m_infoFields;
 
+	/// names of information fields that store 64-bit integers
+	vectorstr m_intInfoFields;
+
+	/// if each information field stores a 64-bit integer, empty if none does
+	vector<bool> m_intInfo;
+
 	mutable map<genomic_pos, size_t> m_lociPosMap;
 
 	mutable UINT m_refCount;
@@ -248,7 +265,8 @@ private:
 #ifndef SWIG
 // set version for GenoStructure class
 // version 0: base (reset for 1.0)
-BOOST_CLASS_VERSION(simuPOP::GenoStructure, 0)
+// version 1: add integer information fields
+BOOST_CLASS_VERSION(simuPOP::GenoStructure, 1)
 #endif
 
 namespace simuPOP {
@@ -291,7 +309,8 @@ public:
 	/// CPPONLY set genotypic structure
 	void setGenoStructure(UINT ploidy, const vectoru & loci, const vectoru & chromTypes, bool haplodiploid,
 		const vectorf & lociPos, const vectorstr & chromNames, const matrixstr & alleleNames,
-		const vectorstr & lociNames, const vectorstr & infoFields);
+		const vectorstr & lociNames, const vectorstr & infoFields,
+		const vectorstr & intInfoFields = vectorstr());
 
 	/// CPPONLY set an existing geno structure
 	/**
@@ -830,12 +849,42 @@ public:
 	 */
 	size_t infoIdx(const string & name) const;
 
+	/** return the type (\c INFO_FLOAT64 or \c INFO_INT64) of information
+	 *  field \e field (by index or name).
+	 *  <group>5-info</group>
+	 */
+	int infoType(const uintString & field) const;
+
+	/// CPPONLY return \c true if information field \e idx stores a 64-bit integer
+	bool isIntInfoField(size_t idx) const
+	{
+		const vector<bool> & intInfo = s_genoStruRepository[m_genoStruIdx].m_intInfo;
+
+		return !intInfo.empty() && intInfo[idx];
+	}
+
+
+	/// CPPONLY return \c true if any information field stores a 64-bit integer
+	bool hasIntInfoFields() const
+	{
+		return !s_genoStruRepository[m_genoStruIdx].m_intInfo.empty();
+	}
+
+
+	/// CPPONLY return the names of information fields that store 64-bit integers
+	vectorstr intInfoFields() const
+	{
+		return s_genoStruRepository[m_genoStruIdx].m_intInfoFields;
+	}
+
+
 	/// CPPONLY add a new information field
 	/**
 	   \note Should only be called by Population::requestInfoField.
 	   Right now, do not allow dynamic addition of these fields.
+	   Existing fields are changed to type \e type.
 	 */
-	const GenoStructure gsAddInfoFields(const vectorstr & fields);
+	const GenoStructure gsAddInfoFields(const vectorstr & fields, int type = INFO_FLOAT64);
 
 	/// CPPONLY should only be called from population
 	const GenoStructure gsSetInfoFields(const vectorstr & fields);
@@ -108,7 +108,8 @@ bool Individual::operator==(const Individual & rhs) const
 #endif
 
 	for (size_t i = 0, iEnd = infoSize(); i < iEnd; ++i)
-		if (*(m_infoPtr + i) != *(rhs.m_infoPtr + i)) {
+		if (isIntInfoField(i) ? int64Info(m_infoPtr[i]) != int64Info(rhs.m_infoPtr[i])
+		    : *(m_infoPtr + i) != *(rhs.m_infoPtr + i)) {
 			DBG_DO(DBG_POPULATION, cerr << "Information field " << infoField(i) << " differ" << endl);
 			return false;
 		}
@@ -1031,7 +1032,10 @@ void Individual::display(ostream & out, int width, const vectoru & loci, const v
 		out << "| ";
 		for (vectoru::const_iterator info = infoIdx.begin();
 			info != infoIdx.end(); ++info)
-			out << " " << *(infoBegin() + *info);
+			if (isIntInfoField(*info))
+				out << " " << int64Info(m_infoPtr[*info]);
+			else
+				out << " " << m_infoPtr[*info];
 	}
 }
 
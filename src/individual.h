@@ -50,6 +50,8 @@ using std::dec;
 #include <numeric>
 using std::pair;
 
+#include <cstring>
+
 namespace simuPOP {
 
 
@@ -514,6 +516,8 @@ public:
 		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
 
 		CHECKRANGEINFO(idx);
+		if (isIntInfoField(idx))
+			return static_cast<double>(int64Info(m_infoPtr[idx]));
 		return m_infoPtr[idx];
 	}
 
@@ -527,10 +531,28 @@ public:
 		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
 
 		CHECKRANGEINFO(idx);
+		if (isIntInfoField(idx))
+			return static_cast<int>(int64Info(m_infoPtr[idx]));
 		return static_cast<int>(m_infoPtr[idx]);
 	}
 
 
+	/** Return the value of an information field \e field (by index or name)
+	 *  as an individual ID. The value is exact if the field stores 64-bit
+	 *  integers, and is rounded from a floating point number otherwise.
+	 *  CPPONLY
+	 */
+	size_t idInfo(const uintString & field) const
+	{
+		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
+
+		CHECKRANGEINFO(idx);
+		if (isIntInfoField(idx))
+			return static_cast<size_t>(int64Info(m_infoPtr[idx]));
+		return toID(m_infoPtr[idx]);
+	}
+
+
 	/** set the value of an information field \e field (by index or name) to
 	 *  \e value. <tt>ind.setInfo(value, field)</tt> is equivalent to
 	 *  <tt>ind.field = value</tt> although the function form allows the use
@@ -542,7 +564,53 @@ public:
 		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
 
 		CHECKRANGEINFO(idx);
-		m_infoPtr[idx] = value;
+		if (isIntInfoField(idx))
+			setInt64Info(roundInt64(value), m_infoPtr[idx]);
+		else
+			m_infoPtr[idx] = value;
+	}
+
+
+	/** set the value of an information field \e field (by index or name) to
+	 *  individual ID \e id, which is stored exactly if the field stores
+	 *  64-bit integers.
+	 *  CPPONLY
+	 */
+	void setIdInfo(size_t id, const uintString & field)
+	{
+		size_t idx = field.empty() ? field.value() : infoIdx(field.name());
+
+		CHECKRANGEINFO(idx);
+		if (isIntInfoField(idx))
+			setInt64Info(static_cast<int64_t>(id), m_infoPtr[idx]);
+		else
+			m_infoPtr[idx] = static_cast<double>(id);
+	}
+
+
+	/** CPPONLY return the 64-bit integer stored in \e slot of an information
+	 *  field of type \c INFO_INT64, which keeps the bit pattern of the integer.
+	 */
+	static int64_t int64Info(const double & slot)
+	{
+		int64_t value;
+
+		memcpy(&value, &slot, sizeof(value));
+		return value;
+	}
+
+
+	/// CPPONLY store a 64-bit integer \e value to \e slot of an information field
+	static void setInt64Info(int64_t value, double & slot)
+	{
+		memcpy(&slot, &value, sizeof(value));
+	}
+
+
+	/// CPPONLY round \e value to the nearest 64-bit integer
+	static int64_t roundInt64(double value)
+	{
+		return static_cast<int64_t>(value < 0 ? value - 0.5 : value + 0.5);
 	}
 
 
@@ -792,6 +860,14 @@ public:
 	bool operator()(const Individual & lhs, const Individual & rhs) const
 	{
 		for (size_t i = 0; i < m_fields.size(); ++i) {
+			if (lhs.isIntInfoField(m_fields[i])) {
+				// compare IDs beyond 2^53 exactly
+				int64_t v1 = Individual::int64Info(lhs.infoPtr()[m_fields[i]]);
+				int64_t v2 = Individual::int64Info(rhs.infoPtr()[m_fields[i]]);
+				if (v1 == v2)
+					continue;
+				return m_reverse ? v1 > v2 : v1 < v2;
+			}
 			double v1 = lhs.info(m_fields[i]);
 			double v2 = rhs.info(m_fields[i]);
 			if (v1 == v2)
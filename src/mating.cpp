@@ -270,6 +270,20 @@ void OffspringGenerator::initialize(const Population & pop, size_t /* subPop */)
 }
 
 
+void OffspringGenerator::finalize(Population & pop)
+{
+	opList::const_iterator iop = m_transmitters.begin();
+	opList::const_iterator iopEnd = m_transmitters.end();
+
+	for (; iop != iopEnd; ++iop)
+		(*iop)->finalizeDuringMating(pop);
+
+	m_numOffModel->reset();
+	m_sexModel->reset();
+	m_initialized = false;
+}
+
+
 string OffspringGenerator::describe(bool format) const
 {
 	string desc = "<simuPOP.OffspringGenerator> produces offspring using operators\n<ul>\n";
@@ -611,11 +625,20 @@ void SequentialParentChooser::initialize(Population & pop, size_t sp)
 		m_begin = pop.indIterator(sp);
 		m_ind = m_begin;
 	} else {
-		IndIterator it = pop.indIterator(sp);
 		Sex s = m_choice == MALE_ONLY ? MALE : FEMALE;
-		for (; it.valid(); ++it) {
-			if (it->sex() == s)
-				m_index.push_back(it.rawIter());
+		if (pop.hasActivatedVirtualSubPop(sp)) {
+			IndIterator it = pop.indIterator(sp);
+			for (; it.valid(); ++it) {
+				if (it->sex() == s)
+					m_index.push_back(it.rawIter());
+			}
+		} else {
+			// read sex from packed bits instead of individuals
+			const vector<uint64_t> & male = pop.maleBits(sp);
+			RawIndIterator base = pop.rawIndBegin();
+			for (size_t i = pop.subPopBegin(sp); i < pop.subPopEnd(sp); ++i)
+				if (Population::flagBit(male, i) == (s == MALE))
+					m_index.push_back(base + i);
 		}
 		DBG_FAILIF(m_index.empty(), RuntimeError,
 			string("No ") + (s == MALE ? "male" : "female") + " individual exists in a population.");
@@ -664,7 +687,7 @@ void RandomParentChooser::initialize(Population & pop, size_t sp)
 					fitness.push_back(it->info(fit_id));
 			}
 			DBG_FAILIF(m_index.empty(), RuntimeError, "Can not select parent from an empty subpopulation.");
-		} else {
+		} else if (pop.hasActivatedVirtualSubPop(sp)) {
 			Sex s = m_choice == MALE_ONLY ? MALE : FEMALE;
 			for (; it.valid(); ++it) {
 				if (it->sex() == s) {
@@ -675,12 +698,29 @@ void RandomParentChooser::initialize(Population & pop, size_t sp)
 			}
 			DBG_FAILIF(m_index.empty(), RuntimeError,
 				string("No ") + (s == MALE ? "male" : "female") + " individual exists in a population.");
+		} else {
+			Sex s = m_choice == MALE_ONLY ? MALE : FEMALE;
+			// read sex from packed bits instead of individuals
+			const vector<uint64_t> & male = pop.maleBits(sp);
+			RawIndIterator base = pop.rawIndBegin();
+			for (size_t i = pop.subPopBegin(sp); i < pop.subPopEnd(sp); ++i) {
+				if (Population::flagBit(male, i) == (s == MALE)) {
+					m_index.push_back(base + i);
+					if (m_selection)
+						fitness.push_back((base + i)->info(fit_id));
+				}
+			}
+			DBG_FAILIF(m_index.empty(), RuntimeError,
+				string("No ") + (s == MALE ? "male" : "female") + " individual exists in a population.");
 		}
 	} else {
 		if (!m_replacement)
 			for (IndIterator it = pop.indIterator(sp); it.valid(); ++it)
 				m_index.push_back(it.rawIter());
-		if (m_selection)
+		if (m_selection && pop.isIntInfoField(fit_id)) {
+			for (IndIterator it = pop.indIterator(sp); it.valid(); ++it)
+				fitness.push_back(it->info(fit_id));
+		} else if (m_selection)
 			fitness = vectorf(pop.infoBegin(fit_id, sp), pop.infoEnd(fit_id, sp));
 	}
 
@@ -755,16 +795,33 @@ void RandomParentsChooser::initialize(Population & pop, size_t subPop)
 		maleFitness = m_fitness.begin();
 		femaleFitness = m_fitness.rbegin();
 	}
-	IndIterator it = pop.indIterator(subPop);
-	for (; it.valid(); it++) {
-		if (it->sex() == MALE) {
-			*maleIndex++ = it.rawIter();
-			if (m_selection)
-				*maleFitness++ = it->info(fit_id);
-		} else {
-			*femaleIndex++ = it.rawIter();
-			if (m_selection)
-				*femaleFitness++ = it->info(fit_id);
+	if (pop.hasActivatedVirtualSubPop(subPop)) {
+		IndIterator it = pop.indIterator(subPop);
+		for (; it.valid(); it++) {
+			if (it->sex() == MALE) {
+				*maleIndex++ = it.rawIter();
+				if (m_selection)
+					*maleFitness++ = it->info(fit_id);
+			} else {
+				*femaleIndex++ = it.rawIter();
+				if (m_selection)
+					*femaleFitness++ = it->info(fit_id);
+			}
+		}
+	} else {
+		// read sex from packed bits instead of individuals
+		const vector<uint64_t> & male = pop.maleBits(subPop);
+		RawIndIterator base = pop.rawIndBegin();
+		for (size_t i = pop.subPopBegin(subPop); i < pop.subPopEnd(subPop); ++i) {
+			if (Population::flagBit(male, i)) {
+				*maleIndex++ = base + i;
+				if (m_selection)
+					*maleFitness++ = (base + i)->info(fit_id);
+			} else {
+				*femaleIndex++ = base + i;
+				if (m_selection)
+					*femaleFitness++ = (base + i)->info(fit_id);
+			}
 		}
 	}
 	// m_numMale + m_numFemale might not be pop.subPopSize because of virtual subpopulation
@@ -840,12 +897,17 @@ void PolyParentsChooser::initialize(Population & pop, size_t subPop)
 	m_polyCount = 0;
 #endif
 
-	IndIterator it = pop.indIterator(subPop);
-	for (; it.valid(); ++it) {
-		if (it->sex() == MALE)
-			m_numMale++;
-		else
-			m_numFemale++;
+	if (pop.hasActivatedVirtualSubPop(subPop)) {
+		IndIterator it = pop.indIterator(subPop);
+		for (; it.valid(); ++it) {
+			if (it->sex() == MALE)
+				m_numMale++;
+			else
+				m_numFemale++;
+		}
+	} else {
+		m_numMale = Population::countBits(pop.maleBits(subPop), pop.subPopBegin(subPop), pop.subPopEnd(subPop));
+		m_numFemale = pop.subPopSize(subPop) - m_numMale;
 	}
 
 	// allocate memory at first for performance reasons
@@ -864,7 +926,7 @@ void PolyParentsChooser::initialize(Population & pop, size_t subPop)
 	m_numMale = 0;
 	m_numFemale = 0;
 
-	it = pop.indIterator(subPop);
+	IndIterator it = pop.indIterator(subPop);
 	for (; it.valid(); it++) {
 		if (it->sex() == MALE) {
 			m_maleIndex[m_numMale] = it.rawIter();
@@ -1237,6 +1299,510 @@ MatingScheme::MatingScheme(const uintListFunc & subPopSize)
 }
 
 
+// call a Python function with parameters (pop, arg), arg is ignored if NULL.
+static PyObject * callPyWithPop(PyObject * func, Population & pop, PyObject * arg = NULL)
+{
+	PyObject * popObj = pyPopObj(static_cast<void *>(&pop));
+	PyObject * res = NULL;
+	{
+		PythonCallGuard guard;
+		res = PyObject_CallFunctionObjArgs(func, popObj, arg, NULL);
+	}
+	Py_DECREF(popObj);
+	if (res == NULL) {
+		PyErr_Print();
+		PyErr_Clear();
+		throw ValueError("Failed to apply demographic model or event.");
+	}
+	return res;
+}
+
+
+// convert sizes returned by a demographic model
+static vectoru demographicSizes(const vectori & res)
+{
+	vectoru sz(res.size());
+	for (size_t i = 0; i < res.size(); i++) {
+		if (res[i] < 0)
+			throw ValueError((boost::format("Negative population size %1% returned for subpopulation %2%") % res[i] % i).str());
+		sz[i] = static_cast<ULONG>(res[i]);
+	}
+	return sz;
+}
+
+
+// return the native model of a Python demographic model, if available
+static NativeDemographicModel * nativeModelOf(PyObject * model)
+{
+	if (!PyObject_HasAttrString(model, "_native"))
+		return NULL;
+	PyObject * obj = PyObject_GetAttrString(model, "_native");
+	NativeDemographicModel * native = NULL;
+	if (obj != Py_None)
+		native = reinterpret_cast<NativeDemographicModel *>(pyDemographicModelPointer(obj));
+	Py_DECREF(obj);
+	return native != NULL && !native->isReset() ? native : NULL;
+}
+
+
+// read an attribute of a Python object as a number or a list of numbers,
+// return true if the attribute is a sequence.
+static bool pyAttrAsArray(PyObject * obj, const char * name, vectorf & val)
+{
+	PyObject * attr = PyObject_GetAttrString(obj, name);
+	DBG_ASSERT(attr, ValueError, (boost::format("Failed to get attribute %1%") % name).str());
+	bool isSeq = PySequence_Check(attr) != 0;
+	if (attr == Py_None || !PyObject_IsTrue(attr))
+		val.clear();
+	else
+		PyObj_As_Array(attr, val);
+	Py_DECREF(attr);
+	return isSeq;
+}
+
+
+static bool isPyString(PyObject * obj)
+{
+#if PY_VERSION_HEX >= 0x03000000
+	return PyUnicode_Check(obj);
+#else
+	return PyString_Check(obj) || PyUnicode_Check(obj);
+#endif
+}
+
+
+static long pyAttrAsInt(PyObject * obj, const char * name)
+{
+	PyObject * attr = PyObject_GetAttrString(obj, name);
+	DBG_ASSERT(attr, ValueError, (boost::format("Failed to get attribute %1%") % name).str());
+	long val = 0;
+	PyObj_As_Int(attr, val);
+	Py_DECREF(attr);
+	return val;
+}
+
+
+NativeDemographicModel::NativeDemographicModel(PyObject * model, long startGen, long numGens,
+	const uintList & startSize, const opList & ops)
+	: m_model(model), m_startGen(startGen), m_lastGen(startGen), m_numGens(numGens),
+	m_ops(ops), m_reset(false), m_expectedSize(), m_sizeCache()
+{
+	if (!startSize.elems().empty())
+		m_sizeCache[startGen] = startSize.elems();
+}
+
+
+void NativeDemographicModel::setGenVars(Population & pop, long gen) const
+{
+	pop.getVars().setVar("_gen", gen);
+	pop.getVars().setVar("_num_gens", m_numGens);
+}
+
+
+void NativeDemographicModel::readExpectedSize(Population & pop)
+{
+	SharedVariables & vars = pop.getVars();
+
+	if (!vars.hasVar("_expected_size"))
+		return;
+	vectori val;
+	PyObj_As_IntArray(vars.getVar("_expected_size"), val);
+	vars.removeVar("_expected_size");
+	m_expectedSize = demographicSizes(val);
+}
+
+
+vectoru NativeDemographicModel::subPopSizes(Population & pop)
+{
+	long gen = static_cast<long>(pop.gen());
+
+	// applied to a generation that has been evolved, return cached size
+	if (gen != m_lastGen + 1) {
+		PARAM_FAILIF(m_sizeCache.empty(), RuntimeError,
+			(boost::format("Failed to determine size for generation %1%") % gen).str());
+		std::map<long, vectoru>::const_iterator it = m_sizeCache.upper_bound(gen);
+		// size of the last generation with changed size at or before gen
+		// is used, or the last size if gen is after all recorded generations
+		PARAM_FAILIF(it == m_sizeCache.begin(), RuntimeError,
+			(boost::format("Failed to determine size for generation %1%") % gen).str());
+		return (--it)->second;
+	}
+	m_lastGen = gen;
+	long modelGen = gen - m_startGen;
+
+	setGenVars(pop, modelGen);
+	m_expectedSize.clear();
+	if (!m_ops.empty()) {
+		opList::const_iterator it = m_ops.begin();
+		opList::const_iterator itEnd = m_ops.end();
+		for (; it != itEnd; ++it) {
+			if (!(*it)->apply(pop)) {
+				m_reset = true;
+				return vectoru();
+			}
+		}
+		readExpectedSize(pop);
+	}
+	vectoru sz;
+	if (!nextSizes(pop, modelGen, sz) || sz.empty())
+		return vectoru();
+	// only record sizes that differ from the previous generation
+	std::map<long, vectoru>::const_iterator it = m_sizeCache.lower_bound(gen);
+	if (it == m_sizeCache.begin() || (--it)->second != sz)
+		m_sizeCache[gen] = sz;
+	return sz;
+}
+
+
+NativeGrowthModel::NativeGrowthModel(PyObject * model, long startGen, long numGens,
+	const uintList & startSize, const opList & ops,
+	const uintList & N0, const floatList & NT, const floatList & r,
+	bool exponential)
+	: NativeDemographicModel(model, startGen, numGens, startSize, ops),
+	m_N0(N0.elems()), m_NT(NT.elems()), m_r(r.elems()), m_exponential(exponential)
+{
+	PARAM_FAILIF(m_N0.size() != m_NT.size() || (!m_r.empty() && m_r.size() != m_N0.size()),
+		ValueError, "Starting and ending population should have the same number of subpopulations");
+}
+
+
+bool NativeGrowthModel::nextSizes(Population & /* pop */, long gen, vectoru & sz)
+{
+	if (gen == m_numGens)
+		return false;
+
+	vectori res(m_N0.size());
+	double T = static_cast<double>(m_numGens);
+	for (size_t i = 0; i < m_N0.size(); ++i) {
+		double n0 = static_cast<double>(m_N0[i]);
+		double nt = m_NT[i];
+		if (m_r.empty()) {
+			// interpolate between N0 and NT
+			if (gen == m_numGens - 1)
+				res[i] = static_cast<long>(nt);
+			else if (m_exponential)
+				res[i] = static_cast<long>(nearbyint(exp(((gen + 1) * log(nt) + (T - gen - 1) * log(n0)) / T)));
+			else
+				res[i] = static_cast<long>(nearbyint(((gen + 1) * nt + (T - gen - 1) * n0) / T));
+		} else if (m_exponential)
+			res[i] = std::min(static_cast<long>(nearbyint(nt)),
+				static_cast<long>(nearbyint(n0 * exp(m_r[i] * (gen + 1)))));
+		else
+			res[i] = std::min(static_cast<long>(nt),
+				static_cast<long>(n0 + n0 * (gen + 1.) * m_r[i]));
+	}
+	sz = demographicSizes(res);
+	return true;
+}
+
+
+NativeInstantChangeModel::NativeInstantChangeModel(PyObject * model, long startGen, long numGens,
+	const uintList & startSize, const opList & ops,
+	const uintList & G, bool removeEmptySubPops)
+	: NativeDemographicModel(model, startGen, numGens, startSize, ops),
+	m_G(G.elems()), m_removeEmptySubPops(removeEmptySubPops)
+{
+}
+
+
+bool NativeInstantChangeModel::nextSizes(Population & pop, long gen, vectoru & sz)
+{
+	vectoru::const_iterator it = find(m_G.begin(), m_G.end(), static_cast<size_t>(gen));
+	if (gen >= 0 && it != m_G.end()) {
+		// let the Python model fit the population to the new size
+		PyObject * NG = PyObject_GetAttrString(m_model, "NG");
+		PyObject * fit = PyObject_GetAttrString(m_model, "_fitToSize");
+		DBG_ASSERT(NG && fit, RuntimeError, "Invalid InstantChangeModel");
+		PyObject * size = PySequence_GetItem(NG, it - m_G.begin());
+		PyObject * res = callPyWithPop(fit, pop, size);
+		Py_DECREF(res);
+		Py_DECREF(size);
+		Py_DECREF(fit);
+		Py_DECREF(NG);
+	}
+	if (m_removeEmptySubPops) {
+		subPopList emptySubPops;
+		for (size_t i = 0; i < pop.numSubPop(); ++i)
+			if (pop.subPopSize(i) == 0)
+				emptySubPops.push_back(i);
+		if (!emptySubPops.empty())
+			pop.removeSubPops(emptySubPops);
+	}
+	sz = pop.subPopSizes();
+	return true;
+}
+
+
+NativeMultiStageModel::NativeMultiStageModel(PyObject * model, long startGen, long numGens,
+	const uintList & startSize, const opList & ops,
+	size_t modelIdx, long modelStartGen)
+	: NativeDemographicModel(model, startGen, numGens, startSize, ops),
+	m_models(NULL), m_modelIdx(modelIdx), m_modelStartGen(modelStartGen)
+{
+	PyObject * models = PyObject_GetAttrString(model, "models");
+	DBG_ASSERT(models && PySequence_Check(models), ValueError,
+		"Invalid MultiStageModel");
+	m_models = pyObject(models);
+	Py_DECREF(models);
+}
+
+
+long NativeMultiStageModel::stageGens(size_t idx) const
+{
+	PyObject * stage = PySequence_GetItem(m_models.object(), idx);
+	NativeDemographicModel * native = nativeModelOf(stage);
+	long gens = native ? native->numGens() : pyAttrAsInt(stage, "num_gens");
+	Py_DECREF(stage);
+	return gens;
+}
+
+
+bool NativeMultiStageModel::applyStage(size_t idx, Population & pop, vectoru & sz)
+{
+	PyObject * stage = PySequence_GetItem(m_models.object(), idx);
+	NativeDemographicModel * native = nativeModelOf(stage);
+	if (native)
+		sz = native->subPopSizes(pop);
+	else {
+		// the first generation of a stage is handled by the Python model
+		PyObject * res = callPyWithPop(stage, pop);
+		vectori val;
+		PyObj_As_IntArray(res, val);
+		Py_DECREF(res);
+		sz = demographicSizes(val);
+	}
+	Py_DECREF(stage);
+	return !sz.empty();
+}
+
+
+bool NativeMultiStageModel::advance(Population & pop, long gen, vectoru & sz)
+{
+	++m_modelIdx;
+	m_modelStartGen = gen;
+	size_t numModels = PySequence_Size(m_models.object());
+	while (true) {
+		if (m_modelIdx == numModels) {
+			// the Python model will reset itself when it is called again.
+			m_reset = true;
+			return false;
+		}
+		// call and skip
+		if (stageGens(m_modelIdx) == 0) {
+			applyStage(m_modelIdx, pop, sz);
+			++m_modelIdx;
+			continue;
+		}
+		if (applyStage(m_modelIdx, pop, sz))
+			return true;
+		++m_modelIdx;
+	}
+	return false;
+}
+
+
+bool NativeMultiStageModel::nextSizes(Population & pop, long gen, vectoru & sz)
+{
+	long gens = stageGens(m_modelIdx);
+
+	if (gens < 0 || gens > gen - m_modelStartGen) {
+		if (!applyStage(m_modelIdx, pop, sz))
+			return advance(pop, gen, sz);
+	} else if (gens == 0) {
+		applyStage(m_modelIdx, pop, sz);
+		return advance(pop, gen, sz);
+	} else
+		return advance(pop, gen, sz);
+	return true;
+}
+
+
+NativeEventBasedModel::NativeEventBasedModel(PyObject * model, long startGen, long numGens,
+	const uintList & startSize, const opList & ops, PyObject * events)
+	: NativeDemographicModel(model, startGen, numGens, startSize, ops),
+	m_events()
+{
+	DBG_ASSERT(PySequence_Check(events), ValueError, "A list of demographic events is expected.");
+	for (Py_ssize_t i = 0; i < PySequence_Size(events); ++i) {
+		PyObject * obj = PySequence_GetItem(events, i);
+		Event event(obj);
+		event.begin = pyAttrAsInt(obj, "begin");
+		event.end = pyAttrAsInt(obj, "end");
+		event.step = pyAttrAsInt(obj, "step");
+		PyObject * attr = PyObject_GetAttrString(obj, "at");
+		PyObj_As_IntArray(attr, event.at);
+		Py_DECREF(attr);
+		attr = PyObject_GetAttrString(obj, "reps");
+		if (attr != Py_True)
+			PyObj_As_IntArray(attr, event.reps);
+		Py_DECREF(attr);
+		// only expansion events without operators are applied natively
+		PyObject * cls = PyObject_GetAttrString(obj, "__class__");
+		PyObject * name = PyObject_GetAttrString(cls, "__name__");
+		PyObject * evtOps = PyObject_GetAttrString(obj, "ops");
+		event.expansion = PyObj_AsString(name) == "ExpansionEvent" && PySequence_Size(evtOps) == 0;
+		Py_DECREF(evtOps);
+		Py_DECREF(name);
+		Py_DECREF(cls);
+		if (event.expansion) {
+			event.multiRates = pyAttrAsArray(obj, "rates", event.rates);
+			if (event.rates.empty())
+				event.multiRates = pyAttrAsArray(obj, "slopes", event.slopes);
+			event.multiCapacity = pyAttrAsArray(obj, "capacity", event.capacity);
+			attr = PyObject_GetAttrString(obj, "subPops");
+			event.allSubPops = attr == Py_True;
+			if (!event.allSubPops) {
+				PyObject * sps = PySequence_Check(attr) && !isPyString(attr) ? attr : NULL;
+				Py_ssize_t n = sps ? PySequence_Size(sps) : 1;
+				for (Py_ssize_t j = 0; j < n; ++j) {
+					PyObject * sp = sps ? PySequence_GetItem(sps, j) : attr;
+					if (isPyString(sp)) {
+						event.subPops.push_back(-1);
+						event.subPopNames.push_back(PyObj_AsString(sp));
+					} else {
+						long idx = 0;
+						PyObj_As_Int(sp, idx);
+						event.subPops.push_back(idx);
+						event.subPopNames.push_back(string());
+					}
+					if (sps)
+						Py_DECREF(sp);
+				}
+			}
+			Py_DECREF(attr);
+			// continue from the state of the Python event
+			attr = PyObject_GetAttrString(obj, "_N0");
+			if (attr != Py_None) {
+				vectori N0;
+				PyObj_As_IntArray(attr, N0);
+				event.N0 = demographicSizes(N0);
+				event.T0 = pyAttrAsInt(obj, "_T0");
+			}
+			Py_DECREF(attr);
+		}
+		m_events.push_back(event);
+		Py_DECREF(obj);
+	}
+}
+
+
+bool NativeEventBasedModel::applicable(const Event & event, long gen, long rep) const
+{
+	long end = m_numGens - 1;
+
+	if (!event.reps.empty() && find(event.reps.begin(), event.reps.end(), rep) == event.reps.end())
+		return false;
+	//
+	if (!event.at.empty()) {
+		for (size_t i = 0; i < event.at.size(); ++i) {
+			long a = event.at[i];
+			if (a >= 0 ? a == gen : (end >= 0 && end + a + 1 == gen))
+				return true;
+		}
+		return false;
+	}
+	//
+	if (end < 0)
+		return event.begin >= 0 && event.begin <= gen && (gen - event.begin) % event.step == 0;
+	long rstart = event.begin >= 0 ? event.begin : event.begin + end + 1;
+	long rend = event.end >= 0 ? event.end : event.end + end + 1;
+	if (rstart > rend)
+		return false;
+	return gen >= rstart && gen <= rend && (gen - rstart) % event.step == 0;
+}
+
+
+void NativeEventBasedModel::expand(Event & event, Population & pop)
+{
+	vectoru subPops;
+	if (event.allSubPops) {
+		for (size_t sp = 0; sp < pop.numSubPop(); ++sp)
+			subPops.push_back(sp);
+	} else {
+		vectorstr names = pop.subPopNames();
+		for (size_t i = 0; i < event.subPops.size(); ++i) {
+			if (event.subPops[i] >= 0) {
+				subPops.push_back(event.subPops[i]);
+				continue;
+			}
+			vectorstr::iterator it = find(names.begin(), names.end(), event.subPopNames[i]);
+			PARAM_FAILIF(it == names.end(), ValueError,
+				(boost::format("Invalid subpopulation name %1%") % event.subPopNames[i]).str());
+			subPops.push_back(it - names.begin());
+		}
+	}
+	const vectorf & rates = event.rates.empty() ? event.slopes : event.rates;
+	PARAM_FAILIF(event.multiRates && rates.size() != subPops.size(), ValueError,
+		(boost::format("Please specify growth rate or slopes for all subpopulations or each of the %1% subpopulations") % subPops.size()).str());
+	PARAM_FAILIF(event.multiCapacity && event.capacity.size() != subPops.size(), ValueError,
+		(boost::format("If specified, please specify carrying capacity for all subpopulations or each of the %1% subpopulations") % subPops.size()).str());
+
+	vectoru sz = m_expectedSize.empty() ? pop.subPopSizes() : m_expectedSize;
+	long gen = static_cast<long>(pop.gen());
+	if (event.N0.size() != subPops.size()) {
+		event.N0.resize(subPops.size());
+		for (size_t i = 0; i < subPops.size(); ++i)
+			event.N0[i] = sz[subPops[i]];
+		event.T0 = gen;
+	}
+	for (size_t i = 0; i < subPops.size(); ++i) {
+		size_t sp = subPops[i];
+		double r = event.multiRates ? rates[i] : rates[0];
+		double expected = event.rates.empty() ? event.N0[i] + (gen - event.T0) * r
+		                  : event.N0[i] * exp((gen - event.T0) * r);
+		if (sz[sp] == static_cast<size_t>(nearbyint(expected))) {
+			// if current size match, use it to do next
+			expected = event.rates.empty() ? event.N0[i] + (gen - event.T0 + 1) * r
+			           : event.N0[i] * exp((gen - event.T0 + 1) * r);
+			sz[sp] = static_cast<size_t>(nearbyint(expected));
+		} else {
+			// otherwise reset ...
+			for (size_t j = 0; j < subPops.size(); ++j)
+				event.N0[j] = sz[subPops[j]];
+			event.T0 = gen;
+			sz[sp] = static_cast<size_t>(nearbyint(event.rates.empty() ? sz[sp] + r : sz[sp] * exp(r)));
+		}
+	}
+	if (!event.capacity.empty()) {
+		for (size_t i = 0; i < subPops.size(); ++i) {
+			double cap = event.multiCapacity ? event.capacity[i] : event.capacity[0];
+			sz[subPops[i]] = std::min(sz[subPops[i]], static_cast<size_t>(cap));
+		}
+	}
+	m_expectedSize = sz;
+}
+
+
+bool NativeEventBasedModel::nextSizes(Population & pop, long gen, vectoru & sz)
+{
+	for (size_t i = 0; i < m_events.size(); ++i) {
+		Event & event = m_events[i];
+		if (!applicable(event, gen, static_cast<long>(pop.rep())))
+			continue;
+		if (event.expansion) {
+			expand(event, pop);
+			continue;
+		}
+		// pass expected size to and from the Python event
+		if (!m_expectedSize.empty())
+			pop.getVars().setVar("_expected_size", m_expectedSize);
+		PyObject * apply = PyObject_GetAttrString(event.event.object(), "apply");
+		PyObject * res = callPyWithPop(apply, pop);
+		Py_DECREF(apply);
+		bool succ = PyObject_IsTrue(res) != 0;
+		Py_DECREF(res);
+		if (!succ) {
+			m_reset = true;
+			return false;
+		}
+		m_expectedSize.clear();
+		readExpectedSize(pop);
+	}
+	sz = m_expectedSize.empty() ? pop.subPopSizes() : m_expectedSize;
+	return true;
+}
+
+
 bool MatingScheme::prepareScratchPop(Population & pop, Population & scratch)
 {
 	if (scratch.genoStruIdx() != pop.genoStruIdx())
@@ -1249,33 +1815,35 @@ bool MatingScheme::prepareScratchPop(Population & pop, Population & scratch)
 		scratch.fitSubPopStru(m_subPopSize.elems(), pop.subPopNames());
 	else {                                                                              // use m_subPopSizeFunc
 		const pyFunc & func = m_subPopSize.func();
-		PyObject * args = PyTuple_New(func.numArgs());
-		DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
-
-		for (size_t i = 0; i < func.numArgs(); ++i) {
-			const string & arg = func.arg(i);
-			if (arg == "gen")
-				PyTuple_SET_ITEM(args, i, PyInt_FromLong(static_cast<long>(pop.gen())));
-			else if (arg == "pop")
-				PyTuple_SET_ITEM(args, i, pyPopObj(static_cast<void *>(&pop)));
-			else {
-				DBG_FAILIF(true, ValueError,
-					"Only parameters 'gen' and 'pop' are acceptable in a demographic function.");
+		// use the native implementation of a demographic model if available
+		NativeDemographicModel * native = nativeModelOf(func.func());
+		vectoru sz;
+		if (native)
+			sz = native->subPopSizes(pop);
+		else {
+			PyObject * args = PyTuple_New(func.numArgs());
+			DBG_ASSERT(args, RuntimeError, "Failed to create a parameter tuple");
+
+			for (size_t i = 0; i < func.numArgs(); ++i) {
+				const string & arg = func.arg(i);
+				if (arg == "gen")
+					PyTuple_SET_ITEM(args, i, PyInt_FromLong(static_cast<long>(pop.gen())));
+				else if (arg == "pop")
+					PyTuple_SET_ITEM(args, i, pyPopObj(static_cast<void *>(&pop)));
+				else {
+					DBG_FAILIF(true, ValueError,
+						"Only parameters 'gen' and 'pop' are acceptable in a demographic function.");
+				}
 			}
+			vectori res = func(PyObj_As_IntArray, args);
+			Py_XDECREF(args);
+			sz = demographicSizes(res);
 		}
-		vectori res = func(PyObj_As_IntArray, args);
-		Py_XDECREF(args);
 
-		if (res.empty()) {
+		if (sz.empty()) {
 			DBG_DO(DBG_SIMULATOR, cerr << "Stop iteration due to empty offspring population size." << endl);
 			return false;
 		}
-		vectoru sz(res.size());
-		for (size_t i = 0; i < res.size(); i++) {
-			if (res[i] < 0)
-				throw ValueError((boost::format("Negative population size %1% returned for subpopulation %2%") % res[i] % i).str());
-			sz[i] = static_cast<ULONG>(res[i]);
-		}
 
 		// allow change of pop size of scratch
 		scratch.fitSubPopStru(sz, pop.subPopNames());
@@ -1463,7 +2031,7 @@ bool PedigreeMating::mate(Population & pop, Population & scratch)
 	RawIndIterator it = pop.rawIndBegin();
 	RawIndIterator it_end = pop.rawIndEnd();
 	for (; it != it_end; ++it)
-		idMap[toID(it->info(idIdx))] = &*it;
+		idMap[it->idInfo(idIdx)] = &*it;
 
 	// initialize operator before entering parallel region in order to avoid race condition
 	opList::const_iterator iop = m_transmitters.begin();
@@ -1487,7 +2055,7 @@ bool PedigreeMating::mate(Population & pop, Population & scratch)
 		for (; it != it_end; ++it, ++i) {
 			const Individual & pedInd = m_ped.individual(static_cast<double>(i));
 
-			size_t my_id = toID(pedInd.info(m_ped.idIdx()));
+			size_t my_id = pedInd.idInfo(m_ped.idIdx());
 			size_t father_id = m_ped.fatherOf(my_id);
 			size_t mother_id = m_ped.motherOf(my_id);
 			Individual * dad = NULL;
@@ -1524,6 +2092,9 @@ bool PedigreeMating::mate(Population & pop, Population & scratch)
 			it->setInfo(static_cast<double>(my_id), m_idField);
 		}
 	}
+	// write buffered output of operators
+	for (iop = m_transmitters.begin(); iop != iopEnd; ++iop)
+		(*iop)->finalizeDuringMating(pop);
 	const_cast<Pedigree &>(m_ped).useAncestralGen(oldGen);
 	submitScratch(pop, scratch);
 	--m_gen;
@@ -1747,8 +2318,9 @@ bool HeteroMating::mate(Population & pop, Population & scratch)
 				                     "of another mating scheme.");
 			if (*itSize == 0)
 				continue;
+			// parents are only read by mating schemes
 			if (sps[idx].isVirtual())
-				pop.activateVirtualSubPop(sps[idx]);
+				pop.activateVirtualSubPop(sps[idx], true);
 			// if previous mating scheme works on a virtual subpop,
 			// and the current one is not. deactivate it.
 			else if (pop.hasActivatedVirtualSubPop(sp))
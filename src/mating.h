@@ -626,12 +626,7 @@ public:
 		RawIndIterator & offBegin, RawIndIterator & offEnd);
 
 	/// CPPONLY
-	virtual void finalize(const Population & /* pop */)
-	{
-		m_numOffModel->reset();
-		m_sexModel->reset();
-		m_initialized = false;
-	}
+	virtual void finalize(Population & pop);
 
 
 	/// HIDDEN describe an offspring generator
@@ -1417,6 +1412,246 @@ private:
 };
 
 
+/** This class is the base class of native implementations of demographic
+ *  models defined in module \c simuPOP.demography. A Python demographic
+ *  model creates a native model (saved as its attribute \c _native) after it
+ *  is applied to a population for the first time. Mating schemes then use
+ *  the native model to determine the size of offspring populations, without
+ *  calling the Python model at each generation. The Python model is only
+ *  called back when the population structure needs to be changed by Python
+ *  code (e.g. at generations of instant population changes). These classes
+ *  are created by Python demographic models and are not supposed to be used
+ *  directly.
+ */
+class NativeDemographicModel
+{
+public:
+	/** HIDDEN Create a native model for Python demographic model \e model,
+	 *  which has been applied to a population at generation \e startGen and
+	 *  returned \e startSize. The model lasts \e numGens generations (-1 for
+	 *  unlimited) and applies operators \e ops to the parental population
+	 *  before the size of the offspring population is determined.
+	 */
+	NativeDemographicModel(PyObject * model, long startGen, long numGens,
+		const uintList & startSize, const opList & ops);
+
+	/// destructor
+	virtual ~NativeDemographicModel()
+	{
+	}
+
+
+	/** HIDDEN Return subpopulation sizes of the offspring generation of
+	 *  parental population \e pop, or an empty list if the model ends.
+	 */
+	vectoru subPopSizes(Population & pop);
+
+	/// HIDDEN number of generations of the model (-1 for unlimited)
+	long numGens() const
+	{
+		return m_numGens;
+	}
+
+
+	/// HIDDEN Return True if the model ends and should be set up again
+	bool isReset() const
+	{
+		return m_reset;
+	}
+
+
+protected:
+	/** CPPONLY Determine subpopulation sizes \e sz of the offspring
+	 *  generation at generation \e gen of the model. Return \c false if
+	 *  the model ends.
+	 */
+	virtual bool nextSizes(Population & pop, long gen, vectoru & sz) = 0;
+
+	/// CPPONLY set variables \c _gen and \c _num_gens used by Python operators
+	void setGenVars(Population & pop, long gen) const;
+
+	/// CPPONLY move variable \c _expected_size of \e pop to \c m_expectedSize
+	void readExpectedSize(Population & pop);
+
+	/// Python model, which owns this native model
+	PyObject * m_model;
+
+	/// absolute generation at which the model starts
+	long m_startGen;
+
+	/// last generation at which the model was applied
+	long m_lastGen;
+
+	/// number of generations of the model
+	long m_numGens;
+
+	/// operators applied before each generation
+	const opList m_ops;
+
+	/// the model ends or an operator fails
+	bool m_reset;
+
+	/// expected size of the offspring generation, set by operators or
+	/// demographic events as variable \c _expected_size
+	vectoru m_expectedSize;
+
+private:
+	/// sizes of previous generations, which are returned if the model is
+	/// applied to a previous generation.
+	std::map<long, vectoru> m_sizeCache;
+};
+
+
+/** Native implementation of \c ExponentialGrowthModel and
+ *  \c LinearGrowthModel.
+ */
+class NativeGrowthModel : public NativeDemographicModel
+{
+public:
+	/** HIDDEN Create a native growth model that grows a population from
+	 *  sizes \e N0 to \e NT exponentially (if \e exponential is \c True) or
+	 *  linearly, with rates \e r, or by interpolation if \e r is empty.
+	 */
+	NativeGrowthModel(PyObject * model, long startGen, long numGens,
+		const uintList & startSize, const opList & ops,
+		const uintList & N0, const floatList & NT, const floatList & r,
+		bool exponential);
+
+protected:
+	/// CPPONLY
+	bool nextSizes(Population & pop, long gen, vectoru & sz);
+
+private:
+	const vectoru m_N0;
+
+	const vectorf m_NT;
+
+	const vectorf m_r;
+
+	const bool m_exponential;
+};
+
+
+/** Native implementation of \c InstantChangeModel. Function \c _fitToSize
+ *  of the Python model is called at generations \e G.
+ */
+class NativeInstantChangeModel : public NativeDemographicModel
+{
+public:
+	/** HIDDEN Create a native instant change model that changes population
+	 *  sizes at generations \e G of the model, and removes empty
+	 *  subpopulations if \e removeEmptySubPops is \c True.
+	 */
+	NativeInstantChangeModel(PyObject * model, long startGen, long numGens,
+		const uintList & startSize, const opList & ops,
+		const uintList & G, bool removeEmptySubPops);
+
+protected:
+	/// CPPONLY
+	bool nextSizes(Population & pop, long gen, vectoru & sz);
+
+private:
+	const vectoru m_G;
+
+	const bool m_removeEmptySubPops;
+};
+
+
+/** Native implementation of \c MultiStageModel. Each stage is evaluated by
+ *  the native model of the stage if it has one, and the Python model is
+ *  called at the first generation of each stage.
+ */
+class NativeMultiStageModel : public NativeDemographicModel
+{
+public:
+	/** HIDDEN Create a native multi-stage model that is currently at stage
+	 *  \e modelIdx, which starts at generation \e modelStartGen of the model.
+	 */
+	NativeMultiStageModel(PyObject * model, long startGen, long numGens,
+		const uintList & startSize, const opList & ops,
+		size_t modelIdx, long modelStartGen);
+
+protected:
+	/// CPPONLY
+	bool nextSizes(Population & pop, long gen, vectoru & sz);
+
+private:
+	/// move to the next stage
+	bool advance(Population & pop, long gen, vectoru & sz);
+
+	/// apply stage \e idx to \e pop
+	bool applyStage(size_t idx, Population & pop, vectoru & sz);
+
+	/// number of generations of stage \e idx
+	long stageGens(size_t idx) const;
+
+	/// Python list of stages
+	pyObject m_models;
+
+	size_t m_modelIdx;
+
+	long m_modelStartGen;
+};
+
+
+/** Native implementation of \c EventBasedModel. Applicable generations of
+ *  events are determined natively, \c ExpansionEvent without operators is
+ *  applied natively, and other events are applied by calling Python.
+ */
+class NativeEventBasedModel : public NativeDemographicModel
+{
+public:
+	/** HIDDEN Create a native event based model with Python demographic
+	 *  events \e events.
+	 */
+	NativeEventBasedModel(PyObject * model, long startGen, long numGens,
+		const uintList & startSize, const opList & ops, PyObject * events);
+
+protected:
+	/// CPPONLY
+	bool nextSizes(Population & pop, long gen, vectoru & sz);
+
+private:
+	struct Event
+	{
+		Event(PyObject * obj) : event(obj), N0(), T0(0)
+		{
+		}
+
+
+		pyObject event;
+		long begin;
+		long end;
+		long step;
+		vectori at;
+		// empty for all replicates
+		vectori reps;
+		// expansion events are applied natively
+		bool expansion;
+		vectorf rates;
+		vectorf slopes;
+		bool multiRates;
+		vectorf capacity;
+		bool multiCapacity;
+		// subpopulations by index, or by name if the index is -1
+		bool allSubPops;
+		vectori subPops;
+		vectorstr subPopNames;
+		// state of expansion
+		vectoru N0;
+		long T0;
+	};
+
+	/// whether or not event is applicable at generation \e gen of the model
+	bool applicable(const Event & event, long gen, long rep) const;
+
+	/// expand population according to a native expansion event
+	void expand(Event & event, Population & pop);
+
+	vector<Event> m_events;
+};
+
+
 /** This mating scheme is the base class of all mating schemes. It evolves
  *  a population generation by generation but does not actually transmit
  *  genotype.
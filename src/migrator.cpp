@@ -33,12 +33,12 @@ Migrator::Migrator(const floatMatrix & rate, int mode, const uintList & toSubPop
 	int begin, int end, int step, const intList & at,
 	const intList & reps, const subPopList & subPops, const stringList & infoFields)
 	: BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
-	m_rate(rate.elems()), m_mode(mode), m_to(toSubPops)
+	m_rate(rate.elems()), m_rateCols(rate.columns()), m_sparse(rate.isSparse()), m_mode(mode), m_to(toSubPops)
 {
 	DBG_FAILIF(mode != BY_IND_INFO && !subPops.empty() && subPops.size() != m_rate.size(),
 		ValueError, "Length of param fromSubPop must match rows of rate matrix.");
 
-	DBG_FAILIF(mode != BY_IND_INFO && !m_to.elems().empty() && m_to.elems().size() != m_rate[0].size(),
+	DBG_FAILIF(mode != BY_IND_INFO && !m_sparse && !m_to.elems().empty() && m_to.elems().size() != m_rate[0].size(),
 		ValueError, "Length of param toSubPop must match columns of rate matrix.");
 }
 
@@ -104,16 +104,30 @@ bool Migrator::apply(Population & pop) const
 	// of different number of subpopulations, and toSubPops can be ALL_AVAIL, and
 	// then does not have to match subPops.
 	matrixf migrationRate = m_rate;
+	// destination subpopulations of each row of a sparse matrix
+	vector<vectoru> rowTo(m_rateCols.size());
+	for (size_t i = 0; i < m_rateCols.size(); ++i) {
+		for (size_t j = 0; j < m_rateCols[i].size(); ++j) {
+			size_t col = m_rateCols[i][j];
+			if (m_to.allAvail())
+				rowTo[i].push_back(col);
+			else {
+				DBG_FAILIF(col >= toSubPops.size(), IndexError,
+					(boost::format("Column index %1% of sparse migration matrix out of range") % col).str());
+				rowTo[i].push_back(toSubPops[col]);
+			}
+		}
+	}
+
 	if (m_mode != BY_IND_INFO) {
 		size_t szFrom = migrationRate.size();
-		size_t szTo = migrationRate[0].size();
 
 		// check parameters
 		for (size_t i = 0; i < szFrom; ++i) {
-			DBG_FAILIF(migrationRate[i].size() != szTo, ValueError,
+			DBG_FAILIF(!m_sparse && migrationRate[i].size() != migrationRate[0].size(), ValueError,
 				"Expecting a matrix of migration rate.");
 
-			for (size_t j = 0; j < szTo; ++j) {
+			for (size_t j = 0; j < migrationRate[i].size(); ++j) {
 				DBG_FAILIF(fcmp_lt(migrationRate[i][j], 0.), ValueError,
 					"Migration rate should be positive.");
 				DBG_FAILIF(m_mode != BY_COUNTS && fcmp_gt(migrationRate[i][j], 1.), ValueError,
@@ -124,18 +138,19 @@ bool Migrator::apply(Population & pop) const
 		// set r[i][i]--- may need to extend rate (to add i->i)
 		if (m_mode == BY_PROBABILITY || m_mode == BY_PROPORTION) {
 			for (size_t i = 0; i < szFrom; i++) {               // from
+				const vectoru & to = m_sparse ? rowTo[i] : toSubPops;
 				// look for from=to cell.
 				size_t spFrom = fromSubPops[i].subPop();
 				double sum = accumulate(migrationRate[i].begin(), migrationRate[i].end(), 0.0);
 				//
-				vectoru::const_iterator spTo = find(toSubPops.begin(), toSubPops.end(), spFrom);
-				if (spTo == toSubPops.end()) {                        // if no to, only check if sum <= 1
+				vectoru::const_iterator spTo = find(to.begin(), to.end(), spFrom);
+				if (spTo == to.end()) {                        // if no to, only check if sum <= 1
 					if (fcmp_gt(sum, 1.0))
 						throw ValueError("Sum of migrate rate from one subPop should <= 1");
 					// adding i->i item
 					migrationRate[i].push_back(1.0 - sum);
 				} else {                                                          // if not, set r[i][i]
-					double & self = migrationRate[i][ spTo - toSubPops.begin() ];
+					double & self = migrationRate[i][ spTo - to.begin() ];
 					sum -= self;
 					if (fcmp_gt(sum, 1.0))
 						throw ValueError("Sum of migrate rate from one subPop should <= 1");
@@ -148,8 +163,10 @@ bool Migrator::apply(Population & pop) const
 
 	for (size_t from = 0, fromEnd = fromSubPops.size(); from < fromEnd; ++from) {
 		size_t spFrom = fromSubPops[from].subPop();
+		// destinations of this source subpopulation
+		const vectoru & destSubPops = m_sparse ? rowTo[from] : toSubPops;
 		// rateSize might be toSize + 1, the last one is from->from
-		size_t toSize = toSubPops.size();
+		size_t toSize = destSubPops.size();
 		size_t toIndex;
 
 		// fromSubPops out of range....
@@ -158,6 +175,13 @@ bool Migrator::apply(Population & pop) const
 
 		size_t spSize = pop.subPopSize(fromSubPops[from]);
 
+		// probability to leave spFrom
+		double leaveProb = 0.;
+		if (m_mode == BY_PROBABILITY)
+			for (size_t i = 0; i < toSize; ++i)
+				if (destSubPops[i] != spFrom)
+					leaveProb += migrationRate[from][i];
+
 		if (fromSubPops[from].isVirtual())
 			pop.activateVirtualSubPop(fromSubPops[from]);
 
@@ -178,8 +202,37 @@ bool Migrator::apply(Population & pop) const
 						ind->setInfo(oldInfo[&*ind - &*pop.rawIndBegin()], info);
 				}
 			}
+		} else if (m_mode == BY_PROBABILITY && !fromSubPops[from].isVirtual() &&
+		           fcmp_lt(leaveProb, 0.25)) {
+			// When few individuals leave a subpopulation, skip directly from one
+			// migrant to the next (the distance follows a geometric distribution)
+			// and choose its destination, instead of drawing for every individual.
+			if (leaveProb > 0.) {
+				vectorf leaveRate(toSize, 0.);
+				for (size_t i = 0; i < toSize; ++i)
+					if (destSubPops[i] != spFrom)
+						leaveRate[i] = migrationRate[from][i];
+				WeightedSampler ws(leaveRate);
+				RawIndIterator ind = pop.rawIndBegin(spFrom);
+				// 1-based index of the last migrant
+				size_t pos = 0;
+				while (true) {
+					size_t step = getRNG().randGeometric(leaveProb);
+					// step can be zero if it overflows for extremely small rate
+					if (step == 0 || step > spSize - pos)
+						break;
+					pos += step;
+					toIndex = ws.draw();
+					DBG_ASSERT(toIndex < toSize, ValueError, "Return index out of range.");
+					(ind + (pos - 1))->setInfo(static_cast<double>(destSubPops[toIndex]), info);
+				}
+			}
 		} else if (m_mode == BY_PROBABILITY) {
-			WeightedSampler ws(migrationRate[from]);
+			// samplers are reused if migration rates are unchanged
+			if (m_samplers.size() < fromEnd)
+				m_samplers.resize(fromEnd);
+			WeightedSampler & ws = m_samplers[from];
+			ws.set(migrationRate[from].begin(), migrationRate[from].end());
 
 			// for each individual, migrate according to migration probability
 			if (numThreads() > 1) {
@@ -190,8 +243,8 @@ bool Migrator::apply(Population & pop) const
 						toIndex = ws.draw();
 						DBG_ASSERT(toIndex < migrationRate[from].size(), ValueError,
 							"Return index out of range.");
-						if (toIndex < toSize && toSubPops[toIndex] != spFrom)
-							ind->setInfo(static_cast<double>(toSubPops[toIndex]), info);
+						if (toIndex < toSize && destSubPops[toIndex] != spFrom)
+							ind->setInfo(static_cast<double>(destSubPops[toIndex]), info);
 					}
 				}
 #endif
@@ -207,8 +260,8 @@ bool Migrator::apply(Population & pop) const
 					//     toIndex < toSize
 					// rateSize = toSize + 1, ignore i->1 (last one)
 					//     toIndex < toSize
-					if (toIndex < toSize && toSubPops[toIndex] != spFrom)
-						ind->setInfo(static_cast<double>(toSubPops[toIndex]), info);
+					if (toIndex < toSize && destSubPops[toIndex] != spFrom)
+						ind->setInfo(static_cast<double>(destSubPops[toIndex]), info);
 				}
 			}
 		} else {
@@ -231,7 +284,7 @@ bool Migrator::apply(Population & pop) const
 			size_t k = 0;
 			for (size_t i = 0; i < toSize && k < spSize; ++i)
 				for (size_t j = 0; j < toNum[i] && k < spSize; ++j)
-					toIndices[k++] = toSubPops[i];
+					toIndices[k++] = destSubPops[i];
 
 			// the rest of individuals will stay in their original subpopulation.
 			while (k < spSize)
@@ -269,15 +322,58 @@ BackwardMigrator::BackwardMigrator(const floatMatrix & rate, int mode,
 	int begin, int end, int step, const intList & at,
 	const intList & reps, const subPopList & subPops, const stringList & infoFields)
 	: BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
-	m_rate(rate.elems()), m_inverse_rate(rate.elems().size(), rate.elems().size()), m_symmetric_matrix(true), m_mode(mode)
+	m_rate(rate.elems()), m_rateCols(rate.columns()), m_sparse(rate.isSparse()),
+	m_rateT(), m_rateTCols(), m_inverse_rate(), m_symmetric_matrix(true), m_mode(mode)
 {
 	DBG_FAILIF(!subPops.empty() && subPops.size() != m_rate.size(),
 		ValueError, "Length of param subPop must match rows of rate matrix.");
 	DBG_FAILIF(m_mode != BY_PROBABILITY && m_mode != BY_PROPORTION,
 		ValueError, "Only BY_PROBABILITY and BY_PROPORTION is supported by BackMigrator");
 
-	// find the inverse of B'
 	size_t sz = m_rate.size();
+	if (m_sparse) {
+		// B' (transpose of m_rate) without diagonal elements, which are the
+		// off-diagonal elements of rows of the forward migration matrix.
+		m_rateT.resize(sz);
+		m_rateTCols.resize(sz);
+		for (size_t i = 0; i < sz; ++i) {
+			double sum = 0;
+			for (size_t k = 0; k < m_rateCols[i].size(); ++k) {
+				size_t j = m_rateCols[i][k];
+				if (j >= sz)
+					throw ValueError("A m by m matrix is required for backward migration matrix.");
+				if (fcmp_lt(m_rate[i][k], 0.))
+					throw ValueError((boost::format("Backward migration rate should be positive. %d provided.") % m_rate[i][k]).str());
+				if (j == i)
+					continue;
+				sum += m_rate[i][k];
+				m_rateT[j].push_back(m_rate[i][k]);
+				m_rateTCols[j].push_back(i);
+			}
+			if (fcmp_gt(sum, 1.))
+				throw ValueError((boost::format("Backward migration rate should be in the range of [0,1], %d provided.") % (1. - sum)).str());
+		}
+		// the matrix is symmetric if row i of B and B' are the same
+		for (size_t i = 0; i < sz && m_symmetric_matrix; ++i) {
+			size_t k = 0;
+			for (size_t l = 0; l < m_rateCols[i].size(); ++l) {
+				if (m_rateCols[i][l] == i)
+					continue;
+				if (k == m_rateTCols[i].size() || m_rateTCols[i][k] != m_rateCols[i][l] ||
+				    m_rateT[i][k] != m_rate[i][l]) {
+					m_symmetric_matrix = false;
+					break;
+				}
+				++k;
+			}
+			if (k != m_rateTCols[i].size())
+				m_symmetric_matrix = false;
+		}
+		return;
+	}
+
+	// find the inverse of B'
+	m_inverse_rate.resize(sz, sz);
 	boost::numeric::ublas::matrix<double> Bt(sz, sz);
 	for (size_t i = 0; i < sz; ++i) {
 		if (m_rate[i].size() != sz) 
@@ -312,6 +408,48 @@ BackwardMigrator::BackwardMigrator(const floatMatrix & rate, int mode,
 }
 
 
+vectorf BackwardMigrator::expectedSizes(const vectoru & S) const
+{
+	size_t sz = m_rate.size();
+	vectorf Sp(sz, 0.);
+
+	if (!m_sparse) {
+		for (size_t i = 0; i < sz; ++i)
+			for (size_t j = 0; j < sz; ++j)
+				Sp[i] += m_inverse_rate(i, j) * S[j];
+		return Sp;
+	}
+	// solve B' S' = S using Gauss-Seidel iterations. The diagonal elements
+	// of B' (probabilities to originate from the same subpopulation) are
+	// usually dominant for realistic migration rates.
+	vectorf diag(sz, 1.);
+	for (size_t i = 0; i < sz; ++i) {
+		for (size_t k = 0; k < m_rateCols[i].size(); ++k)
+			if (m_rateCols[i][k] != i)
+				diag[i] -= m_rate[i][k];
+		if (fcmp_le(diag[i], 0.))
+			throw RuntimeError("Failed to calculate forward migration matrix from a sparse backward migration matrix.");
+		Sp[i] = static_cast<double>(S[i]);
+	}
+	for (size_t iter = 0; iter < 10000; ++iter) {
+		double maxDiff = 0;
+		for (size_t i = 0; i < sz; ++i) {
+			double val = static_cast<double>(S[i]);
+			for (size_t k = 0; k < m_rateT[i].size(); ++k)
+				val -= m_rateT[i][k] * Sp[m_rateTCols[i][k]];
+			val /= diag[i];
+			maxDiff = std::max(maxDiff, fabs(val - Sp[i]) / std::max(1., fabs(val)));
+			Sp[i] = val;
+		}
+		if (maxDiff < 1e-12)
+			return Sp;
+	}
+	throw RuntimeError("Failed to calculate forward migration matrix from a sparse backward migration matrix.");
+	// will not reach here
+	return Sp;
+}
+
+
 string BackwardMigrator::describe(bool /* format */) const
 {
 	return "<simuPOP.BackwardMigrator>";
@@ -334,7 +472,7 @@ bool BackwardMigrator::apply(Population & pop) const
 	for (size_t i = 0; i < VSPs.size(); ++i) {
 		DBG_FAILIF(VSPs[i].isVirtual(), ValueError, 
 			"BackwardMigrator does not support virtual subpupulations.")
-		DBG_FAILIF(m_rate[i].size() != VSPs.size(), ValueError,
+		DBG_FAILIF(!m_sparse && m_rate[i].size() != VSPs.size(), ValueError,
 			"A square matrix is required for BackwardMigrator")
 		subPops.push_back(VSPs[i].subPop());
 	}
@@ -388,16 +526,14 @@ bool BackwardMigrator::apply(Population & pop) const
 	size_t sz = m_rate.size();
 	// if not the simple case, we need to calculate rate...
 	matrixf migrationRate;
-	if (simple_case)
+	// destinations (indexes of subPops) of rows of a sparse forward matrix
+	vector<vectoru> rowTo;
+	if (simple_case) {
 		migrationRate = m_rate;
-	else {
+		rowTo = m_rateCols;
+	} else {
 		// with Bt^-1, we can calculate expected population size
-		vectorf Sp(sz);
-		for (size_t i = 0; i < sz; ++i) {
-			Sp[i] = 0;
-			for (size_t j = 0; j < sz; ++j)
-				Sp[i] += m_inverse_rate(i, j) * S[j];
-		}
+		vectorf Sp = expectedSizes(S);
 		DBG_DO(DBG_MIGRATOR, cerr << "Expected next population size is " << Sp << endl);
 		for (size_t i = 0; i < sz; ++i) {
 			if (Sp[i] <= 0)
@@ -405,25 +541,41 @@ bool BackwardMigrator::apply(Population & pop) const
 					% Sp[i] % i).str());
 		}
 		// now, F = diag(S)^-1 * BT * diag (S')
-		migrationRate = m_rate;
-		for (size_t i = 0; i < sz; ++i)
-			for (size_t j = 0; j < sz; ++j)
-				// m_rate[i][i] might not be defined.
-				migrationRate[i][j] = m_rate[j][i] * Sp[j] / S[i];
+		if (m_sparse) {
+			migrationRate = m_rateT;
+			rowTo = m_rateTCols;
+			for (size_t i = 0; i < sz; ++i)
+				for (size_t k = 0; k < rowTo[i].size(); ++k)
+					migrationRate[i][k] = m_rateT[i][k] * Sp[rowTo[i][k]] / S[i];
+		} else {
+			migrationRate = m_rate;
+			for (size_t i = 0; i < sz; ++i)
+				for (size_t j = 0; j < sz; ++j)
+					// m_rate[i][i] might not be defined.
+					migrationRate[i][j] = m_rate[j][i] * Sp[j] / S[i];
+		}
 	}
 
 	// check parameters
 	for (size_t i = 0; i < sz; ++i) {
-		for (size_t j = 0; j < sz; ++j) {
+		for (size_t j = 0; j < migrationRate[i].size(); ++j) {
 			if (fcmp_lt(migrationRate[i][j], 0.))
 				throw ValueError("Converted forward migration rate should be positive.");
 			if (fcmp_gt(migrationRate[i][j], 1.))
 				throw ValueError("Converted forward migration rate should be in the range of [0,1]");
 		}
 		// look for from=to cell.
+		size_t selfIdx = i;
+		if (m_sparse) {
+			selfIdx = find(rowTo[i].begin(), rowTo[i].end(), i) - rowTo[i].begin();
+			if (selfIdx == rowTo[i].size()) {
+				rowTo[i].push_back(i);
+				migrationRate[i].push_back(0.);
+			}
+		}
 		double sum = accumulate(migrationRate[i].begin(), migrationRate[i].end(), 0.0);
 		//
-		double & self = migrationRate[i][i];
+		double & self = migrationRate[i][selfIdx];
 		sum -= self;
 		if (fcmp_gt(sum, 1.0))
 			throw ValueError("Sum of migrate rate from one subPop should <= 1");
@@ -435,15 +587,26 @@ bool BackwardMigrator::apply(Population & pop) const
 		DBG_DO(DBG_MIGRATOR, cerr << "Forward migration matrix is " << migrationRate << endl);
 	}
 
+	// destinations of rows of a dense forward matrix
+	vectoru allTo;
+	if (!m_sparse)
+		for (size_t i = 0; i < sz; ++i)
+			allTo.push_back(i);
+
 	for (size_t from = 0, fromEnd = subPops.size(); from < fromEnd; ++from) {
 		size_t spFrom = subPops[from];
-		// rateSize might be toSize + 1, the last one is from->from
+		const vectoru & to = m_sparse ? rowTo[from] : allTo;
+		size_t toSize = to.size();
 		size_t toIndex;
 
 		size_t spSize = pop.subPopSize(spFrom);
 
 		if (m_mode == BY_PROBABILITY) {
-			WeightedSampler ws(migrationRate[from]);
+			// samplers are reused if migration rates are unchanged
+			if (m_samplers.size() < fromEnd)
+				m_samplers.resize(fromEnd);
+			WeightedSampler & ws = m_samplers[from];
+			ws.set(migrationRate[from].begin(), migrationRate[from].end());
 
 			// for each individual, migrate according to migration probability
 			for (IndIterator ind = pop.indIterator(spFrom); ind.valid(); ++ind) {
@@ -453,25 +616,25 @@ bool BackwardMigrator::apply(Population & pop) const
 				DBG_ASSERT(toIndex < migrationRate[from].size(), ValueError,
 					"Return index out of range.");
 
-				if (toIndex < sz && subPops[toIndex] != spFrom)
-					ind->setInfo(static_cast<double>(subPops[toIndex]), info);
+				if (toIndex < toSize && subPops[to[toIndex]] != spFrom)
+					ind->setInfo(static_cast<double>(subPops[to[toIndex]]), info);
 			}
 		} else {
 			// 2nd, or 3rd method
 			// first find out how many people will move to other subPop
 			// then randomly assign individuals to move
-			vectoru toNum(sz);
+			vectoru toNum(toSize);
 			// in case that to sub is not in from sub, the last added
 			// element is not used. sum of toNum is not spSize.
-			for (size_t i = 0; i < sz; ++i)
+			for (size_t i = 0; i < toSize; ++i)
 				toNum[i] = static_cast<ULONG>(spSize * migrationRate[from][i]);
 			// create a vector and assign indexes, then random shuffle
 			// and assign info
 			vectoru toIndices(spSize);
 			size_t k = 0;
-			for (size_t i = 0; i < sz && k < spSize; ++i)
+			for (size_t i = 0; i < toSize && k < spSize; ++i)
 				for (size_t j = 0; j < toNum[i] && k < spSize; ++j)
-					toIndices[k++] = subPops[i];
+					toIndices[k++] = subPops[to[i]];
 
 			// the rest of individuals will stay in their original subpopulation.
 			while (k < spSize)
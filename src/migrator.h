@@ -99,6 +99,14 @@ namespace simuPOP {
  *  individuals to migrate to each detination subpopulation. The migrants are
  *  chosen randomly.
  *
+ *  The migration matrix can also be specified as a list of dictionaries,
+ *  one for each source subpopulation, with indexes of destination
+ *  subpopulations (or indexes of \e toSubPops if specified) as keys and
+ *  migration rates as values. Migration rates that are not specified are
+ *  assumed to be zero. Such a sparse migration matrix uses much less
+ *  memory and time when there are a large number of subpopulations that
+ *  only exchange migrants with their neighbors (e.g. a stepping stone model).
+ *
  *  This operator goes through all source (virtual) subpopulations and assign
  *  detination subpopulation of each individual to an information field.
  *  Unexpected results may happen if individuals migrate from overlapping
@@ -155,15 +163,25 @@ public:
 	string describe(bool format = true) const;
 
 protected:
-	/// migration rate. its meaning is controled by m_mode
+	/// migration rate. its meaning is controled by m_mode. Only non-zero
+	/// rates are stored for a sparse matrix.
 	const matrixf m_rate;
 
+	/// column indexes of m_rate if the matrix is sparse
+	const vector<vectoru> m_rateCols;
+
+	/// if the migration matrix is sparse
+	const bool m_sparse;
+
 	/// asProbability (1), asProportion (2), or asCounts.
 	const int m_mode;
 
 	/// from->to subPop index.
 	/// default to 0 - rows of rate - 1, 0 - columns of rate - 1
 	const uintList m_to;
+
+	/// samplers of destinations for each source subpopulation
+	mutable vector<WeightedSampler> m_samplers;
 };
 
 
@@ -203,7 +221,11 @@ protected:
  *  This operator calculates the corresponding forward migration matrix
  *  from backward matrix and current population size. This process is not
  *  always feasible so an error will raise if no valid ending population
- *  size or forward migration matrix could be determined. Please refer to 
+ *  size or forward migration matrix could be determined. As in operator
+ *  \c Migrator, the backward migration matrix can be specified as a list
+ *  of dictionaries with non-zero migration rates, in which case expected
+ *  population sizes are calculated iteratively instead of inverting the
+ *  matrix. Please refer to 
  *  the simuPOP user's guide for an explanation of the theory behind forward
  *  and backward migration matrices.
  */
@@ -247,15 +269,36 @@ public:
 	string describe(bool format = true) const;
 
 protected:
-	/// migration rate. its meaning is controled by m_mode
+	/// CPPONLY expected subpopulation sizes after migration, from sizes \e S
+	/// before migration.
+	vectorf expectedSizes(const vectoru & S) const;
+
+	/// migration rate. its meaning is controled by m_mode. Only non-zero
+	/// rates are stored for a sparse matrix.
 	const matrixf m_rate;
 
+	/// column indexes of m_rate if the matrix is sparse
+	const vector<vectoru> m_rateCols;
+
+	/// if the migration matrix is sparse
+	const bool m_sparse;
+
+	/// off-diagonal elements of the transpose of a sparse m_rate, and their
+	/// column indexes
+	matrixf m_rateT;
+
+	vector<vectoru> m_rateTCols;
+
+	/// inverse of the transpose of a dense m_rate
 	boost::numeric::ublas::matrix<double> m_inverse_rate;
 
 	bool m_symmetric_matrix;
 
 	/// asProbability (1), asProportion (2),
 	const int m_mode;
+
+	/// samplers of destinations for each source subpopulation
+	mutable vector<WeightedSampler> m_samplers;
 };
 
 
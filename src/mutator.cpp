@@ -276,6 +276,7 @@ MatrixMutator::MatrixMutator(const floatMatrix & rate,
 	: BaseMutator(vectorf(1, 0), loci, mapIn, mapOut, 0, output, begin, end, step,
 	              at, reps, subPops, infoFields, lineageMode)
 {
+	PARAM_FAILIF(rate.isSparse(), ValueError, "A sparse mutation rate matrix is not supported.");
 	matrixf rateMatrix = rate.elems();
 	// step 0, determine mu
 	double mu = 0;
@@ -309,6 +309,71 @@ opList::~opList()
 }
 
 
+size_t opList::applyFused(size_t first, Population & pop, size_t rep, ssize_t gen, ssize_t end,
+                          const vector<bool> & activeReps) const
+{
+	bool parallel = true;
+
+	if (first + 1 >= m_elems.size() || !m_elems[first]->initIndKernel(pop, parallel))
+		return 0;
+
+	subPopList subPops = m_elems[first]->applicableSubPops(pop);
+	// operators applied to virtual subpopulations can change the membership
+	// of these subpopulations so they have to be applied one by one
+	for (size_t i = 0; i < subPops.size(); ++i)
+		if (subPops[i].isVirtual())
+			return 0;
+
+	vectorop kernels(1, m_elems[first]);
+	size_t last = first + 1;
+	for (; last < m_elems.size(); ++last) {
+		BaseOperator * op = m_elems[last];
+		if (!op->isActive(rep, gen, end, activeReps))
+			continue;
+		subPopList opSubPops = op->applicableSubPops(pop);
+		bool sameSubPops = opSubPops.size() == subPops.size();
+		for (size_t i = 0; sameSubPops && i < subPops.size(); ++i)
+			sameSubPops = opSubPops[i] == subPops[i];
+		if (!sameSubPops || !op->initIndKernel(pop, parallel))
+			break;
+		kernels.push_back(op);
+	}
+	if (kernels.size() < 2)
+		return 0;
+
+	DBG_DO(DBG_SIMULATOR, cerr << "Apply " << kernels.size() << " operators in a single pass." << endl);
+
+	vector<int> errs(kernels.size(), 0);
+	subPopList::const_iterator sp = subPops.begin();
+	subPopList::const_iterator spEnd = subPops.end();
+	for (; sp != spEnd; ++sp) {
+		if (numThreads() > 1 && parallel) {
+#pragma omp parallel
+			{
+#ifdef _OPENMP
+				vector<int> threadErrs(kernels.size(), 0);
+				IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
+				for (; ind.valid(); ++ind)
+					for (size_t k = 0; k < kernels.size(); ++k)
+						kernels[k]->applyIndKernel(pop, ind.rawIter(), threadErrs[k]);
+#  pragma omp critical
+				for (size_t k = 0; k < kernels.size(); ++k)
+					errs[k] += threadErrs[k];
+#endif
+			}
+		} else {
+			IndIterator ind = pop.indIterator(sp->subPop());
+			for (; ind.valid(); ++ind)
+				for (size_t k = 0; k < kernels.size(); ++k)
+					kernels[k]->applyIndKernel(pop, ind.rawIter(), errs[k]);
+		}
+	}
+	for (size_t k = 0; k < kernels.size(); ++k)
+		kernels[k]->finishIndKernel(pop, errs[k]);
+	return last - first;
+}
+
+
 vectori Pause::s_cachedKeys = vectori();
 
 string Pause::describe(bool /* format */) const
@@ -395,6 +460,7 @@ IfElse::IfElse(PyObject * cond, const opList & ifOps, const opList & elseOps,
 	const stringList & infoFields) :
 	BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
 	m_cond(PyString_Check(cond) ? PyObj_AsString(cond) : string()),
+	m_nativeCond(PyString_Check(cond) ? PyObj_AsString(cond) : string()),
 	m_func(PyCallable_Check(cond) ? cond : NULL),
 	m_fixedCond(-1), m_ifOps(ifOps), m_elseOps(elseOps)
 {
@@ -407,6 +473,20 @@ IfElse::IfElse(PyObject * cond, const opList & ifOps, const opList & elseOps,
 }
 
 
+bool IfElse::evalNativeCond(Population & pop, bool & res) const
+{
+	if (!m_nativeCond.bind(vectorstr(), pop.dict()))
+		return false;
+	int err = 0;
+	double value = m_nativeCond.evaluate(InfoIterator(), 0, 0, err);
+	// let Python raise a proper error
+	if (err != 0)
+		return false;
+	res = value != 0;
+	return true;
+}
+
+
 string IfElse::describe(bool format) const
 {
 	string desc = "<simuPOP.IfElse>";
@@ -475,7 +555,7 @@ bool IfElse::applyDuringMating(Population & pop, Population & offPop, RawIndIter
 		}
 		res = m_func(PyObj_As_Bool, args);
 		Py_XDECREF(args);
-	} else {
+	} else if (!evalNativeCond(pop, res)) {
 		m_cond.setLocalDict(pop.dict());
 		res = m_cond.valueAsBool();
 	}
@@ -529,7 +609,7 @@ bool IfElse::apply(Population & pop) const
 		}
 		res = m_func(PyObj_As_Bool, args);
 		Py_XDECREF(args);
-	} else {
+	} else if (!evalNativeCond(pop, res)) {
 		m_cond.setLocalDict(pop.dict());
 		res = m_cond.valueAsBool();
 	}
@@ -301,6 +301,54 @@ public:
 	}
 
 
+	/** CPPONLY Return \c true if this operator does not change any individual
+	 *  so that information cached from individuals (e.g. members of VSPs)
+	 *  remains valid after it is applied.
+	 */
+	virtual bool readOnly() const
+	{
+		return false;
+	}
+
+
+	/** CPPONLY Prepare this operator to be applied to individuals of
+	 *  population \e pop one by one through function \c applyIndKernel(),
+	 *  so that it can share a single pass through the population with other
+	 *  such operators. Return \c false if the operator has to be applied by
+	 *  function \c apply(). \e parallel should be set to \c false if
+	 *  \c applyIndKernel() cannot be called by multiple threads.
+	 */
+	virtual bool initIndKernel(Population & pop, bool & parallel) const
+	{
+		(void)pop;  // avoid warning about unused parameter
+		(void)parallel;
+		return false;
+	}
+
+
+	/** CPPONLY Apply the operator to individual \e ind of population \e pop
+	 *  after \c initIndKernel() returns \c true. Errors should be counted in
+	 *  \e err instead of raised because this function can be called by
+	 *  multiple threads.
+	 */
+	virtual void applyIndKernel(Population & pop, RawIndIterator ind, int & err) const
+	{
+		(void)pop;  // avoid warning about unused parameter
+		(void)ind;
+		(void)err;
+	}
+
+
+	/** CPPONLY Called after \c applyIndKernel() has been applied to all
+	 *  individuals, with the number of errors \e err.
+	 */
+	virtual void finishIndKernel(Population & pop, int err) const
+	{
+		(void)pop;  // avoid warning about unused parameter
+		(void)err;
+	}
+
+
 	/// CPPONLY
 	virtual void initialize(const Individual & ind) const
 	{
@@ -315,6 +363,16 @@ public:
 	}
 
 
+	/** CPPONLY Called after a mating scheme has produced offspring of a
+	 *  subpopulation of \e pop with this operator, so that buffered output
+	 *  can be written.
+	 */
+	virtual void finalizeDuringMating(Population & pop) const
+	{
+		(void)pop;  // avoid warning about unused parameter
+	}
+
+
 protected:
 	/// analyze active generations: set m_flagAtAllGen etc
 	void setFlags();
@@ -418,6 +476,19 @@ public:
 	}
 
 
+	/** CPPONLY Apply operator \e first and the following active operators
+	 *  that can be applied individual by individual (see
+	 *  \c BaseOperator::initIndKernel()) to the same (non-virtual)
+	 *  subpopulations of \e pop in a single (parallel) pass through the
+	 *  population. Operators that are inactive at generation \e gen of
+	 *  replicate \e rep are skipped. Return the number of operators that
+	 *  have been processed, or \c 0 if less than two operators could be
+	 *  fused, in which case no operator is applied.
+	 */
+	size_t applyFused(size_t first, Population & pop, size_t rep, ssize_t gen, ssize_t end,
+		const vector<bool> & activeReps) const;
+
+
 protected:
 	vectorop m_elems;
 };
@@ -549,6 +620,13 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
 };
 
 /** This operator uses a condition, which can be a fixed condition, an
@@ -607,8 +685,12 @@ public:
 	string describe(bool format = true) const;
 
 private:
+	bool evalNativeCond(Population & pop, bool & res) const;
+
 	/// These will be kept constant (they are set in constructor only)
 	Expression m_cond;
+	/// condition that involves only numbers is evaluated without Python
+	nativeExpr m_nativeCond;
 	pyFunc m_func;
 	int m_fixedCond;
 
@@ -867,6 +949,13 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
 private:
 	const double m_stopAfter;
 	mutable time_t m_startTime;
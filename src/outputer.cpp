@@ -24,6 +24,12 @@
  */
 #include "outputer.h"
 
+#include <fstream>
+#include <sstream>
+#include <cstring>
+using std::ofstream;
+using std::ostringstream;
+
 namespace simuPOP {
 
 bool PyOutput::apply(Population & pop) const
@@ -115,7 +121,7 @@ UINT Dumper::displayGenotype(const Population & pop, const subPopList & subPops,
 		out << "SubPopulation " << *sp << " (" << pop.subPopName(*sp) << "), "
 		    << spSize << " Individuals:" << endl;
 
-		const_cast<Population &>(pop).activateVirtualSubPop(*sp);
+		const_cast<Population &>(pop).activateVirtualSubPop(*sp, true);
 		IndIterator ind = const_cast<Population &>(pop).indIterator(sp->subPop());
 		for ( ; ind.valid(); ++ind, ++count) {
 			out << setw(4) << (&*ind - &*pop.rawIndBegin()) << ": ";
@@ -193,4 +199,351 @@ bool SavePopulation::apply(Population & pop) const
 }
 
 
+string SavePlink::describe(bool /* format */) const
+{
+	return "<simuPOP.SavePlink> save genotypes in PLINK binary format to files " + m_filename + ".bed/bim/fam";
+}
+
+
+void SavePlink::saveFam(const Population & pop, const vector<const Individual *> & inds,
+                        const string & filename) const
+{
+	ofstream fam(filename.c_str());
+
+	if (!fam)
+		throw RuntimeError("Failed to create file " + filename);
+
+	bool hasID = !m_idField.empty() && pop.hasInfoField(m_idField);
+	bool hasFather = !m_fatherField.empty() && pop.hasInfoField(m_fatherField);
+	bool hasMother = !m_motherField.empty() && pop.hasInfoField(m_motherField);
+	bool hasPheno = !m_phenoField.empty();
+	size_t id = hasID ? pop.infoIdx(m_idField) : 0;
+	size_t father = hasFather ? pop.infoIdx(m_fatherField) : 0;
+	size_t mother = hasMother ? pop.infoIdx(m_motherField) : 0;
+	size_t pheno = hasPheno ? pop.infoIdx(m_phenoField) : 0;
+
+	for (size_t i = 0; i < inds.size(); ++i) {
+		const Individual * ind = inds[i];
+		fam << (i + 1) << ' '
+		    << (hasID ? ind->idInfo(id) : i + 1) << ' '
+		    << (hasFather ? ind->idInfo(father) : 0) << ' '
+		    << (hasMother ? ind->idInfo(mother) : 0) << ' '
+		    << (ind->sex() == MALE ? 1 : 2) << ' ';
+		if (hasPheno)
+			fam << ind->info(pheno) << '\n';
+		else
+			fam << (ind->affected() ? 2 : 1) << '\n';
+	}
+}
+
+
+void SavePlink::saveBim(const Population & pop, const string & filename) const
+{
+	ofstream bim(filename.c_str());
+
+	if (!bim)
+		throw RuntimeError("Failed to create file " + filename);
+
+	for (size_t ch = 0; ch < pop.numChrom(); ++ch) {
+		string chName = pop.chromName(ch);
+		if (chName.empty())
+			chName = (boost::format("%1%") % (ch + 1)).str();
+		for (size_t loc = pop.chromBegin(ch); loc < pop.chromEnd(ch); ++loc) {
+			string name = pop.locusName(loc);
+			bim << chName << '\t' << (name.empty() ? "." : name) << "\t0\t"
+			    << static_cast<long>(pop.locusPos(loc) * m_posMultiplier + 0.5) << '\t'
+			    << (1 + m_adjust) << '\t' << m_adjust << '\n';
+		}
+	}
+}
+
+
+void SavePlink::saveBed(const Population & pop, const vector<const Individual *> & inds,
+                        const string & filename) const
+{
+	ofstream bed(filename.c_str(), std::ios::binary);
+
+	if (!bed)
+		throw RuntimeError("Failed to create file " + filename);
+
+	// magic number and SNP-major mode
+	const char header[3] = { 0x6c, 0x1b, 0x01 };
+	bed.write(header, 3);
+
+	const size_t nInds = inds.size();
+	const size_t nBytes = (nInds + 3) / 4;
+	const size_t nLoci = pop.totNumLoci();
+	const bool haploid = pop.ploidy() == 1;
+
+	// 0 for autosomes and customized chromosomes, 1 for chromosome X, 2 for
+	// chromosome Y and 3 for mitochondrial DNA (first homologous copy only).
+	vector<unsigned char> locType(nLoci, 0);
+	for (size_t ch = 0; ch < pop.numChrom(); ++ch) {
+		unsigned char t = pop.chromType(ch) == CHROMOSOME_X ? 1 :
+		                  (pop.chromType(ch) == CHROMOSOME_Y ? 2 :
+		                   (pop.chromType(ch) == MITOCHONDRIAL ? 3 : 0));
+		std::fill(locType.begin() + pop.chromBegin(ch), locType.begin() + pop.chromEnd(ch), t);
+	}
+
+	// genotype codes indexed by number of non-zero alleles (3 for missing
+	// genotype): 11 for homozygous allele 0 (the second allele in .bim),
+	// 10 for heterozygote, 00 for homozygous non-zero allele and 01 for
+	// missing genotype.
+	const unsigned char code[4] = { 3, 2, 0, 1 };
+
+	vector<unsigned char> block;
+	for (size_t blkBegin = 0; blkBegin < nLoci; blkBegin += m_blockSize) {
+		size_t blkEnd = std::min(blkBegin + m_blockSize, nLoci);
+		block.assign((blkEnd - blkBegin) * nBytes, 0);
+		// Each byte holds genotypes of four individuals so a thread that
+		// handles a group of four individuals reads their genotypes
+		// sequentially and fills its own column of the SNP-major block.
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t byte = 0; byte < static_cast<ssize_t>(nBytes); ++byte) {
+			for (size_t j = 0; j < 4 && byte * 4 + j < nInds; ++j) {
+				const Individual * ind = inds[byte * 4 + j];
+				GenoIterator g0 = ind->genoBegin(0);
+				GenoIterator g1 = haploid ? g0 : ind->genoBegin(1);
+				bool male = ind->sex() == MALE;
+				unsigned char * ptr = &block[byte];
+				for (size_t loc = blkBegin; loc < blkEnd; ++loc, ptr += nBytes) {
+					// number of non-zero alleles, 3 for missing genotype
+					size_t cnt = 0;
+					switch (locType[loc]) {
+					case 1:
+						cnt = male ? (DEREF_ALLELE(g0 + loc) != 0) * 2
+						      : (DEREF_ALLELE(g0 + loc) != 0) + (DEREF_ALLELE(g1 + loc) != 0);
+						break;
+					case 2:
+						cnt = male ? (DEREF_ALLELE(g1 + loc) != 0) * 2 : 3;
+						break;
+					case 3:
+						cnt = (DEREF_ALLELE(g0 + loc) != 0) * 2;
+						break;
+					default:
+						cnt = (DEREF_ALLELE(g0 + loc) != 0) + (DEREF_ALLELE(g1 + loc) != 0);
+					}
+					*ptr |= static_cast<unsigned char>(code[cnt] << (2 * j));
+				}
+			}
+		}
+		if (!block.empty())
+			bed.write(reinterpret_cast<const char *>(&block[0]), block.size());
+	}
+	if (!bed)
+		throw RuntimeError("Failed to write to file " + filename);
+}
+
+
+bool SavePlink::apply(Population & pop) const
+{
+	if (m_filename.empty())
+		return true;
+
+	PARAM_FAILIF(pop.ploidy() > 2, ValueError,
+		"Operator SavePlink can only save haploid or diploid populations.");
+
+	string prefix;
+	if (m_filename[0] != '!')
+		prefix = m_filename;
+	else {
+		Expression filenameParser(m_filename.substr(1));
+		filenameParser.setLocalDict(pop.dict());
+		prefix = filenameParser.valueAsString();
+	}
+
+	vector<const Individual *> inds;
+	inds.reserve(pop.popSize());
+	subPopList subPops = applicableSubPops(pop);
+	subPopList::const_iterator sp = subPops.begin();
+	subPopList::const_iterator spEnd = subPops.end();
+	for (; sp != spEnd; ++sp) {
+		pop.activateVirtualSubPop(*sp, true);
+		IndIterator it = pop.indIterator(sp->subPop());
+		for (; it.valid(); ++it)
+			inds.push_back(&*it);
+		pop.deactivateVirtualSubPop(sp->subPop());
+	}
+
+	DBG_DO(DBG_POPULATION, cerr << "Save " << inds.size() << " individuals in PLINK format to "
+		                        << prefix << ".bed/bim/fam" << endl);
+	saveFam(pop, inds, prefix + ".fam");
+	saveBim(pop, prefix + ".bim");
+	saveBed(pop, inds, prefix + ".bed");
+	return true;
+}
+
+
+string SaveVCF::describe(bool /* format */) const
+{
+	return "<simuPOP.SaveVCF> save genotypes in VCF format to file " + m_filename;
+}
+
+
+// REF and ALT alleles of a VCF file should be sequences of bases
+static bool isVCFBases(const string & name)
+{
+	if (name.empty())
+		return false;
+	for (size_t i = 0; i < name.size(); ++i)
+		if (strchr("ACGTNacgtn", name[i]) == NULL)
+			return false;
+	return true;
+}
+
+
+bool SaveVCF::apply(Population & pop) const
+{
+	if (m_filename.empty())
+		return true;
+
+	string filename;
+	if (m_filename[0] != '!')
+		filename = m_filename;
+	else {
+		Expression filenameParser(m_filename.substr(1));
+		filenameParser.setLocalDict(pop.dict());
+		filename = filenameParser.valueAsString();
+	}
+
+	vector<const Individual *> inds;
+	inds.reserve(pop.popSize());
+	subPopList subPops = applicableSubPops(pop);
+	subPopList::const_iterator sp = subPops.begin();
+	subPopList::const_iterator spEnd = subPops.end();
+	for (; sp != spEnd; ++sp) {
+		pop.activateVirtualSubPop(*sp, true);
+		IndIterator it = pop.indIterator(sp->subPop());
+		for (; it.valid(); ++it)
+			inds.push_back(&*it);
+		pop.deactivateVirtualSubPop(sp->subPop());
+	}
+
+	bool compress = filename.size() > 3 && filename.substr(filename.size() - 3) == ".gz";
+	DBG_DO(DBG_POPULATION, cerr << "Save " << inds.size() << " individuals in VCF format to "
+		                        << filename << endl);
+	BgzfWriter vcf(filename, compress);
+
+	const size_t nInds = inds.size();
+	const size_t nLoci = pop.totNumLoci();
+	const size_t ploidy = pop.ploidy();
+
+	// chromosome names and header
+	vectorstr chNames(pop.numChrom());
+	ostringstream header;
+	header << "##fileformat=VCFv4.2\n##source=simuPOP\n";
+	for (size_t ch = 0; ch < pop.numChrom(); ++ch) {
+		chNames[ch] = pop.chromName(ch);
+		if (chNames[ch].empty())
+			chNames[ch] = (boost::format("%1%") % (ch + 1)).str();
+		header << "##contig=<ID=" << chNames[ch] << ">\n";
+	}
+	header << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n"
+	       << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT";
+	bool hasID = !m_idField.empty() && pop.hasInfoField(m_idField);
+	size_t id = hasID ? pop.infoIdx(m_idField) : 0;
+	for (size_t i = 0; i < nInds; ++i) {
+		if (hasID)
+			header << '\t' << inds[i]->idInfo(id);
+		else
+			header << "\tS" << (i + 1);
+	}
+	header << '\n';
+	vcf.write(header.str());
+
+	// chromosome index and type (see SavePlink::saveBed) of each locus
+	vectoru locChrom(nLoci, 0);
+	vector<unsigned char> locType(nLoci, 0);
+	for (size_t ch = 0; ch < pop.numChrom(); ++ch) {
+		unsigned char t = pop.chromType(ch) == CHROMOSOME_X ? 1 :
+		                  (pop.chromType(ch) == CHROMOSOME_Y ? 2 :
+		                   (pop.chromType(ch) == MITOCHONDRIAL ? 3 : 0));
+		std::fill(locType.begin() + pop.chromBegin(ch), locType.begin() + pop.chromEnd(ch), t);
+		std::fill(locChrom.begin() + pop.chromBegin(ch), locChrom.begin() + pop.chromEnd(ch), ch);
+	}
+	// allele names are initialized lazily so they are accessed once before
+	// they are used by multiple threads.
+	pop.alleleName(0, 0);
+
+	vectorstr sites;
+	for (size_t blkBegin = 0; blkBegin < nLoci; blkBegin += m_blockSize) {
+		size_t blkEnd = std::min(blkBegin + m_blockSize, nLoci);
+		sites.assign(blkEnd - blkBegin, string());
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t loc = blkBegin; loc < static_cast<ssize_t>(blkEnd); ++loc) {
+			// number of alleles written for each individual, 0 for missing
+			// genotype.
+			vectoru nAlleles(nInds, ploidy);
+			vector<size_t> firstCopy(nInds, 0);
+			for (size_t i = 0; i < nInds; ++i) {
+				bool male = inds[i]->sex() == MALE;
+				switch (locType[loc]) {
+				case 1:
+					nAlleles[i] = male ? 1 : ploidy;
+					break;
+				case 2:
+					nAlleles[i] = male ? 1 : 0;
+					firstCopy[i] = 1;
+					break;
+				case 3:
+					nAlleles[i] = 1;
+					break;
+				default:
+					break;
+				}
+			}
+			// non-zero alleles that appear in the samples, sorted
+			vector<ULONG> alts;
+			for (size_t i = 0; i < nInds; ++i) {
+				for (size_t p = firstCopy[i]; p < firstCopy[i] + nAlleles[i]; ++p) {
+					ULONG a = DEREF_ALLELE(inds[i]->genoBegin(p) + loc);
+					if (a == 0)
+						continue;
+					vector<ULONG>::iterator it = std::lower_bound(alts.begin(), alts.end(), a);
+					if (it == alts.end() || *it != a)
+						alts.insert(it, a);
+				}
+			}
+			ostringstream line;
+			string name = pop.locusName(loc);
+			string ref = pop.alleleName(0, loc);
+			line << chNames[locChrom[loc]] << '\t'
+			     << static_cast<long>(pop.locusPos(loc) * m_posMultiplier + 0.5) << '\t'
+			     << (name.empty() ? "." : name) << '\t' << (isVCFBases(ref) ? ref : "N") << '\t';
+			if (alts.empty())
+				line << '.';
+			for (size_t j = 0; j < alts.size(); ++j) {
+				string alt = pop.alleleName(alts[j], loc);
+				line << (j == 0 ? "" : ",");
+				// alleles without names of bases are written as symbolic alleles
+				if (isVCFBases(alt))
+					line << alt;
+				else
+					line << "<A" << alts[j] << '>';
+			}
+			line << "\t.\tPASS\t.\tGT";
+			for (size_t i = 0; i < nInds; ++i) {
+				line << '\t';
+				if (nAlleles[i] == 0) {
+					line << '.';
+					continue;
+				}
+				for (size_t p = firstCopy[i]; p < firstCopy[i] + nAlleles[i]; ++p) {
+					ULONG a = DEREF_ALLELE(inds[i]->genoBegin(p) + loc);
+					if (p != firstCopy[i])
+						line << '|';
+					line << (a == 0 ? 0 : std::lower_bound(alts.begin(), alts.end(), a) - alts.begin() + 1);
+				}
+			}
+			line << '\n';
+			sites[loc - blkBegin] = line.str();
+		}
+		for (size_t i = 0; i < sites.size(); ++i)
+			vcf.write(sites[i]);
+	}
+	vcf.close();
+	return true;
+}
+
+
 }
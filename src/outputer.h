@@ -81,6 +81,14 @@ public:
 	/// HIDDEN
 	string describe(bool format = true) const;
 
+
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
 private:
 	const string m_string;
 };
@@ -142,6 +150,13 @@ public:
 	}
 
 
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
 private:
 	void displayStructure(const Population & pop, ostream & out) const;
 
@@ -211,10 +226,205 @@ public:
 	/// HIDDEN
 	string describe(bool format = true) const;
 
+
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
 private:
 	/// filename,
 	const string m_filename;
 };
 
+
+/** An operator that saves genotypes of a diploid population in PLINK
+ *  binary format, namely a \c .bed file with SNP-major genotypes, a \c .bim
+ *  file with marker information and a \c .fam file with individual
+ *  information.
+ */
+class SavePlink : public BaseOperator
+{
+public:
+	/** Create an operator that saves individuals in specified (virtual)
+	 *  subpopulations (parameter \e subPops, default to all individuals) of
+	 *  the present generation to files \c output.bed, \c output.bim and
+	 *  \c output.fam, where \e output is a filename prefix or an expression
+	 *  (\c '!expr') that is evaluated in the local namespace of the population.
+	 *  Genotypes are written directly from the genotype storage of the
+	 *  population, in blocks of \e blockSize loci, so that memory usage does
+	 *  not grow with the number of loci. Because the \c .bed format only
+	 *  stores biallelic markers, all non-zero alleles are treated as the
+	 *  second allele, which is named \c 1+adjust in the \c .bim file with
+	 *  allele \c 0 named \c 0+adjust. Alleles on chromosome X of male
+	 *  individuals are written as homozygous, and genotypes on chromosome Y
+	 *  of females are written as missing. Individual ID and IDs of parents
+	 *  are written from information fields \e idField, \e fatherField and
+	 *  \e motherField if they are available (\c 0 otherwise), with a
+	 *  1-based incremental family ID for each individual. Phenotype is
+	 *  written from information field \e phenoField if specified, or as
+	 *  affection status (\c 2 for affected and \c 1 for unaffected)
+	 *  otherwise. Loci positions multiplied by \e posMultiplier are
+	 *  written as base-pair positions of markers. Please refer to class
+	 *  \c BaseOperator for a detailed description about common operator
+	 *  parameters such as \e stage and \e begin.
+	 */
+	SavePlink(const stringFunc & output = "", const string & idField = "ind_id",
+		const string & fatherField = "father_id", const string & motherField = "mother_id",
+		const string & phenoField = string(), int adjust = 1, double posMultiplier = 1,
+		size_t blockSize = 4096, int begin = 0, int end = -1, int step = 1,
+		const intList & at = vectori(), const intList & reps = intList(),
+		const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr()) :
+		BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
+		m_filename(output.value()), m_idField(idField), m_fatherField(fatherField),
+		m_motherField(motherField), m_phenoField(phenoField), m_adjust(adjust),
+		m_posMultiplier(posMultiplier), m_blockSize(blockSize)
+	{
+		DBG_WARNIF(output.empty(), "An empty output string is passed to operator SavePlink. No file will be saved.");
+		PARAM_FAILIF(m_blockSize == 0, ValueError, "Parameter blockSize should be positive.");
+	}
+
+
+	/// destructor.
+	~SavePlink()
+	{
+	}
+
+
+	/// HIDDEN Deep copy of a SavePlink operator.
+	virtual BaseOperator * clone() const
+	{
+		return new SavePlink(*this);
+	}
+
+
+	/// HIDDEN apply operator to population \e pop.
+	virtual bool apply(Population & pop) const;
+
+	/// HIDDEN
+	string describe(bool format = true) const;
+
+
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
+private:
+	void saveFam(const Population & pop, const vector<const Individual *> & inds,
+		const string & filename) const;
+
+	void saveBim(const Population & pop, const string & filename) const;
+
+	void saveBed(const Population & pop, const vector<const Individual *> & inds,
+		const string & filename) const;
+
+private:
+	/// filename prefix
+	const string m_filename;
+
+	const string m_idField;
+
+	const string m_fatherField;
+
+	const string m_motherField;
+
+	const string m_phenoField;
+
+	const int m_adjust;
+
+	const double m_posMultiplier;
+
+	/// number of loci that are transposed and written at a time
+	const size_t m_blockSize;
+};
+
+
+/** An operator that saves genotypes of individuals in the Variant Call
+ *  Format (VCF, version 4.2), optionally compressed in the BGZF format that
+ *  is used by \c bgzip and \c tabix.
+ */
+class SaveVCF : public BaseOperator
+{
+public:
+	/** Create an operator that saves individuals in specified (virtual)
+	 *  subpopulations (parameter \e subPops, default to all individuals) of
+	 *  the present generation to a VCF file \e output, which can be a
+	 *  filename or an expression (\c '!expr') that is evaluated in the local
+	 *  namespace of the population. The file is compressed in BGZF format if
+	 *  its name ends with \c .gz. Sites are formatted and compressed in
+	 *  blocks of \e blockSize loci, using multiple threads if available,
+	 *  and are streamed to the output so that memory usage does not grow
+	 *  with the number of loci. Samples are named by values of information
+	 *  field \e idField if available, or by their indexes (\c S1, \c S2, ...)
+	 *  otherwise. Names of allele \c 0 are used as reference alleles, and names
+	 *  of non-zero alleles that appear in the samples are listed as alternative
+	 *  alleles. Because alleles in VCF files are sequences of bases, a
+	 *  reference allele without such a name (e.g. when no allele name is
+	 *  specified) is written as \c N, and an alternative allele \c a without
+	 *  such a name is written as a symbolic allele \c <Aa>. Genotypes are written as phased haplotypes, with a single
+	 *  allele for haploid populations and for chromosome X of males and
+	 *  mitochondrial DNA, and with missing genotype for chromosome Y of
+	 *  females. Loci positions multiplied by \e posMultiplier are written
+	 *  as base-pair positions of sites. Please refer to class \c BaseOperator
+	 *  for a detailed description about common operator parameters such as
+	 *  \e stage and \e begin.
+	 */
+	SaveVCF(const stringFunc & output = "", const string & idField = "ind_id",
+		double posMultiplier = 1, size_t blockSize = 1024, int begin = 0, int end = -1,
+		int step = 1, const intList & at = vectori(), const intList & reps = intList(),
+		const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr()) :
+		BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
+		m_filename(output.value()), m_idField(idField), m_posMultiplier(posMultiplier),
+		m_blockSize(blockSize)
+	{
+		DBG_WARNIF(output.empty(), "An empty output string is passed to operator SaveVCF. No file will be saved.");
+		PARAM_FAILIF(m_blockSize == 0, ValueError, "Parameter blockSize should be positive.");
+	}
+
+
+	/// destructor.
+	~SaveVCF()
+	{
+	}
+
+
+	/// HIDDEN Deep copy of a SaveVCF operator.
+	virtual BaseOperator * clone() const
+	{
+		return new SaveVCF(*this);
+	}
+
+
+	/// HIDDEN apply operator to population \e pop.
+	virtual bool apply(Population & pop) const;
+
+	/// HIDDEN
+	string describe(bool format = true) const;
+
+
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
+private:
+	/// filename
+	const string m_filename;
+
+	const string m_idField;
+
+	const double m_posMultiplier;
+
+	/// number of sites that are formatted and compressed at a time
+	const size_t m_blockSize;
+};
+
 }
 #endif
@@ -30,6 +30,8 @@ using std::ofstream;
 
 #include <set>
 
+#include "zlib.h"
+
 namespace simuPOP {
 
 Pedigree::Pedigree(const Population & pop, const lociList & loci,
@@ -101,7 +103,7 @@ void Pedigree::buildIDMap()
 	for (int depth = ancestralGens(); depth >= 0; --depth) {
 		useAncestralGen(depth);
 		for (IndIterator it = indIterator(); it.valid(); ++it) {
-			size_t id = toID(it->info(m_idIdx));
+			size_t id = it->idInfo(m_idIdx);
 			DBG_WARNIF(m_idMap.find(id) != m_idMap.end() && *m_idMap[id] != *it,
 				(boost::format("Different individuals share the same ID %1%"
 					           " so only the latest Individual will be used. If this is an "
@@ -146,16 +148,16 @@ void Pedigree::save(const string & filename, const stringList & fieldList,
 		ConstRawIndIterator it = rawIndBegin();
 		ConstRawIndIterator it_end = rawIndEnd();
 		for (; it != it_end; ++it) {
-			size_t myID = toID(it->info(m_idIdx));
+			size_t myID = it->idInfo(m_idIdx);
 			size_t fatherID = 0;
 			size_t motherID = 0;
 			if (m_fatherIdx != -1) {
-				fatherID = toID(it->info(m_fatherIdx));
+				fatherID = it->idInfo(m_fatherIdx);
 				if (fatherID && m_idMap.find(fatherID) == m_idMap.end())
 					fatherID = 0;
 			}
 			if (m_motherIdx != -1) {
-				motherID = toID(it->info(m_motherIdx));
+				motherID = it->idInfo(m_motherIdx);
 				if (motherID && m_idMap.find(motherID) == m_idMap.end())
 					motherID = 0;
 			}
@@ -296,10 +298,8 @@ void Pedigree::locateSpouse(SexChoice sexChoice, AffectionStatus affectionChoice
 		for (size_t i = 0; i < maxSpouse; ++i) {
 			spouseIdx[i] = infoIdx(resultFields[i]);
 			// clear these fields for the last generation
-			IndInfoIterator ptr = infoBegin(spouseIdx[i]);
-			IndInfoIterator ptrEnd = infoEnd(spouseIdx[i]);
-			for ( ; ptr != ptrEnd; ++ptr)
-				*ptr = -1;
+			for (IndIterator ind = indIterator(); ind.valid(); ++ind)
+				ind->setInfo(-1, spouseIdx[i]);
 		}
 	}
 	// find all the couples
@@ -391,9 +391,8 @@ void Pedigree::locateOffspring(SexChoice sexChoice, AffectionStatus affectionCho
 		for (size_t i = 0; i < maxOffspring; ++i) {
 			offspringIdx[i] = infoIdx(resultFields[i]);
 			// clear these fields for the last generation
-			for (IndInfoIterator ptr = infoBegin(offspringIdx[i]);
-			     ptr != infoEnd(offspringIdx[i]); ++ptr)
-				*ptr = static_cast<double>(-1);
+			for (IndIterator ind = indIterator(); ind.valid(); ++ind)
+				ind->setInfo(-1, offspringIdx[i]);
 		}
 	}
 
@@ -463,9 +462,9 @@ void Pedigree::locateSibling(SexChoice sexChoice, AffectionStatus affectionChoic
 			double f = individual(i).info(m_fatherIdx);
 			double m = individual(i).info(m_motherIdx);
 			if (f >= 1)
-				families[toID(f)].push_back(toID(individual(i).info(m_idIdx)));
+				families[toID(f)].push_back(individual(i).idInfo(m_idIdx));
 			if (m >= 1)
-				families[toID(m)].push_back(toID(individual(i).info(m_idIdx)));
+				families[toID(m)].push_back(individual(i).idInfo(m_idIdx));
 		}
 	}
 	// look in each single-parent family
@@ -560,7 +559,7 @@ void Pedigree::locateFullSibling(SexChoice sexChoice, AffectionStatus affectionC
 			double f = individual(i).info(m_fatherIdx);
 			double m = individual(i).info(m_motherIdx);
 			if (f >= 1 && m >= 1)
-				families[couple(toID(f), toID(m))].push_back(toID(individual(i).info(m_idIdx)));
+				families[couple(toID(f), toID(m))].push_back(individual(i).idInfo(m_idIdx));
 		}
 	}
 	// look in each single-parent family
@@ -639,10 +638,8 @@ void Pedigree::locateCommonOffspring(SexChoice sexChoice, AffectionStatus affect
 		for (size_t i = 0; i < maxOffspring; ++i) {
 			offspringIdx[i] = infoIdx(resultFields[i + 1]);
 			// clear these fields for the last generation
-			IndInfoIterator ptr = infoBegin(offspringIdx[i]);
-			IndInfoIterator ptrEnd = infoEnd(offspringIdx[i]);
-			for (; ptr != ptrEnd; ++ptr)
-				*ptr = static_cast<double>(-1);
+			for (IndIterator ind = indIterator(); ind.valid(); ++ind)
+				ind->setInfo(-1, offspringIdx[i]);
 		}
 	}
 
@@ -655,7 +652,7 @@ void Pedigree::locateCommonOffspring(SexChoice sexChoice, AffectionStatus affect
 			double f = individual(i).info(m_fatherIdx);
 			double m = individual(i).info(m_motherIdx);
 			if (f >= 1 && m >= 1)
-				families[couple(toID(f), toID(m))].push_back(toID(individual(i).info(m_idIdx)));
+				families[couple(toID(f), toID(m))].push_back(individual(i).idInfo(m_idIdx));
 		}
 	}
 	// look in each family
@@ -779,7 +776,7 @@ bool Pedigree::traceRelatives(const stringMatrix & fieldPath,
 		useAncestralGen(gens[genIdx]);
 		for (IndIterator ind = indIterator(); ind.valid(); ++ind, ++idx) {
 			Sex mySex = ind->sex();
-			vectoru inds = vectoru(1, toID(ind->info(m_idIdx)));
+			vectoru inds = vectoru(1, ind->idInfo(m_idIdx));
 			// go through the path
 			for (size_t path = 0; path < pathFields.size(); ++path) {
 				DBG_DO(DBG_POPULATION, cerr << "Start of path " << path
@@ -914,7 +911,7 @@ vectoru Pedigree::individualsWithRelatives(const stringList & infoFieldList, con
 				}
 			}
 			if (valid)
-				IDs.push_back(toID(ind->info(m_idIdx)));
+				IDs.push_back(ind->idInfo(m_idIdx));
 		}
 	}
 	useAncestralGen(oldGen);
@@ -957,7 +954,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 		RawIndIterator itEnd = rawIndEnd();
 		for (; it != itEnd; ++it)
 			if (it->marked())
-				famID[toID(it->info(m_idIdx))] = -1;
+				famID[it->idInfo(m_idIdx)] = -1;
 	}
 	// step 2: decide family ID
 	size_t famCount = 0;
@@ -976,7 +973,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 		ssize_t momFam = -2;
 		// try to identify father and mother....
 		if (m_fatherIdx != -1) {
-			size_t dad_id = toID(ind->info(m_fatherIdx));
+			size_t dad_id = ind->idInfo(m_fatherIdx);
 			// ok father
 			std::map<size_t, ssize_t>::iterator dad_fam = famID.find(dad_id);
 			// because father exists in famID
@@ -986,7 +983,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 			}
 		}
 		if (m_motherIdx != -1) {
-			size_t mom_id = toID(ind->info(m_motherIdx));
+			size_t mom_id = ind->idInfo(m_motherIdx);
 			// ok mother
 			std::map<size_t, ssize_t>::iterator mom_fam = famID.find(mom_id);
 			// because father exists in famID
@@ -1005,7 +1002,7 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 				it->second = dadFam;
 			else {
 				it->second = famCount;
-				famID[toID(dad->info(m_idIdx))] = famCount;
+				famID[dad->idInfo(m_idIdx)] = famCount;
 				++famCount;
 			}
 		} else if (dad == NULL && mom != NULL) {
@@ -1015,23 +1012,23 @@ vectoru Pedigree::identifyFamilies(const string & pedField, const subPopList & s
 				it->second = momFam;
 			else {
 				it->second = famCount;
-				famID[toID(mom->info(m_idIdx))] = famCount;
+				famID[mom->idInfo(m_idIdx)] = famCount;
 				++famCount;
 			}
 		} else if (dadFam < 0 && momFam < 0) {
 			// CASE FIVE: fresh father and mother
 			it->second = famCount;
-			famID[toID(mom->info(m_idIdx))] = famCount;
-			famID[toID(dad->info(m_idIdx))] = famCount;
+			famID[mom->idInfo(m_idIdx)] = famCount;
+			famID[dad->idInfo(m_idIdx)] = famCount;
 			++famCount;
 		} else if (dadFam >= 0 && momFam < 0) {
 			// CASE SIX: fresh mother
 			it->second = dadFam;
-			famID[toID(mom->info(m_idIdx))] = dadFam;
+			famID[mom->idInfo(m_idIdx)] = dadFam;
 		} else if (dadFam < 0 && momFam >= 0) {
 			// CASE SEVEN: fresh father
 			it->second = momFam;
-			famID[toID(dad->info(m_idIdx))] = momFam;
+			famID[dad->idInfo(m_idIdx)] = momFam;
 		} else if (dadFam == momFam) {
 			// CASE EIGHT: a sibling?
 			it->second = momFam;
@@ -1106,7 +1103,7 @@ vectoru Pedigree::identifyAncestors(const uintList & IDs,
 		RawIndIterator itEnd = rawIndEnd();
 		for (; it != itEnd; ++it)
 			if (it->marked())
-				res.push_back(toID(it->info(m_idIdx)));
+				res.push_back(it->idInfo(m_idIdx));
 	} else {
 		const vectoru & inputIDs = IDs.elems();
 		res.reserve(inputIDs.size());
@@ -1129,9 +1126,9 @@ vectoru Pedigree::identifyAncestors(const uintList & IDs,
 				// if this ID exists
 				Individual & ind = indByID(ID);
 				if (m_fatherIdx != -1)
-					father_ID = toID(ind.info(m_fatherIdx));
+					father_ID = ind.idInfo(m_fatherIdx);
 				if (m_motherIdx != -1)
-					mother_ID = toID(ind.info(m_motherIdx));
+					mother_ID = ind.idInfo(m_motherIdx);
 			} catch (IndexError &) {
 				//
 			}
@@ -1204,9 +1201,9 @@ vectoru Pedigree::identifyOffspring(const uintList & IDs,
 		for (; it != itEnd; ++it) {
 			// I am a valid offspring
 			if (it->marked()) {
-				size_t myID = toID(it->info(m_idIdx));
-				size_t fatherID = m_fatherIdx == -1 ? 0 : toID(it->info(m_fatherIdx));
-				size_t motherID = m_motherIdx == -1 ? 0 : toID(it->info(m_motherIdx));
+				size_t myID = it->idInfo(m_idIdx);
+				size_t fatherID = m_fatherIdx == -1 ? 0 : it->idInfo(m_fatherIdx);
+				size_t motherID = m_motherIdx == -1 ? 0 : it->idInfo(m_motherIdx);
 				// we do not care if father or mother is valid.
 				if (fatherID) {
 					if (offspringMap.find(fatherID) == offspringMap.end())
@@ -1335,45 +1332,187 @@ struct IndInfo
 	IndInfo(size_t off) : sex(MALE), parents(), offspring(1, off), affectionStatus(false), fields(), genotype() {}
 };
 
+#if TR1_SUPPORT == 0
+typedef std::map<size_t, IndInfo *> IndInfoMap;
+#else
+typedef std::tr1::unordered_map<size_t, IndInfo *> IndInfoMap;
+#endif
 
-Pedigree loadPedigree(const string & file, const string & idField, const string & fatherField,
-                      const string & motherField, float ploidy, const uintList & _lociList, const uintList & chromTypes,
-                      const floatList & lociPos, const stringList & chromNames, const stringMatrix & alleleNames,
-                      const stringList & lociNames, const stringList & subPopNames, const stringList & fieldList)
+// create an entry for individual myID
+static IndInfo * addIndInfo(IndInfoMap & individuals, size_t myID)
 {
-	initClock();
-	int pldy = ploidy == HAPLODIPLOID ? 2 : static_cast<int>(ploidy);
-	//
-	const vectorstr & infoFields = fieldList.elems();
+	if (individuals.find(myID) != individuals.end())
+		throw ValueError((boost::format("Duplicate individual ID %1%") % myID).str());
+	return (individuals.insert(IndInfoMap::value_type(myID, new IndInfo())).first)->second;
+}
 
-	for (size_t i = 0; i < infoFields.size(); ++i) {
-		DBG_FAILIF(infoFields[i] == idField || infoFields[i] == fatherField || infoFields[i] == motherField,
-			ValueError, "Parameter infoFields can only specify additional fields other than idField, fatherField and motherField.");
+
+// add parent id to individual myID
+static void addParent(IndInfoMap & individuals, IndInfo * info, size_t myID, size_t id)
+{
+	info->parents.push_back(id);
+	IndInfoMap::iterator it = individuals.find(id);
+	// this is a parent but we do not know if he or she has parent
+	if (it == individuals.end())
+		individuals[id] = new IndInfo(myID);
+	else
+		it->second->offspring.push_back(myID);
+}
+
+
+// determine or check the number of loci from genotype of an individual
+static void checkGenotype(const IndInfo * info, vectoru & loci, size_t & genoCols, int pldy)
+{
+	if (info->genotype.empty())
+		return;
+	if (loci.empty()) {
+		loci.push_back(info->genotype.size() / pldy);
+		genoCols = info->genotype.size();
+		if (loci.back() * pldy != genoCols)
+			throw ValueError("Incorrect number of genotype colmns for a diploid population.");
+	} else {
+		if (genoCols != info->genotype.size())
+			throw ValueError("Inconsistent number of columns of genotypes.");
 	}
-	vectoru loci = _lociList.elems();
-	size_t genoCols = accumulate(loci.begin(), loci.end(), size_t(0)) * pldy;
+}
+
 
-	ifstream input(file.c_str());
-	if (!input)
+// read an unsigned integer of specified bytes in little endian
+static inline uint64_t readUInt(const char * p, size_t bytes)
+{
+	uint64_t v = 0;
+
+	for (size_t i = bytes; i > 0; --i)
+		v = (v << 8) | static_cast<unsigned char>(p[i - 1]);
+	return v;
+}
+
+
+// read a line of arbitrary length from a gzip file, without trailing newline
+static bool gzReadLine(gzFile file, string & line)
+{
+	char buf[65536];
+
+	line.clear();
+	while (gzgets(file, buf, sizeof(buf)) != NULL) {
+		line += buf;
+		if (!line.empty() && line[line.size() - 1] == '\n') {
+			line.erase(line.size() - 1);
+			if (!line.empty() && line[line.size() - 1] == '\r')
+				line.erase(line.size() - 1);
+			return true;
+		}
+	}
+	return !line.empty();
+}
+
+
+/* A reader that reads records of individuals sequentially from a text or
+ * binary pedigree file, which can be compressed by gzip.
+ */
+class PedigreeRecordReader
+{
+public:
+	PedigreeRecordReader(const string & file, size_t numInfoFields);
+
+	~PedigreeRecordReader()
+	{
+		gzclose(m_file);
+	}
+
+
+	/// read the next individual to \e myID and \e info, return false
+	/// if there is no more individual.
+	bool read(size_t & myID, IndInfo & info);
+
+	/// return an individual so that it will be read again
+	void unread(size_t myID, const IndInfo & info)
+	{
+		m_unreadID = myID;
+		m_unread = info;
+		m_hasUnread = true;
+	}
+
+
+private:
+	bool readText(size_t & myID, IndInfo & info);
+
+	bool readBinary(size_t & myID, IndInfo & info);
+
+	/// read the next chunk of binary records, return false at the end of file
+	bool readChunk();
+
+	gzFile m_file;
+
+	string m_filename;
+
+	size_t m_numInfoFields;
+
+	bool m_binary;
+
+	string m_line;
+
+	// layout and records of the current chunk of binary records
+	size_t m_numParents;
+	size_t m_alleleBytes;
+	size_t m_numFields;
+	size_t m_numAlleles;
+	size_t m_numRecords;
+	size_t m_nextRecord;
+	vector<char> m_records;
+	const char * m_ptr;
+
+	// an individual that has been returned
+	bool m_hasUnread;
+	size_t m_unreadID;
+	IndInfo m_unread;
+};
+
+
+PedigreeRecordReader::PedigreeRecordReader(const string & file, size_t numInfoFields)
+	: m_file(gzopen(file.c_str(), "rb")), m_filename(file), m_numInfoFields(numInfoFields),
+	m_binary(false), m_line(), m_numParents(0), m_alleleBytes(0), m_numFields(0), m_numAlleles(0),
+	m_numRecords(0), m_nextRecord(0), m_records(), m_ptr(NULL),
+	m_hasUnread(false), m_unreadID(0), m_unread()
+{
+	if (m_file == NULL)
 		throw RuntimeError("Cannot open specified pedigree file " + file);
-	//
-	size_t max_parents = 0;
-	string line;
-	// individual and their parents
-#if TR1_SUPPORT == 0
-	typedef std::map<size_t, IndInfo *> IdMap;
-#else
-	typedef std::tr1::unordered_map<size_t, IndInfo *> IdMap;
+#if ZLIB_VERNUM >= 0x1240
+	gzbuffer(m_file, 1 << 20);
 #endif
-	IdMap individuals;
-	while (getline(input, line)) {
-		if (line.empty())
+	// binary files start with a magic string
+	char magic[4];
+	m_binary = gzread(m_file, magic, 4) == 4 && std::string(magic, 4) == PEDIGREE_BINARY_MAGIC;
+	gzrewind(m_file);
+}
+
+
+bool PedigreeRecordReader::read(size_t & myID, IndInfo & info)
+{
+	if (m_hasUnread) {
+		myID = m_unreadID;
+		info = m_unread;
+		m_hasUnread = false;
+		return true;
+	}
+	info.sex = MALE;
+	info.affectionStatus = false;
+	info.parents.clear();
+	info.offspring.clear();
+	info.fields.clear();
+	info.genotype.clear();
+	return m_binary ? readBinary(myID, info) : readText(myID, info);
+}
+
+
+bool PedigreeRecordReader::readText(size_t & myID, IndInfo & info)
+{
+	while (gzReadLine(m_file, m_line)) {
+		if (m_line.empty())
 			continue;
 		//
-		IndInfo * info = NULL;
-		size_t myID = 0;
 		int part = 0;
-		char * p = strtok(const_cast<char *>(line.c_str()), " ");
+		char * p = strtok(&m_line[0], " ");
 		// boost::tokenizer is proven to be too slow..... (5.5s vs. 1.5s)
 		while (p) {
 			char * q = p;
@@ -1381,76 +1520,153 @@ Pedigree loadPedigree(const string & file, const string & idField, const string
 			// collect self ID
 			if (part == 0) {
 				myID = atoi(q);
-				if (individuals.find(myID) != individuals.end())
-					throw ValueError((boost::format("Duplicate individual ID %1%") % myID).str());
-				info = (individuals.insert(IdMap::value_type(myID, new IndInfo())).first)->second;
 				++part;
 				continue;
 				// parental ID and sex
 			} else if (part == 1) {
 				if (*q == 'M') {
-					info->sex = MALE;
+					info.sex = MALE;
 					++part;
 					continue;
 				} else if (*q == 'F') {
-					info->sex = FEMALE;
+					info.sex = FEMALE;
 					++part;
 					continue;
 				} else {
 					size_t id = atoi(q);
-					if (id) {
-						info->parents.push_back(id);
-						IdMap::iterator it = individuals.find(id);
-						// this is a parent but we do not know if he or she has parent
-						if (it == individuals.end())
-							individuals[id] = new IndInfo(myID);
-						else
-							it->second->offspring.push_back(myID);
-					}
-					if (info->parents.size() > 2)
+					if (id)
+						info.parents.push_back(id);
+					if (info.parents.size() > 2)
 						throw ValueError("At most two parental IDs are allowed before sex information");
 				}
 				// parental affection status, can be ignored
 			} else if (part == 2) {
 				if (*q == 'A')
-					info->affectionStatus = true;
+					info.affectionStatus = true;
 				else if (*q == 'U')
-					info->affectionStatus = false;
+					info.affectionStatus = false;
 				else
 					++part;
 			}
 
 			// information fields, can be ignored
 			if (part == 3) {
-				if (info->fields.size() == infoFields.size())
+				if (info.fields.size() == m_numInfoFields)
 					++part;
 				else
-					info->fields.push_back(atof(q));
+					info.fields.push_back(atof(q));
 			}
 
 			// genotype
 			if (part == 4)
-				info->genotype.push_back(TO_ALLELE(atoi(q)));
+				info.genotype.push_back(TO_ALLELE(atoi(q)));
 		}
 		// if there is no valid input...
-		if (part == 0)
-			continue;
-		if (!info->genotype.empty()) {
-			if (loci.empty()) {
-				loci.push_back(info->genotype.size() / pldy);
-				genoCols = info->genotype.size();
-				if (loci.back() * pldy != genoCols)
-					throw ValueError("Incorrect number of genotype colmns for a diploid population.");
-			} else {
-				if (genoCols != info->genotype.size())
-					throw ValueError("Inconsistent number of columns of genotypes.");
-			}
+		if (part > 0)
+			return true;
+	}
+	return false;
+}
+
+
+bool PedigreeRecordReader::readChunk()
+{
+	char header[PEDIGREE_BINARY_HEADER_SIZE];
+	int len = gzread(m_file, header, PEDIGREE_BINARY_HEADER_SIZE);
+
+	if (len == 0)
+		return false;
+	if (len != PEDIGREE_BINARY_HEADER_SIZE || std::string(header, 4) != PEDIGREE_BINARY_MAGIC
+	    || header[4] != PEDIGREE_BINARY_VERSION)
+		throw ValueError("Corrupted or unsupported binary pedigree file " + m_filename);
+	m_numParents = static_cast<unsigned char>(header[5]);
+	m_alleleBytes = static_cast<unsigned char>(header[6]);
+	m_numFields = readUInt(header + 8, 4);
+	m_numAlleles = readUInt(header + 12, 4);
+	m_numRecords = readUInt(header + 16, 4);
+	if (m_numParents > 2)
+		throw ValueError("At most two parental IDs are allowed in binary pedigree file " + m_filename);
+	size_t recSize = 8 * (1 + m_numParents) + 1 + 8 * m_numFields + m_alleleBytes * m_numAlleles;
+	m_records.resize(recSize * m_numRecords + 1);
+	if (gzread(m_file, &m_records[0], static_cast<unsigned>(recSize * m_numRecords))
+	    != static_cast<int>(recSize * m_numRecords))
+		throw ValueError("Truncated binary pedigree file " + m_filename);
+	m_ptr = &m_records[0];
+	m_nextRecord = 0;
+	return true;
+}
+
+
+bool PedigreeRecordReader::readBinary(size_t & myID, IndInfo & info)
+{
+	while (m_nextRecord == m_numRecords)
+		if (!readChunk())
+			return false;
+
+	const char * p = m_ptr;
+	myID = readUInt(p, 8);
+	p += 8;
+	for (size_t i = 0; i < m_numParents; ++i, p += 8) {
+		size_t id = readUInt(p, 8);
+		if (id)
+			info.parents.push_back(id);
+	}
+	info.sex = (*p & 1) ? FEMALE : MALE;
+	info.affectionStatus = (*p & 2) != 0;
+	++p;
+	// fields that are not named are ignored
+	for (size_t i = 0; i < m_numFields; ++i, p += 8) {
+		if (i < m_numInfoFields) {
+			double value;
+			std::copy(p, p + 8, reinterpret_cast<char *>(&value));
+			info.fields.push_back(value);
 		}
+	}
+	info.genotype.resize(m_numAlleles);
+	for (size_t i = 0; i < m_numAlleles; ++i, p += m_alleleBytes)
+		info.genotype[i] = TO_ALLELE(readUInt(p, m_alleleBytes));
+	m_ptr = p;
+	++m_nextRecord;
+	return true;
+}
+
+
+Pedigree loadPedigree(const string & file, const string & idField, const string & fatherField,
+                      const string & motherField, float ploidy, const uintList & _lociList, const uintList & chromTypes,
+                      const floatList & lociPos, const stringList & chromNames, const stringMatrix & alleleNames,
+                      const stringList & lociNames, const stringList & subPopNames, const stringList & fieldList)
+{
+	initClock();
+	int pldy = ploidy == HAPLODIPLOID ? 2 : static_cast<int>(ploidy);
+	//
+	const vectorstr & infoFields = fieldList.elems();
+
+	for (size_t i = 0; i < infoFields.size(); ++i) {
+		DBG_FAILIF(infoFields[i] == idField || infoFields[i] == fatherField || infoFields[i] == motherField,
+			ValueError, "Parameter infoFields can only specify additional fields other than idField, fatherField and motherField.");
+	}
+	vectoru loci = _lociList.elems();
+	size_t genoCols = accumulate(loci.begin(), loci.end(), size_t(0)) * pldy;
+
+	size_t max_parents = 0;
+	// individual and their parents
+	IndInfoMap individuals;
+	PedigreeRecordReader reader(file, infoFields.size());
+	size_t myID = 0;
+	IndInfo rec;
+	while (reader.read(myID, rec)) {
+		IndInfo * info = addIndInfo(individuals, myID);
+		for (size_t i = 0; i < rec.parents.size(); ++i)
+			addParent(individuals, info, myID, rec.parents[i]);
+		info->sex = rec.sex;
+		info->affectionStatus = rec.affectionStatus;
+		info->fields.swap(rec.fields);
+		info->genotype.swap(rec.genotype);
+		checkGenotype(info, loci, genoCols, pldy);
 		//
 		if (max_parents < info->parents.size())
 			max_parents = info->parents.size();
 	}
-	input.close();
 	elapsedTime("Readfile");
 	DBG_DO(DBG_POPULATION, cerr << "Information about " << individuals.size() << " individuals are loaded." << endl);
 	// create the top most ancestral generation
@@ -1473,8 +1689,8 @@ Pedigree loadPedigree(const string & file, const string & idField, const string
 	//
 	typedef std::set<size_t> IdSet;
 	IdSet parents;
-	IdMap::iterator it = individuals.begin();
-	IdMap::iterator it_end = individuals.end();
+	IndInfoMap::iterator it = individuals.begin();
+	IndInfoMap::iterator it_end = individuals.end();
 	for (; it != it_end; ++it)
 		if (it->second->parents.empty())
 			parents.insert(it->first);
@@ -1508,7 +1724,7 @@ Pedigree loadPedigree(const string & file, const string & idField, const string
 		pit = parents.begin();
 		IdSet::iterator pit_end = parents.end();
 		for (; pit != pit_end; ++pit) {
-			const IdMap::const_iterator info = individuals.find(*pit);
+			const IndInfoMap::const_iterator info = individuals.find(*pit);
 			const vectoru & off = info->second->offspring;
 			for (size_t i = 0; i < off.size(); ++i)
 				offspring.insert(off[i]);
@@ -1557,4 +1773,127 @@ Pedigree loadPedigree(const string & file, const string & idField, const string
 }
 
 
+PedigreeReader::PedigreeReader(const string & file, const string & idField, const string & fatherField,
+                               const string & motherField, float ploidy, const uintList & loci, const uintList & chromTypes,
+                               const floatList & lociPos, const stringList & chromNames, const stringMatrix & alleleNames,
+                               const stringList & lociNames, const stringList & subPopNames, const stringList & infoFields,
+                               int ancGen)
+	: m_reader(NULL), m_idField(idField), m_fatherField(fatherField), m_motherField(motherField),
+	m_ploidy(ploidy), m_loci(loci.elems()), m_genoCols(0), m_chromTypes(chromTypes), m_lociPos(lociPos),
+	m_chromNames(chromNames), m_alleleNames(alleleNames), m_lociNames(lociNames),
+	m_subPopNames(subPopNames), m_infoFields(infoFields.elems()), m_ancGen(ancGen),
+	m_ped(NULL), m_gen(0)
+{
+	for (size_t i = 0; i < m_infoFields.size(); ++i) {
+		DBG_FAILIF(m_infoFields[i] == idField || m_infoFields[i] == fatherField || m_infoFields[i] == motherField,
+			ValueError, "Parameter infoFields can only specify additional fields other than idField, fatherField and motherField.");
+	}
+	DBG_FAILIF(ancGen < 0, ValueError, "A non-negative number of ancestral generations is required.");
+	int pldy = ploidy == HAPLODIPLOID ? 2 : static_cast<int>(ploidy);
+	m_genoCols = accumulate(m_loci.begin(), m_loci.end(), size_t(0)) * pldy;
+	m_reader = new PedigreeRecordReader(file, m_infoFields.size());
+}
+
+
+PedigreeReader::~PedigreeReader()
+{
+	delete m_reader;
+	delete m_ped;
+}
+
+
+Pedigree & PedigreeReader::next()
+{
+	int pldy = m_ploidy == HAPLODIPLOID ? 2 : static_cast<int>(m_ploidy);
+
+#if TR1_SUPPORT == 0
+	typedef std::map<size_t, size_t> IdIndexMap;
+#else
+	typedef std::tr1::unordered_map<size_t, size_t> IdIndexMap;
+#endif
+	// individuals in this generation
+	IdIndexMap IDs;
+	vectoru inds;
+	vector<IndInfo> infos;
+	size_t myID = 0;
+	IndInfo rec;
+
+	while (m_reader->read(myID, rec)) {
+		// an offspring of this generation starts the next generation
+		bool nextGen = false;
+		for (size_t i = 0; i < rec.parents.size() && !nextGen; ++i)
+			nextGen = IDs.find(rec.parents[i]) != IDs.end();
+		if (nextGen) {
+			m_reader->unread(myID, rec);
+			break;
+		}
+		if (IDs.find(myID) != IDs.end())
+			throw ValueError((boost::format("Duplicate individual ID %1%") % myID).str());
+		checkGenotype(&rec, m_loci, m_genoCols, pldy);
+		IDs[myID] = inds.size();
+		inds.push_back(myID);
+		infos.push_back(IndInfo());
+		IndInfo & info = infos.back();
+		info.sex = rec.sex;
+		info.affectionStatus = rec.affectionStatus;
+		info.parents.swap(rec.parents);
+		info.fields.swap(rec.fields);
+		info.genotype.swap(rec.genotype);
+	}
+	if (inds.empty())
+		throw StopIteration("");
+
+	// fields of existing pedigree, which might have been added by users
+	vectorstr fields;
+	if (m_ped != NULL)
+		fields = m_ped->infoFields();
+	else {
+		fields.push_back(m_idField);
+		if (!m_fatherField.empty())
+			fields.push_back(m_fatherField);
+		if (!m_motherField.empty())
+			fields.push_back(m_motherField);
+		fields.insert(fields.end(), m_infoFields.begin(), m_infoFields.end());
+	}
+	Population pop(vectoru(1, inds.size()), m_ploidy, m_loci, m_chromTypes.elems(), m_lociPos,
+	               0, m_chromNames, m_alleleNames, m_lociNames, m_subPopNames, fields);
+	size_t idIdx = pop.infoIdx(m_idField);
+	vectoru parentIdx;
+	if (!m_fatherField.empty())
+		parentIdx.push_back(pop.infoIdx(m_fatherField));
+	if (!m_motherField.empty())
+		parentIdx.push_back(pop.infoIdx(m_motherField));
+	vectoru fieldIdx(m_infoFields.size());
+	for (size_t i = 0; i < m_infoFields.size(); ++i)
+		fieldIdx[i] = pop.infoIdx(m_infoFields[i]);
+	// set individual info
+	RawIndIterator ind = pop.rawIndBegin();
+	for (size_t k = 0; k < inds.size(); ++k, ++ind) {
+		const IndInfo & info = infos[k];
+		ind->setInfo(static_cast<double>(inds[k]), idIdx);
+		for (size_t i = 0; i < info.parents.size() && i < parentIdx.size(); ++i)
+			ind->setInfo(static_cast<double>(info.parents[i]), parentIdx[i]);
+		ind->setSex(info.sex);
+		ind->setAffected(info.affectionStatus);
+		for (size_t i = 0; i < info.fields.size(); ++i)
+			ind->setInfo(info.fields[i], fieldIdx[i]);
+		if (info.genotype.empty())
+			continue;
+		for (size_t i = 0, j = 0; i < m_genoCols / pldy; ++i)
+			for (int p = 0; p < pldy; ++p, ++j)
+				ind->setAllele(info.genotype[j], i, p);
+	}
+	if (m_ped == NULL) {
+		m_ped = new Pedigree(pop, lociList(), pop.infoFields(), uintList(),
+			m_idField, m_fatherField, m_motherField, true);
+		m_ped->setAncestralDepth(m_ancGen);
+	} else {
+		m_ped->useAncestralGen(0);
+		m_ped->push(pop);
+	}
+	++m_gen;
+	return *m_ped;
+}
+
+
 }
@@ -33,6 +33,21 @@
 
 #include "boost_pch.hpp"
 
+// Binary pedigree files written by PedigreeTagger consist of chunks of
+// records, each starting with a header of
+//   "SPED", version (1 byte), number of parental IDs (1 byte), bytes per
+//   allele (1 byte), 0 (1 byte), number of information fields (4 bytes),
+//   number of alleles (4 bytes), number of records (4 bytes), 0 (4 bytes)
+// followed by records of
+//   ID (8 bytes), parental IDs (8 bytes each), sex and affection status
+//   (1 byte, bit 0 for FEMALE and bit 1 for affected), information fields
+//   (8 bytes each), alleles (bytes per allele each).
+// All integers are saved in little endian. Chunks are compressed in BGZF
+// blocks.
+#define PEDIGREE_BINARY_MAGIC "SPED"
+#define PEDIGREE_BINARY_VERSION 1
+#define PEDIGREE_BINARY_HEADER_SIZE 24
+
 
 namespace simuPOP {
 
@@ -97,7 +112,7 @@ public:
 		IdMap::iterator it = m_idMap.find(id);
 		if (it == m_idMap.end())
 			return 0;
-		return toID(it->second->info(m_fatherIdx));
+		return it->second->idInfo(m_fatherIdx);
 	}
 
 
@@ -110,7 +125,7 @@ public:
 		IdMap::iterator it = m_idMap.find(id);
 		if (it == m_idMap.end())
 			return 0;
-		return toID(it->second->info(m_motherIdx));
+		return it->second->idInfo(m_motherIdx);
 	}
 
 
@@ -434,6 +449,11 @@ private:
  *  \e chromTypes, \e lociPos, \e chromNames, \e alleleNames, \e lociNames
  *  could be used to specified the genotype structured of the loaded pedigree.
  *  Please refer to class \c Population for details about these parameters.
+ *
+ *  Files saved by operator \c PedigreeTagger in binary format are recognized
+ *  automatically. Because such files record the number of information fields
+ *  and alleles of each individual, information fields that are not named by
+ *  parameter \e infoFields are ignored instead of being treated as alleles.
  */
 Pedigree loadPedigree(const string & file,
 	const string & idField = "ind_id",
@@ -449,5 +469,112 @@ Pedigree loadPedigree(const string & file,
 	const stringList & subPopNames = vectorstr(),
 	const stringList & infoFields = vectorstr());
 
+
+class PedigreeRecordReader;
+
+/** A pedigree reader reads a pedigree file saved by operator \c PedigreeTagger
+ *  (in text or binary format) or function \c Pedigree.save generation by
+ *  generation, so that relatives of individuals in large multi-generational
+ *  pedigrees can be located without loading the whole pedigree. Each call
+ *  to its \c next() function (or each iteration of a \c for loop) reads
+ *  the next generation from the file and returns a \c Pedigree object with
+ *  this generation and at most \e ancGen of its ancestral generations, on
+ *  which functions such as \c locateRelatives and \c identifyAncestors can
+ *  be called. Because the same \c Pedigree object is updated by subsequent
+ *  calls, results of these functions should be processed or saved before
+ *  the next generation is read. Information fields added to the returned
+ *  pedigree (e.g. to store the results of \c locateRelatives) are kept for
+ *  subsequent generations.
+ *
+ *  Unlike function \c loadPedigree, this reader assumes that individuals
+ *  are saved in the order of generations, which is the case for files saved
+ *  by \c PedigreeTagger and \c Pedigree.save. An individual starts a new
+ *  generation if any of his or her parents is in the generation that is
+ *  being read, and parents that are not saved in the file or that belong
+ *  to generations that have been discarded are treated as missing. Other
+ *  parameters are interpreted as in function \c loadPedigree.
+ */
+class PedigreeReader
+{
+public:
+	/** Create a reader that reads pedigree from file \e file, keeping at most
+	 *  \e ancGen ancestral generations in memory.
+	 */
+	PedigreeReader(const string & file,
+		const string & idField = "ind_id",
+		const string & fatherField = "father_id",
+		const string & motherField = "mother_id",
+		float ploidy = 2,
+		const uintList & loci = vectoru(),
+		const uintList & chromTypes = vectoru(),
+		const floatList & lociPos = floatList(),
+		const stringList & chromNames = vectorstr(),
+		const stringMatrix & alleleNames = stringMatrix(),
+		const stringList & lociNames = vectorstr(),
+		const stringList & subPopNames = vectorstr(),
+		const stringList & infoFields = vectorstr(),
+		int ancGen = 1);
+
+	~PedigreeReader();
+
+	/// HIDDEN
+	PedigreeReader & __iter__()
+	{
+		return *this;
+	}
+
+
+	/** Read the next generation and return a pedigree with this generation
+	 *  and its ancestral generations. Raise a \c StopIteration exception if
+	 *  all generations have been read.
+	 */
+	Pedigree & next();
+
+	/// HIDDEN python 3.x uses __next__ instead of next.
+	Pedigree & __next__()
+	{
+		return next();
+	}
+
+
+	/// Return the number of generations that have been read.
+	size_t gen() const
+	{
+		return m_gen;
+	}
+
+
+private:
+	PedigreeReader(const PedigreeReader &);
+
+	PedigreeReader & operator=(const PedigreeReader &);
+
+	PedigreeRecordReader * m_reader;
+
+	const string m_idField;
+	const string m_fatherField;
+	const string m_motherField;
+
+	float m_ploidy;
+	vectoru m_loci;
+	/// number of alleles of each individual
+	size_t m_genoCols;
+	uintList m_chromTypes;
+	floatList m_lociPos;
+	stringList m_chromNames;
+	stringMatrix m_alleleNames;
+	stringList m_lociNames;
+	stringList m_subPopNames;
+	vectorstr m_infoFields;
+
+	int m_ancGen;
+
+	/// pedigree with generations in the window, NULL before the first
+	/// generation is read.
+	Pedigree * m_ped;
+
+	size_t m_gen;
+};
+
 }
 #endif
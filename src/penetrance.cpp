@@ -105,6 +105,30 @@ bool BasePenetrance::apply(Population & pop) const
 }
 
 
+bool BasePenetrance::initIndKernel(Population & pop, bool & parallel) const
+{
+	// ancestral generations are processed by apply()
+	if (!m_ancGens.unspecified())
+		return false;
+	if (infoSize() > 0)
+		m_infoIdx = pop.infoIdx(infoField(0));
+	if (!parallelizable())
+		parallel = false;
+	return true;
+}
+
+
+void BasePenetrance::applyIndKernel(Population & pop, RawIndIterator ind, int & /* err */) const
+{
+	double p = penet(&pop, ind);
+
+	if (infoSize() > 0)
+		ind->setInfo(p, m_infoIdx);
+
+	ind->setAffected(getRNG().randUniform() < p);
+}
+
+
 bool BasePenetrance::applyToIndividual(Individual * ind, Population * pop)
 {
 	double p = penet(pop, pop->rawIndBegin() + (ind - &*pop->rawIndBegin()));
@@ -83,7 +83,7 @@ public:
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = vectorstr())
 		: BaseOperator("", begin, end, step, at, reps, subPops, infoFields),
-		m_ancGens(ancGens)
+		m_ancGens(ancGens), m_infoIdx(0)
 	{
 	}
 
@@ -126,6 +126,12 @@ public:
 	virtual bool applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
 		Individual * dad = NULL, Individual * mom = NULL) const;
 
+	/// CPPONLY
+	bool initIndKernel(Population & pop, bool & parallel) const;
+
+	/// CPPONLY
+	void applyIndKernel(Population & pop, RawIndIterator ind, int & err) const;
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -137,6 +143,9 @@ public:
 private:
 	/// how to handle ancestral gen
 	const uintList m_ancGens;
+
+	/// index of the information field to save penetrance
+	mutable size_t m_infoIdx;
 };
 
 /** This penetrance operator assigns individual affection status using a
@@ -28,6 +28,7 @@
 
 // for file compression
 #include "boost_pch.hpp"
+#include "zlib.h"
 
 #if PY_VERSION_HEX >= 0x03000000
 #  define PyInt_FromLong(x) PyLong_FromLong(x)
@@ -36,6 +37,11 @@
 using std::max;
 using std::max_element;
 
+#if PY_VERSION_HEX >= 0x03030000
+// defined in customizedTypes.c which is included in simuPOP_wrap.cpp
+extern "C" PyObject * newinfobufferobject(double * buf, size_t rows, size_t cols);
+#endif
+
 namespace simuPOP {
 
 Population::Population(const uintList & size,
@@ -56,6 +62,12 @@ Population::Population(const uintList & size,
 	m_subPopNames(),
 	m_subPopIndex(size.elems().size() + 1),
 	m_vspSplitter(NULL),
+	m_vspCaching(false),
+	m_maleBits(),
+	m_affectedBits(),
+	m_flagBitsCount(InvalidValue),
+	m_flagBitsGen(0),
+	m_flagBitsSize(0),
 	m_genotype(0),
 #ifdef LINEAGE
 	m_lineage(0),
@@ -116,6 +128,12 @@ Population::Population(const Population & rhs) :
 	m_subPopNames(rhs.m_subPopNames),
 	m_subPopIndex(rhs.m_subPopIndex),
 	m_vspSplitter(NULL),
+	m_vspCaching(false),
+	m_maleBits(),
+	m_affectedBits(),
+	m_flagBitsCount(InvalidValue),
+	m_flagBitsGen(0),
+	m_flagBitsSize(0),
 	m_genotype(0),
 #ifdef LINEAGE
 	m_lineage(0),
@@ -313,6 +331,9 @@ void Population::setVirtualSplitter(BaseVspSplitter * vsp)
 		delete m_vspSplitter;
 
 	m_vspSplitter = vsp ? vsp->clone() : NULL;
+	// a cloned splitter should not carry members of VSPs of another population
+	if (m_vspSplitter)
+		m_vspSplitter->clearCache();
 }
 
 
@@ -324,14 +345,116 @@ size_t Population::numVirtualSubPop() const
 }
 
 
-void Population::activateVirtualSubPop(vspID subPop) const
+void Population::setVspCaching(bool caching)
+{
+	m_vspCaching = caching;
+	if (!caching && m_vspSplitter)
+		m_vspSplitter->clearCache();
+	if (!caching)
+		m_flagBitsCount = InvalidValue;
+}
+
+
+void Population::updateFlagBits(size_t subPop) const
+{
+	CHECKRANGESUBPOP(subPop);
+	// Python functions can change individuals at any time
+	bool caching = m_vspCaching && !inPythonCall();
+	if (caching && m_flagBitsCount == indModificationCount() && m_flagBitsGen == m_curAncestralGen
+	    && m_flagBitsSize == m_popSize)
+		return;
+
+	size_t numWords = (m_popSize + 63) / 64;
+	m_maleBits.resize(numWords);
+	m_affectedBits.resize(numWords);
+	// without caching, the bits are rebuilt for each call so only words
+	// of the requested subpopulation are rebuilt
+	ssize_t firstWord = caching ? 0 : static_cast<ssize_t>(m_subPopIndex[subPop] / 64);
+	ssize_t lastWord = caching ? static_cast<ssize_t>(numWords)
+	                   : static_cast<ssize_t>((m_subPopIndex[subPop + 1] + 63) / 64);
+	// each word is built from 64 consecutive individuals
+#pragma omp parallel for if(numThreads() > 1)
+	for (ssize_t w = firstWord; w < lastWord; ++w) {
+		uint64_t male = 0;
+		uint64_t affected = 0;
+		size_t begin = w * 64;
+		size_t end = std::min(begin + 64, m_popSize);
+		for (size_t i = begin; i < end; ++i) {
+			const Individual & ind = m_inds[i];
+			if (ind.sex() == MALE)
+				male |= static_cast<uint64_t>(1) << (i - begin);
+			if (ind.affected())
+				affected |= static_cast<uint64_t>(1) << (i - begin);
+		}
+		m_maleBits[w] = male;
+		m_affectedBits[w] = affected;
+	}
+	m_flagBitsCount = caching ? indModificationCount() : InvalidValue;
+	m_flagBitsGen = m_curAncestralGen;
+	m_flagBitsSize = m_popSize;
+}
+
+
+static size_t popCount(uint64_t word)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(word);
+#else
+	size_t count = 0;
+	for (; word; ++count)
+		word &= word - 1;
+	return count;
+#endif
+}
+
+
+size_t Population::countBits(const vector<uint64_t> & bits, size_t begin, size_t end)
+{
+	if (begin >= end)
+		return 0;
+	size_t first = begin / 64;
+	size_t last = (end - 1) / 64;
+	// bits before begin and after end are masked out
+	uint64_t firstMask = ~static_cast<uint64_t>(0) << (begin % 64);
+	uint64_t lastMask = ~static_cast<uint64_t>(0) >> (63 - (end - 1) % 64);
+	if (first == last)
+		return popCount(bits[first] & firstMask & lastMask);
+	size_t count = popCount(bits[first] & firstMask) + popCount(bits[last] & lastMask);
+	for (size_t w = first + 1; w < last; ++w)
+		count += popCount(bits[w]);
+	return count;
+}
+
+
+const vectoru * Population::cachedVspIndexes(size_t subPop, size_t virtualSubPop) const
+{
+	// Python functions can change individuals at any time
+	if (!m_vspCaching || inPythonCall())
+		return NULL;
+	return m_vspSplitter->cachedIndexes(subPop, virtualSubPop);
+}
+
+
+void Population::activateVirtualSubPop(vspID subPop, bool readOnly) const
 {
 	CHECKRANGESUBPOP(subPop.subPop());
 	if (!subPop.isVirtual())
 		return;
 	DBG_ASSERT(hasVirtualSubPop(), ValueError, "population has no virtual subpopulations");
-	m_vspSplitter->activate(*this, subPop.subPop(), subPop.virtualSubPop());
-	DBG_ASSERT(m_vspSplitter->activatedSubPop() == subPop.subPop(), SystemError,
+	size_t sp = subPop.subPop();
+	size_t vsp = subPop.virtualSubPop();
+	const vectoru * indexes = cachedVspIndexes(sp, vsp);
+	if (indexes)
+		m_vspSplitter->activateIndexes(*this, sp, *indexes);
+	else {
+		m_vspSplitter->activate(*this, sp, vsp);
+		if (readOnly && m_vspCaching && !inPythonCall())
+			m_vspSplitter->cacheIndexes(*this, sp, vsp);
+	}
+	// individuals in the VSP might be changed by the caller
+	if (!readOnly)
+		markIndModified();
+	DBG_ASSERT(m_vspSplitter->activatedSubPop() == sp, SystemError,
 		"Failed to activate virtual subpopulation");
 }
 
@@ -410,12 +533,12 @@ Individual & Population::indByID(double fid, const uintList & ancGens, const str
 		size_t startID = (*inds)[0].intInfo(idx);
 		if (idx >= startID && startID + (*inds).size() > id) {
 			Individual & ind = (*inds)[id - startID];
-			if (toID(ind.intInfo(idx)) == id)
+			if (ind.idInfo(idx) == id)
 				return ind;
 		}
 		// now we have to search all individuals
 		for (size_t i = 0; i < (*inds).size(); ++i) {
-			if (toID((*inds)[i].intInfo(idx)) == id)
+			if ((*inds)[i].idInfo(idx) == id)
 				return (*inds)[i];
 		}
 	}
@@ -742,28 +865,53 @@ pyMutantIterator Population::mutants(vspID subPopID)
 }
 
 
-void Population::setGenotype(const uintList & genoList, vspID subPopID)
+// fill n alleles from ptr with geno, which is reused if it is shorter than n.
+static void fillAlleles(GenoIterator ptr, size_t n, const vectoru & geno)
+{
+	size_t sz = geno.size();
+
+#if defined(BINARYALLELE) || defined(MUTANTALLELE)
+	for (size_t i = 0; i < n; ++i, ++ptr)
+		REF_ASSIGN_ALLELE(ptr, TO_ALLELE(geno[i % sz]));
+#else
+	if (sz >= n) {
+#  pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = 0; i < static_cast<ssize_t>(n); ++i)
+			*(ptr + i) = TO_ALLELE(geno[i]);
+	} else {
+#  pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = 0; i < static_cast<ssize_t>(n); ++i)
+			*(ptr + i) = TO_ALLELE(geno[i % sz]);
+	}
+#endif
+}
+
+
+void Population::setGenotype(const uintList & genoList, vspID subPopID, const lociList & lociList)
 {
 	const vectoru & geno = genoList.elems();
 
+	DBG_FAILIF(geno.empty(), ValueError, "No genotype is specified.");
+
 	vspID subPop = subPopID.resolve(*this);
 
 #ifdef MUTANTALLELE
 	// a special case: clear genotype for every one. This is
 	// useful for mutant modules
-	if (!subPop.valid() && geno.size() == 1 && geno[0] == 0) {
+	if (!subPop.valid() && lociList.allAvail() && geno.size() == 1 && geno[0] == 0) {
 		m_genotype.clear();
 		return;
 	}
 #endif
 
+	if (!lociList.allAvail()) {
+		setGenotypeAtLoci(geno, subPop, lociList.elems(this));
+		return;
+	}
+
 	syncIndPointers();
 	if (!subPop.valid()) {
-		GenoIterator ptr = m_genotype.begin();
-		size_t sz = geno.size();
-		for (size_t i = 0; i < popSize() * genoSize(); ++i, ++ptr) {
-			REF_ASSIGN_ALLELE(ptr, TO_ALLELE(geno[i % sz]));
-		}
+		fillAlleles(m_genotype.begin(), popSize() * genoSize(), geno);
 		return;
 	}
 
@@ -775,9 +923,7 @@ void Population::setGenotype(const uintList & genoList, vspID subPopID)
 
 	size_t sz = geno.size();
 	if (!subPop.isVirtual()) {
-		GenoIterator ptr = genoBegin(sp, true);
-		for (size_t i = 0; i < subPopSize(sp) * genoSize(); ++i, ++ptr)
-			REF_ASSIGN_ALLELE(ptr, TO_ALLELE(geno[i % sz]));
+		fillAlleles(genoBegin(sp, true), subPopSize(sp) * genoSize(), geno);
 	} else {
 		activateVirtualSubPop(subPop);
 		IndIterator it = indIterator(sp);
@@ -790,6 +936,55 @@ void Population::setGenotype(const uintList & genoList, vspID subPopID)
 }
 
 
+void Population::setGenotypeAtLoci(const vectoru & geno, vspID subPop, const vectoru & loci)
+{
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+
+	for (size_t j = 0; j < loci.size(); ++j) {
+		CHECKRANGEABSLOCUS(loci[j]);
+	}
+	if (loci.empty())
+		return;
+
+	size_t sz = geno.size();
+	size_t pld = ploidy();
+	size_t nLoci = loci.size();
+	if (subPop.valid() && subPop.isVirtual()) {
+		CHECKRANGESUBPOP(subPop.subPop());
+		activateVirtualSubPop(subPop);
+		IndIterator it = indIterator(subPop.subPop());
+		size_t i = 0;
+		for (; it.valid(); ++it)
+			for (size_t p = 0; p < pld; ++p) {
+				GenoIterator ptr = it->genoBegin(p);
+				for (size_t j = 0; j < nLoci; ++j, ++i)
+					REF_ASSIGN_ALLELE(ptr + loci[j], TO_ALLELE(geno[i % sz]));
+			}
+		deactivateVirtualSubPop(subPop.subPop());
+		return;
+	}
+
+	if (subPop.valid()) {
+		CHECKRANGESUBPOP(subPop.subPop());
+	}
+	RawIndIterator begin = subPop.valid() ? rawIndBegin(subPop.subPop()) : rawIndBegin();
+	size_t nInds = subPop.valid() ? subPopSize(subPop.subPop()) : popSize();
+	// individuals are filled in parallel, each from its own part of geno
+#if !defined(BINARYALLELE) && !defined(MUTANTALLELE)
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+	for (ssize_t k = 0; k < static_cast<ssize_t>(nInds); ++k) {
+		size_t i = k * pld * nLoci;
+		for (size_t p = 0; p < pld; ++p) {
+			GenoIterator ptr = (begin + k)->genoBegin(p);
+			for (size_t j = 0; j < nLoci; ++j, ++i)
+				REF_ASSIGN_ALLELE(ptr + loci[j], TO_ALLELE(geno[i % sz]));
+		}
+	}
+}
+
+
 void Population::setLineage(const uintList & lineageList, vspID subPopID)
 {
 #ifdef LINEAGE
@@ -798,11 +993,12 @@ void Population::setLineage(const uintList & lineageList, vspID subPopID)
 	vspID subPop = subPopID.resolve(*this);
 
 	syncIndPointers();
+	size_t sz = lineage.size();
 	if (!subPop.valid()) {
 		LineageIterator ptr = m_lineage.begin();
-		size_t sz = lineage.size();
-		for (size_t i = 0; i < popSize() * genoSize(); ++i)
-			*(ptr++) = static_cast<long>(lineage[i % sz]);
+#  pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = 0; i < static_cast<ssize_t>(popSize() * genoSize()); ++i)
+			*(ptr + i) = static_cast<long>(lineage[i % sz]);
 		return;
 	}
 
@@ -812,11 +1008,11 @@ void Population::setLineage(const uintList & lineageList, vspID subPopID)
 	size_t sp = subPop.subPop();
 	CHECKRANGESUBPOP(sp);
 
-	size_t sz = lineage.size();
 	if (!subPop.isVirtual()) {
 		LineageIterator ptr = lineageBegin(sp, true);
-		for (size_t i = 0; i < subPopSize(sp) * genoSize(); ++i)
-			*(ptr++) = static_cast<long>(lineage[i % sz]);
+#  pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = 0; i < static_cast<ssize_t>(subPopSize(sp) * genoSize()); ++i)
+			*(ptr + i) = static_cast<long>(lineage[i % sz]);
 	} else {
 		activateVirtualSubPop(subPop);
 		IndIterator it = indIterator(sp);
@@ -978,6 +1174,8 @@ void Population::setSubPopStru(const vectoru & newSubPopSizes,
 	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
+	markIndModified();
+
 	DBG_ASSERT(accumulate(newSubPopSizes.begin(), newSubPopSizes.end(), size_t(0)) == m_popSize, ValueError,
 		"Overall population size should not be changed in setSubPopStru.");
 
@@ -1011,9 +1209,11 @@ size_t Population::subPopSize(vspID subPopID, int ancGen) const
 	if (ancGen < 0 || ancGen == m_curAncestralGen) {
 		CHECKRANGESUBPOP(subPop.subPop());
 		CHECKRANGEVIRTUALSUBPOP(subPop.virtualSubPop());
-		if (subPop.isVirtual())
-			return m_vspSplitter->size(*this, subPop.subPop(), subPop.virtualSubPop());
-		else
+		if (subPop.isVirtual()) {
+			const vectoru * indexes = cachedVspIndexes(subPop.subPop(), subPop.virtualSubPop());
+			return indexes ? indexes->size()
+			       : m_vspSplitter->size(*this, subPop.subPop(), subPop.virtualSubPop());
+		} else
 			return m_subPopSize[subPop.subPop()];
 	} else if (subPop.isVirtual()) {
 		int curGen = m_curAncestralGen;
@@ -1035,17 +1235,137 @@ size_t Population::subPopSize(vspID subPopID, int ancGen) const
 }
 
 
+// map the value of an information field to an unsigned integer with the same
+// order, namely the bits of a double with the sign bit flipped, or all bits
+// flipped for negative numbers, and the two's complement of an integer with
+// the sign bit flipped.
+static uint64_t radixKey(const double & slot, bool intField, bool reverse)
+{
+	const uint64_t signBit = static_cast<uint64_t>(1) << 63;
+	uint64_t key = 0;
+
+	if (intField)
+		key = static_cast<uint64_t>(Individual::int64Info(slot)) ^ signBit;
+	else {
+		// +0 and -0 are equal
+		double value = slot == 0 ? 0. : slot;
+		memcpy(&key, &value, sizeof(double));
+		key = (key & signBit) ? ~key : (key ^ signBit);
+	}
+	return reverse ? ~key : key;
+}
+
+
+// sort individuals between start and start + n by their keys at fields, using
+// a stable least significant digit radix sort of (key, index) pairs. The
+// returned vector lists the original indexes of individuals in sorted order.
+static vectoru radixSortIndexes(RawIndIterator start, size_t n,
+                                const vectoru & fields, const vector<bool> & intFields, bool reverse)
+{
+	vectoru order(n);
+	vectoru newOrder(n);
+	vector<uint64_t> keys(n);
+	vector<uint64_t> newKeys(n);
+
+	for (size_t i = 0; i < n; ++i)
+		order[i] = i;
+
+#if !defined(BINARYALLELE) && !defined(MUTANTALLELE)
+	ssize_t numBlocks = numThreads() > 1 && n > 10000 ? numThreads() : 1;
+#else
+	ssize_t numBlocks = 1;
+#endif
+	size_t blockSize = n / numBlocks + (n % numBlocks != 0);
+	// counts[b][d]: number of keys in block b with digit d at the current pass
+	vector<vectoru> counts(numBlocks, vectoru(256));
+
+	// the last field is sorted first so that the first field is the primary key
+	for (size_t f = fields.size(); f > 0; --f) {
+		size_t fld = fields[f - 1];
+		bool intField = intFields[f - 1];
+		ssize_t numInds = static_cast<ssize_t>(n);
+#pragma omp parallel for if(numBlocks > 1)
+		for (ssize_t i = 0; i < numInds; ++i)
+			keys[i] = radixKey((start + order[i])->infoPtr()[fld], intField, reverse);
+
+		for (size_t shift = 0; shift < 64; shift += 8) {
+#pragma omp parallel for if(numBlocks > 1)
+			for (ssize_t b = 0; b < numBlocks; ++b) {
+				vectoru & cnt = counts[b];
+				std::fill(cnt.begin(), cnt.end(), 0);
+				for (size_t i = b * blockSize; i < std::min((b + 1) * blockSize, n); ++i)
+					++cnt[(keys[i] >> shift) & 0xFF];
+			}
+			// skip digits that are shared by all keys, which is common for
+			// small integers such as age
+			bool sameDigit = false;
+			for (size_t d = 0; d < 256; ++d) {
+				size_t total = 0;
+				for (ssize_t b = 0; b < numBlocks; ++b)
+					total += counts[b][d];
+				if (total == n) {
+					sameDigit = true;
+					break;
+				} else if (total != 0)
+					break;
+			}
+			if (sameDigit)
+				continue;
+			// turn counts into the first destination of each digit in each block
+			size_t pos = 0;
+			for (size_t d = 0; d < 256; ++d)
+				for (ssize_t b = 0; b < numBlocks; ++b) {
+					size_t cnt = counts[b][d];
+					counts[b][d] = pos;
+					pos += cnt;
+				}
+#pragma omp parallel for if(numBlocks > 1)
+			for (ssize_t b = 0; b < numBlocks; ++b) {
+				vectoru & dest = counts[b];
+				for (size_t i = b * blockSize; i < std::min((b + 1) * blockSize, n); ++i) {
+					size_t j = dest[(keys[i] >> shift) & 0xFF]++;
+					newKeys[j] = keys[i];
+					newOrder[j] = order[i];
+				}
+			}
+			keys.swap(newKeys);
+			order.swap(newOrder);
+		}
+	}
+	return order;
+}
+
+
 void Population::sortIndividuals(const stringList & infoList, bool reverse)
 {
 	const vectorstr & infoFields = infoList.elems();
 
 	if (infoFields.size() == 0)
 		return;
+	markIndModified();
 	vectoru fields(infoFields.size());
-	for (size_t i = 0; i < infoFields.size(); ++i)
+	vector<bool> intFields(infoFields.size());
+	for (size_t i = 0; i < infoFields.size(); ++i) {
 		fields[i] = infoIdx(infoFields[i]);
-	for (size_t sp = 0; sp < numSubPop(); ++sp)
-		parallelSort(rawIndBegin(sp), rawIndEnd(sp), indCompare(fields, reverse));
+		intFields[i] = isIntInfoField(fields[i]);
+	}
+	for (size_t sp = 0; sp < numSubPop(); ++sp) {
+		size_t spSize = subPopSize(sp);
+		// comparison sort is faster for small subpopulations
+		if (spSize < 1000) {
+			parallelSort(rawIndBegin(sp), rawIndEnd(sp), indCompare(fields, reverse));
+			continue;
+		}
+		vectoru order = radixSortIndexes(rawIndBegin(sp), spSize, fields, intFields, reverse);
+		// individuals only hold pointers to their genotypes and information
+		// fields, which are rearranged later by syncIndPointers
+		vector<Individual> sorted;
+		sorted.reserve(spSize);
+		RawIndIterator it = rawIndBegin(sp);
+		for (size_t i = 0; i < spSize; ++i)
+			sorted.push_back(*(it + order[i]));
+		std::copy(sorted.begin(), sorted.end(), it);
+	}
 	setIndOrdered(false);
 }
 
@@ -1056,84 +1376,104 @@ void Population::setSubPopByIndInfo(const string & field)
 		"This operation is not allowed when there is an activated virtual subpopulation");
 
 	size_t info = infoIdx(field);
-	DBG_DO(DBG_POPULATION, cerr << "Sorting individuals." << endl);
-	// sort individuals first
-	parallelSort(rawIndBegin(), rawIndEnd(), indCompare(info));
-	setIndOrdered(false);
+	DBG_DO(DBG_POPULATION, cerr << "Rearranging individuals." << endl);
+	markIndModified();
+
+	// Individuals are moved to their new subpopulations with a counting sort.
+	// The population is divided into blocks, and the number of individuals
+	// in each block that belong to each subpopulation determines where
+	// individuals in the block are copied to, so that blocks can be copied
+	// in parallel and the order of individuals in a subpopulation is kept.
+#if !defined(BINARYALLELE) && !defined(MUTANTALLELE)
+	ssize_t numBlocks = numThreads() > 1 && m_popSize > 1000 ? numThreads() : 1;
+#else
+	ssize_t numBlocks = 1;
+#endif
+	size_t blockSize = m_popSize / numBlocks + (m_popSize % numBlocks != 0);
+	// counts[b][sp]: number of individuals in block b that belong to subpopulation sp
+	vector<vectoru> counts(numBlocks);
+
+#pragma omp parallel for if(numBlocks > 1)
+	for (ssize_t b = 0; b < numBlocks; ++b) {
+		vectoru & cnt = counts[b];
+		for (size_t i = b * blockSize; i < std::min((b + 1) * blockSize, m_popSize); ++i) {
+			double sp = m_inds[i].info(info);
+			// individuals with negative values are removed
+			if (sp < 0)
+				continue;
+			if (static_cast<size_t>(sp) >= cnt.size())
+				cnt.resize(static_cast<size_t>(sp) + 1, 0);
+			++cnt[static_cast<size_t>(sp)];
+		}
+	}
 
-	// sort individuals first
-	// remove individuals with negative index.
-	if (indIterator()->info(info) < 0) {
-		// popsize etc will be changed.
-		size_t newPopSize = m_popSize;
-		IndIterator it = indIterator();
-		for (; it.valid(); ++it) {
-			if (it->info(info) < 0)
-				newPopSize-- ;
-			else
-				break;
+	size_t newNumSubPop = 1;
+	for (ssize_t b = 0; b < numBlocks; ++b)
+		newNumSubPop = std::max(newNumSubPop, counts[b].size());
+	// new subpopulation sizes, and the first destination of each block in
+	// each subpopulation
+	vectoru newSubPopSize(newNumSubPop, 0);
+	for (ssize_t b = 0; b < numBlocks; ++b) {
+		counts[b].resize(newNumSubPop, 0);
+		for (size_t sp = 0; sp < newNumSubPop; ++sp) {
+			size_t cnt = counts[b][sp];
+			counts[b][sp] = newSubPopSize[sp];
+			newSubPopSize[sp] += cnt;
 		}
-		// 'it' now point to the one with positive info(info)
+	}
+	size_t newPopSize = 0;
+	for (size_t sp = 0; sp < newNumSubPop; ++sp) {
+		for (ssize_t b = 0; b < numBlocks; ++b)
+			counts[b][sp] += newPopSize;
+		newPopSize += newSubPopSize[sp];
+	}
 
-		DBG_DO(DBG_POPULATION, cerr << "New pop size" << newPopSize << endl);
+	DBG_DO(DBG_POPULATION, cerr << "New pop size" << newPopSize << endl);
 
-		// allocate new genotype and inds
+	// allocate new genotype and inds
 #ifdef MUTANTALLELE
-		vectorm newGenotype(genoSize() * newPopSize);
+	vectorm newGenotype(genoSize() * newPopSize);
 #else
-		vectora newGenotype(genoSize() * newPopSize);
+	vectora newGenotype(genoSize() * newPopSize);
 #endif
-		LINEAGE_EXPR(vectori newLineage(genoSize() * newPopSize));
-		vectorf newInfo(newPopSize * infoSize());
-		vector<Individual> newInds(newPopSize);
+	LINEAGE_EXPR(vectori newLineage(genoSize() * newPopSize));
+	vectorf newInfo(newPopSize * infoSize());
+	vector<Individual> newInds(newPopSize);
 
-		// assign genotype location and set structure information for individuals
-		InfoIterator infoPtr = newInfo.begin();
-		size_t step = genoSize();
-		size_t infoStep = infoSize();
-		GenoIterator ptr = newGenotype.begin();
-#ifdef LINEAGE
-		LineageIterator lineagePtr = newLineage.begin();
-		for (size_t i = 0; i < newPopSize; ++i, ptr += step, ++it, lineagePtr += step, infoPtr += infoStep) {
-			newInds[i].setLineagePtr(lineagePtr);
-#else
-		for (size_t i = 0; i < newPopSize; ++i, ptr += step, ++it, infoPtr += infoStep) {
-#endif
-			newInds[i].setGenoStruIdx(genoStruIdx());
-			newInds[i].setGenoPtr(ptr);
-			newInds[i].setInfoPtr(infoPtr);
-			newInds[i].copyFrom(*it);                         // copy everything, with info value
+	size_t step = genoSize();
+	size_t infoStep = infoSize();
+#pragma omp parallel for if(numBlocks > 1)
+	for (ssize_t b = 0; b < numBlocks; ++b) {
+		vectoru & dest = counts[b];
+		for (size_t i = b * blockSize; i < std::min((b + 1) * blockSize, m_popSize); ++i) {
+			double sp = m_inds[i].info(info);
+			if (sp < 0)
+				continue;
+			size_t d = dest[static_cast<size_t>(sp)]++;
+			// assign genotype location and set structure information for individuals
+			newInds[d].setGenoStruIdx(genoStruIdx());
+			newInds[d].setGenoPtr(newGenotype.begin() + d * step);
+			newInds[d].setInfoPtr(newInfo.begin() + d * infoStep);
+			LINEAGE_EXPR(newInds[d].setLineagePtr(newLineage.begin() + d * step));
+			newInds[d].copyFrom(m_inds[i]);                         // copy everything, with info value
 		}
-		// now, switch!
-		m_genotype.swap(newGenotype);
-		m_info.swap(newInfo);
-		m_inds.swap(newInds);
-		LINEAGE_EXPR(m_lineage.swap(newLineage));
-		m_popSize = newPopSize;
-		setIndOrdered(true);
+	}
+	// now, switch!
+	m_genotype.swap(newGenotype);
+	m_info.swap(newInfo);
+	m_inds.swap(newInds);
+	LINEAGE_EXPR(m_lineage.swap(newLineage));
+	m_popSize = newPopSize;
+	setIndOrdered(true);
 #ifdef MUTANTALLELE
-		// vectorm must be setGenoPtr after swap
-		ptr = m_genotype.begin();
-		for (size_t i = 0; i < m_popSize; ++i, ptr += genoSize())
-			m_inds[i].setGenoPtr(ptr);
-
+	// vectorm must be setGenoPtr after swap
+	GenoIterator ptr = m_genotype.begin();
+	for (size_t i = 0; i < m_popSize; ++i, ptr += genoSize())
+		m_inds[i].setGenoPtr(ptr);
 #endif
-	}
 
-	if (m_inds.empty()) {
-		m_subPopSize.resize(1, 0);
-		m_subPopIndex.resize(2);
-	} else {
-		// reset indexes etc.
-		size_t numSubPop = static_cast<size_t>(m_inds.back().info(info)) + 1;
-		m_subPopSize.resize(numSubPop);
-		m_subPopIndex.resize(numSubPop + 1);
-
-		// check subpop size
-		fill(m_subPopSize.begin(), m_subPopSize.end(), 0);
-		for (IndIterator it = indIterator(); it.valid(); ++it)
-			m_subPopSize[ static_cast<size_t>(it->info(info)) ]++;
-	}
+	m_subPopSize.swap(newSubPopSize);
+	m_subPopIndex.resize(newNumSubPop + 1);
 	// rebuild index
 	size_t i = 1;
 	for (m_subPopIndex[0] = 0; i <= numSubPop(); ++i)
@@ -1141,6 +1481,7 @@ void Population::setSubPopByIndInfo(const string & field)
 	// subpopulation names
 	if (!m_subPopNames.empty())
 		m_subPopNames.resize(numSubPop(), UnnamedSubPop);
+	elapsedTime("Rearranged individuals by information field " + field);
 }
 
 
@@ -1460,7 +1801,7 @@ void Population::removeIndividuals(const uintList & indexList, const floatList &
 			RawIndIterator it = rawIndBegin();
 			RawIndIterator itEnd = rawIndEnd();
 			for (; it != itEnd; ++it) {
-				size_t id = toID(it->info(fieldIdx));
+				size_t id = it->idInfo(fieldIdx);
 				if (idMap.find(id) != idMap.end())
 					it->setMarked(true);
 			}
@@ -2419,7 +2760,7 @@ Population & Population::extractIndividuals(const uintList & indexList,
 			ConstRawIndIterator it = rawIndBegin();
 			ConstRawIndIterator itEnd = rawIndEnd();
 			for (; it != itEnd; ++it) {
-				size_t id = toID(it->info(fieldIdx));
+				size_t id = it->idInfo(fieldIdx);
 				if (idMap.find(id) != idMap.end())
 					it->setMarked(true);
 			}
@@ -2505,7 +2846,7 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 	} else if (!removeLoci) {
 		// only change information fields
 		pop.setGenoStructure(ploidy(), numLoci(), chromTypes(), isHaplodiploid(),
-			lociPos(), chromNames(), allAlleleNames(), lociNames(), keptInfoFields);
+			lociPos(), chromNames(), allAlleleNames(), lociNames(), keptInfoFields, intInfoFields());
 	} else {
 		// figure out number of loci.
 		vectoru new_numLoci;
@@ -2549,7 +2890,7 @@ Population & Population::extract(const lociList & extractedLoci, const stringLis
 			                        << "\ninfoFields: " << keptInfoFields
 			                        << endl);
 		pop.setGenoStructure(ploidy(), new_numLoci, new_chromTypes, isHaplodiploid(),
-			new_lociPos, new_chromNames, new_alleleNames, new_lociNames, keptInfoFields);
+			new_lociPos, new_chromNames, new_alleleNames, new_lociNames, keptInfoFields, intInfoFields());
 	}
 	size_t step = pop.genoSize();
 	size_t infoStep = pop.infoSize();
@@ -3012,6 +3353,7 @@ void Population::recodeAlleles(const uintListFunc & newAlleles, const lociList &
 
 void Population::push(Population & rhs)
 {
+	markIndModified();
 	if (rhs.genoStruIdx() != genoStruIdx()) {
 		if (m_ancestralGens > 0)
 			throw ValueError("Cannot save a population with different structure as an ancestral population to the existing population");
@@ -3082,8 +3424,19 @@ vectorf Population::indInfo(const uintString & field, vspID subPopID)
 		"This operation is not allowed when there is an activated virtual subpopulation");
 	vspID subPop = subPopID.resolve(*this);
 	size_t idx = field.empty() ? field.value() : infoIdx(field.name());
+	if (isIntInfoField(idx)) {
+		// values of integer fields have to be converted one by one
+		vectorf ret;
+		if (subPop.valid())
+			activateVirtualSubPop(subPop, true);
+		for (IndIterator ind = subPop.valid() ? indIterator(subPop.subPop()) : indIterator(); ind.valid(); ++ind)
+			ret.push_back(ind->info(idx));
+		if (subPop.valid())
+			deactivateVirtualSubPop(subPop.subPop());
+		return ret;
+	}
 	if (subPop.valid()) {
-		activateVirtualSubPop(subPop);
+		activateVirtualSubPop(subPop, true);
 		vectorf ret(infoBegin(idx, subPop), infoEnd(idx, subPop));
 		deactivateVirtualSubPop(subPop.subPop());
 		return ret;
@@ -3092,38 +3445,89 @@ vectorf Population::indInfo(const uintString & field, vspID subPopID)
 }
 
 
-void Population::addInfoFields(const stringList & fieldList, double init)
+PyObject * Population::infoArray(vspID subPopID)
+{
+	vspID vsp = subPopID.resolve(*this);
+
+	DBG_FAILIF(vsp.isVirtual(), ValueError,
+		"Function infoArray currently does not support virtual subpopulation");
+	DBG_FAILIF(hasActivatedVirtualSubPop(), ValueError,
+		"This operation is not allowed when there is an activated virtual subpopulation");
+	PARAM_FAILIF(hasIntInfoFields(), ValueError,
+		"Function infoArray does not support information fields of type INFO_INT64");
+
+#if PY_VERSION_HEX < 0x03030000
+	throw RuntimeError("Function infoArray requires Python 3.3 or later.");
+#else
+	// make sure that information fields are stored in the order of individuals
+	syncIndPointers(true);
+	size_t begin = 0;
+	size_t end = popSize();
+	if (vsp.valid()) {
+		size_t subPop = vsp.subPop();
+		CHECKRANGESUBPOP(subPop);
+		begin = subPopBegin(subPop);
+		end = subPopEnd(subPop);
+	}
+	size_t is = infoSize();
+	// a valid address is needed even if there is no information field
+	static double empty = 0;
+	// the view refers to an exporter object, which refers to the Python
+	// object of the population once it is set by the Python wrapper
+	PyObject * buffer = newinfobufferobject((end == begin || is == 0) ? &empty : &m_info[begin * is],
+		end - begin, is);
+	PyObject * res = buffer == NULL ? NULL : PyMemoryView_FromObject(buffer);
+	Py_XDECREF(buffer);
+	if (res == NULL) {
+		PyErr_Clear();
+		throw RuntimeError("Failed to create a view of information fields.");
+	}
+	return res;
+#endif
+}
+
+
+void Population::addInfoFields(const stringList & fieldList, double init, int type)
 {
 	const vectorstr & fields = fieldList.elems();
 
 	DBG_ASSERT(m_info.size() == infoSize() * popSize(), SystemError,
 		"Info size is wrong");
+	PARAM_FAILIF(type != INFO_FLOAT64 && type != INFO_INT64, ValueError,
+		"Information fields can only be of type INFO_FLOAT64 or INFO_INT64");
 
 	vectorstr newfields;
+	vectoru existingIdx;
+	bool typeChanged = false;
 
 	// oldsize, this is valid for rank 0
 	size_t os = infoSize();
 	for (vectorstr::const_iterator it = fields.begin(); it != fields.end(); ++it) {
 		try {
-			// has field
+			// has field, only needs to initialize
 			size_t idx = infoIdx(*it);
-			// only needs to initialize
-			int oldAncPop = m_curAncestralGen;
-			for (size_t anc = 0; anc <= m_ancestralPops.size(); anc++) {
-				useAncestralGen(anc);
-
-				for (IndIterator ind = indIterator(); ind.valid(); ++ind)
-					ind->setInfo(init, idx);
-			}
-			useAncestralGen(oldAncPop);
+			existingIdx.push_back(idx);
+			typeChanged = typeChanged || isIntInfoField(idx) != (type == INFO_INT64);
 		} catch (IndexError &) {
 			newfields.push_back(*it);
 		}
 	}
 
+	// existing fields keep their slots but might change their types
+	if (newfields.empty() && typeChanged) {
+		setGenoStructure(gsAddInfoFields(fields, type));
+		int oldAncPop = m_curAncestralGen;
+		for (size_t anc = 0; anc <= m_ancestralPops.size(); anc++) {
+			useAncestralGen(anc);
+			for (RawIndIterator ind = rawIndBegin(); ind != rawIndEnd(); ++ind)
+				ind->setGenoStruIdx(genoStruIdx());
+		}
+		useAncestralGen(oldAncPop);
+	}
+
 	// add these fields
 	if (!newfields.empty()) {
-		setGenoStructure(gsAddInfoFields(newfields));
+		setGenoStructure(gsAddInfoFields(fields, type));
 
 		// adjust information size.
 		size_t is = infoSize();
@@ -3131,19 +3535,36 @@ void Population::addInfoFields(const stringList & fieldList, double init)
 		for (size_t anc = 0; anc <= m_ancestralPops.size(); anc++) {
 			useAncestralGen(anc);
 			vectorf newInfo(is * popSize(), 0.);
-			// copy the old stuff in
-			InfoIterator ptr = newInfo.begin();
-			for (IndIterator ind = indIterator(); ind.valid(); ++ind) {
+			// copy the old stuff in, block by block
+			ssize_t numInds = static_cast<ssize_t>(popSize());
+			RawIndIterator inds = rawIndBegin();
+#pragma omp parallel for if(numThreads() > 1)
+			for (ssize_t j = 0; j < numInds; ++j) {
+				RawIndIterator ind = inds + j;
+				InfoIterator ptr = newInfo.begin() + j * is;
 				copy(ind->infoBegin(), ind->infoBegin() + os, ptr);
 				ind->setInfoPtr(ptr);
 				ind->setGenoStruIdx(genoStruIdx());
-				fill(ind->infoBegin() + os, ind->infoEnd(), init);
-				ptr += is;
+				for (size_t i = os; i < is; ++i)
+					ind->setInfo(init, i);
 			}
 			m_info.swap(newInfo);
 		}
 		useAncestralGen(oldAncPop);
 	}
+
+	// re-initialize existing fields after their types are set
+	if (!existingIdx.empty()) {
+		int oldAncPop = m_curAncestralGen;
+		for (size_t anc = 0; anc <= m_ancestralPops.size(); anc++) {
+			useAncestralGen(anc);
+
+			for (IndIterator ind = indIterator(); ind.valid(); ++ind)
+				for (size_t i = 0; i < existingIdx.size(); ++i)
+					ind->setInfo(init, existingIdx[i]);
+		}
+		useAncestralGen(oldAncPop);
+	}
 }
 
 
@@ -3162,6 +3583,10 @@ void Population::setInfoFields(const stringList & fieldList, double init)
 		for (IndIterator ind = indIterator(); ind.valid(); ++ind, ptr += is) {
 			ind->setInfoPtr(ptr);
 			ind->setGenoStruIdx(genoStruIdx());
+			// fields of type INFO_INT64 keep their types
+			for (size_t i = 0; i < is; ++i)
+				if (isIntInfoField(i))
+					ind->setInfo(init, i);
 		}
 		m_info.swap(newInfo);
 	}
@@ -3196,11 +3621,14 @@ void Population::removeInfoFields(const stringList & fieldList)
 	for (size_t anc = 0; anc <= m_ancestralPops.size(); anc++) {
 		useAncestralGen(anc);
 		vectorf newInfo(sz * popSize(), 0.);
-		// copy the old stuff in
-		InfoIterator ptr = newInfo.begin();
-
-		for (IndIterator ind = indIterator(); ind.valid(); ++ind) {
+		// copy the old stuff in, block by block
+		ssize_t numInds = static_cast<ssize_t>(popSize());
+		RawIndIterator inds = rawIndBegin();
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t j = 0; j < numInds; ++j) {
+			RawIndIterator ind = inds + j;
 			InfoIterator oldptr = ind->infoPtr();
+			InfoIterator ptr = newInfo.begin() + j * sz;
 			ind->setInfoPtr(ptr);
 			ind->setGenoStruIdx(genoStruIdx());
 			for (size_t i = 0; i < sz; ++i)
@@ -3257,16 +3685,27 @@ void Population::setIndInfo(const floatList & valueList, const uintString &
 	CHECKRANGEINFO(idx);
 	const vectorf & values = valueList.elems();
 	size_t valueSize = values.size();
-	if (subPop.valid()) {
+	DBG_FAILIF(valueSize == 0, ValueError, "No value is specified.");
+	if ((!subPop.valid() && !hasActivatedVirtualSubPop()) || (subPop.valid() && !subPop.isVirtual())) {
+		// set values of individuals in parallel
+		if (subPop.valid()) {
+			CHECKRANGESUBPOP(subPop.subPop());
+		}
+		RawIndIterator begin = subPop.valid() ? rawIndBegin(subPop.subPop()) : rawIndBegin();
+		size_t nInds = subPop.valid() ? subPopSize(subPop.subPop()) : popSize();
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t k = 0; k < static_cast<ssize_t>(nInds); ++k)
+			(begin + k)->setInfo(values[k % valueSize], idx);
+	} else if (subPop.valid()) {
 		activateVirtualSubPop(subPop);
-		IndInfoIterator ptr = infoBegin(idx, subPop);
-		for (size_t i = 0; ptr != infoEnd(idx, subPop); ++ptr, ++i)
-			*ptr = static_cast<double>(values[i % valueSize]);
+		IndIterator ind = indIterator(subPop.subPop());
+		for (size_t i = 0; ind.valid(); ++ind, ++i)
+			ind->setInfo(values[i % valueSize], idx);
 		deactivateVirtualSubPop(subPop.subPop());
 	} else {
-		IndInfoIterator ptr = infoBegin(idx);
-		for (size_t i = 0; ptr != infoEnd(idx); ++ptr, ++i)
-			*ptr = static_cast<double>(values[i % valueSize]);
+		IndIterator ind = indIterator();
+		for (size_t i = 0; ind.valid(); ++ind, ++i)
+			ind->setInfo(values[i % valueSize], idx);
 	}
 }
 
@@ -3361,6 +3800,9 @@ void Population::useAncestralGen(ssize_t idx)
 	if (idx == m_curAncestralGen)
 		return;
 
+	// the same VSP refers to different individuals now
+	markIndModified();
+
 	DBG_DO(DBG_POPULATION, cerr << "Use ancestral generation: " << idx <<
 		" Current ancestral index: " << m_curAncestralGen << endl);
 
@@ -3390,6 +3832,44 @@ void Population::useAncestralGen(ssize_t idx)
 }
 
 
+// Information fields of type INFO_INT64 keep the bit patterns of integers,
+// which are not valid floating point numbers for text archives, so their
+// values are archived separately after the other information fields.
+static void saveInfo(boost::archive::text_oarchive & ar, const vectorf & info,
+                     const vectoru & intIdx, size_t infoSize)
+{
+	vector<int64_t> values;
+
+	if (intIdx.empty()) {
+		ar & info;
+		ar & values;
+		return;
+	}
+	vectorf tmp(info);
+	for (size_t i = 0; i < tmp.size(); i += infoSize)
+		for (size_t j = 0; j < intIdx.size(); ++j) {
+			values.push_back(Individual::int64Info(tmp[i + intIdx[j]]));
+			tmp[i + intIdx[j]] = static_cast<double>(values.back());
+		}
+	ar & tmp;
+	ar & values;
+}
+
+
+static void restoreIntInfo(vectorf & info, const vector<int64_t> & values,
+                           const vectoru & intIdx, size_t infoSize)
+{
+	if (values.empty())
+		return;
+	DBG_FAILIF(intIdx.empty() || values.size() != info.size() / infoSize * intIdx.size(),
+		ValueError, "Wrong number of values of integer information fields");
+	vector<int64_t>::const_iterator it = values.begin();
+	for (size_t i = 0; i < info.size(); i += infoSize)
+		for (size_t j = 0; j < intIdx.size(); ++j)
+			Individual::setInt64Info(*it++, info[i + intIdx[j]]);
+}
+
+
 void Population::save(boost::archive::text_oarchive & ar, const unsigned int version) const
 {
 	// deep adjustment: everyone in order
@@ -3399,6 +3879,11 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 	// GenoStructure genoStru = this->genoStru();
 	ar & genoStru();
 
+	vectoru intIdx;
+	for (size_t i = 0; i < infoSize(); ++i)
+		if (isIntInfoField(i))
+			intIdx.push_back(i);
+
 	ar & m_subPopSize;
 	ar & m_subPopNames;
 	DBG_DO(DBG_POPULATION, cerr << "Handling genotype" << endl);
@@ -3506,7 +3991,7 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 	ar & has_lineage;
 #endif
 	DBG_DO(DBG_POPULATION, cerr << "Handling information" << endl);
-	ar & m_info;
+	saveInfo(ar, m_info, intIdx, infoSize());
 	DBG_DO(DBG_POPULATION, cerr << "Handling Individuals" << endl);
 	ar & m_inds;
 	DBG_DO(DBG_POPULATION, cerr << "Handling ancestral populations" << endl);
@@ -3621,7 +4106,7 @@ void Population::save(boost::archive::text_oarchive & ar, const unsigned int ver
 		ar & has_lineage;
 #endif
 
-		ar & m_info;
+		saveInfo(ar, m_info, intIdx, infoSize());
 		ar & m_inds;
 	}
 	const_cast<Population *>(this)->useAncestralGen(0);
@@ -3817,6 +4302,10 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 	}
 	DBG_DO(DBG_POPULATION, cerr << "Handling info" << endl);
 	ar & m_info;
+	// values of integer information fields are saved since version 4
+	vector<int64_t> intValues;
+	if (version >= 4)
+		ar & intValues;
 
 	DBG_DO(DBG_POPULATION, cerr << "Handling Individuals" << endl);
 	ar & m_inds;
@@ -3829,6 +4318,12 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 
 	DBG_FAILIF(m_info.size() != m_popSize * infoSize(), ValueError, "Wgong size of info vector");
 
+	vectoru intIdx;
+	for (size_t i = 0; i < infoSize(); ++i)
+		if (isIntInfoField(i))
+			intIdx.push_back(i);
+	restoreIntInfo(m_info, intValues, intIdx, infoSize());
+
 	if (m_popSize != m_inds.size()) {
 		throw ValueError("Number of individuals does not match population size.\n"
 			             "Please use the same (binary, short or long) module to save and load files.");
@@ -4034,6 +4529,10 @@ void Population::load(boost::archive::text_iarchive & ar, const unsigned int ver
 #endif
 		}
 		ar & pd.m_info;
+		if (version >= 4) {
+			ar & intValues;
+			restoreIntInfo(pd.m_info, intValues, intIdx, infoSize());
+		}
 		ar & pd.m_inds;
 		// set pointer after copy this thing again (push_back)
 		m_ancestralPops.push_back(pd);
@@ -4255,6 +4754,255 @@ Population & loadPopulation(const string & file)
 }
 
 
+// read a line of arbitrary length from a gzip file, without trailing newline
+static bool gzReadLine(gzFile file, string & line)
+{
+	char buf[65536];
+
+	line.clear();
+	while (gzgets(file, buf, sizeof(buf)) != NULL) {
+		line += buf;
+		if (!line.empty() && line[line.size() - 1] == '\n') {
+			line.erase(line.size() - 1);
+			if (!line.empty() && line[line.size() - 1] == '\r')
+				line.erase(line.size() - 1);
+			return true;
+		}
+	}
+	return !line.empty();
+}
+
+
+// split a line into fields by tab without copying them
+static void splitVCFLine(const string & line, vector<pair<size_t, size_t> > & fields)
+{
+	fields.clear();
+	size_t start = 0;
+	while (true) {
+		size_t end = line.find('\t', start);
+		if (end == string::npos) {
+			fields.push_back(pair<size_t, size_t>(start, line.size()));
+			return;
+		}
+		fields.push_back(pair<size_t, size_t>(start, end));
+		start = end + 1;
+	}
+}
+
+
+Population & loadVCF(const string & filename, const stringList & samplesList,
+                     const stringList & regionsList, const stringList & infoFields)
+{
+	gzFile file = gzopen(filename.c_str(), "rb");
+
+	if (file == NULL)
+		throw ValueError("Can not open file " + filename);
+
+	// regions as (chrom, begin, end)
+	vector<pair<string, pair<ULONG, ULONG> > > regions;
+	const vectorstr & regionStrs = regionsList.elems();
+	for (size_t i = 0; i < regionStrs.size(); ++i) {
+		size_t colon = regionStrs[i].find(':');
+		ULONG beg = 0;
+		ULONG end = std::numeric_limits<ULONG>::max();
+		if (colon != string::npos) {
+			size_t dash = regionStrs[i].find('-', colon);
+			try {
+				beg = boost::lexical_cast<ULONG>(regionStrs[i].substr(colon + 1, dash == string::npos ? string::npos : dash - colon - 1));
+				if (dash != string::npos)
+					end = boost::lexical_cast<ULONG>(regionStrs[i].substr(dash + 1));
+				else
+					end = beg;
+			} catch (boost::bad_lexical_cast &) {
+				gzclose(file);
+				throw ValueError("Invalid region " + regionStrs[i]);
+			}
+		}
+		regions.push_back(std::make_pair(regionStrs[i].substr(0, colon), std::make_pair(beg, end)));
+	}
+
+	string line;
+	vector<pair<size_t, size_t> > fields;
+	// column of selected samples
+	vectoru sampleCols;
+	// chromosome, loci and genotypes of selected sites
+	vectorstr chromNames;
+	vectoru numLoci;
+	vectorf lociPos;
+	vectorstr lociNames;
+	matrixstr alleleNames;
+	std::set<string> usedNames;
+	size_t ploidy = 0;
+	// site-major genotypes, ploidy alleles for each selected sample
+	vector<unsigned char> genotypes;
+	vector<unsigned char> gt;
+	string msg;
+
+	while (msg.empty() && gzReadLine(file, line)) {
+		if (line.empty() || (line.size() > 1 && line[0] == '#' && line[1] == '#'))
+			continue;
+		splitVCFLine(line, fields);
+		if (line[0] == '#') {
+			// header line with sample names
+			if (fields.size() < 9) {
+				sampleCols.clear();
+				continue;
+			}
+			const vectorstr & samples = samplesList.elems();
+			if (samplesList.allAvail())
+				for (size_t col = 9; col < fields.size(); ++col)
+					sampleCols.push_back(col);
+			else {
+				for (size_t i = 0; i < samples.size(); ++i) {
+					size_t col = 9;
+					for (; col < fields.size(); ++col)
+						if (line.compare(fields[col].first, fields[col].second - fields[col].first, samples[i]) == 0)
+							break;
+					if (col == fields.size()) {
+						msg = "Sample " + samples[i] + " does not exist in file " + filename;
+						break;
+					}
+					sampleCols.push_back(col);
+				}
+			}
+			continue;
+		}
+		if (fields.size() < 8) {
+			msg = "Invalid VCF line: " + line.substr(0, 100);
+			break;
+		}
+		string chrom = line.substr(fields[0].first, fields[0].second - fields[0].first);
+		ULONG pos = 0;
+		try {
+			pos = boost::lexical_cast<ULONG>(line.substr(fields[1].first, fields[1].second - fields[1].first));
+		} catch (boost::bad_lexical_cast &) {
+			msg = "Invalid position in line: " + line.substr(0, 100);
+			break;
+		}
+		if (!regions.empty()) {
+			size_t r = 0;
+			for (; r < regions.size(); ++r)
+				if (regions[r].first == chrom && regions[r].second.first <= pos && pos <= regions[r].second.second)
+					break;
+			if (r == regions.size())
+				continue;
+		}
+		if (chromNames.empty() || chromNames.back() != chrom) {
+			if (std::find(chromNames.begin(), chromNames.end(), chrom) != chromNames.end()) {
+				msg = "Sites of chromosome " + chrom + " are not grouped together in file " + filename;
+				break;
+			}
+			chromNames.push_back(chrom);
+			numLoci.push_back(0);
+		} else if (pos < lociPos.back()) {
+			msg = (boost::format("Sites of chromosome %1% are not sorted at position %2% in file %3%")
+			       % chrom % pos % filename).str();
+			break;
+		}
+		numLoci.back() += 1;
+		lociPos.push_back(static_cast<double>(pos));
+		// locus name, which should be unique
+		string name = line.substr(fields[2].first, fields[2].second - fields[2].first);
+		if (name == "." || !usedNames.insert(name).second)
+			name = string();
+		lociNames.push_back(name);
+		// allele names
+		vectorstr names(1, line.substr(fields[3].first, fields[3].second - fields[3].first));
+		string alt = line.substr(fields[4].first, fields[4].second - fields[4].first);
+		if (alt != ".") {
+			size_t start = 0;
+			while (true) {
+				size_t comma = alt.find(',', start);
+				names.push_back(alt.substr(start, comma == string::npos ? string::npos : comma - start));
+				if (comma == string::npos)
+					break;
+				start = comma + 1;
+			}
+		}
+		if (names.size() - 1 > std::min(ModuleMaxAllele, 255UL)) {
+			msg = (boost::format("Site at %1%:%2% has more alleles than allowed") % chrom % pos).str();
+			break;
+		}
+		alleleNames.push_back(names);
+		if (sampleCols.empty())
+			continue;
+		if (fields.size() <= sampleCols.back() ||
+		    line.compare(fields[8].first, 2, "GT") != 0) {
+			msg = (boost::format("No genotype for site at %1%:%2%. GT should be the first FORMAT field.") % chrom % pos).str();
+			break;
+		}
+		// genotypes
+		for (size_t s = 0; s < sampleCols.size() && msg.empty(); ++s) {
+			gt.clear();
+			size_t p = fields[sampleCols[s]].first;
+			size_t e = fields[sampleCols[s]].second;
+			while (p < e && line[p] != ':') {
+				if (line[p] == '.') {
+					gt.push_back(0);
+					++p;
+				} else if (isdigit(line[p])) {
+					size_t a = 0;
+					for (; p < e && isdigit(line[p]); ++p)
+						a = a * 10 + (line[p] - '0');
+					if (a >= names.size()) {
+						msg = (boost::format("Invalid genotype for site at %1%:%2%") % chrom % pos).str();
+						break;
+					}
+					gt.push_back(static_cast<unsigned char>(a));
+				} else
+					// separator / or |
+					++p;
+			}
+			// ploidy is the largest number of alleles of all genotypes, so
+			// genotypes that have been read are padded when a genotype with
+			// more alleles is found (e.g. when the first sample is a male and
+			// the first site is on chromosome X)
+			if (gt.size() > ploidy) {
+				if (!genotypes.empty()) {
+					size_t numGT = genotypes.size() / ploidy;
+					vector<unsigned char> padded(numGT * gt.size(), 0);
+					for (size_t j = 0; j < numGT; ++j)
+						std::copy(genotypes.begin() + j * ploidy, genotypes.begin() + (j + 1) * ploidy,
+							padded.begin() + j * gt.size());
+					genotypes.swap(padded);
+				}
+				ploidy = gt.size();
+			}
+			// haploid genotypes (e.g. chromosome X of males) are padded
+			// with allele 0
+			gt.resize(ploidy, 0);
+			genotypes.insert(genotypes.end(), gt.begin(), gt.end());
+		}
+	}
+	gzclose(file);
+	if (!msg.empty())
+		throw ValueError(msg);
+
+	size_t nSamples = sampleCols.size();
+	size_t nLoci = lociPos.size();
+	Population * pop = new Population(vectoru(1, nSamples), ploidy == 0 ? 2 : ploidy, numLoci,
+		vectoru(), lociPos, 0, chromNames, stringMatrix(alleleNames), lociNames, vectorstr(), infoFields);
+	if (nSamples == 0 || nLoci == 0 || genotypes.empty())
+		return *pop;
+	// transpose site-major genotypes to genotypes of individuals
+#if !defined(BINARYALLELE) && !defined(MUTANTALLELE)
+#  pragma omp parallel for if(numThreads() > 1)
+#endif
+	for (ssize_t i = 0; i < static_cast<ssize_t>(nSamples); ++i) {
+		Individual & ind = pop->individual(static_cast<size_t>(i));
+		for (size_t p = 0; p < ploidy; ++p) {
+			GenoIterator ptr = ind.genoBegin(p);
+			const unsigned char * g = &genotypes[i * ploidy + p];
+			for (size_t loc = 0; loc < nLoci; ++loc, ++ptr, g += nSamples * ploidy)
+				if (*g != 0) {
+					REF_ASSIGN_ALLELE(ptr, TO_ALLELE(*g));
+				}
+		}
+	}
+	return *pop;
+}
+
+
 }
 
 
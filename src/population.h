@@ -272,6 +272,7 @@ public:
 	 */
 	void swap(Population & rhs)
 	{
+		markIndModified();
 		GenoStruTrait::swap(rhs);
 		std::swap(m_popSize, rhs.m_popSize);
 
@@ -356,8 +357,57 @@ public:
 	 */
 	size_t numVirtualSubPop() const;
 
-	/// HIDDEN activate a virtual subpopulation.
-	void activateVirtualSubPop(vspID subPop) const;
+	/** HIDDEN activate a virtual subpopulation. If \e readOnly is set, the
+	 *  caller promises not to change any individual so the members of the
+	 *  VSP can be cached and reused by later activations (if caching is
+	 *  enabled by \c setVspCaching).
+	 */
+	void activateVirtualSubPop(vspID subPop, bool readOnly = false) const;
+
+	/** CPPONLY
+	 *  Allow or disallow caching of members of VSPs. Caching is allowed only
+	 *  when individuals are changed only by operators that are applied by a
+	 *  simulator, which calls \c markIndModified() after applying operators
+	 *  that can change individuals.
+	 */
+	void setVspCaching(bool caching);
+
+	/** CPPONLY
+	 *  Return the sex (bit set for \c MALE) of individuals of the present
+	 *  generation, packed 64 individuals per word, with bit \c i of the vector
+	 *  for the \c i-th individual. Only bits of individuals in subpopulation
+	 *  \e subPop are guaranteed to be valid. If caching is allowed (see
+	 *  \c setVspCaching), bits of all individuals are built once and reused
+	 *  until individuals are changed. Otherwise, bits of subpopulation
+	 *  \e subPop are rebuilt for each call.
+	 */
+	const vector<uint64_t> & maleBits(size_t subPop) const
+	{
+		updateFlagBits(subPop);
+		return m_maleBits;
+	}
+
+
+	/** CPPONLY
+	 *  Return the affection status (bit set for affected) of individuals of
+	 *  the present generation, packed the same way as \c maleBits().
+	 */
+	const vector<uint64_t> & affectedBits(size_t subPop) const
+	{
+		updateFlagBits(subPop);
+		return m_affectedBits;
+	}
+
+
+	/// CPPONLY bit \e i of bits returned by \c maleBits() or \c affectedBits()
+	static bool flagBit(const vector<uint64_t> & bits, size_t i)
+	{
+		return ((bits[i / 64] >> (i % 64)) & 1) != 0;
+	}
+
+
+	/// CPPONLY number of set bits of \e bits between index begin and end
+	static size_t countBits(const vector<uint64_t> & bits, size_t begin, size_t end);
 
 	/** HIDDEN
 	 *  deactivate virtual subpopulations in a given
@@ -1050,7 +1100,11 @@ public:
 
 	/** Return an editable array of the genotype of all individuals in
 	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
-	 *  subpopulation \e subPop. Virtual subpopulation is unsupported.
+	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. Except
+	 *  for binary and mutant modules, the array supports the Python buffer
+	 *  protocol so that it can be wrapped by, for example,
+	 *  <tt>numpy.asarray(pop.genotype())</tt> without copying. The array and
+	 *  such views become invalid once the population is changed.
 	 *  <group>5-genotype</group>
 	 */
 	PyObject * genotype(vspID subPop = vspID());
@@ -1069,7 +1123,8 @@ public:
 
 	/** Return an editable array of the lineage of alleles for all individuals in
 	 *  a population (if <tt>subPop=[]</tt>, default), or individuals in a
-	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. <bf>
+	 *  subpopulation \e subPop. Virtual subpopulation is unsupported. The
+	 *  array supports the Python buffer protocol (see \c genotype()). <bf>
 	 *  This function returns \c None for modules without lineage information.</bf>
 	 *  <group>5-genotype</group>
 	 */
@@ -1079,18 +1134,26 @@ public:
 	 *  <tt>subPop=[]</tt>) or in a (virtual) subpopulation \e subPop (if
 	 *  <tt>subPop=sp</tt> or <tt>(sp, vsp)</tt>) using a list of alleles
 	 *  \e geno. \e geno will be reused if its length is less than
-	 *  <tt>subPopSize(subPop)*totNumLoci()*ploidy()</tt>.
+	 *  <tt>subPopSize(subPop)*totNumLoci()*ploidy()</tt>. If a list of loci
+	 *  (indexes or names) is specified by parameter \e loci, only alleles at
+	 *  these loci are set, with \e geno listing <tt>len(loci)</tt> alleles for
+	 *  each homologous copy of chromosomes of each individual. \e geno can be
+	 *  a (multi-dimensional, possibly strided) array of integers that supports
+	 *  the Python buffer protocol (e.g. a numpy array), in which case its
+	 *  items are converted in bulk without creating Python objects.
 	 *  <group>5-genotype</group>
 	 */
-	void setGenotype(const uintList & geno, vspID subPop = vspID());
+	void setGenotype(const uintList & geno, vspID subPop = vspID(), const lociList & loci = lociList());
 
 
 	/** Fill the lineage of all individuals in a population (if
 	 *  <tt>subPop=[]</tt>) or in a (virtual) subpopulation \e subPop (if
 	 *  <tt>subPop=sp</tt> or <tt>(sp, vsp)</tt>) using a list of IDs
 	 *  \e lineage. \e lineage will be reused if its length is less than
-	 *  <tt>subPopSize(subPop)*totNumLoci()*ploidy()</tt>. This function
-	 *  returns directly for modules without lineage information.
+	 *  <tt>subPopSize(subPop)*totNumLoci()*ploidy()</tt>. Similar to function
+	 *  \c setGenotype, \e lineage can be an array that supports the Python
+	 *  buffer protocol. This function returns directly for modules without
+	 *  lineage information.
 	 *  <group>5-genotype</group>
 	 */
 	void setLineage(const uintList & geno, vspID subPop = vspID());
@@ -1402,13 +1465,32 @@ public:
 	 *  all individuals (if <tt>subPop=[]</tt>, default), or individuals in
 	 *  a (virtual) subpopulation (<tt>subPop=sp</tt> or <tt>(sp, vsp)</tt>)
 	 *  to \e values. \e values will be reused if its length is smaller than
-	 *  the size of the population or (virtual) subpopulation.
+	 *  the size of the population or (virtual) subpopulation. \e values can
+	 *  be an array of numbers that supports the Python buffer protocol (e.g.
+	 *  a numpy array), in which case its items are converted in bulk.
 	 *  <group>8-info</group>
 	 */
 	void setIndInfo(const floatList & values, const uintString & field,
 		vspID subPop = vspID());
 
 
+	/** CPPONLY Return a pointer to information field \e idx of the first
+	 *  individual of subpopulation \e subPop, from which the field of the
+	 *  next individual is \c infoSize() values away, so that the field can
+	 *  be scanned without visiting individuals. \c NULL is returned if
+	 *  information fields are not stored in the order of individuals, if
+	 *  the field stores 64-bit integers, or if the subpopulation is empty.
+	 */
+	const double * infoColumn(size_t idx, size_t subPop) const
+	{
+		CHECKRANGEINFO(idx);
+		CHECKRANGESUBPOP(subPop);
+		if (!indOrdered() || isIntInfoField(idx) || m_subPopSize[subPop] == 0)
+			return NULL;
+		return &m_info[m_subPopIndex[subPop] * infoSize() + idx];
+	}
+
+
 	/// CPPONLY info iterator
 	IndInfoIterator infoBegin(size_t idx)
 	{
@@ -1483,16 +1565,41 @@ public:
 	 */
 	vectorf indInfo(const uintString & field, vspID subPop = vspID());
 
+	/** Return an editable two-dimensional view (a Python \c memoryview of
+	 *  doubles) of the information fields of all individuals (if
+	 *  <tt>subPop=[]</tt>, default), or individuals in a subpopulation
+	 *  \e subPop, with one row for each individual and one column for each
+	 *  information field. The view refers directly to the information fields
+	 *  of the population so it can be wrapped by, for example,
+	 *  <tt>numpy.asarray(pop.infoArray())</tt> without copying, and a column
+	 *  of it is a strided view of a single information field. Similar to
+	 *  the array returned by \c genotype(), this view becomes invalid once
+	 *  the population is resized, reordered or evolved, or when information
+	 *  fields are added or removed, but it holds a reference to the population
+	 *  so it remains valid if the population is deleted from Python before
+	 *  the view. Virtual subpopulation is unsupported.
+	 *  This function requires Python 3.3 or later.
+	 *  <group>8-info</group>
+	 */
+	PyObject * infoArray(vspID subPop = vspID());
+
 
 	/** Add a list of information fields \e fields to a population and
 	 *  initialize their values to \e init. If an information field alreay
-	 *  exists, it will be re-initialized.
+	 *  exists, it will be re-initialized. Information fields store floating
+	 *  point numbers by default (\e type=INFO_FLOAT64). Fields of type
+	 *  \c INFO_INT64 store 64-bit integers so that individual IDs and
+	 *  counters are exact beyond <tt>2^53</tt>. Their values are still
+	 *  returned as floating point numbers by functions such as \c info and
+	 *  \c indInfo, and they cannot be accessed through \c infoArray.
+	 *  Existing fields are changed to type \e type.
 	 * <group>8-info</group>
 	 */
-	void addInfoFields(const stringList & fields, double init = 0);
+	void addInfoFields(const stringList & fields, double init = 0, int type = INFO_FLOAT64);
 
 	/** Set information fields \e fields to a population and initialize them
 	 *  with value \e init. All existing information fields will be removed.
+	 *  Fields that already exist keep their types.
 	 *  <group>8-info</group>
 	 */
 	void setInfoFields(const stringList & fields, double init = 0);
@@ -1638,6 +1745,12 @@ private:
 
 	BOOST_SERIALIZATION_SPLIT_MEMBER();
 
+	/// set genotype at specified loci, used by setGenotype
+	void setGenotypeAtLoci(const vectoru & geno, vspID subPop, const vectoru & loci);
+
+	/// cached indexes of individuals in a VSP, NULL if unavailable
+	const vectoru * cachedVspIndexes(size_t subPop, size_t virtualSubPop) const;
+
 private:
 	/// population size: number of individual
 	size_t m_popSize;
@@ -1654,6 +1767,24 @@ private:
 	///
 	BaseVspSplitter * m_vspSplitter;
 
+	/// if members of VSPs can be cached
+	bool m_vspCaching;
+
+	/// rebuild m_maleBits and m_affectedBits of subpopulation \e subPop, or
+	/// of all individuals if caching is allowed, if they might be outdated
+	void updateFlagBits(size_t subPop) const;
+
+	/// packed sex and affection status of individuals, see maleBits()
+	mutable vector<uint64_t> m_maleBits;
+	mutable vector<uint64_t> m_affectedBits;
+
+	/// indModificationCount(), ancestral generation and population size when
+	/// the bits were built, m_flagBitsCount is InvalidValue if they should be
+	/// rebuilt
+	mutable size_t m_flagBitsCount;
+	mutable int m_flagBitsGen;
+	mutable size_t m_flagBitsSize;
+
 	/// pool of genotypic information
 #ifdef MUTANTALLELE
 	vectorm m_genotype;
@@ -1759,6 +1890,25 @@ public:
  */
 Population & loadPopulation(const string & file);
 
+/** Load a population from a file in Variant Call Format (VCF), which can be
+ *  plain text or compressed by \c gzip or \c bgzip. Genotypes of all samples,
+ *  or samples listed in \e samples, are imported, optionally from sites in
+ *  specified \e regions (a list of \c 'chr' or \c 'chr:begin-end' with
+ *  1-based inclusive positions). The resulting population has a single
+ *  subpopulation and one chromosome for each contig in the file. Its ploidy
+ *  is the largest number of alleles of genotypes in the file, and genotypes
+ *  with fewer alleles (e.g. chromosome X of males) are padded with allele
+ *  \c 0. The reference and alternative alleles are imported as alleles
+ *  \c 0, \c 1, ... with their names as allele names. Missing alleles are imported as allele \c 0.
+ *  Positions, IDs (if unique) and chromosome names of sites are imported as
+ *  loci positions, names and chromosome names of the population. Information
+ *  fields \e infoFields are added to the population if specified. Sites of
+ *  each chromosome should be sorted by position, and \c GT should be the
+ *  first \c FORMAT field.
+ */
+Population & loadVCF(const string & filename, const stringList & samples = stringList(),
+                     const stringList & regions = stringList(), const stringList & infoFields = vectorstr());
+
 }
 
 
@@ -1768,7 +1918,8 @@ Population & loadPopulation(const string & file);
 // version 1: with lineage information for lineage-aware modules
 // version 2: for memory-efficient save/load
 // version 3: use pickle to save load population variables
-BOOST_CLASS_VERSION(simuPOP::Population, 3)
+// version 4: save values of integer information fields separately
+BOOST_CLASS_VERSION(simuPOP::Population, 4)
 #  endif
 #endif
 #endif
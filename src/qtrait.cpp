@@ -114,6 +114,7 @@ void PyQuanTrait::qtrait(Individual * ind, size_t gen, vectorf & traits) const
 		}
 	}
 
+	PythonCallGuard guard;
 	PyObject * res = PyEval_CallObject(m_func.func(), args);
 	Py_XDECREF(args);
 
@@ -26,6 +26,10 @@
 
 #include "sandbox.h"
 
+#if PY_VERSION_HEX >= 0x03000000
+#  define PyInt_FromLong(x) PyLong_FromLong(x)
+#endif
+
 namespace simuPOP {
 namespace sandbox {
 
@@ -37,65 +41,195 @@ bool RevertFixedSites::apply(Population & pop) const
 		return true;
 
 	bool chX = pop.chromType(0) == CHROMOSOME_X;
+	ssize_t popSize = static_cast<ssize_t>(pop.popSize());
 
-	RawIndIterator it = pop.rawIndBegin();
-	RawIndIterator it_end = pop.rawIndEnd();
-	std::set<Allele> commonAlleles(it->genoBegin(0), it->genoEnd(0));
-	commonAlleles.erase(0);
-	if (commonAlleles.size() == 0)
+	// only mutants on the first haplotype can be fixed
+	vectora candidates(pop.rawIndBegin()->genoBegin(0), pop.rawIndBegin()->genoEnd(0));
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	if (!candidates.empty() && candidates[0] == 0)
+		candidates.erase(candidates.begin());
+	if (candidates.empty())
 		return true;
 
-	for (; it != it_end; ++it) {
-		// common = commonAlleles & geno0
-		std::set<Allele> common;
-		std::set<Allele> alleles1(it->genoBegin(0), it->genoEnd(0));
-		set_intersection(commonAlleles.begin(),
-			commonAlleles.end(), alleles1.begin(), alleles1.end(),
-			std::inserter(common, common.begin()));
-		// commonAlleles = common & geno1
-		if (chX && it->sex() == MALE) {
-			// commonAlleles = common
-			commonAlleles.swap(common);
-		} else {
-			commonAlleles.clear();
-			std::set<Allele> alleles2(it->genoBegin(1), it->genoEnd(1));
-			set_intersection(common.begin(),
-				common.end(), alleles2.begin(), alleles2.end(),
-				std::inserter(commonAlleles, commonAlleles.begin()));
+	size_t nCand = candidates.size();
+	// number of haplotypes that carry each candidate
+	vectoru counts(nCand, 0);
+	size_t numHaplotypes = 0;
+	// set if a haplotype carries none of the candidates that are carried by
+	// all previous haplotypes of the same thread
+	int noneFixed = 0;
+
+#pragma omp parallel if(numThreads() > 1)
+	{
+		vectoru localCounts(nCand, 0);
+		// last haplotype that carries a candidate, so that duplicated
+		// mutants on a haplotype are counted once
+		vectoru lastSeen(nCand, InvalidValue);
+		size_t localHaplotypes = 0;
+#pragma omp for reduction(| : noneFixed)
+		for (ssize_t i = 0; i < popSize; ++i) {
+			if (noneFixed)
+				continue;
+			const Individual & ind = *(pop.rawIndBegin() + i);
+			size_t ploidy = chX && ind.sex() == MALE ? 1 : 2;
+			for (size_t p = 0; p < ploidy; ++p) {
+				size_t hap = 2 * i + p;
+				size_t hits = 0;
+				ConstGenoIterator it = ind.genoBegin(p);
+				ConstGenoIterator itEnd = ind.genoEnd(p);
+				for (; it != itEnd; ++it) {
+					if (*it == 0)
+						continue;
+					vectora::const_iterator c = std::lower_bound(candidates.begin(), candidates.end(), *it);
+					if (c == candidates.end() || *c != *it)
+						continue;
+					size_t k = c - candidates.begin();
+					if (lastSeen[k] == hap)
+						continue;
+					lastSeen[k] = hap;
+					// candidates that are carried by all previous haplotypes
+					if (localCounts[k] == localHaplotypes)
+						++hits;
+					++localCounts[k];
+				}
+				++localHaplotypes;
+				if (hits == 0)
+					noneFixed = 1;
+			}
+		}
+#pragma omp critical
+		{
+			for (size_t k = 0; k < nCand; ++k)
+				counts[k] += localCounts[k];
+			numHaplotypes += localHaplotypes;
 		}
-		if (commonAlleles.size() == 0)
-			return true;
 	}
+	if (noneFixed)
+		return true;
+
+	vectora fixedAlleles;
+	for (size_t k = 0; k < nCand; ++k)
+		if (counts[k] == numHaplotypes)
+			fixedAlleles.push_back(candidates[k]);
+	if (fixedAlleles.empty())
+		return true;
+
 	if (!noOutput()) {
 		ostream & out = getOstream(pop.dict());
 		out << pop.gen();
-		std::set<Allele>::iterator beg = commonAlleles.begin();
-		std::set<Allele>::iterator end = commonAlleles.end();
+		vectora::const_iterator beg = fixedAlleles.begin();
+		vectora::const_iterator end = fixedAlleles.end();
 		for (; beg != end ; ++beg)
 			out << '\t' << *beg;
 		out << endl;
+		closeOstream();
 	}
-	it = pop.rawIndBegin();
-	vectora new_alleles(pop.totNumLoci());
-	for (; it != it_end; ++it) {
-		for (size_t p = 0; p < 2; ++p) {
-			if (p == 1 && chX && it->sex() == MALE)
-				continue;
-			std::set<Allele> old_alleles(it->genoBegin(p), it->genoEnd(p));
-			old_alleles.erase(0);
-			std::fill(new_alleles.begin(), new_alleles.end(), Allele(0));
-			set_difference(old_alleles.begin(), old_alleles.end(),
-				commonAlleles.begin(), commonAlleles.end(), new_alleles.begin());
-			std::copy(new_alleles.begin(), new_alleles.end(),
-				it->genoBegin(p));
+	// remove fixed mutants, and save the remaining mutants of each haplotype
+	// in sorted order without duplicates
+#pragma omp parallel if(numThreads() > 1)
+	{
+		vectora alleles;
+#pragma omp for
+		for (ssize_t i = 0; i < popSize; ++i) {
+			Individual & ind = *(pop.rawIndBegin() + i);
+			for (size_t p = 0; p < 2; ++p) {
+				if (p == 1 && chX && ind.sex() == MALE)
+					continue;
+				alleles.clear();
+				GenoIterator it = ind.genoBegin(p);
+				GenoIterator itEnd = ind.genoEnd(p);
+				for (; it != itEnd; ++it)
+					if (*it != 0 && !std::binary_search(fixedAlleles.begin(), fixedAlleles.end(), *it))
+						alleles.push_back(*it);
+				std::sort(alleles.begin(), alleles.end());
+				alleles.erase(std::unique(alleles.begin(), alleles.end()), alleles.end());
+				std::fill(std::copy(alleles.begin(), alleles.end(), ind.genoBegin(p)), itEnd, Allele(0));
+			}
 		}
 	}
 	return true;
 }
 
 
-double MutSpaceSelector::indFitness(Population & /* pop */, RawIndIterator ind) const
+size_t MutationTable::add(size_t loc, ULONG gen, double effect, double dominance)
+{
+	size_t id = m_loc.size();
+
+	m_loc.push_back(loc);
+	m_gen.push_back(gen);
+	m_effect.push_back(effect);
+	m_dominance.push_back(dominance);
+	m_count.push_back(0);
+	m_index[loc] = id;
+	return id;
+}
+
+
+size_t MutationTable::collect(Population & pop)
+{
+	size_t nMutants = m_loc.size();
+
+	std::fill(m_count.begin(), m_count.end(), 0);
+	// the last haplotype in which a mutant is seen, so that a mutant that
+	// appears more than once in a haplotype is counted once
+	vectoru lastSeen(nMutants, InvalidValue);
+	size_t h = 0;
+	IndIterator it = pop.indIterator();
+	for (; it.valid(); ++it) {
+		for (size_t p = 0; p < pop.ploidy(); ++p, ++h) {
+			GenoIterator a = it->genoBegin(p);
+			GenoIterator a_end = it->genoEnd(p);
+			for (; a != a_end; ++a) {
+				if (*a == 0u)
+					continue;
+				MutIndex::const_iterator mit = m_index.find(*a);
+				if (mit == m_index.end() || lastSeen[mit->second] == h)
+					continue;
+				lastSeen[mit->second] = h;
+				++m_count[mit->second];
+			}
+		}
+	}
+	// move existing mutants forward, in the order they were added
+	size_t dest = 0;
+	m_index.clear();
+	for (size_t id = 0; id < nMutants; ++id) {
+		if (m_count[id] == 0)
+			continue;
+		m_loc[dest] = m_loc[id];
+		m_gen[dest] = m_gen[id];
+		m_effect[dest] = m_effect[id];
+		m_dominance[dest] = m_dominance[id];
+		m_count[dest] = m_count[id];
+		m_index[m_loc[dest]] = dest;
+		++dest;
+	}
+	m_loc.resize(dest);
+	m_gen.resize(dest);
+	m_effect.resize(dest);
+	m_dominance.resize(dest);
+	m_count.resize(dest);
+	m_collected = dest;
+	return nMutants - dest;
+}
+
+
+void MutSpaceSelector::useReplicate(Population & pop) const
+{
+	m_rep = pop.rep();
+	m_gen = pop.gen();
+	if (m_mutations.size() <= m_rep) {
+		m_mutations.resize(m_rep + 1);
+		m_hapFitness.resize(m_rep + 1);
+	}
+}
+
+
+double MutSpaceSelector::indFitness(Population & pop, RawIndIterator ind) const
 {
+	// this function can be called without apply(), e.g. during mating
+	useReplicate(pop);
 	if (ind->sex() == MALE && ind->chromType(0) == CHROMOSOME_X) {
 		if (m_mode == MULTIPLICATIVE) {
 			return randomSelMulFitnessExt(ind->genoBegin(0), ind->genoEnd(0), true);
@@ -129,26 +263,203 @@ double MutSpaceSelector::indFitness(Population & /* pop */, RawIndIterator ind)
 }
 
 
+// mix bits of a mutant so that sums of mixed mutants distinguish haplotypes
+static inline uint64_t mutantSignature(uint64_t x)
+{
+	x += 0x9E3779B97F4A7C15ULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+
+// sorted mutants on a haplotype and an order-independent signature of them,
+// 0 if there is no mutant
+static uint64_t haplotypeMutants(GenoIterator it, GenoIterator it_end, vectora & mutants)
+{
+	uint64_t sig = 0;
+
+	mutants.clear();
+	for (; it != it_end; ++it) {
+		if (*it == 0u)
+			continue;
+		mutants.push_back(*it);
+		sig += mutantSignature(*it);
+	}
+	if (mutants.empty())
+		return 0;
+	std::sort(mutants.begin(), mutants.end());
+	return sig ^ (static_cast<uint64_t>(mutants.size()) << 56);
+}
+
+
+bool MutSpaceSelector::applyCachedFitness(Population & pop) const
+{
+	size_t fit_id = pop.infoIdx(this->infoField(0));
+	HapFitnessMap & hapFitness = m_hapFitness[m_rep];
+
+	subPopList subPops = applicableSubPops(pop);
+	subPopList::const_iterator sp = subPops.begin();
+	subPopList::const_iterator spEnd = subPops.end();
+	size_t numHaplotypes = 0;
+
+	for (; sp != spEnd; ++sp) {
+		if (sp->isVirtual())
+			pop.activateVirtualSubPop(*sp);
+		vector<Individual *> inds;
+		IndIterator it = pop.indIterator(sp->subPop());
+		for (; it.valid(); ++it)
+			inds.push_back(&*it);
+		ssize_t nInds = static_cast<ssize_t>(inds.size());
+		// signature and sum of selection coefficients of each haplotype
+		vector<uint64_t> signatures(2 * nInds, 0);
+		vectorf sums(2 * nInds, 0);
+		vector<char> cached(2 * nInds, 1);
+
+		// look for haplotypes in the cache
+#pragma omp parallel if(numThreads() > 1)
+		{
+			vectora mutants;
+#pragma omp for
+			for (ssize_t i = 0; i < nInds; ++i) {
+				Individual & ind = *inds[i];
+				size_t ploidy = ind.sex() == MALE && ind.chromType(0) == CHROMOSOME_X ? 1 : 2;
+				for (size_t p = 0; p < ploidy; ++p) {
+					uint64_t sig = haplotypeMutants(ind.genoBegin(p), ind.genoEnd(p), mutants);
+					if (sig == 0)
+						continue;
+					signatures[2 * i + p] = sig;
+					HapFitnessMap::const_iterator hit = hapFitness.find(sig);
+					if (hit == hapFitness.end() || hit->second.mutants != mutants)
+						cached[2 * i + p] = 0;
+					else
+						sums[2 * i + p] = hit->second.sum;
+				}
+			}
+		}
+		// new haplotypes, which might have new mutants
+		vectora mutants;
+		for (ssize_t h = 0; h < 2 * nInds; ++h) {
+			if (cached[h])
+				continue;
+			haplotypeMutants(inds[h / 2]->genoBegin(h % 2), inds[h / 2]->genoEnd(h % 2), mutants);
+			HapFitnessMap::const_iterator hit = hapFitness.find(signatures[h]);
+			if (hit != hapFitness.end() && hit->second.mutants == mutants) {
+				sums[h] = hit->second.sum;
+				continue;
+			}
+			double s = 0;
+			vectora::const_iterator a = mutants.begin();
+			vectora::const_iterator a_end = mutants.end();
+			for (; a != a_end; ++a)
+				s += selCoef(*a).first / 2.;
+			if (!m_additive) {
+				if (sp->isVirtual())
+					pop.deactivateVirtualSubPop(sp->subPop());
+				return false;
+			}
+			sums[h] = s;
+			// a haplotype with the signature of another cached haplotype
+			// is not cached
+			if (hit == hapFitness.end()) {
+				HapFitness & hf = hapFitness[signatures[h]];
+				hf.mutants = mutants;
+				hf.sum = s;
+			}
+		}
+		// assign fitness
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = 0; i < nInds; ++i) {
+			Individual & ind = *inds[i];
+			double s = sums[2 * i] + sums[2 * i + 1];
+			if (ind.sex() == MALE && ind.chromType(0) == CHROMOSOME_X)
+				// fitness of variant on chromosome X is as if it is homogeneous
+				s += s;
+			if (m_mode == ADDITIVE)
+				ind.setInfo(1 - s > 0 ? 1 - s : 0, fit_id);
+			else
+				ind.setInfo(exp(-s), fit_id);
+		}
+		numHaplotypes += 2 * nInds;
+		if (sp->isVirtual())
+			pop.deactivateVirtualSubPop(sp->subPop());
+	}
+	// remove haplotypes that no longer exist in the population
+	if (hapFitness.size() > 2 * numHaplotypes + 1024) {
+		HapFitnessMap existing;
+		vectora mutants;
+		for (sp = subPops.begin(); sp != spEnd; ++sp) {
+			IndIterator it = pop.indIterator(sp->subPop());
+			for (; it.valid(); ++it) {
+				for (size_t p = 0; p < 2; ++p) {
+					uint64_t sig = haplotypeMutants(it->genoBegin(p), it->genoEnd(p), mutants);
+					HapFitnessMap::const_iterator hit = hapFitness.find(sig);
+					if (hit != hapFitness.end() && hit->second.mutants == mutants)
+						existing[sig] = hit->second;
+				}
+			}
+		}
+		hapFitness.swap(existing);
+	}
+	return true;
+}
+
+
 bool MutSpaceSelector::apply(Population & pop) const
 {
 	m_newMutants.clear();
-	if (!BaseSelector::apply(pop))
+	useReplicate(pop);
+	// fitness of individuals is determined by sums of selection coefficients
+	// of their haplotypes if all mutants are additive.
+	bool done = m_additive && (m_mode == ADDITIVE || m_mode == EXPONENTIAL) &&
+	            applyCachedFitness(pop);
+	if (!done && !BaseSelector::apply(pop))
 		return false;
 	// output NEW mutant...
 	if (!m_newMutants.empty() && !noOutput()) {
 		ostream & out = getOstream(pop.dict());
 		vectoru::const_iterator it = m_newMutants.begin();
 		vectoru::const_iterator it_end = m_newMutants.end();
+		const MutationTable & table = m_mutations[m_rep];
 		for (; it != it_end; ++it) {
-			SelCoef s = m_selFactory[*it];
-			out << *it << '\t' << s.first << '\t' << s.second << '\n';
+			size_t id = table.find(*it);
+			out << *it << '\t' << table.effect(id) << '\t' << table.dominance(id) << '\n';
 		}
 		closeOstream();
 	}
+	// remove mutants that are no longer in the population. Fitness of cached
+	// haplotypes is discarded because a removed mutant might be introduced
+	// again with a different selection coefficient.
+	if (m_mutations[m_rep].needsCollection()) {
+		m_mutations[m_rep].collect(pop);
+		m_hapFitness[m_rep].clear();
+	}
 	return true;
 }
 
 
+PyObject * MutSpaceSelector::mutants(Population & pop) const
+{
+	PyObject * res = PyDict_New();
+
+	if (pop.rep() >= m_mutations.size())
+		return res;
+
+	MutationTable & table = m_mutations[pop.rep()];
+	table.collect(pop);
+	m_hapFitness[pop.rep()].clear();
+	for (size_t id = 0; id < table.size(); ++id) {
+		PyObject * key = PyInt_FromLong(static_cast<long>(table.location(id)));
+		PyObject * val = Py_BuildValue("(ddkk)", table.effect(id), table.dominance(id),
+			static_cast<unsigned long>(table.gen(id)), static_cast<unsigned long>(table.count(id)));
+		PyDict_SetItem(res, key, val);
+		Py_DECREF(key);
+		Py_DECREF(val);
+	}
+	return res;
+}
+
+
 MutSpaceSelector::SelCoef MutSpaceSelector::getFitnessValue(size_t mutant) const
 {
 	size_t sz = m_selDist.size();
@@ -195,7 +506,7 @@ MutSpaceSelector::SelCoef MutSpaceSelector::getFitnessValue(size_t mutant) const
 				h = m_selDist[3];
 		}
 	}
-	m_selFactory[mutant] = SelCoef(s, h);
+	m_mutations[m_rep].add(mutant, m_gen, s, h);
 	m_newMutants.push_back(mutant);
 	if (m_additive && h != 0.5)
 		m_additive = false;
@@ -210,11 +521,7 @@ double MutSpaceSelector::randomSelAddFitness(GenoIterator it, GenoIterator it_en
 	for (; it != it_end; ++it) {
 		if (*it == 0u)
 			continue;
-		SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(*it));
-		if (sit == m_selFactory.end())
-			s += getFitnessValue(*it).first / 2.;
-		else
-			s += sit->second.first / 2;
+		s += selCoef(*it).first / 2.;
 	}
 	if (chrX)
 		// fitness of variant on chromosome X is as if it is homogeneous
@@ -230,11 +537,7 @@ double MutSpaceSelector::randomSelExpFitness(GenoIterator it, GenoIterator it_en
 	for (; it != it_end; ++it) {
 		if (*it == 0u)
 			continue;
-		SelMap::iterator sit = m_selFactory.find(static_cast<unsigned int>(*it));
-		if (sit == m_selFactory.end())
-			s += getFitnessValue(*it).first / 2.;
-		else
-			s += sit->second.first / 2;
+		s += selCoef(*it).first / 2.;
 	}
 	if (chrX)
 		// fitness of variant on chromosome X is as if it is homogeneous
@@ -261,19 +564,11 @@ double MutSpaceSelector::randomSelMulFitnessExt(GenoIterator it, GenoIterator it
 	MutCounter::iterator mit = cnt.begin();
 	MutCounter::iterator mit_end = cnt.end();
 	for (; mit != mit_end; ++mit) {
-		SelMap::iterator sit = m_selFactory.find(mit->first);
-		if (sit == m_selFactory.end()) {
-			SelCoef sf = getFitnessValue(mit->first);
-			if (mit->second == 1 && !chrX)
-				s *= 1 - sf.first * sf.second;
-			else
-				s *= 1 - sf.first;
-		} else {
-			if (mit->second == 1 && !chrX)
-				s *= 1 - sit->second.first * sit->second.second;
-			else
-				s *= 1 - sit->second.first;
-		}
+		SelCoef sf = selCoef(mit->first);
+		if (mit->second == 1 && !chrX)
+			s *= 1 - sf.first * sf.second;
+		else
+			s *= 1 - sf.first;
 	}
 	return s;
 }
@@ -297,19 +592,11 @@ double MutSpaceSelector::randomSelAddFitnessExt(GenoIterator it, GenoIterator it
 	MutCounter::iterator mit = cnt.begin();
 	MutCounter::iterator mit_end = cnt.end();
 	for (; mit != mit_end; ++mit) {
-		SelMap::iterator sit = m_selFactory.find(mit->first);
-		if (sit == m_selFactory.end()) {
-			SelCoef sf = getFitnessValue(mit->first);
-			if (mit->second == 1 && !chrX)
-				s += sf.first * sf.second;
-			else
-				s += sf.first;
-		} else {
-			if (mit->second == 1 && !chrX)
-				s += sit->second.first * sit->second.second;
-			else
-				s += sit->second.first;
-		}
+		SelCoef sf = selCoef(mit->first);
+		if (mit->second == 1 && !chrX)
+			s += sf.first * sf.second;
+		else
+			s += sf.first;
 	}
 	return 1 - s > 0 ? 1 - s : 0;
 }
@@ -333,49 +620,43 @@ double MutSpaceSelector::randomSelExpFitnessExt(GenoIterator it, GenoIterator it
 	MutCounter::iterator mit = cnt.begin();
 	MutCounter::iterator mit_end = cnt.end();
 	for (; mit != mit_end; ++mit) {
-		SelMap::iterator sit = m_selFactory.find(mit->first);
-		if (sit == m_selFactory.end()) {
-			SelCoef sf = getFitnessValue(mit->first);
-			if (mit->second == 1 && !chrX)
-				s += sf.first * sf.second;
-			else
-				s += sf.first;
-		} else {
-			if (mit->second == 1 && !chrX)
-				s += sit->second.first * sit->second.second;
-			else
-				s += sit->second.first;
-		}
+		SelCoef sf = selCoef(mit->first);
+		if (mit->second == 1 && !chrX)
+			s += sf.first * sf.second;
+		else
+			s += sf.first;
 	}
 	return exp(-s);
 }
 
 
-size_t MutSpaceMutator::locateVacantLocus(Population & /* pop */, size_t beg, size_t end, std::set<size_t> & mutants) const
+size_t MutSpaceMutator::locateVacantLocus(Population & /* pop */, const OccupancyIndex & mutants) const
 {
-	size_t loc = getRNG().randInt(static_cast<ULONG>(end - beg)) + beg;
-
-	std::set<size_t>::iterator it = std::find(mutants.begin(), mutants.end(), loc);
-
-	if (it == mutants.end())
-		return loc;
-	// look forward and backward
-	size_t loc1 = loc + 1;
-	std::set<size_t>::iterator it1(it);
-	++it1;
-	for (; it1 != mutants.end() && loc1 != end; ++it1, ++loc1) {
-		if (*it1 != loc1)
-			return loc1;
-	}
-	size_t loc2 = loc - 1;
-	std::set<size_t>::reverse_iterator it2(it);
-	--it2;
-	for (; it2 != mutants.rend() && loc2 != beg; --it2, --loc2) {
-		if (*it2 != loc2)
-			return loc2;
-	}
-	// still cannot find
-	return 0;
+	size_t loc = mutants.randVacantSite();
+
+	// return 0 if all loci have existing mutants
+	return loc == mutants.end() ? 0 : loc;
+}
+
+
+void MutSpaceMutator::indexMutants(Population & pop, MutantIndex & index) const
+{
+	const matrixi & ranges = m_ranges.elems();
+
+	index.regions.resize(ranges.size());
+	for (size_t ch = 0; ch < ranges.size(); ++ch)
+		index.regions[ch].reset(ranges[ch][0], ranges[ch][1]);
+	// mutants on each chromosome are located in the corresponding region
+	IndIterator it = pop.indIterator();
+	for (; it.valid(); ++it)
+		for (size_t p = 0; p < pop.ploidy(); ++p)
+			for (size_t ch = 0; ch < ranges.size(); ++ch)
+				index.regions[ch].markOccupied(it->genoBegin(p, ch), it->genoEnd(p, ch));
+	index.scanned = 0;
+	for (size_t ch = 0; ch < ranges.size(); ++ch)
+		index.scanned += index.regions[ch].count();
+	index.added = 0;
+	index.valid = true;
 }
 
 
@@ -395,8 +676,18 @@ bool MutSpaceMutator::apply(Population & pop) const
 	if (!noOutput())
 		out = &getOstream(pop.dict());
 
-	// build a set of existing mutants
-	std::set<size_t> mutants;
+	// Existing mutants of a replicate are kept across generations. The index
+	// is rebuilt when the first mutation happens if it is used for another
+	// population (generation goes back), or if many of its mutants might have
+	// been lost or reverted since it was built.
+	if (m_mutants.size() <= pop.rep())
+		m_mutants.resize(pop.rep() + 1);
+	MutantIndex & index = m_mutants[pop.rep()];
+	if (index.valid && pop.gen() < index.gen)
+		index.valid = false;
+	index.gen = pop.gen();
+	bool indexed = false;
+	bool rebuilt = false;
 	bool saturated = false;
 
 	subPopList subPops = applicableSubPops(pop);
@@ -441,22 +732,23 @@ bool MutSpaceMutator::apply(Population & pop) const
 							        << "\t3\n";
 						continue;
 					}
-					bool ok = false;
 					// if the first time
-					if (mutants.empty()) {
-						// first try our luck...
-						ok = find(pop.genoBegin(false), pop.genoEnd(false), TO_ALLELE(mutLoc)) == pop.genoEnd(false);
-						if (!ok) {
-							std::set<size_t> existing(pop.genoBegin(false), pop.genoEnd(false));
-							mutants.swap(existing);
-							mutants.erase(0);
-							saturated = mutants.size() == ploidyWidth;
-							if (saturated)
-								cerr << "Failed to introduce new mutants at generation " << pop.gen() << " because all loci have existing mutants." << endl;
+					if (!indexed) {
+						if (!index.valid || index.added > index.scanned + 1024) {
+							indexMutants(pop, index);
+							rebuilt = true;
 						}
+						indexed = true;
+					}
+					OccupancyIndex & mutants = index.regions[ch];
+					// sites of lost or reverted mutants are released when the
+					// index is rebuilt
+					if (!rebuilt && mutants.vacant() == 0) {
+						indexMutants(pop, index);
+						rebuilt = true;
 					}
-					if (!ok && mutants.find(mutLoc) != mutants.end()) {
-						size_t newLoc = locateVacantLocus(pop, ranges[ch][0], ranges[ch][1], mutants);
+					if (mutants.occupied(mutLoc)) {
+						size_t newLoc = locateVacantLocus(pop, mutants);
 						// nothing is found
 						if (out)
 							(*out)	<< pop.gen() << '\t' << mutLoc << '\t' << indIndex
@@ -471,7 +763,8 @@ bool MutSpaceMutator::apply(Population & pop) const
 						}
 						// if there is no existing mutant, new mutant is allowed
 					}
-					mutants.insert(mutLoc);
+					mutants.occupy(mutLoc);
+					++index.added;
 				}
 				GenoIterator geno = ind.genoBegin(p, ch);
 				size_t nLoci = pop.numLoci(ch);
@@ -92,6 +92,112 @@ public:
 
 };
 
+
+/** CPPONLY A table of mutants in the mutational space. Properties of mutants
+ *  (location, generation at which the mutant is introduced, selection and
+ *  dominance coefficients, and number of carrying haplotypes when the table
+ *  is last collected) are saved in separate arrays indexed by compact
+ *  mutation IDs, which are assigned to mutants in the order they are added.
+ *  Mutants that are lost from the population are removed and IDs are
+ *  reassigned by function \c collect().
+ */
+class MutationTable
+{
+public:
+	MutationTable() : m_loc(), m_gen(), m_effect(), m_dominance(), m_count(),
+		m_index(), m_collected(0)
+	{
+	}
+
+
+	/// number of mutants in the table
+	size_t size() const
+	{
+		return m_loc.size();
+	}
+
+
+	/// ID of mutant at location \e loc, or \c InvalidValue if not in table
+	size_t find(size_t loc) const
+	{
+		MutIndex::const_iterator it = m_index.find(loc);
+		return it == m_index.end() ? InvalidValue : it->second;
+	}
+
+
+	/// add a mutant and return its ID
+	size_t add(size_t loc, ULONG gen, double effect, double dominance);
+
+	size_t location(size_t id) const
+	{
+		return m_loc[id];
+	}
+
+
+	ULONG gen(size_t id) const
+	{
+		return m_gen[id];
+	}
+
+
+	double effect(size_t id) const
+	{
+		return m_effect[id];
+	}
+
+
+	double dominance(size_t id) const
+	{
+		return m_dominance[id];
+	}
+
+
+	/// number of haplotypes with the mutant when the table was last collected
+	size_t count(size_t id) const
+	{
+		return m_count[id];
+	}
+
+
+	/// return \c true if half of the mutants might have been lost since
+	/// the table was last collected
+	bool needsCollection() const
+	{
+		return m_loc.size() > 2 * m_collected + 1024;
+	}
+
+
+	/** Count haplotypes of the present generation of \e pop that carry
+	 *  each mutant, and remove mutants that are no longer in \e pop.
+	 *  Mutant IDs are reassigned. Return the number of removed mutants.
+	 */
+	size_t collect(Population & pop);
+
+private:
+#  if TR1_SUPPORT == 0
+	typedef std::map<size_t, size_t> MutIndex;
+#  else
+	typedef std::tr1::unordered_map<size_t, size_t> MutIndex;
+#  endif
+
+	vectoru m_loc;
+
+	vectoru m_gen;
+
+	vectorf m_effect;
+
+	vectorf m_dominance;
+
+	vectoru m_count;
+
+	/// location to mutant ID
+	MutIndex m_index;
+
+	/// number of mutants after last collection
+	size_t m_collected;
+};
+
+
 /** This selector assumes that alleles are mutant locations in the mutational
  *  space and assign fitness values to them according to a random distribution.
  *  The overall individual fitness is determined by either an additive, an
@@ -128,7 +234,7 @@ public:
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = stringList("fitness")) :
 		BaseSelector(output, begin, end, step, at, reps, subPops, infoFields),
-		m_selDist(selDist), m_mode(mode), m_selFactory(), m_additive(true)
+		m_selDist(selDist), m_mode(mode), m_mutations(), m_rep(0), m_gen(0), m_additive(true), m_hapFitness()
 	{
 		if (m_selDist.size() == 0) {
 			DBG_FAILIF(!m_selDist.func().isValid(), ValueError,
@@ -169,11 +275,55 @@ public:
 	/// CPPONLY
 	bool apply(Population & pop) const;
 
+	/// CPPONLY new mutants are collected and written by apply()
+	bool initIndKernel(Population & /* pop */, bool & /* parallel */) const
+	{
+		return false;
+	}
+
+
 	typedef std::pair<double, double> SelCoef;
 
+	/** Return a dictionary of mutants that have been assigned selection
+	 *  coefficients in population \e pop, which should be the population
+	 *  (replicate) to which this selector has been applied. Keys of the
+	 *  dictionary are locations of mutants and values are tuples
+	 *  <tt>(s, h, gen, count)</tt> where \c s and \c h are selection and
+	 *  dominance coefficients, \c gen is the generation at which the mutant
+	 *  is first seen, and \c count is the number of haplotypes of \e pop
+	 *  that carry the mutant. Mutants that are no longer in \e pop are
+	 *  removed from the table and will be assigned new selection
+	 *  coefficients if they are introduced again.
+	 */
+	PyObject * mutants(Population & pop) const;
+
+
 private:
+	/// use mutants of the replicate of \e pop
+	void useReplicate(Population & pop) const;
+
 	SelCoef getFitnessValue(size_t mutant) const;
 
+	/// selection and dominance coefficient of a mutant, which is
+	/// determined by getFitnessValue if the mutant is new
+	SelCoef selCoef(size_t mutant) const
+	{
+		const MutationTable & table = m_mutations[m_rep];
+		size_t id = table.find(mutant);
+
+		if (id == InvalidValue)
+			return getFitnessValue(mutant);
+		return SelCoef(table.effect(id), table.dominance(id));
+	}
+
+
+	/** Assign fitness to individuals using cached total selection
+	 *  coefficients of haplotypes. Only used for additive (h=0.5) mutants in
+	 *  ADDITIVE and EXPONENTIAL modes. Return \c false if a new mutant that
+	 *  is not additive is found.
+	 */
+	bool applyCachedFitness(Population & pop) const;
+
 
 	double randomSelAddFitness(GenoIterator it, GenoIterator it_end, bool maleChrX) const;
 
@@ -193,17 +343,38 @@ private:
 	int m_mode;
 	///
 #  if TR1_SUPPORT == 0
-	typedef std::map<unsigned int, SelCoef> SelMap;
 	typedef std::map<unsigned int, int> MutCounter;
 #  else
 	// this is faster than std::map
-	typedef std::tr1::unordered_map<size_t, SelCoef> SelMap;
 	typedef std::tr1::unordered_map<size_t, size_t> MutCounter;
 #  endif
-	mutable SelMap m_selFactory;
+	/// mutants of each replicate, because mutants are collected from, and
+	/// counted in, the population to which the selector is applied
+	mutable vector<MutationTable> m_mutations;
+	/// replicate and generation of the population to which the selector is applied
+	mutable size_t m_rep;
+	mutable ULONG m_gen;
 	mutable vectoru m_newMutants;
 	// whether or not all markers are additive.
 	mutable bool m_additive;
+
+	struct HapFitness
+	{
+		/// sorted mutants on the haplotype
+		vectora mutants;
+		/// sum of selection coefficients of the mutants
+		double sum;
+	};
+
+#  if TR1_SUPPORT == 0
+	typedef std::map<uint64_t, HapFitness> HapFitnessMap;
+#  else
+	typedef std::tr1::unordered_map<uint64_t, HapFitness> HapFitnessMap;
+#  endif
+	// sum of selection coefficients of haplotypes of each replicate, indexed
+	// by an order-independent signature of mutants on the haplotypes. Mutants
+	// are saved because different haplotypes can have the same signature.
+	mutable vector<HapFitnessMap> m_hapFitness;
 };
 
 
@@ -231,7 +402,10 @@ public:
 	 *  backward (1->0), 2 for relocated mutations, and 3 for ignored mutation
 	 *  because no vacent locus is available. The second mode  has the
 	 *  advantage that all mutants in the simulated population can be traced
-	 *  to a single mutation event. If the regions are reasonably wide and
+	 *  to a single mutation event. Existing mutants are indexed and the index
+	 *  is updated with new mutants across generations, so sites of mutants
+	 *  that have been lost or reverted might be treated as occupied until
+	 *  the index is rebuilt. If the regions are reasonably wide and
 	 *  mutation rates are low, these two mutation models should yield
 	 *  similar results.
 	 */
@@ -287,7 +461,30 @@ public:
 
 
 private:
-	size_t locateVacantLocus(Population & pop, size_t beg, size_t end, std::set<size_t> & mutants) const;
+	/// existing mutants of a replicate
+	struct MutantIndex
+	{
+		MutantIndex() : regions(), gen(0), valid(false), scanned(0), added(0)
+		{
+		}
+
+
+		/// occupied sites of each region
+		vector<OccupancyIndex> regions;
+		/// generation at which the index is last used
+		ULONG gen;
+		/// whether or not the index has been built
+		bool valid;
+		/// number of occupied sites when the index is built
+		size_t scanned;
+		/// number of sites occupied after the index is built
+		size_t added;
+	};
+
+	size_t locateVacantLocus(Population & pop, const OccupancyIndex & mutants) const;
+
+	/// build index of existing mutants of each region
+	void indexMutants(Population & pop, MutantIndex & index) const;
 
 private:
 	const double m_rate;
@@ -295,6 +492,10 @@ private:
 	const intMatrix m_ranges;
 
 	const int m_model;
+
+	/// existing mutants of each replicate, which are kept across generations
+	/// and updated with new mutants
+	mutable vector<MutantIndex> m_mutants;
 };
 
 
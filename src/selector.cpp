@@ -69,6 +69,21 @@ bool BaseSelector::apply(Population & pop) const
 }
 
 
+bool BaseSelector::initIndKernel(Population & pop, bool & parallel) const
+{
+	m_fitIdx = pop.infoIdx(this->infoField(0));
+	if (!parallelizable())
+		parallel = false;
+	return true;
+}
+
+
+void BaseSelector::applyIndKernel(Population & pop, RawIndIterator ind, int & /* err */) const
+{
+	ind->setInfo(indFitness(pop, ind), m_fitIdx);
+}
+
+
 double MapSelector::indFitness(Population & pop, RawIndIterator ind) const
 {
 	vectoru chromTypes;
@@ -121,7 +121,8 @@ public:
 	BaseSelector(const stringFunc & output = "", int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = stringList("fitness"))
-		: BaseOperator(output, begin, end, step, at, reps, subPops, infoFields)
+		: BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
+		m_fitIdx(0)
 	{
 	}
 
@@ -171,6 +172,12 @@ public:
 	}
 
 
+	/// CPPONLY
+	virtual bool initIndKernel(Population & pop, bool & parallel) const;
+
+	/// CPPONLY
+	void applyIndKernel(Population & pop, RawIndIterator ind, int & err) const;
+
 	/// HIDDEN
 	string describe(bool format = true) const
 	{
@@ -179,6 +186,9 @@ public:
 	}
 
 
+private:
+	/// index of the information field to save fitness
+	mutable size_t m_fitIdx;
 };
 
 
@@ -559,6 +569,13 @@ public:
 	/// CPPONLY
 	bool apply(Population & pop) const;
 
+	/// CPPONLY new genotypes are collected and written by apply()
+	bool initIndKernel(Population & /* pop */, bool & /* parallel */) const
+	{
+		return false;
+	}
+
+
 	typedef std::pair<size_t, vectora> LocGenotype;
 
 private:
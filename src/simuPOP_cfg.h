@@ -219,6 +219,7 @@ extern const unsigned long MaxRandomNumber;
 
 #define PopSWIGType "simuPOP::Population *"
 #define IndSWIGType "simuPOP::Individual *"
+#define DemographicModelSWIGType "simuPOP::NativeDemographicModel *"
 
 // For genotypic structure
 enum Sex {
@@ -328,6 +329,12 @@ enum InitMode {
 	FROM_INFO_SIGNED = 116,
 };
 
+// type of information fields
+enum InfoType {
+	INFO_FLOAT64 = 121,
+	INFO_INT64 = 122,
+};
+
 #define DBG_CODE_LENGTH 21
 
 /// CPPONLY
@@ -188,6 +188,31 @@ string Simulator::describe(bool /* format */) const
 }
 
 
+/// allow caching of members of VSPs of populations during the lifetime of this object
+class VspCachingGuard
+{
+public:
+	VspCachingGuard(const vector<Population *> & pops) : m_pops(pops)
+	{
+		// individuals and variables might have been changed before evolve()
+		markIndModified();
+		for (size_t i = 0; i < m_pops.size(); ++i)
+			m_pops[i]->setVspCaching(true);
+	}
+
+
+	~VspCachingGuard()
+	{
+		for (size_t i = 0; i < m_pops.size(); ++i)
+			m_pops[i]->setVspCaching(false);
+	}
+
+
+private:
+	const vector<Population *> & m_pops;
+};
+
+
 vectoru Simulator::evolve(
                           const opList & initOps,
                           const opList & preOps,
@@ -224,6 +249,10 @@ vectoru Simulator::evolve(
 
 	initClock();
 
+	// files opened during evolution are written asynchronously if
+	// requested by setOptions(asyncOutput=...)
+	AsyncOutputGuard asyncOutput;
+
 	// appy pre-op, most likely initializer. Do not check if they are active
 	// or if they are successful
 	if (!initOps.empty())
@@ -231,6 +260,10 @@ vectoru Simulator::evolve(
 
 	elapsedTime("Start evolution.");
 
+	// members of VSPs are cached until they are changed by operators that
+	// are not read-only, mating, or Python functions.
+	VspCachingGuard vspCaching(m_pops);
+
 	while (1) {
 		// save refcount at the beginning
 #ifdef Py_REF_DEBUG
@@ -271,7 +304,18 @@ vectoru Simulator::evolve(
 						continue;
 
 					try {
-						if (!preOps[it]->apply(curPop)) {
+						// apply this and following operators in a single pass if possible
+						size_t fused = preOps.applyFused(it, curPop, curRep, curGen, end, activeReps);
+						if (fused > 0) {
+							markIndModified();
+							it += fused - 1;
+							elapsedTime("Applied fused operators.");
+							continue;
+						}
+						bool res = preOps[it]->apply(curPop);
+						if (!preOps[it]->readOnly())
+							markIndModified();
+						if (!res) {
 							DBG_DO(DBG_SIMULATOR, cerr << "Pre-mating Operator " << preOps[it]->describe() <<
 								" stops at replicate " << curRep << endl);
 
@@ -284,6 +328,7 @@ vectoru Simulator::evolve(
 						if (PyErr_CheckSignals())
 							throw StopEvolution("Evolution stopped due to keyboard interruption.");
 					} catch (StopEvolution e) {
+						markIndModified();
 						DBG_DO(DBG_SIMULATOR, cerr	<< "All replicates are stopped due to a StopEvolution exception raised by "
 							                        << "Pre-mating Operator " << preOps[it]->describe() <<
 							" stops at replicate " << curRep << endl);
@@ -293,6 +338,7 @@ vectoru Simulator::evolve(
 						numStopped = activeReps.size();
 						break;
 					} catch (RevertEvolution e) {
+						markIndModified();
 						long newCurGen = curPop.getVars().getVarAsInt("gen");
 						if (newCurGen != static_cast<long>(curPop.gen()))
 							curPop.setGen(newCurGen);
@@ -311,7 +357,10 @@ vectoru Simulator::evolve(
 			elapsedTime((boost::format("Start mating at generation %1%") % curGen).str());
 			// start mating:
 			try {
-				if (!const_cast<MatingScheme &>(matingScheme).mate(curPop, scratchPopulation())) {
+				bool res = const_cast<MatingScheme &>(matingScheme).mate(curPop, scratchPopulation());
+				// parents are replaced by offspring
+				markIndModified();
+				if (!res) {
 					DBG_DO(DBG_SIMULATOR, cerr << "Mating stops at replicate " << curRep << endl);
 
 					numStopped++;
@@ -322,6 +371,7 @@ vectoru Simulator::evolve(
 				if (PyErr_CheckSignals())
 					throw StopEvolution("Evolution stopped due to keyboard interruption.");
 			} catch (StopEvolution e) {
+				markIndModified();
 				DBG_DO(DBG_SIMULATOR, cerr	<< "All replicates are stopped due to a StopEvolution exception raised by "
 					                        << "During-mating Operator at replicate " << curRep << endl);
 
@@ -330,6 +380,7 @@ vectoru Simulator::evolve(
 				// does not execute post mating operator
 				break;
 			} catch (RevertEvolution e) {
+				markIndModified();
 				long newCurGen = curPop.getVars().getVarAsInt("gen");
 				if (newCurGen != static_cast<long>(curPop.gen()))
 					curPop.setGen(newCurGen);
@@ -348,7 +399,18 @@ vectoru Simulator::evolve(
 						continue;
 
 					try {
-						if (!postOps[it]->apply(curPop)) {
+						// apply this and following operators in a single pass if possible
+						size_t fused = postOps.applyFused(it, curPop, curRep, curGen, end, activeReps);
+						if (fused > 0) {
+							markIndModified();
+							it += fused - 1;
+							elapsedTime("Applied fused operators.");
+							continue;
+						}
+						bool res = postOps[it]->apply(curPop);
+						if (!postOps[it]->readOnly())
+							markIndModified();
+						if (!res) {
 							DBG_DO(DBG_SIMULATOR, cerr << "Post-mating Operator " + postOps[it]->describe() +
 								" stops at replicate " << curRep << endl);
 							numStopped++;
@@ -359,6 +421,7 @@ vectoru Simulator::evolve(
 						if (PyErr_CheckSignals())
 							throw StopEvolution("Evolution stopped due to keyboard interruption.");
 					} catch (StopEvolution e) {
+						markIndModified();
 						DBG_DO(DBG_SIMULATOR, cerr	<< "All replicates are stopped due to a StopEvolution exception raised by "
 							                        << "Post-mating Operator " + postOps[it]->describe() +
 							" stops at replicate " << curRep << endl);
@@ -369,6 +432,7 @@ vectoru Simulator::evolve(
 						// does not run the rest of the post-mating operators.
 						break;
 					} catch (RevertEvolution e) {
+						markIndModified();
 						long newCurGen = curPop.getVars().getVarAsInt("gen");
 						if (newCurGen != static_cast<long>(curPop.gen()))
 							curPop.setGen(newCurGen);
@@ -389,6 +453,9 @@ vectoru Simulator::evolve(
 		checkRefCount();
 #endif
 
+		// hand output of this generation to background writers
+		flushOutput(false);
+
 		--gens;
 		//
 		//   start 0, gen = 2
@@ -407,6 +474,7 @@ vectoru Simulator::evolve(
 
 	// close every opened file (including append-cross-evolution ones)
 	ostreamManager().closeAll();
+	flushOutput(true);
 	cleanupCircularRefs();
 	return evolvedGens;
 }
@@ -427,7 +495,10 @@ bool Simulator::apply(const opList & ops)
 
 			try {
 				ops[it]->apply(curPop);
+				if (!ops[it]->readOnly())
+					markIndModified();
 			} catch (RevertEvolution e) {
+				markIndModified();
 				//
 			}
 			elapsedTime("Applied " + ops[it]->describe());
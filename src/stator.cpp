@@ -210,6 +210,31 @@ bool InfoEval::apply(Population & pop) const
 	subPopList::const_iterator sp = subPops.begin();
 	subPopList::const_iterator spEnd = subPops.end();
 
+	// an expression that returns values of a fixed type can be evaluated
+	// without Python, which reads information fields as floating point numbers
+	if (m_expr.stmts().empty() && !pop.hasIntInfoFields() &&
+	    m_native.bind(pop.infoFields(), pop.dict()) && m_native.hasFixedType()) {
+		int err = 0;
+		for ( ; sp != spEnd; ++sp) {
+			pop.activateVirtualSubPop(*sp, true);
+			IndIterator ind = pop.indIterator(sp->subPop());
+			for (; ind.valid(); ++ind) {
+				double res = m_native.evaluate(ind->infoBegin(), ind->sex(), ind->affected(), err);
+				if (err != 0) {
+					pop.deactivateVirtualSubPop(sp->subPop());
+					throw RuntimeError("Evalulation of expression '" + m_expr.expr() + "' failed");
+				}
+				if (!this->noOutput()) {
+					ostream & out = this->getOstream(pop.dict());
+					out << m_native.valueAsString(res);
+					this->closeOstream();
+				}
+			}
+			pop.deactivateVirtualSubPop(sp->subPop());
+		}
+		return true;
+	}
+
 	for ( ; sp != spEnd; ++sp) {
 		pop.activateVirtualSubPop(*sp);
 		IndIterator ind = const_cast<Population &>(pop).indIterator(sp->subPop());
@@ -228,12 +253,40 @@ bool InfoEval::apply(Population & pop) const
 }
 
 
+bool InfoEval::bindDuringMating(Population & pop, Population & offPop) const
+{
+	// population variables can only be changed by Python functions during
+	// mating, and individuals are always marked modified after mating
+	if (m_boundDict == pop.dict() && m_boundStru == offPop.genoStruIdx() &&
+	    m_boundCount == indModificationCount())
+		return m_bound;
+	m_bound = m_native.bind(offPop.infoFields(), pop.dict());
+	m_boundDict = pop.dict();
+	m_boundStru = offPop.genoStruIdx();
+	m_boundCount = indModificationCount();
+	return m_bound;
+}
+
+
 bool InfoEval::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
                                  Individual * /* dad */, Individual * /* mom */) const
 {
 	// if offspring does not belong to subPops, do nothing, but does not fail.
 	if (!applicableToAllOffspring() && !applicableToOffspring(offPop, offspring))
 		return true;
+	if (m_expr.stmts().empty() && !offPop.hasIntInfoFields() &&
+	    bindDuringMating(pop, offPop) && m_native.hasFixedType()) {
+		int err = 0;
+		double res = m_native.evaluate(offspring->infoBegin(), offspring->sex(), offspring->affected(), err);
+		if (err != 0)
+			throw RuntimeError("Evalulation of expression '" + m_expr.expr() + "' failed");
+		if (!this->noOutput()) {
+			ostream & out = this->getOstream(pop.dict());
+			out << m_native.valueAsString(res);
+			this->closeOstream();
+		}
+		return true;
+	}
 	string res = evalInfo(&*offspring, pop.dict());
 
 	if (!this->noOutput()) {
@@ -257,47 +310,49 @@ bool InfoExec::apply(Population & pop) const
 	subPopList subPops = applicableSubPops(pop);
 
 	simpleStmt::OperationType oType = m_simpleStmt.operation();
-	string oVar = m_simpleStmt.var();
-	double oValue = m_simpleStmt.value();
-	size_t oVarIdx = 0;
 
 	if (oType != simpleStmt::NoOperation)
-		oVarIdx = pop.infoIdx(oVar);
+		m_varIdx = pop.infoIdx(m_simpleStmt.var());
 
 	subPopList::const_iterator sp = subPops.begin();
 	subPopList::const_iterator spEnd = subPops.end();
+
+	// statements that only involve numbers can be executed without Python,
+	// and in parallel because no Python object is touched
+	if (oType == simpleStmt::NoOperation && !pop.hasIntInfoFields() &&
+	    m_native.bind(pop.infoFields(), pop.dict())) {
+		int err = 0;
+		for ( ; sp != spEnd; ++sp) {
+			pop.activateVirtualSubPop(*sp);
+			if (numThreads() > 1) {
+#pragma omp parallel reduction(+ : err)
+				{
+#ifdef _OPENMP
+					IndIterator ind = pop.indIterator(sp->subPop(), omp_get_thread_num());
+					for (; ind.valid(); ++ind)
+						m_native.evaluate(ind->infoBegin(), ind->sex(), ind->affected(), err);
+#endif
+				}
+			} else {
+				IndIterator ind = pop.indIterator(sp->subPop());
+				for (; ind.valid(); ++ind)
+					m_native.evaluate(ind->infoBegin(), ind->sex(), ind->affected(), err);
+			}
+			pop.deactivateVirtualSubPop(sp->subPop());
+			if (err != 0)
+				throw RuntimeError("Evalulation of statements '" + m_expr.stmts() + "' failed");
+		}
+		return true;
+	}
+
 	for ( ; sp != spEnd; ++sp) {
 		pop.activateVirtualSubPop(*sp);
 		IndIterator ind = const_cast<Population &>(pop).indIterator(sp->subPop());
 		for (; ind.valid(); ++ind) {
-			switch (oType) {
-			case simpleStmt::NoOperation:
+			if (oType == simpleStmt::NoOperation)
 				evalInfo(&*ind, pop.dict());
-				break;
-			case simpleStmt::Assignment:
-				ind->setInfo(oValue, oVarIdx);
-				break;
-			case simpleStmt::Increment:
-				ind->setInfo(ind->info(oVarIdx) + oValue, oVarIdx);
-				break;
-			case simpleStmt::Decrement:
-				ind->setInfo(ind->info(oVarIdx) - oValue, oVarIdx);
-				break;
-			case simpleStmt::MultipliedBy:
-				ind->setInfo(ind->info(oVarIdx) * oValue, oVarIdx);
-				break;
-			case simpleStmt::SetSex:
-				ind->setInfo(ind->sex(), oVarIdx);
-				break;
-			case simpleStmt::SetAffected:
-				ind->setInfo(ind->affected(), oVarIdx);
-				break;
-			case simpleStmt::SetUnaffected:
-				ind->setInfo(!ind->affected(), oVarIdx);
-				break;
-			default:
-				throw RuntimeError("Incorrect operation type");
-			}
+			else
+				execSimpleStmt(*ind);
 		}
 		pop.deactivateVirtualSubPop(sp->subPop());
 	}
@@ -307,12 +362,77 @@ bool InfoExec::apply(Population & pop) const
 }
 
 
+void InfoExec::execSimpleStmt(Individual & ind) const
+{
+	double oValue = m_simpleStmt.value();
+
+	switch (m_simpleStmt.operation()) {
+	case simpleStmt::Assignment:
+		ind.setInfo(oValue, m_varIdx);
+		break;
+	case simpleStmt::Increment:
+		ind.setInfo(ind.info(m_varIdx) + oValue, m_varIdx);
+		break;
+	case simpleStmt::Decrement:
+		ind.setInfo(ind.info(m_varIdx) - oValue, m_varIdx);
+		break;
+	case simpleStmt::MultipliedBy:
+		ind.setInfo(ind.info(m_varIdx) * oValue, m_varIdx);
+		break;
+	case simpleStmt::SetSex:
+		ind.setInfo(ind.sex(), m_varIdx);
+		break;
+	case simpleStmt::SetAffected:
+		ind.setInfo(ind.affected(), m_varIdx);
+		break;
+	case simpleStmt::SetUnaffected:
+		ind.setInfo(!ind.affected(), m_varIdx);
+		break;
+	default:
+		throw RuntimeError("Incorrect operation type");
+	}
+}
+
+
+bool InfoExec::initIndKernel(Population & pop, bool & /* parallel */) const
+{
+	// statements that have to be executed by Python cannot be fused
+	if (m_simpleStmt.operation() == simpleStmt::NoOperation)
+		return !pop.hasIntInfoFields() && m_native.bind(pop.infoFields(), pop.dict());
+	m_varIdx = pop.infoIdx(m_simpleStmt.var());
+	return true;
+}
+
+
+void InfoExec::applyIndKernel(Population & /* pop */, RawIndIterator ind, int & err) const
+{
+	if (m_simpleStmt.operation() == simpleStmt::NoOperation)
+		m_native.evaluate(ind->infoBegin(), ind->sex(), ind->affected(), err);
+	else
+		execSimpleStmt(*ind);
+}
+
+
+void InfoExec::finishIndKernel(Population & /* pop */, int err) const
+{
+	if (err != 0)
+		throw RuntimeError("Evalulation of statements '" + m_expr.stmts() + "' failed");
+}
+
+
 bool InfoExec::applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
                                  Individual * /* dad */, Individual * /* mom */) const
 {
 	// if offspring does not belong to subPops, do nothing, but does not fail.
 	if (!applicableToAllOffspring() && !applicableToOffspring(offPop, offspring))
 		return true;
+	if (!offPop.hasIntInfoFields() && bindDuringMating(pop, offPop)) {
+		int err = 0;
+		m_native.evaluate(offspring->infoBegin(), offspring->sex(), offspring->affected(), err);
+		if (err != 0)
+			throw RuntimeError("Evalulation of statements '" + m_expr.stmts() + "' failed");
+		return true;
+	}
 	evalInfo(&*offspring, pop.dict());
 	clearVars(pop);
 	return true;
@@ -553,20 +673,26 @@ bool statNumOfMales::apply(Population & pop) const
 		size_t maleCnt = 0;
 		size_t femaleCnt = 0;
 		size_t totalCnt = 0;
-		pop.activateVirtualSubPop(*sp);
+		pop.activateVirtualSubPop(*sp, true);
 
+		if (!pop.hasActivatedVirtualSubPop(sp->subPop())) {
+			maleCnt = Population::countBits(pop.maleBits(sp->subPop()), pop.subPopBegin(sp->subPop()),
+				pop.subPopEnd(sp->subPop()));
+			femaleCnt = pop.subPopSize(sp->subPop()) - maleCnt;
+		} else {
 #pragma omp parallel reduction (+ : maleCnt,femaleCnt) if(numThreads() > 1)
-		{
+			{
 #ifdef _OPENMP
-			IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
+				IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
 #else
-			IndIterator it = pop.indIterator(sp->subPop());
+				IndIterator it = pop.indIterator(sp->subPop());
 #endif
-			for (; it.valid(); ++it)
-				if (it->sex() == MALE)
-					maleCnt++;
-				else
-					femaleCnt++;
+				for (; it.valid(); ++it)
+					if (it->sex() == MALE)
+						maleCnt++;
+					else
+						femaleCnt++;
+			}
 		}
 
 		pop.deactivateVirtualSubPop(sp->subPop());
@@ -640,20 +766,26 @@ bool statNumOfAffected::apply(Population & pop) const
 		size_t affectedCnt = 0;
 		size_t unaffectedCnt = 0;
 		size_t totalCnt = 0;
-		pop.activateVirtualSubPop(*sp);
+		pop.activateVirtualSubPop(*sp, true);
 
+		if (!pop.hasActivatedVirtualSubPop(sp->subPop())) {
+			affectedCnt = Population::countBits(pop.affectedBits(sp->subPop()), pop.subPopBegin(sp->subPop()),
+				pop.subPopEnd(sp->subPop()));
+			unaffectedCnt = pop.subPopSize(sp->subPop()) - affectedCnt;
+		} else {
 #pragma omp parallel reduction (+ : affectedCnt,unaffectedCnt) if(numThreads() > 1)
-		{
+			{
 #ifdef _OPENMP
-			IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
+				IndIterator it = pop.indIterator(sp->subPop(), omp_get_thread_num());
 #else
-			IndIterator it = pop.indIterator(sp->subPop());
+				IndIterator it = pop.indIterator(sp->subPop());
 #endif
-			for (; it.valid(); ++it)
-				if (it->affected())
-					affectedCnt++;
-				else
-					unaffectedCnt++;
+				for (; it.valid(); ++it)
+					if (it->affected())
+						affectedCnt++;
+					else
+						unaffectedCnt++;
+			}
 		}
 
 		pop.deactivateVirtualSubPop(sp->subPop());
@@ -739,7 +871,7 @@ bool statNumOfSegSites::apply(Population & pop) const
 	for (; sp != spEnd; ++sp) {
 		std::set<size_t> fixedSites;
 		std::set<size_t> segSites;
-		pop.activateVirtualSubPop(*sp);
+		pop.activateVirtualSubPop(*sp, true);
 
 		// go through all loci
 #ifdef MUTANTALLELE
@@ -901,7 +1033,7 @@ bool statNumOfMutants::apply(Population & pop) const
 	subPopList::const_iterator spEnd = subPops.end();
 	for ( ; sp != spEnd; ++sp) {
 		size_t mutantCount = 0;
-		pop.activateVirtualSubPop(*sp);
+		pop.activateVirtualSubPop(*sp, true);
 		IndIterator ind = pop.indIterator(sp->subPop());
 		for (; ind.valid(); ++ind) {
 			GenoIterator it = ind->genoBegin();
@@ -997,7 +1129,7 @@ bool statAlleleFreq::apply(Population & pop) const
 		if (m_vars.contains(AlleleFreq_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, AlleleFreq_String, m_suffix));
 
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 #ifdef MUTANTALLELE
 		/* the following counts alleles for all loci all at once and tend to
 		   use more memory than other modules (which counts loci one by one). In
@@ -1290,7 +1422,7 @@ bool statHeteroFreq::apply(Population & pop) const
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
 	for (; it != itEnd; ++it) {
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		uintDict heteroCnt;
 		uintDict homoCnt;
@@ -1467,7 +1599,7 @@ bool statGenoFreq::apply(Population & pop) const
 		if (m_vars.contains(GenotypeFreq_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, GenotypeFreq_String, m_suffix));
 
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 #pragma omp parallel for if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(loci.size()); ++idx) {
@@ -1622,7 +1754,7 @@ bool statHaploFreq::apply(Population & pop) const
 		if (m_vars.contains(HaplotypeFreq_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, HaplotypeFreq_String, m_suffix));
 
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 #pragma omp parallel for if(numThreads() > 1)
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(m_loci.size()); ++idx) {
@@ -1781,7 +1913,7 @@ bool statHaploHomoFreq::apply(Population & pop) const
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
 	for (; it != itEnd; ++it) {
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		tupleDict heteroCnt;
 		tupleDict homoCnt;
@@ -1979,6 +2111,54 @@ string statInfo::describe(bool /* format */) const
 }
 
 
+// sum, sum of squares, max and min of n values starting from col, with
+// neighboring values step doubles apart.
+static double columnSum(const double * col, size_t step, size_t n)
+{
+	double sum = 0;
+	ssize_t cnt = static_cast<ssize_t>(n);
+
+#pragma omp parallel for reduction(+ : sum) if(numThreads() > 1)
+	for (ssize_t i = 0; i < cnt; ++i)
+		sum += col[i * step];
+	return sum;
+}
+
+
+static double columnSumOfSquares(const double * col, size_t step, size_t n)
+{
+	double sum = 0;
+	ssize_t cnt = static_cast<ssize_t>(n);
+
+#pragma omp parallel for reduction(+ : sum) if(numThreads() > 1)
+	for (ssize_t i = 0; i < cnt; ++i)
+		sum += col[i * step] * col[i * step];
+	return sum;
+}
+
+
+static double columnMax(const double * col, size_t step, size_t n)
+{
+	double val = col[0];
+
+	for (size_t i = 1; i < n; ++i)
+		if (val < col[i * step])
+			val = col[i * step];
+	return val;
+}
+
+
+static double columnMin(const double * col, size_t step, size_t n)
+{
+	double val = col[0];
+
+	for (size_t i = 1; i < n; ++i)
+		if (val > col[i * step])
+			val = col[i * step];
+	return val;
+}
+
+
 bool statInfo::apply(Population & pop) const
 {
 	if (m_sumOfInfo.empty() && m_meanOfInfo.empty() && m_varOfInfo.empty()
@@ -2032,39 +2212,63 @@ bool statInfo::apply(Population & pop) const
 		vectorf maxVal(0);
 		vectorf minVal(0);
 
-		pop.activateVirtualSubPop(*sp);
+		pop.activateVirtualSubPop(*sp, true);
 
-		IndIterator it = pop.indIterator(sp->subPop());
 		size_t indCnt = 0;
-		for (; it.valid(); ++it, ++indCnt) {
-			for (size_t i = 0; i < numSumFld; ++i)
-				sumVal[i] += it->info(sumOfInfo[i]);
-			for (size_t i = 0; i < numMeanFld; ++i) {
-				meanSumVal[i] += it->info(meanOfInfo[i]);
-				meanNumVal[i]++;
-			}
-			for (size_t i = 0; i < numVarFld; ++i) {
-				double val = it->info(varOfInfo[i]);
-				varSumVal[i] += val;
-				varSum2Val[i] += val * val;
-				varNumVal[i]++;
-			}
-			if (maxVal.empty()) {
-				for (size_t i = 0; i < numMaxFld; ++i)
-					maxVal.push_back(it->info(maxOfInfo[i]));
-			} else {
-				for (size_t i = 0; i < numMaxFld; ++i) {
-					if (maxVal[i] < it->info(maxOfInfo[i]))
-						maxVal[i] = it->info(maxOfInfo[i]);
+		if (!sp->isVirtual() && pop.indOrdered() && !pop.hasIntInfoFields()) {
+			// scan each field as a strided column of the information array
+			indCnt = pop.subPopSize(sp->subPop());
+			if (indCnt > 0) {
+				size_t step = pop.infoSize();
+				for (size_t i = 0; i < numSumFld; ++i)
+					sumVal[i] = columnSum(pop.infoColumn(sumOfInfo[i], sp->subPop()), step, indCnt);
+				for (size_t i = 0; i < numMeanFld; ++i) {
+					meanSumVal[i] = columnSum(pop.infoColumn(meanOfInfo[i], sp->subPop()), step, indCnt);
+					meanNumVal[i] = indCnt;
 				}
-			}
-			if (minVal.empty()) {
+				for (size_t i = 0; i < numVarFld; ++i) {
+					const double * col = pop.infoColumn(varOfInfo[i], sp->subPop());
+					varSumVal[i] = columnSum(col, step, indCnt);
+					varSum2Val[i] = columnSumOfSquares(col, step, indCnt);
+					varNumVal[i] = indCnt;
+				}
+				for (size_t i = 0; i < numMaxFld; ++i)
+					maxVal.push_back(columnMax(pop.infoColumn(maxOfInfo[i], sp->subPop()), step, indCnt));
 				for (size_t i = 0; i < numMinFld; ++i)
-					minVal.push_back(it->info(minOfInfo[i]));
-			} else {
-				for (size_t i = 0; i < numMinFld; ++i) {
-					if (minVal[i] > it->info(minOfInfo[i]))
-						minVal[i] = it->info(minOfInfo[i]);
+					minVal.push_back(columnMin(pop.infoColumn(minOfInfo[i], sp->subPop()), step, indCnt));
+			}
+		} else {
+			IndIterator it = pop.indIterator(sp->subPop());
+			for (; it.valid(); ++it, ++indCnt) {
+				for (size_t i = 0; i < numSumFld; ++i)
+					sumVal[i] += it->info(sumOfInfo[i]);
+				for (size_t i = 0; i < numMeanFld; ++i) {
+					meanSumVal[i] += it->info(meanOfInfo[i]);
+					meanNumVal[i]++;
+				}
+				for (size_t i = 0; i < numVarFld; ++i) {
+					double val = it->info(varOfInfo[i]);
+					varSumVal[i] += val;
+					varSum2Val[i] += val * val;
+					varNumVal[i]++;
+				}
+				if (maxVal.empty()) {
+					for (size_t i = 0; i < numMaxFld; ++i)
+						maxVal.push_back(it->info(maxOfInfo[i]));
+				} else {
+					for (size_t i = 0; i < numMaxFld; ++i) {
+						if (maxVal[i] < it->info(maxOfInfo[i]))
+							maxVal[i] = it->info(maxOfInfo[i]);
+					}
+				}
+				if (minVal.empty()) {
+					for (size_t i = 0; i < numMinFld; ++i)
+						minVal.push_back(it->info(minOfInfo[i]));
+				} else {
+					for (size_t i = 0; i < numMinFld; ++i) {
+						if (minVal[i] > it->info(minOfInfo[i]))
+							minVal[i] = it->info(minOfInfo[i]);
+					}
 				}
 			}
 		}
@@ -2465,7 +2669,7 @@ bool statLD::apply(Population & pop) const
 				pop.getVars().removeVar(subPopVar_String(*it, spVars[i], m_suffix));
 		}
 
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		ALLELECNTLIST alleleCnt(loci.size());
 		HAPLOCNTLIST haploCnt(m_LD.size());
@@ -2785,7 +2989,7 @@ bool statAssociation::apply(Population & pop) const
 		GENOCNTLIST caseGenoCnt(nLoci);
 		GENOCNTLIST ctrlGenoCnt(nLoci);
 
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		IndIterator ind = pop.indIterator(it->subPop());
 		for (; ind.valid(); ++ind) {
@@ -3008,7 +3212,7 @@ bool statNeutrality::apply(Population & pop) const
 	subPopList::const_iterator itEnd = subPops.end();
 	size_t ply = pop.ploidy();
 	for (; it != itEnd; ++it) {
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		size_t spBegin = allHaplotypes.size();
 		// go through all individual
@@ -3234,7 +3438,7 @@ bool statStructure::apply(Population & pop) const
 		if (m_vars.contains(AlleleFreq_sp_String))
 			pop.getVars().removeVar(subPopVar_String(*it, AlleleFreq_String, m_suffix));
 
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		size_t spSize = 0;
 		for (size_t idx = 0; idx < loci.size(); ++idx) {
@@ -3406,7 +3610,7 @@ bool statHWE::apply(Population & pop) const
 	for (; it != itEnd; ++it) {
 		GENOCNTLIST genoCnt(nLoci);
 
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		IndIterator ind = pop.indIterator(it->subPop());
 		for (; ind.valid(); ++ind) {
@@ -3498,7 +3702,7 @@ bool statInbreeding::apply(Population & pop) const
 	subPopList::const_iterator it = subPops.begin();
 	subPopList::const_iterator itEnd = subPops.end();
 	for (; it != itEnd; ++it) {
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		uintDict IBDCnt;
 		uintDict IBSCnt;
@@ -3917,7 +4121,7 @@ bool statEffectiveSize::demographicEffectiveSize(Population & pop) const
 			subPopList::const_iterator itEnd = subPops.end();
 			for (; it != itEnd; ++it) {
 				vectoru parents_in_sp(0);
-				pop.activateVirtualSubPop(*it);
+				pop.activateVirtualSubPop(*it, true);
 				IndIterator ind = pop.indIterator(it->subPop());
 				// the individual has been in another vsp
 				for (; ind.valid(); ++ind) {
@@ -4144,7 +4348,7 @@ bool statEffectiveSize::temporalEffectiveSize(Population & pop) const
 			// save size
 			pop.getVars().setVar(subPopVar_String(*it, Ne_temporal_base_String, m_suffix) + "{'size'}", St);
 		}
-		pop.activateVirtualSubPop(*it);
+		pop.activateVirtualSubPop(*it, true);
 
 		// do not run in parallel because Pt is pushed in order
 		for (ssize_t idx = 0; idx < static_cast<ssize_t>(loci.size()); ++idx) {
@@ -4611,7 +4815,7 @@ bool statEffectiveSize::LDEffectiveSize(Population & pop) const
 			subPopList::const_iterator sp = subPops.begin();
 			subPopList::const_iterator spEnd = subPops.end();
 			for (size_t spIdx = 0; sp != spEnd; ++sp, ++spIdx) {
-				pop.activateVirtualSubPop(*sp);
+				pop.activateVirtualSubPop(*sp, true);
 
 				HOMOCNT homo_cnt_i;
 				HOMOCNT homo_cnt_j;
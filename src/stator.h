@@ -200,7 +200,9 @@ public:
 		const stringFunc & output = ">", int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr())
 		: BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
-		m_expr(expr, stmts), m_exposeInd(exposeInd), m_lastValues()
+		m_expr(expr, stmts), m_exposeInd(exposeInd), m_lastValues(),
+		m_native(expr, stmts, exposeInd), m_boundDict(NULL), m_boundStru(InvalidValue),
+		m_boundCount(InvalidValue), m_bound(false)
 	{
 		(void)usePopVars;  // this parameter is obsolete, use (void) to avoid a warning message
 		DBG_WARNIF(debug(DBG_COMPATIBILITY) && usePopVars, "WARNING: parameter usePopVars is obsolete.");
@@ -234,6 +236,10 @@ protected:
 
 	void clearVars(Population & pop) const;
 
+	/// bind m_native to information fields of \e offPop and variables of
+	/// \e pop, unless it is already bound to them during the same mating
+	bool bindDuringMating(Population & pop, Population & offPop) const;
+
 	/// expression to evaluate
 	const Expression m_expr;
 
@@ -242,6 +248,16 @@ protected:
 	/// if the next individual holds the same value at an information field
 	/// existing variable will not be set again.
 	mutable vectorf m_lastValues;
+
+	/// simple expressions and statements are evaluated without Python
+	const nativeExpr m_native;
+
+	/// population variables, genotypic structure and indModificationCount()
+	/// when m_native was last bound by bindDuringMating, and the result
+	mutable PyObject * m_boundDict;
+	mutable size_t m_boundStru;
+	mutable size_t m_boundCount;
+	mutable bool m_bound;
 };
 
 /** Operator \c InfoExec is similar to \c InfoEval in that it works at the
@@ -276,7 +292,7 @@ public:
 		const stringFunc & output = "", int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(), const stringList & infoFields = vectorstr())
 		: InfoEval(string(), stmts, usePopVars, exposeInd, output, begin, end, step, at, reps, subPops, infoFields),
-		m_simpleStmt(stmts, exposeInd)
+		m_simpleStmt(stmts, exposeInd), m_varIdx(0)
 	{
 	}
 
@@ -300,11 +316,25 @@ public:
 	bool applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
 		Individual * dad = NULL, Individual * mom = NULL) const;
 
+	/// CPPONLY
+	bool initIndKernel(Population & pop, bool & parallel) const;
+
+	/// CPPONLY
+	void applyIndKernel(Population & pop, RawIndIterator ind, int & err) const;
+
+	/// CPPONLY
+	void finishIndKernel(Population & pop, int err) const;
+
 	/// HIDDEN
 	string describe(bool format = true) const;
 
 private:
+	void execSimpleStmt(Individual & ind) const;
+
 	const simpleStmt m_simpleStmt;
+
+	/// index of the information field changed by a simple statement
+	mutable size_t m_varIdx;
 };
 
 
@@ -1574,6 +1604,13 @@ public:
 	string describe(bool format = true) const;
 
 
+	/// CPPONLY
+	bool readOnly() const
+	{
+		return true;
+	}
+
+
 	/// HIDDEN Deep copy of a \c Stat operator
 	virtual BaseOperator * clone() const
 	{
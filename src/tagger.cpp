@@ -59,7 +59,7 @@ bool IdTagger::apply(Population & pop) const
 	for (int depth = pop.ancestralGens(); depth >= 0; --depth) {
 		pop.useAncestralGen(depth);
 		for (size_t i = 0, iEnd = pop.popSize(); i < iEnd; ++i)
-			pop.individual(i).setInfo(static_cast<double>(g_indID++), idx);
+			pop.individual(i).setIdInfo(static_cast<size_t>(g_indID++), idx);
 	}
 	pop.useAncestralGen(curGen);
 	return true;
@@ -76,15 +76,15 @@ bool IdTagger::applyDuringMating(Population & pop, Population & offPop, RawIndIt
 
 	(void)dad;  // avoid a warning message in optimized modules
 	(void)mom;  // avoid a warning message in optimized modules
-	DBG_FAILIF(dad != NULL && dad->info(idx) >= g_indID, RuntimeError,
+	DBG_FAILIF(dad != NULL && dad->idInfo(idx) >= static_cast<size_t>(g_indID), RuntimeError,
 		"Paternal ID is larger than or equal to offspring ID (wrong startID?).");
-	DBG_FAILIF(mom != NULL && mom->info(idx) >= g_indID, RuntimeError,
+	DBG_FAILIF(mom != NULL && mom->idInfo(idx) >= static_cast<size_t>(g_indID), RuntimeError,
 		"Matental ID is larger than or equal to offspring ID (wrong startID?).");
 #ifdef _OPENMP
 	ATOMICLONG id = fetchAndIncrement(&g_indID);
-	offspring->setInfo(static_cast<long>(id), idx);
+	offspring->setIdInfo(static_cast<size_t>(id), idx);
 #else
-	offspring->setInfo(static_cast<long>(g_indID++), idx);
+	offspring->setIdInfo(static_cast<size_t>(g_indID++), idx);
 #endif
 	return true;
 }
@@ -312,7 +312,7 @@ string PedigreeTagger::describe(bool /* format */) const
 
 
 void PedigreeTagger::outputIndividual(ostream & out, const Individual * ind,
-                                      const vectorf & IDs) const
+                                      const vectoru & IDs) const
 {
 	// out << .... is very slow compared to the sprintf implementation.
 	//
@@ -322,11 +322,11 @@ void PedigreeTagger::outputIndividual(ostream & out, const Individual * ind,
 	char affChar = ind->affected() ? 'A' : 'U';
 
 	if (IDs.empty())
-		sprintf(buffer, SIZE_T_FORMAT " %c %c", toID(ind->info(m_idField)), sexChar, affChar);
+		sprintf(buffer, SIZE_T_FORMAT " %c %c", ind->idInfo(m_idField), sexChar, affChar);
 	else if (IDs.size() == 1)
-		sprintf(buffer, SIZE_T_FORMAT " " SIZE_T_FORMAT " %c %c", (unsigned long)toID(ind->info(m_idField)), toID(IDs[0]), sexChar, affChar);
+		sprintf(buffer, SIZE_T_FORMAT " " SIZE_T_FORMAT " %c %c", ind->idInfo(m_idField), IDs[0], sexChar, affChar);
 	else
-		sprintf(buffer, SIZE_T_FORMAT " " SIZE_T_FORMAT " " SIZE_T_FORMAT " %c %c", toID(ind->info(m_idField)), toID(IDs[0]), toID(IDs[1]), sexChar, affChar);
+		sprintf(buffer, SIZE_T_FORMAT " " SIZE_T_FORMAT " " SIZE_T_FORMAT " %c %c", ind->idInfo(m_idField), IDs[0], IDs[1], sexChar, affChar);
 	out << buffer;
 	// it is difficult to create buffers for the following, but we do not really care
 	// because writing information fields and genotype is rare.
@@ -354,6 +354,84 @@ void PedigreeTagger::outputIndividual(ostream & out, const Individual * ind,
 }
 
 
+// append the lowest bytes of value v to buffer, in little endian
+static inline void appendUInt(string & buffer, uint64_t v, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; ++i, v >>= 8)
+		buffer.push_back(static_cast<char>(v & 0xff));
+}
+
+
+void PedigreeTagger::outputBinaryIndividual(ostream & out, const Individual * ind,
+                                            const vectoru & IDs) const
+{
+	const vectorstr & fields = m_outputFields.elems();
+	const vectoru & loci = m_outputLoci.elems();
+	size_t numFields = m_outputFields.allAvail() ? ind->infoSize() : fields.size();
+	size_t numLoci = m_outputLoci.allAvail() ? ind->totNumLoci() : loci.size();
+	size_t pldy = ind->ploidy();
+
+	// records in a chunk have the same layout
+	if (m_layout[0] != IDs.size() || m_layout[1] != numFields || m_layout[2] != numLoci * pldy) {
+		flushRecords(out);
+		m_layout[0] = IDs.size();
+		m_layout[1] = numFields;
+		m_layout[2] = numLoci * pldy;
+	}
+	appendUInt(m_records, ind->idInfo(m_idField), 8);
+	for (size_t i = 0; i < IDs.size(); ++i)
+		appendUInt(m_records, IDs[i], 8);
+	m_records.push_back(static_cast<char>((ind->sex() == FEMALE ? 1 : 0) | (ind->affected() ? 2 : 0)));
+	for (size_t i = 0; i < numFields; ++i) {
+		double value = m_outputFields.allAvail() ? ind->info(i) : ind->info(fields[i]);
+		m_records.append(reinterpret_cast<const char *>(&value), sizeof(double));
+	}
+#ifdef BINARYALLELE
+	const size_t alleleBytes = 1;
+#else
+	const size_t alleleBytes = sizeof(Allele);
+#endif
+	for (size_t i = 0; i < numLoci; ++i)
+		for (size_t p = 0; p < pldy; ++p)
+			appendUInt(m_records, ind->allele(m_outputLoci.allAvail() ? i : loci[i], p), alleleBytes);
+	++m_numRecords;
+	if (m_records.size() + PEDIGREE_BINARY_HEADER_SIZE >= BGZF_BLOCK_SIZE)
+		flushRecords(out);
+}
+
+
+void PedigreeTagger::flushRecords(ostream & out) const
+{
+	if (m_numRecords == 0)
+		return;
+
+	string chunk(PEDIGREE_BINARY_MAGIC);
+	chunk.push_back(static_cast<char>(PEDIGREE_BINARY_VERSION));
+	chunk.push_back(static_cast<char>(m_layout[0]));
+#ifdef BINARYALLELE
+	chunk.push_back(static_cast<char>(1));
+#else
+	chunk.push_back(static_cast<char>(sizeof(Allele)));
+#endif
+	chunk.push_back(0);
+	appendUInt(chunk, m_layout[1], 4);
+	appendUInt(chunk, m_layout[2], 4);
+	appendUInt(chunk, m_numRecords, 4);
+	appendUInt(chunk, 0, 4);
+	chunk += m_records;
+	m_records.clear();
+	m_numRecords = 0;
+	// a chunk with long records can span several BGZF blocks
+	string block;
+	for (size_t start = 0; start < chunk.size(); start += BGZF_BLOCK_SIZE) {
+		if (!compressBgzfBlock(chunk.data() + start,
+				std::min(static_cast<size_t>(BGZF_BLOCK_SIZE), chunk.size() - start), block))
+			throw RuntimeError("Failed to compress binary pedigree records.");
+		out.write(block.data(), block.size());
+	}
+}
+
+
 bool PedigreeTagger::apply(Population & pop) const
 {
 	if (noOutput())
@@ -364,7 +442,7 @@ bool PedigreeTagger::apply(Population & pop) const
 
 	ostream & out = getOstream(pop.dict());
 	size_t is = infoSize();
-	vectorf IDs(is);
+	vectoru IDs(is);
 	vectoru idx(is);
 	for (size_t i = 0; i < infoSize(); ++i)
 		idx[i] = pop.infoIdx(infoField(i));
@@ -376,16 +454,22 @@ bool PedigreeTagger::apply(Population & pop) const
 		ConstRawIndIterator it = pop.rawIndBegin();
 		ConstRawIndIterator it_end = pop.rawIndEnd();
 		for (; it != it_end; ++it) {
-			size_t myID = toID(it->info(idIdx));
+			size_t myID = it->idInfo(idIdx);
 			idMap[myID] = 1;
 			for (size_t i = 0; i < is; ++i) {
-				IDs[i] = it->info(idx[i]);
-				if (idMap.find(toID(IDs[i])) == idMap.end())
+				IDs[i] = it->idInfo(idx[i]);
+				if (idMap.find(IDs[i]) == idMap.end())
 					IDs[i] = 0;
 			}
-			outputIndividual(out, &*it, IDs);
+			if (m_binary)
+				outputBinaryIndividual(out, &*it, IDs);
+			else
+				outputIndividual(out, &*it, IDs);
 		}
 	}
+	if (m_binary)
+		flushRecords(out);
+	closeOstream();
 	pop.useAncestralGen(curGen);
 	return true;
 }
@@ -403,29 +487,42 @@ bool PedigreeTagger::applyDuringMating(Population & pop, Population & offPop, Ra
 	size_t idIdx = pop.infoIdx(m_idField);
 	// record to one or two information fields
 	size_t is = infoSize();
-	vectorf IDs(is);
+	vectoru IDs(is);
 	if (is == 1) {
 		if (dad != NULL)
-			IDs[0] = dad->info(idIdx);
+			IDs[0] = dad->idInfo(idIdx);
 		else if (mom != NULL)
-			IDs[0] = mom->info(idIdx);
-		offspring->setInfo(IDs[0], pop.infoIdx(infoField(0)));
+			IDs[0] = mom->idInfo(idIdx);
+		offspring->setIdInfo(IDs[0], pop.infoIdx(infoField(0)));
 	} else if (is == 2) {
-		IDs[0] = dad == NULL ? 0 : dad->info(idIdx);
-		IDs[1] = mom == NULL ? 0 : mom->info(idIdx);
-		offspring->setInfo(IDs[0], pop.infoIdx(infoField(0)));
-		offspring->setInfo(IDs[1], pop.infoIdx(infoField(1)));
+		IDs[0] = dad == NULL ? 0 : dad->idInfo(idIdx);
+		IDs[1] = mom == NULL ? 0 : mom->idInfo(idIdx);
+		offspring->setIdInfo(IDs[0], pop.infoIdx(infoField(0)));
+		offspring->setIdInfo(IDs[1], pop.infoIdx(infoField(1)));
 	}
 
 	if (noOutput())
 		return true;
 
 	ostream & out = getOstream(pop.dict());
-	outputIndividual(out, &*offspring, IDs);
+	// binary records are written by finalizeDuringMating after all offspring
+	// of a subpopulation are produced
+	if (m_binary)
+		outputBinaryIndividual(out, &*offspring, IDs);
+	else
+		outputIndividual(out, &*offspring, IDs);
 	return true;
 }
 
 
+void PedigreeTagger::finalizeDuringMating(Population & pop) const
+{
+	if (m_numRecords == 0 || noOutput())
+		return;
+	flushRecords(getOstream(pop.dict()));
+}
+
+
 bool PyTagger::applyDuringMating(Population & /* pop */, Population & offPop, RawIndIterator offspring,
                                  Individual * dad, Individual * mom) const
 {
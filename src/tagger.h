@@ -392,6 +392,15 @@ public:
 	 *  will be ignored if only one parent is involved. This file format
 	 *  can be loaded using function \c loadPedigree.
 	 *
+	 *  If \e binary is set to \c True, the same information is written in
+	 *  a compact binary format with fixed-width IDs, sex and affection status
+	 *  packed in a byte, and raw values of information fields and alleles.
+	 *  Records are buffered and written in BGZF (blocked gzip) compressed
+	 *  blocks, so the file should be a real file (not a string or function)
+	 *  and can be decompressed by any gzip decompressor. Binary pedigree
+	 *  files are recognized and loaded by function \c loadPedigree without
+	 *  parsing text.
+	 *
 	 *  Because only offspring will be outputed, individuals in the top-most
 	 *  ancestral generation will not be outputed. This is usually not a
 	 *  problem because individuals who have offspring in the next generation
@@ -408,11 +417,13 @@ public:
 	 */
 	PedigreeTagger(const string & idField = "ind_id", const stringFunc & output = "",
 		const stringList & outputFields = vectorstr(), const uintList & outputLoci = vectoru(),
+		bool binary = false,
 		int begin = 0, int end = -1, int step = 1, const intList & at = vectori(),
 		const intList & reps = intList(), const subPopList & subPops = subPopList(),
 		const stringList & infoFields = stringList("father_id", "mother_id")) :
 		BaseOperator(output, begin, end, step, at, reps, subPops, infoFields),
-		m_idField(idField), m_outputFields(outputFields), m_outputLoci(outputLoci)
+		m_idField(idField), m_outputFields(outputFields), m_outputLoci(outputLoci),
+		m_binary(binary), m_records(), m_numRecords(0), m_layout(3, 0)
 	{
 	}
 
@@ -441,6 +452,8 @@ public:
 	bool applyDuringMating(Population & pop, Population & offPop, RawIndIterator offspring,
 		Individual * dad = NULL, Individual * mom = NULL) const;
 
+	/// CPPONLY write buffered binary records
+	void finalizeDuringMating(Population & pop) const;
 
 	/// CPPONLY
 	bool parallelizable() const
@@ -451,12 +464,31 @@ public:
 
 private:
 	void outputIndividual(ostream & out, const Individual * ind,
-		const vectorf & IDs) const;
+		const vectoru & IDs) const;
+
+	/// add a binary record to the buffer, which is written to \e out
+	/// when it is full.
+	void outputBinaryIndividual(ostream & out, const Individual * ind,
+		const vectoru & IDs) const;
+
+	/// write buffered binary records as a compressed chunk to \e out
+	void flushRecords(ostream & out) const;
 
 private:
 	const string m_idField;
 	stringList m_outputFields;
 	uintList m_outputLoci;
+
+	bool m_binary;
+
+	/// buffered binary records
+	mutable string m_records;
+
+	mutable size_t m_numRecords;
+
+	/// number of parental IDs, information fields and alleles of
+	/// buffered binary records
+	mutable vectoru m_layout;
 };
 
 
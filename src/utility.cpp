@@ -52,8 +52,21 @@ using std::fstream;
 using std::ifstream;
 using std::ofstream;
 
+// background writer threads for asynchronous output need C++11 threads
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1700)
+#  define ASYNC_OUTPUT
+#  include <thread>
+#  include <mutex>
+#  include <condition_variable>
+#  include <chrono>
+#  include <deque>
+#endif
+
 #include "boost_pch.hpp"
 
+// for BGZF compression
+#include "zlib.h"
+
 // for data type lociList
 #include "genoStru.h"
 
@@ -413,6 +426,21 @@ int simuPOP_getch(void)
 // thread number, global variable
 UINT g_numThreads;
 
+#ifdef ASYNC_OUTPUT
+// maximum number of bytes queued for each file. 0 means synchronous output.
+static size_t g_asyncBufferSize = 0;
+
+// number of active AsyncOutputGuard objects
+static int g_asyncSessions = 0;
+
+// statistics of asynchronous output, protected by g_asyncStatMutex because
+// bytes are counted by the writer threads.
+static std::mutex g_asyncStatMutex;
+static ULONG g_asyncBytesWritten = 0;
+static double g_asyncBlockedTime = 0;
+
+#endif
+
 // random number generator. a global variable.
 #ifdef _OPENMP
 #  if THREADPRIVATE_SUPPORT == 0
@@ -426,8 +454,18 @@ RNG * g_RNG;
 RNG g_RNG;
 #endif
 
-void setOptions(const int numThreads, const char * name, unsigned long seed)
+void setOptions(const int numThreads, const char * name, unsigned long seed,
+                long asyncOutput)
 {
+	if (asyncOutput >= 0) {
+#ifdef ASYNC_OUTPUT
+		g_asyncBufferSize = static_cast<size_t>(asyncOutput);
+#else
+		PARAM_FAILIF(asyncOutput > 0, RuntimeError,
+			"Asynchronous output is not supported by the compiler used to build this module.");
+#endif
+	}
+
 #ifdef _OPENMP
 	// if numThreads is zero, all threads will be used.
 	if (numThreads == 0) {
@@ -564,12 +602,132 @@ unsigned pow3(unsigned n)
 
 namespace simuPOP {
 
+#if PY_VERSION_HEX >= 0x03000000
+// convert items of type S in a strided buffer to out, in C order.
+template <typename S, typename T>
+void copyStridedBuffer(const Py_buffer & view, T * out)
+{
+	const char * buf = static_cast<const char *>(view.buf);
+
+	if (view.ndim == 0) {
+		S val;
+		memcpy(&val, buf, sizeof(S));
+		out[0] = static_cast<T>(val);
+		return;
+	}
+	const ssize_t cols = view.shape[view.ndim - 1];
+	const ssize_t colStride = view.strides[view.ndim - 1];
+	ssize_t rows = 1;
+	for (int d = 0; d < view.ndim - 1; ++d)
+		rows *= view.shape[d];
+	if (rows == 1) {
+#  pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t c = 0; c < cols; ++c) {
+			S val;
+			memcpy(&val, buf + c * colStride, sizeof(S));
+			out[c] = static_cast<T>(val);
+		}
+		return;
+	}
+#  pragma omp parallel for if(numThreads() > 1)
+	for (ssize_t r = 0; r < rows; ++r) {
+		// offset of the r-th row
+		ssize_t offset = 0;
+		ssize_t rem = r;
+		for (int d = view.ndim - 2; d >= 0; --d) {
+			offset += (rem % view.shape[d]) * view.strides[d];
+			rem /= view.shape[d];
+		}
+		const char * ptr = buf + offset;
+		T * row = out + r * cols;
+		for (ssize_t c = 0; c < cols; ++c, ptr += colStride) {
+			S val;
+			memcpy(&val, ptr, sizeof(S));
+			row[c] = static_cast<T>(val);
+		}
+	}
+}
+
+
+// Fill elems from an object that supports the buffer protocol (e.g. a numpy
+// array) without creating a Python object for each item. Return false if
+// obj does not support the buffer protocol.
+template <typename T>
+bool bufferToVector(PyObject * obj, vector<T> & elems, bool acceptFloat)
+{
+	if (!PyObject_CheckBuffer(obj))
+		return false;
+
+	Py_buffer view;
+	if (PyObject_GetBuffer(obj, &view, PyBUF_RECORDS_RO) < 0) {
+		PyErr_Clear();
+		return false;
+	}
+
+	// only native byte order is supported
+	const int one = 1;
+	const bool littleEndian = *reinterpret_cast<const char *>(&one) == 1;
+	const char * fmt = view.format == NULL ? "B" : view.format;
+	if (*fmt == '@' || *fmt == '=' || (*fmt == '<' && littleEndian) || ((*fmt == '>' || *fmt == '!') && !littleEndian))
+		++fmt;
+
+	size_t n = 1;
+	for (int d = 0; d < view.ndim; ++d)
+		n *= view.shape[d];
+	elems.resize(n);
+
+	bool ok = view.suboffsets == NULL && fmt[0] != '\0' && fmt[1] == '\0';
+	if (ok && n > 0) {
+		switch (fmt[0]) {
+		case 'b': copyStridedBuffer<signed char, T>(view, &elems[0]); break;
+		case 'B': copyStridedBuffer<unsigned char, T>(view, &elems[0]); break;
+		case '?': copyStridedBuffer<bool, T>(view, &elems[0]); break;
+		case 'h': copyStridedBuffer<short, T>(view, &elems[0]); break;
+		case 'H': copyStridedBuffer<unsigned short, T>(view, &elems[0]); break;
+		case 'i': copyStridedBuffer<int, T>(view, &elems[0]); break;
+		case 'I': copyStridedBuffer<unsigned int, T>(view, &elems[0]); break;
+		case 'l': copyStridedBuffer<long, T>(view, &elems[0]); break;
+		case 'L': copyStridedBuffer<unsigned long, T>(view, &elems[0]); break;
+		case 'q': copyStridedBuffer<long long, T>(view, &elems[0]); break;
+		case 'Q': copyStridedBuffer<unsigned long long, T>(view, &elems[0]); break;
+		case 'n': copyStridedBuffer<Py_ssize_t, T>(view, &elems[0]); break;
+		case 'N': copyStridedBuffer<size_t, T>(view, &elems[0]); break;
+		case 'f':
+			ok = acceptFloat;
+			if (ok)
+				copyStridedBuffer<float, T>(view, &elems[0]);
+			break;
+		case 'd':
+			ok = acceptFloat;
+			if (ok)
+				copyStridedBuffer<double, T>(view, &elems[0]);
+			break;
+		default:
+			ok = false;
+		}
+	}
+	string format = view.format == NULL ? "B" : view.format;
+	PyBuffer_Release(&view);
+	if (!ok)
+		throw ValueError("Unsupported array item type (format '" + format + "'). An array of "
+			+ (acceptFloat ? "integers or floating point numbers" : "integers")
+			+ " in native byte order is expected.");
+	return true;
+}
+
+
+#endif
+
 // additional types
 floatList::floatList(PyObject * obj) : m_elems()
 {
 	if (obj == NULL)
 		return;
 
+#if PY_VERSION_HEX >= 0x03000000
+	if (bufferToVector(obj, m_elems, true))
+		return;
+#endif
 	if (PyNumber_Check(obj))
 		m_elems.push_back(PyFloat_AsDouble(obj));
 	else if (PySequence_Check(obj)) {
@@ -732,10 +890,51 @@ intMatrix::intMatrix(PyObject * obj) : m_elems()
 }
 
 
-floatMatrix::floatMatrix(PyObject * obj) : m_elems()
+floatMatrix::floatMatrix(PyObject * obj) : m_elems(), m_sparse(false), m_columns()
 {
 	if (obj == NULL)
 		return;
+	// a list of dictionaries
+	if (PySequence_Check(obj) && PySequence_Size(obj) > 0) {
+		PyObject * item = PySequence_GetItem(obj, 0);
+		m_sparse = PyDict_Check(item);
+		Py_DECREF(item);
+	}
+	if (m_sparse) {
+		size_t numRows = PySequence_Size(obj);
+		m_elems.resize(numRows);
+		m_columns.resize(numRows);
+		for (size_t i = 0; i < numRows; ++i) {
+			PyObject * item = PySequence_GetItem(obj, i);
+			if (!PyDict_Check(item)) {
+				Py_DECREF(item);
+				throw ValueError("A list of dictionaries is expected for a sparse matrix.");
+			}
+			// sort by column index
+			map<size_t, double> row;
+			PyObject * key = NULL;
+			PyObject * value = NULL;
+			Py_ssize_t pos = 0;
+			while (PyDict_Next(item, &pos, &key, &value)) {
+				if (!PyNumber_Check(key) || !PyNumber_Check(value)) {
+					Py_DECREF(item);
+					throw ValueError("Column indexes and values of a sparse matrix should be numbers.");
+				}
+				long col = PyInt_AsLong(key);
+				if (col < 0) {
+					Py_DECREF(item);
+					throw ValueError("Column indexes of a sparse matrix should be non-negative.");
+				}
+				row[static_cast<size_t>(col)] = PyFloat_AsDouble(value);
+			}
+			Py_DECREF(item);
+			for (map<size_t, double>::iterator it = row.begin(); it != row.end(); ++it) {
+				m_columns[i].push_back(it->first);
+				m_elems[i].push_back(it->second);
+			}
+		}
+		return;
+	}
 	if (!PySequence_Check(obj)) {
 		cerr << "A list or a nested list of numbers is expected." << endl;
 		DBG_ASSERT(false, ValueError,
@@ -1066,6 +1265,85 @@ pyFunc::pyFunc(PyObject * func) : m_func(func), m_numArgs(0), m_circular_self(NU
 	Py_DECREF(code);
 }
 
+// number of times individuals might have been changed by Python functions
+static size_t g_indModificationCount = 0;
+
+// level of nested calls to Python functions
+static size_t g_pythonCallDepth = 0;
+
+// The counters are shared by all populations and can be changed by operators
+// applied to replicates in parallel, so they are always accessed atomically.
+static size_t readCounter(const size_t & counter)
+{
+	size_t value;
+
+#if defined(_OPENMP) && _OPENMP >= 201107
+#  pragma omp atomic read
+	value = counter;
+#else
+#  pragma omp critical(simuPOP_counter)
+	value = counter;
+#endif
+	return value;
+}
+
+
+static void increaseCounter(size_t & counter)
+{
+#if defined(_OPENMP) && _OPENMP >= 201107
+#  pragma omp atomic
+	++counter;
+#else
+#  pragma omp critical(simuPOP_counter)
+	++counter;
+#endif
+}
+
+
+static void decreaseCounter(size_t & counter)
+{
+#if defined(_OPENMP) && _OPENMP >= 201107
+#  pragma omp atomic
+	--counter;
+#else
+#  pragma omp critical(simuPOP_counter)
+	--counter;
+#endif
+}
+
+
+size_t indModificationCount()
+{
+	return readCounter(g_indModificationCount);
+}
+
+
+void markIndModified()
+{
+	increaseCounter(g_indModificationCount);
+}
+
+
+bool inPythonCall()
+{
+	return readCounter(g_pythonCallDepth) > 0;
+}
+
+
+PythonCallGuard::PythonCallGuard()
+{
+	increaseCounter(g_pythonCallDepth);
+	increaseCounter(g_indModificationCount);
+}
+
+
+PythonCallGuard::~PythonCallGuard()
+{
+	decreaseCounter(g_pythonCallDepth);
+	increaseCounter(g_indModificationCount);
+}
+
+
 void pyGenerator::set(PyObject * gen)
 {
 	Py_XDECREF(m_iterator);
@@ -1092,6 +1370,7 @@ void pyGenerator::set(PyObject * gen)
 
 PyObject * pyGenerator::next()
 {
+	PythonCallGuard guard;
 	PyObject * obj = PyIter_Next(m_iterator);
 
 #ifndef OPTIMIZED
@@ -1113,6 +1392,11 @@ uintList::uintList(PyObject * obj) : m_elems(), m_status(REGULAR)
 	else if (PyBool_Check(obj))
 		// accept True/False
 		m_status = obj == Py_True ? ALL_AVAIL : UNSPECIFIED;
+#if PY_VERSION_HEX >= 0x03000000
+	else if (bufferToVector(obj, m_elems, false))
+		// accept an array (e.g. a numpy array) of integers
+		return;
+#endif
 	else if (PyNumber_Check(obj)) {
 		// accept a number
 		m_elems.push_back(static_cast<UINT>(PyInt_AsLong(obj)));
@@ -2533,7 +2817,7 @@ void SharedVariables::from_pickle(const string & vars)
 // DO NOT OWN the dictionaries
 SharedVariables g_main_vars, g_module_vars;
 
-swig_type_info * g_swigPopType, * g_swigIndividual;
+swig_type_info * g_swigPopType, * g_swigIndividual, * g_swigDemographicModel;
 
 SharedVariables & mainVars()
 {
@@ -2577,6 +2861,16 @@ void * pyPopPointer(PyObject * obj)
 }
 
 
+void * pyDemographicModelPointer(PyObject * obj)
+{
+	void * ptr = 0;
+
+	if (g_swigDemographicModel == NULL || SWIG_Python_ConvertPtr(obj, &ptr, g_swigDemographicModel, 0) < 0)
+		return NULL;
+	return ptr;
+}
+
+
 string shorten(const string & val, size_t length)
 {
 	return (val.size() > length) ? val.substr(0, length) + "..." : val;
@@ -2655,6 +2949,7 @@ PyObject * Expression::evaluate() const
 	DBG_ASSERT(mainVars().dict() != NULL && m_locals != NULL,
 		ValueError, "Can not evalulate. Dictionary is empty!");
 
+	PythonCallGuard guard;
 	PyObject * res = NULL;
 	if (m_stmts != NULL) {
 #if PY_VERSION_HEX >= 0x03020000
@@ -2823,136 +3118,1478 @@ simpleStmt::simpleStmt(const string & stmt, const string & indVar) : m_var(""),
 }
 
 
-// Stream element, can be of different types
+// Native evaluation of simple expressions and statements
 
-StreamElem::StreamElem(const string & name, bool readable, bool realAppend, bool useString)
-	: m_filename(name)
+// kinds of tokens
+#define NATIVE_NUM   0
+#define NATIVE_NAME  1
+#define NATIVE_STR   2
+#define NATIVE_OP    3
+#define NATIVE_SEP   4
+#define NATIVE_END   5
+
+// a number is finite if it is neither an infinity nor a NaN
+static bool isFinite(double x)
 {
+	return x - x == 0;
+}
 
-	DBG_DO(DBG_UTILITY, cerr << "creating " << name << " with parameter " <<
-		readable << " " << realAppend << " " << useString << " " << endl);
 
-	if (useString) {
-		// existing file will be truncated...
-		m_stream = new stringstream(std::ios::in | std::ios::out);
-		m_type = SSTREAM;
-		m_append = false;
-	} else {                                                                          // no string, usual file
-		m_append = realAppend;
-		m_type = FSTREAM;
-		if (readable) {
-			if (realAppend)     // readable , append
-				m_stream = new fstream(name.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
-			else                // readable, ! append
-				// existing file will be truncated...
-				m_stream = new fstream(name.c_str(),  std::ios::in | std::ios::trunc | std::ios::out);
-		} else {
-			if (realAppend) {     // ! readable, append
-				m_stream = new ofstream(name.c_str(), std::ios::out | std::ios::app);
-				m_type = OFSTREAM;
-			} else                //  !readable, !append )
-				// existing file will be truncated...
-				m_stream = new fstream(name.c_str(),  std::ios::trunc | std::ios::out);
-		}
+// floor division and modulo of Python floats
+static double pyMod(double vx, double wx, int & err)
+{
+	if (wx == 0) {
+		++err;
+		return 0;
 	}
+	double mod = fmod(vx, wx);
+	if (mod != 0) {
+		if ((wx < 0) != (mod < 0))
+			mod += wx;
+	} else
+		mod = wx < 0 ? -0.0 : 0.0;
+	return mod;
+}
 
-	if (m_stream == NULL || !*m_stream)
-		throw ValueError("Can not open specified file:" + name);
-
-	DBG_DO(DBG_UTILITY, cerr << "New file info: " << info() << endl);
 
+static double pyFloorDiv(double vx, double wx, int & err)
+{
+	if (wx == 0) {
+		++err;
+		return 0;
+	}
+	double mod = fmod(vx, wx);
+	double div = (vx - mod) / wx;
+	if (mod != 0 && (wx < 0) != (mod < 0))
+		div -= 1.0;
+	if (div != 0) {
+		double floordiv = floor(div);
+		if (div - floordiv > 0.5)
+			floordiv += 1.0;
+		return floordiv;
+	}
+	return (vx / wx) < 0 ? -0.0 : 0.0;
 }
 
 
-// copy constructor, we need to clear rhs.m_stream to avoid closing file too early
-// this is techniquely advanced (and dangerous)
-StreamElem::StreamElem(const StreamElem & rhs)
+static double pyPow(double vx, double wx, int & err)
 {
-	m_filename = rhs.m_filename;
-	m_type = rhs.m_type;
-	m_append = rhs.m_append;
-	m_stream = rhs.m_stream;
-	const_cast<StreamElem &>(rhs).m_stream = NULL;
+	if (vx == 0 && wx < 0) {
+		++err;
+		return 0;
+	}
+	// result would be a complex number
+	if (vx < 0 && isFinite(wx) && floor(wx) != wx) {
+		++err;
+		return 0;
+	}
+	double res = pow(vx, wx);
+	if (!isFinite(res) && isFinite(vx) && isFinite(wx))
+		++err;
+	return res;
 }
 
 
-// destructor
-StreamElem::~StreamElem()
+static bool isPythonKeyword(const string & name)
 {
-	// close file.
-	if (m_stream != NULL) {
+	static const char * keywords[] = {
+		"in", "is", "lambda", "None", "for", "while", "def", "class", "return",
+		"import", "from", "as", "with", "pass", "del", "global", "nonlocal",
+		"yield", "assert", "raise", "try", "except", "finally", "elif", "break",
+		"continue", "print", "exec", "async", "await", NULL
+	};
+	for (size_t i = 0; keywords[i] != NULL; ++i)
+		if (name == keywords[i])
+			return true;
+	return false;
+}
 
-		DBG_DO(DBG_UTILITY, cerr << "Closing file " << m_filename << endl);
 
-		if (m_type == OFSTREAM)
-			static_cast<ofstream *>(m_stream)->close();
-		else if (m_type == FSTREAM)
-			static_cast<fstream *>(m_stream)->close();
+nativeExpr::nativeExpr(const string & expr, const string & stmts, const string & indVar)
+	: m_nodes(), m_stmts(), m_expr(-1), m_indVar(indVar), m_valid(false),
+	m_usesInd(false), m_type(TypeMixed)
+{
+	if (expr.empty() && stmts.empty())
+		return;
 
-		// do not do anything for fstream (no close function
+	exprTokens tokens;
+	size_t pos = 0;
+	if (!stmts.empty()) {
+		if (!tokenize(stmts, tokens))
+			return;
+		while (tokens[pos].kind != NATIVE_END) {
+			if (tokens[pos].kind == NATIVE_SEP) {
+				++pos;
+				continue;
+			}
+			// only assignment to a name
+			if (tokens[pos].kind != NATIVE_NAME || tokens[pos + 1].kind != NATIVE_OP)
+				return;
+			const string & op = tokens[pos + 1].text;
+			exprStmt stmt;
+			stmt.var = tokens[pos].text;
+			stmt.infoIdx = InvalidValue;
+			if (op == "=")
+				stmt.op = OpAssign;
+			else if (op == "+=")
+				stmt.op = OpAdd;
+			else if (op == "-=")
+				stmt.op = OpSub;
+			else if (op == "*=")
+				stmt.op = OpMul;
+			else if (op == "/=")
+				stmt.op = OpDiv;
+			else if (op == "//=")
+				stmt.op = OpFloorDiv;
+			else if (op == "%=")
+				stmt.op = OpMod;
+			else if (op == "**=")
+				stmt.op = OpPow;
+			else
+				return;
+			pos += 2;
+			stmt.node = parseTest(tokens, pos);
+			if (stmt.node < 0)
+				return;
+			if (tokens[pos].kind != NATIVE_SEP && tokens[pos].kind != NATIVE_END)
+				return;
+			m_stmts.push_back(stmt);
+		}
+	}
+	if (!expr.empty()) {
+		tokens.clear();
+		pos = 0;
+		if (!tokenize(expr, tokens))
+			return;
+		m_expr = parseTest(tokens, pos);
+		if (m_expr < 0 || tokens[pos].kind != NATIVE_END)
+			return;
+	}
+	m_valid = true;
+	DBG_DO(DBG_DEVEL, cerr << "Expression '" << expr << "' and statements '" << stmts
+		                   << "' will be evaluated natively." << endl);
+}
 
-		delete m_stream;
+
+bool nativeExpr::tokenize(const string & text, exprTokens & tokens) const
+{
+	size_t i = 0;
+	size_t depth = 0;
+	const size_t len = text.size();
+
+	while (i < len) {
+		char c = text[i];
+		exprToken token;
+		if (c == ' ' || c == '\t' || c == '\r') {
+			++i;
+			continue;
+		} else if (c == '#') {
+			while (i < len && text[i] != '\n')
+				++i;
+			continue;
+		} else if (c == '\n' || c == ';') {
+			++i;
+			if (depth > 0) {
+				// a statement can not be split by ;
+				if (c == ';')
+					return false;
+				continue;
+			}
+			token.kind = NATIVE_SEP;
+		} else if (isdigit(c) || (c == '.' && i + 1 < len && isdigit(text[i + 1]))) {
+			size_t start = i;
+			while (i < len && isdigit(text[i]))
+				++i;
+			bool isInt = true;
+			if (i < len && text[i] == '.') {
+				isInt = false;
+				++i;
+				while (i < len && isdigit(text[i]))
+					++i;
+			}
+			if (i < len && (text[i] == 'e' || text[i] == 'E')) {
+				isInt = false;
+				++i;
+				if (i < len && (text[i] == '+' || text[i] == '-'))
+					++i;
+				if (i == len || !isdigit(text[i]))
+					return false;
+				while (i < len && isdigit(text[i]))
+					++i;
+			}
+			// hexadecimal, complex, long etc are not supported
+			if (i < len && (isalnum(text[i]) || text[i] == '_' || text[i] == '.'))
+				return false;
+			token.text = text.substr(start, i - start);
+			// leading 0 is not allowed for integers (octal numbers in Python 2)
+			if (isInt && token.text.size() > 1 && token.text[0] == '0')
+				return false;
+			token.kind = NATIVE_NUM;
+		} else if (isalpha(c) || c == '_') {
+			size_t start = i;
+			while (i < len && (isalnum(text[i]) || text[i] == '_'))
+				++i;
+			token.text = text.substr(start, i - start);
+			if (isPythonKeyword(token.text))
+				return false;
+			token.kind = NATIVE_NAME;
+		} else if (c == '\'' || c == '"') {
+			size_t start = ++i;
+			while (i < len && text[i] != c && text[i] != '\\' && text[i] != '\n')
+				++i;
+			if (i == len || text[i] != c)
+				return false;
+			token.text = text.substr(start, i - start);
+			token.kind = NATIVE_STR;
+			++i;
+		} else {
+			static const char * ops[] = {
+				"**=", "//=", "**", "//", "<=", ">=", "==", "!=", "+=", "-=", "*=", "/=", "%=",
+				"+", "-", "*", "/", "%", "<", ">", "=", "(", ")", "[", "]", ",", ".", NULL
+			};
+			size_t k = 0;
+			for (; ops[k] != NULL; ++k)
+				if (text.compare(i, strlen(ops[k]), ops[k]) == 0)
+					break;
+			if (ops[k] == NULL)
+				return false;
+			token.text = ops[k];
+			token.kind = NATIVE_OP;
+			i += token.text.size();
+			if (c == '(' || c == '[')
+				++depth;
+			else if (c == ')' || c == ']') {
+				if (depth == 0)
+					return false;
+				--depth;
+			}
+		}
+		tokens.push_back(token);
 	}
+	if (depth != 0)
+		return false;
+	// two end tokens so that one token can always be looked ahead
+	exprToken end;
+	end.kind = NATIVE_END;
+	tokens.push_back(end);
+	tokens.push_back(end);
+	return true;
 }
 
 
-// the file was write-only, re-open it as read-write
-void StreamElem::makeReadable()
+int nativeExpr::addNode(const exprNode & node)
 {
+	m_nodes.push_back(node);
+	return static_cast<int>(m_nodes.size() - 1);
+}
 
-	DBG_DO(DBG_UTILITY, cerr << "File was opened write-only. Re-open it.  " << info() << endl);
 
-	static_cast<ofstream *>(m_stream)->close();
+// test: or_test ['if' or_test 'else' test]
+int nativeExpr::parseTest(const exprTokens & tokens, size_t & pos)
+{
+	int left = parseOrTest(tokens, pos);
 
-	// have to re-create a stream since pointer type is different.
-	delete m_stream;
+	if (left < 0 || tokens[pos].kind != NATIVE_NAME || tokens[pos].text != "if")
+		return left;
+	++pos;
+	exprNode node(OpIfElse);
+	node.left = left;
+	node.cond = parseOrTest(tokens, pos);
+	if (node.cond < 0 || tokens[pos].kind != NATIVE_NAME || tokens[pos].text != "else")
+		return -1;
+	++pos;
+	node.right = parseTest(tokens, pos);
+	if (node.right < 0)
+		return -1;
+	return addNode(node);
+}
 
-	// try to keep file content
-	m_stream = new fstream(m_filename.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
 
-	if (m_stream == NULL || !*m_stream)
-		throw ValueError("Can not re-open specified file.");
+int nativeExpr::parseOrTest(const exprTokens & tokens, size_t & pos)
+{
+	int left = parseAndTest(tokens, pos);
 
-	m_type = FSTREAM;
+	while (left >= 0 && tokens[pos].kind == NATIVE_NAME && tokens[pos].text == "or") {
+		++pos;
+		exprNode node(OpOr);
+		node.left = left;
+		node.right = parseAndTest(tokens, pos);
+		if (node.right < 0)
+			return -1;
+		left = addNode(node);
+	}
+	return left;
 }
 
 
-// change the append status
-void StreamElem::makeAppend(bool append)
+int nativeExpr::parseAndTest(const exprTokens & tokens, size_t & pos)
 {
+	int left = parseNotTest(tokens, pos);
 
-	DBG_DO(DBG_UTILITY, cerr << "File append status changes to " << append << endl);
-
-	DBG_FAILIF(m_type == SSTREAM, ValueError, "String stream can not be maded appendable. ");
+	while (left >= 0 && tokens[pos].kind == NATIVE_NAME && tokens[pos].text == "and") {
+		++pos;
+		exprNode node(OpAnd);
+		node.left = left;
+		node.right = parseNotTest(tokens, pos);
+		if (node.right < 0)
+			return -1;
+		left = addNode(node);
+	}
+	return left;
+}
 
-	m_append = append;
 
-	// if append = true: no problem, keep writing just do not close file. otherwise
-	// reopen file. Otherwise,
-	if (!append) {
+int nativeExpr::parseNotTest(const exprTokens & tokens, size_t & pos)
+{
+	if (tokens[pos].kind == NATIVE_NAME && tokens[pos].text == "not") {
+		++pos;
+		exprNode node(OpNot);
+		node.left = parseNotTest(tokens, pos);
+		if (node.left < 0)
+			return -1;
+		return addNode(node);
+	}
+	return parseComparison(tokens, pos);
+}
 
-		DBG_DO(DBG_UTILITY, cerr << "Re-open the file " << endl);
 
-		// re-open the file.
+int nativeExpr::parseComparison(const exprTokens & tokens, size_t & pos)
+{
+	int left = parseArith(tokens, pos);
 
-		if (m_type == FSTREAM) {
-			static_cast<fstream *>(m_stream)->close();
-			static_cast<fstream *>(m_stream)->open(m_filename.c_str(), std::ios::in | std::ios::out | std::ios::trunc);
-		} else if (m_type == OFSTREAM) {
-			static_cast< ofstream *>(m_stream)->close();
-			static_cast< ofstream *>(m_stream)->open(m_filename.c_str(), std::ios::out | std::ios::trunc);
-		}
+	if (left < 0)
+		return -1;
+	exprNode node(OpCmp);
+	node.args.push_back(left);
+	while (tokens[pos].kind == NATIVE_OP) {
+		const string & op = tokens[pos].text;
+		int cmp = 0;
+		if (op == "<")
+			cmp = CmpLt;
+		else if (op == "<=")
+			cmp = CmpLe;
+		else if (op == ">")
+			cmp = CmpGt;
+		else if (op == ">=")
+			cmp = CmpGe;
+		else if (op == "==")
+			cmp = CmpEq;
+		else if (op == "!=")
+			cmp = CmpNe;
+		else
+			break;
+		++pos;
+		int right = parseArith(tokens, pos);
+		if (right < 0)
+			return -1;
+		node.cmps.push_back(cmp);
+		node.args.push_back(right);
 	}
+	return node.cmps.empty() ? left : addNode(node);
 }
 
 
-string StreamElem::info()
+int nativeExpr::parseArith(const exprTokens & tokens, size_t & pos)
 {
-	ostringstream out;
+	int left = parseTerm(tokens, pos);
 
-	switch (m_type) {
-	case OFSTREAM:
-		out << m_filename << " : write only file stream. " << endl;
+	while (left >= 0 && tokens[pos].kind == NATIVE_OP &&
+	       (tokens[pos].text == "+" || tokens[pos].text == "-")) {
+		exprNode node(tokens[pos].text == "+" ? OpAdd : OpSub);
+		++pos;
+		node.left = left;
+		node.right = parseTerm(tokens, pos);
+		if (node.right < 0)
+			return -1;
+		left = addNode(node);
+	}
+	return left;
+}
+
+
+int nativeExpr::parseTerm(const exprTokens & tokens, size_t & pos)
+{
+	int left = parseFactor(tokens, pos);
+
+	while (left >= 0 && tokens[pos].kind == NATIVE_OP) {
+		const string & op = tokens[pos].text;
+		exprNode node;
+		if (op == "*")
+			node.op = OpMul;
+		else if (op == "/")
+			node.op = OpDiv;
+		else if (op == "//")
+			node.op = OpFloorDiv;
+		else if (op == "%")
+			node.op = OpMod;
+		else
+			break;
+		++pos;
+		node.left = left;
+		node.right = parseFactor(tokens, pos);
+		if (node.right < 0)
+			return -1;
+		left = addNode(node);
+	}
+	return left;
+}
+
+
+int nativeExpr::parseFactor(const exprTokens & tokens, size_t & pos)
+{
+	if (tokens[pos].kind == NATIVE_OP && (tokens[pos].text == "+" || tokens[pos].text == "-")) {
+		exprNode node(tokens[pos].text == "+" ? OpPos : OpNeg);
+		++pos;
+		node.left = parseFactor(tokens, pos);
+		if (node.left < 0)
+			return -1;
+		return addNode(node);
+	}
+	return parsePower(tokens, pos);
+}
+
+
+int nativeExpr::parsePower(const exprTokens & tokens, size_t & pos)
+{
+	int left = parseAtom(tokens, pos);
+
+	if (left < 0 || tokens[pos].kind != NATIVE_OP || tokens[pos].text != "**")
+		return left;
+	++pos;
+	exprNode node(OpPow);
+	node.left = left;
+	node.right = parseFactor(tokens, pos);
+	if (node.right < 0)
+		return -1;
+	return addNode(node);
+}
+
+
+int nativeExpr::parseAtom(const exprTokens & tokens, size_t & pos)
+{
+	const exprToken & token = tokens[pos];
+
+	if (token.kind == NATIVE_NUM) {
+		++pos;
+		exprNode node(OpConst);
+		bool isInt = token.text.find_first_of(".eE") == string::npos;
+		node.value = atof(token.text.c_str());
+		node.type = isInt ? TypeInt : TypeFloat;
+		return addNode(node);
+	} else if (token.kind == NATIVE_OP && token.text == "(") {
+		++pos;
+		int node = parseTest(tokens, pos);
+		if (node < 0 || tokens[pos].kind != NATIVE_OP || tokens[pos].text != ")")
+			return -1;
+		++pos;
+		return node;
+	} else if (token.kind != NATIVE_NAME)
+		return -1;
+
+	const string & name = token.text;
+	++pos;
+	if (name == "True" || name == "False") {
+		exprNode node(OpConst);
+		node.value = name == "True" ? 1 : 0;
+		node.type = TypeBool;
+		return addNode(node);
+	} else if (name == "if" || name == "else" || name == "and" || name == "or" || name == "not")
+		return -1;
+
+	const exprToken & next = tokens[pos];
+	if (next.kind == NATIVE_OP && next.text == "(") {
+		// function call
+		++pos;
+		exprNode node;
+		node.name = name;
+		if (name == "min")
+			node.op = OpMin;
+		else if (name == "max")
+			node.op = OpMax;
+		else if (name == "abs")
+			node.op = OpAbs;
+		else if (name == "exp")
+			node.op = OpExp;
+		else if (name == "log")
+			node.op = OpLog;
+		else if (name == "sqrt")
+			node.op = OpSqrt;
+		else
+			return -1;
+		while (true) {
+			int arg = parseTest(tokens, pos);
+			if (arg < 0)
+				return -1;
+			node.args.push_back(arg);
+			if (tokens[pos].kind == NATIVE_OP && tokens[pos].text == ",")
+				++pos;
+			else
+				break;
+		}
+		if (tokens[pos].kind != NATIVE_OP || tokens[pos].text != ")")
+			return -1;
+		++pos;
+		// min and max with a single argument expect a sequence
+		if ((node.op == OpMin || node.op == OpMax) ? node.args.size() < 2 : node.args.size() != 1)
+			return -1;
+		return addNode(node);
+	} else if (next.kind == NATIVE_OP && next.text == ".") {
+		// ind.sex() or ind.affected()
+		if (m_indVar.empty() || name != m_indVar || tokens[pos + 1].kind != NATIVE_NAME)
+			return -1;
+		const string & method = tokens[pos + 1].text;
+		pos += 2;
+		if (tokens[pos].kind != NATIVE_OP || tokens[pos].text != "(" ||
+		    tokens[pos + 1].kind != NATIVE_OP || tokens[pos + 1].text != ")")
+			return -1;
+		pos += 2;
+		exprNode node;
+		if (method == "sex") {
+			node.op = OpSex;
+			node.type = TypeInt;
+		} else if (method == "affected") {
+			node.op = OpAffected;
+			node.type = TypeBool;
+		} else
+			return -1;
+		m_usesInd = true;
+		return addNode(node);
+	}
+	// a variable, with optional constant keys
+	exprNode node(OpName);
+	node.name = name;
+	while (tokens[pos].kind == NATIVE_OP && tokens[pos].text == "[") {
+		++pos;
+		string key;
+		if (tokens[pos].kind == NATIVE_OP && tokens[pos].text == "-") {
+			key = "-";
+			++pos;
+		}
+		if (tokens[pos].kind == NATIVE_NUM && tokens[pos].text.find_first_of(".eE") == string::npos)
+			key += tokens[pos].text;
+		else if (tokens[pos].kind == NATIVE_STR && key.empty())
+			key = "'" + tokens[pos].text;
+		else
+			return -1;
+		++pos;
+		if (tokens[pos].kind != NATIVE_OP || tokens[pos].text != "]")
+			return -1;
+		++pos;
+		node.keys.push_back(key);
+	}
+	return addNode(node);
+}
+
+
+// convert a Python number to a double and get its type
+static bool pyNumber(PyObject * obj, double & value, int & type)
+{
+	if (PyBool_Check(obj)) {
+		value = obj == Py_True ? 1 : 0;
+		type = 1;
+	} else if (PyLong_Check(obj)) {
+		value = PyLong_AsDouble(obj);
+		type = 2;
+#if PY_VERSION_HEX < 0x03000000
+	} else if (PyInt_Check(obj)) {
+		value = static_cast<double>(PyInt_AsLong(obj));
+		type = 2;
+#endif
+	} else if (PyFloat_Check(obj)) {
+		value = PyFloat_AsDouble(obj);
+		type = 3;
+	} else
+		return false;
+	if (PyErr_Occurred()) {
+		PyErr_Clear();
+		return false;
+	}
+	return true;
+}
+
+
+// if obj is function name of module math
+static bool isMathFunc(PyObject * obj, const string & name)
+{
+	PyObject * math = PyImport_ImportModule("math");
+	if (math == NULL) {
+		PyErr_Clear();
+		return false;
+	}
+	PyObject * func = PyObject_GetAttrString(math, name.c_str());
+	Py_DECREF(math);
+	if (func == NULL) {
+		PyErr_Clear();
+		return false;
+	}
+	Py_DECREF(func);
+	return func == obj;
+}
+
+
+bool nativeExpr::bind(const vectorstr & infoFields, PyObject * dict) const
+{
+	if (!m_valid)
+		return false;
+
+	for (size_t i = 0; i < m_nodes.size(); ++i) {
+		const exprNode & node = m_nodes[i];
+		switch (node.op) {
+		case OpConst:
+		case OpSex:
+		case OpAffected:
+			break;
+		case OpName: {
+			vectorstr::const_iterator it = find(infoFields.begin(), infoFields.end(), node.name);
+			if (it != infoFields.end()) {
+				// information fields can not be indexed
+				if (!node.keys.empty())
+					return false;
+				node.infoIdx = it - infoFields.begin();
+				node.type = TypeFloat;
+				break;
+			}
+			node.infoIdx = InvalidValue;
+			PyObject * obj = dict == NULL ? NULL : PyDict_GetItemString(dict, node.name.c_str());
+			if (obj == NULL)
+				return false;
+			Py_INCREF(obj);
+			for (size_t k = 0; k < node.keys.size(); ++k) {
+				const string & key = node.keys[k];
+				PyObject * keyObj = key[0] == '\'' ? PyUnicode_FromString(key.c_str() + 1)
+				                    : PyLong_FromLong(atol(key.c_str()));
+				PyObject * item = PyObject_GetItem(obj, keyObj);
+				Py_DECREF(keyObj);
+				Py_DECREF(obj);
+				if (item == NULL) {
+					PyErr_Clear();
+					return false;
+				}
+				obj = item;
+			}
+			bool ok = pyNumber(obj, node.value, node.type);
+			Py_DECREF(obj);
+			if (!ok)
+				return false;
+			break;
+		}
+		case OpNeg:
+		case OpPos:
+			node.type = std::max(static_cast<int>(TypeInt), m_nodes[node.left].type);
+			break;
+		case OpNot:
+		case OpCmp:
+			node.type = TypeBool;
+			break;
+		case OpAdd:
+		case OpSub:
+		case OpMul:
+		case OpFloorDiv:
+		case OpMod:
+			node.type = std::max(static_cast<int>(TypeInt),
+				std::max(m_nodes[node.left].type, m_nodes[node.right].type));
+			break;
+		case OpDiv:
+#if PY_VERSION_HEX < 0x03000000
+			// integer division
+			if (m_nodes[node.left].type != TypeFloat && m_nodes[node.right].type != TypeFloat)
+				return false;
+#endif
+			node.type = TypeFloat;
+			break;
+		case OpPow: {
+			int lt = m_nodes[node.left].type;
+			int rt = m_nodes[node.right].type;
+			const exprNode & exponent = m_nodes[node.right];
+			if (lt == TypeMixed || rt == TypeMixed)
+				node.type = TypeMixed;
+			else if (lt == TypeFloat || rt == TypeFloat)
+				node.type = TypeFloat;
+			// integer power is an integer only for non-negative exponent
+			else if (exponent.op == OpConst || (exponent.op == OpName && exponent.infoIdx == InvalidValue))
+				node.type = exponent.value >= 0 ? TypeInt : TypeFloat;
+			else
+				node.type = TypeMixed;
+			break;
+		}
+		case OpAnd:
+		case OpOr:
+		case OpIfElse:
+			node.type = m_nodes[node.left].type == m_nodes[node.right].type
+			            ? m_nodes[node.left].type : TypeMixed;
+			break;
+		case OpMin:
+		case OpMax:
+		case OpAbs:
+		case OpExp:
+		case OpLog:
+		case OpSqrt: {
+			// a function with the same name is defined
+			if (find(infoFields.begin(), infoFields.end(), node.name) != infoFields.end())
+				return false;
+			PyObject * func = dict == NULL ? NULL : PyDict_GetItemString(dict, node.name.c_str());
+			if (node.op == OpExp || node.op == OpLog || node.op == OpSqrt) {
+				// not builtin functions, so they have to be the functions of
+				// module math in the namespace, as Python would require
+				if (func == NULL || !isMathFunc(func, node.name))
+					return false;
+				node.type = TypeFloat;
+			} else if (func != NULL)
+				return false;
+			else if (node.op == OpAbs)
+				node.type = std::max(static_cast<int>(TypeInt), m_nodes[node.args[0]].type);
+			else {
+				node.type = m_nodes[node.args[0]].type;
+				for (size_t j = 1; j < node.args.size(); ++j)
+					if (m_nodes[node.args[j]].type != node.type)
+						node.type = TypeMixed;
+			}
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	for (size_t i = 0; i < m_stmts.size(); ++i) {
+		vectorstr::const_iterator it = find(infoFields.begin(), infoFields.end(), m_stmts[i].var);
+		// assignment to other variables are not supported
+		if (it == infoFields.end())
+			return false;
+		m_stmts[i].infoIdx = it - infoFields.begin();
+	}
+	m_type = m_expr < 0 ? TypeMixed : m_nodes[m_expr].type;
+	return true;
+}
+
+
+double nativeExpr::evalNode(int idx, InfoIterator info, double sex, double affected, int & err) const
+{
+	const exprNode & node = m_nodes[idx];
+
+	switch (node.op) {
+	case OpConst:
+		return node.value;
+	case OpName:
+		return node.infoIdx == InvalidValue ? node.value : info[node.infoIdx];
+	case OpSex:
+		return sex;
+	case OpAffected:
+		return affected;
+	case OpNeg:
+		return -evalNode(node.left, info, sex, affected, err);
+	case OpPos:
+		return evalNode(node.left, info, sex, affected, err);
+	case OpNot:
+		return evalNode(node.left, info, sex, affected, err) == 0 ? 1 : 0;
+	case OpAdd:
+		return evalNode(node.left, info, sex, affected, err) + evalNode(node.right, info, sex, affected, err);
+	case OpSub:
+		return evalNode(node.left, info, sex, affected, err) - evalNode(node.right, info, sex, affected, err);
+	case OpMul:
+		return evalNode(node.left, info, sex, affected, err) * evalNode(node.right, info, sex, affected, err);
+	case OpDiv: {
+		double left = evalNode(node.left, info, sex, affected, err);
+		double right = evalNode(node.right, info, sex, affected, err);
+		if (right == 0) {
+			++err;
+			return 0;
+		}
+		return left / right;
+	}
+	case OpFloorDiv: {
+		double left = evalNode(node.left, info, sex, affected, err);
+		return pyFloorDiv(left, evalNode(node.right, info, sex, affected, err), err);
+	}
+	case OpMod: {
+		double left = evalNode(node.left, info, sex, affected, err);
+		return pyMod(left, evalNode(node.right, info, sex, affected, err), err);
+	}
+	case OpPow: {
+		double left = evalNode(node.left, info, sex, affected, err);
+		return pyPow(left, evalNode(node.right, info, sex, affected, err), err);
+	}
+	case OpCmp: {
+		double left = evalNode(node.args[0], info, sex, affected, err);
+		for (size_t i = 0; i < node.cmps.size(); ++i) {
+			double right = evalNode(node.args[i + 1], info, sex, affected, err);
+			bool res = false;
+			switch (node.cmps[i]) {
+			case CmpLt:
+				res = left < right;
+				break;
+			case CmpLe:
+				res = left <= right;
+				break;
+			case CmpGt:
+				res = left > right;
+				break;
+			case CmpGe:
+				res = left >= right;
+				break;
+			case CmpEq:
+				res = left == right;
+				break;
+			case CmpNe:
+				res = left != right;
+				break;
+			}
+			if (!res)
+				return 0;
+			left = right;
+		}
+		return 1;
+	}
+	case OpAnd: {
+		double left = evalNode(node.left, info, sex, affected, err);
+		return left == 0 ? left : evalNode(node.right, info, sex, affected, err);
+	}
+	case OpOr: {
+		double left = evalNode(node.left, info, sex, affected, err);
+		return left != 0 ? left : evalNode(node.right, info, sex, affected, err);
+	}
+	case OpIfElse:
+		return evalNode(node.cond, info, sex, affected, err) != 0
+		       ? evalNode(node.left, info, sex, affected, err)
+			   : evalNode(node.right, info, sex, affected, err);
+	case OpMin:
+	case OpMax: {
+		double res = evalNode(node.args[0], info, sex, affected, err);
+		for (size_t i = 1; i < node.args.size(); ++i) {
+			double value = evalNode(node.args[i], info, sex, affected, err);
+			if (node.op == OpMin ? value < res : value > res)
+				res = value;
+		}
+		return res;
+	}
+	case OpAbs:
+		return fabs(evalNode(node.args[0], info, sex, affected, err));
+	case OpExp: {
+		double x = evalNode(node.args[0], info, sex, affected, err);
+		double res = exp(x);
+		if (!isFinite(res) && isFinite(x))
+			++err;
+		return res;
+	}
+	case OpLog: {
+		double x = evalNode(node.args[0], info, sex, affected, err);
+		if (x <= 0) {
+			++err;
+			return 0;
+		}
+		return log(x);
+	}
+	case OpSqrt: {
+		double x = evalNode(node.args[0], info, sex, affected, err);
+		if (x < 0) {
+			++err;
+			return 0;
+		}
+		return sqrt(x);
+	}
+	default:
+		++err;
+		return 0;
+	}
+}
+
+
+double nativeExpr::evaluate(InfoIterator info, double sex, double affected, int & err) const
+{
+	for (size_t i = 0; i < m_stmts.size(); ++i) {
+		const exprStmt & stmt = m_stmts[i];
+		double value = evalNode(stmt.node, info, sex, affected, err);
+		double & var = info[stmt.infoIdx];
+		switch (stmt.op) {
+		case OpAssign:
+			var = value;
+			break;
+		case OpAdd:
+			var += value;
+			break;
+		case OpSub:
+			var -= value;
+			break;
+		case OpMul:
+			var *= value;
+			break;
+		case OpDiv:
+			if (value == 0)
+				++err;
+			else
+				var /= value;
+			break;
+		case OpFloorDiv:
+			var = pyFloorDiv(var, value, err);
+			break;
+		case OpMod:
+			var = pyMod(var, value, err);
+			break;
+		case OpPow:
+			var = pyPow(var, value, err);
+			break;
+		}
+	}
+	return m_expr < 0 ? 0 : evalNode(m_expr, info, sex, affected, err);
+}
+
+
+string nativeExpr::valueAsString(double value) const
+{
+	if (m_type == TypeBool)
+		return value != 0 ? "True" : "False";
+	PyObject * obj = m_type == TypeInt ? PyLong_FromDouble(value) : PyFloat_FromDouble(value);
+	string res;
+	PyObj_As_String(obj, res);
+	Py_XDECREF(obj);
+	return res;
+}
+
+
+// Asynchronous output
+
+#ifdef ASYNC_OUTPUT
+
+// number of bytes an AsyncOstream collects before sending them to its writer
+#define ASYNC_CHUNK_SIZE 65536
+
+static void addBlockedTime(std::chrono::steady_clock::time_point start)
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::lock_guard<std::mutex> lock(g_asyncStatMutex);
+	g_asyncBlockedTime += elapsed.count();
+}
+
+
+/* A background thread that writes to a file. Open, write and close requests
+ * are queued and processed in order so that a file can be re-opened (e.g.
+ * a file that is overwritten at each generation) while earlier output is
+ * still being written. The total size of queued data is bounded by
+ * g_asyncBufferSize, and a request blocks until enough data has been written.
+ * Failures are recorded and reported by checkError().
+ */
+class AsyncWriter
+{
+public:
+	enum taskType { OPEN, APPEND, WRITE, CLOSE, STOP };
+
+	AsyncWriter(const string & filename) : m_filename(filename), m_tasks(), m_queued(0),
+		m_busy(false), m_error(), m_users(0), m_file(), m_thread()
+	{
+		m_thread = std::thread(&AsyncWriter::run, this);
+	}
+
+
+	~AsyncWriter()
+	{
+		submit(STOP, NULL);
+		m_thread.join();
+	}
+
+
+	// queue a request. The content of data (for WRITE) is moved to the queue.
+	void submit(taskType type, string * data)
+	{
+		size_t size = data == NULL ? 0 : data->size();
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		if (m_queued > 0 && m_queued + size > g_asyncBufferSize) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			while (m_queued > 0 && m_queued + size > g_asyncBufferSize)
+				m_done.wait(lock);
+			addBlockedTime(start);
+		}
+		m_tasks.push_back(std::make_pair(type, string()));
+		if (data != NULL)
+			m_tasks.back().second.swap(*data);
+		m_queued += size;
+		lock.unlock();
+		m_hasTask.notify_one();
+	}
+
+
+	// wait until all queued requests are processed
+	void wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		if (!m_tasks.empty() || m_busy) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			while (!m_tasks.empty() || m_busy)
+				m_done.wait(lock);
+			addBlockedTime(start);
+		}
+	}
+
+
+	// if all queued requests are processed
+	bool idle()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		return m_tasks.empty() && !m_busy;
+	}
+
+
+	// raise the first error encountered by the writer, if any.
+	void checkError()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (!m_error.empty()) {
+			string msg = m_error;
+			m_error.clear();
+			throw RuntimeError(msg);
+		}
+	}
+
+
+	// number of AsyncOstream objects that are using this writer
+	int & users()
+	{
+		return m_users;
+	}
+
+
+private:
+	void run()
+	{
+		while (true) {
+			std::pair<taskType, string> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				while (m_tasks.empty())
+					m_hasTask.wait(lock);
+				task.first = m_tasks.front().first;
+				task.second.swap(m_tasks.front().second);
+				m_tasks.pop_front();
+				m_busy = true;
+			}
+			if (task.first == STOP)
+				return;
+
+			string error;
+			switch (task.first) {
+			case OPEN:
+			case APPEND:
+				if (m_file.is_open())
+					m_file.close();
+				m_file.clear();
+				m_file.open(m_filename.c_str(), task.first == OPEN ? std::ios::out | std::ios::trunc
+				                                                   : std::ios::out | std::ios::app);
+				if (!m_file)
+					error = "Can not open specified file:" + m_filename;
+				break;
+			case WRITE:
+				if (m_file.is_open()) {
+					m_file.write(task.second.c_str(), task.second.size());
+					if (!m_file)
+						error = "Failed to write to file " + m_filename;
+					else {
+						std::lock_guard<std::mutex> lock(g_asyncStatMutex);
+						g_asyncBytesWritten += task.second.size();
+					}
+				}
+				break;
+			case CLOSE:
+				if (m_file.is_open())
+					m_file.close();
+				break;
+			default:
+				break;
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_queued -= task.second.size();
+				m_busy = false;
+				if (!error.empty() && m_error.empty())
+					m_error = error;
+			}
+			m_done.notify_all();
+		}
+	}
+
+
+	string m_filename;
+
+	std::deque<std::pair<taskType, string> > m_tasks;
+
+	// number of bytes in m_tasks and in the request being processed
+	size_t m_queued;
+
+	bool m_busy;
+
+	string m_error;
+
+	int m_users;
+
+	// accessed only by the writer thread
+	ofstream m_file;
+
+	std::mutex m_mutex;
+
+	std::condition_variable m_hasTask;
+
+	std::condition_variable m_done;
+
+	std::thread m_thread;
+};
+
+
+// writers, one for each file. They are kept after their files are closed
+// and are removed by flushOutput after they become idle.
+class AsyncWriterPool
+{
+public:
+	typedef map<string, AsyncWriter *> writerMap;
+
+	~AsyncWriterPool()
+	{
+		for (writerMap::iterator it = writers.begin(); it != writers.end(); ++it)
+			delete it->second;
+	}
+
+
+	writerMap writers;
+};
+
+static AsyncWriterPool g_asyncWriters;
+
+
+/* Stream buffer that collects output and hands it to a writer in chunks.
+ * The buffer is not sent with each flush (e.g. endl) because operators flush
+ * frequently, but when a chunk is full, at the end of each generation, and
+ * when the stream is closed.
+ */
+class AsyncStreamBuf : public std::streambuf
+{
+public:
+	AsyncStreamBuf(AsyncWriter * writer) : m_writer(writer), m_buffer()
+	{
+		setp(m_chunk, m_chunk + sizeof(m_chunk));
+	}
+
+
+	// send all buffered output to the writer
+	void submit()
+	{
+		collect();
+		if (!m_buffer.empty())
+			m_writer->submit(AsyncWriter::WRITE, &m_buffer);
+		m_buffer.clear();
+	}
+
+
+protected:
+	int_type overflow(int_type c)
+	{
+		collect();
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+			m_buffer.push_back(traits_type::to_char_type(c));
+		if (m_buffer.size() >= std::min<size_t>(ASYNC_CHUNK_SIZE, g_asyncBufferSize))
+			submit();
+		return traits_type::not_eof(c);
+	}
+
+
+	int sync()
+	{
+		return 0;
+	}
+
+
+private:
+	// move the content of the put area to m_buffer
+	void collect()
+	{
+		m_buffer.append(pbase(), pptr() - pbase());
+		setp(m_chunk, m_chunk + sizeof(m_chunk));
+	}
+
+
+	AsyncWriter * m_writer;
+
+	string m_buffer;
+
+	char m_chunk[4096];
+};
+
+
+/* An output stream that is written by an AsyncWriter. Errors such as failure
+ * to open the file are reported by flushOutput.
+ */
+class AsyncOstream : public std::ostream
+{
+public:
+	AsyncOstream(const string & filename, bool append);
+
+	~AsyncOstream();
+
+	/// close and re-open the file
+	void reopen(bool append)
+	{
+		m_buf.submit();
+		m_writer->submit(append ? AsyncWriter::APPEND : AsyncWriter::OPEN, NULL);
+	}
+
+
+	void submit()
+	{
+		m_buf.submit();
+	}
+
+
+private:
+	AsyncWriter * m_writer;
+
+	AsyncStreamBuf m_buf;
+};
+
+// opened asynchronous streams
+static std::set<AsyncOstream *> g_asyncStreams;
+
+static AsyncWriter * getAsyncWriter(const string & filename)
+{
+	AsyncWriterPool::writerMap::iterator it = g_asyncWriters.writers.find(filename);
+
+	if (it != g_asyncWriters.writers.end())
+		return it->second;
+	return g_asyncWriters.writers[filename] = new AsyncWriter(filename);
+}
+
+
+AsyncOstream::AsyncOstream(const string & filename, bool append)
+	: std::ostream(NULL), m_writer(getAsyncWriter(filename)), m_buf(m_writer)
+{
+	rdbuf(&m_buf);
+	++m_writer->users();
+	m_writer->submit(append ? AsyncWriter::APPEND : AsyncWriter::OPEN, NULL);
+	g_asyncStreams.insert(this);
+}
+
+
+AsyncOstream::~AsyncOstream()
+{
+	g_asyncStreams.erase(this);
+	m_buf.submit();
+	m_writer->submit(AsyncWriter::CLOSE, NULL);
+	--m_writer->users();
+}
+
+
+#endif
+
+void flushOutput(bool wait)
+{
+#ifdef ASYNC_OUTPUT
+	std::set<AsyncOstream *>::iterator it = g_asyncStreams.begin();
+	std::set<AsyncOstream *>::iterator it_end = g_asyncStreams.end();
+	for (; it != it_end; ++it)
+		(*it)->submit();
+
+	string error;
+	AsyncWriterPool::writerMap & writers = g_asyncWriters.writers;
+	for (AsyncWriterPool::writerMap::iterator w = writers.begin(); w != writers.end(); ) {
+		if (wait)
+			w->second->wait();
+		try {
+			w->second->checkError();
+		} catch (RuntimeError & e) {
+			if (error.empty())
+				error = e.message();
+		}
+		// remove writers of closed files
+		if (w->second->users() == 0 && w->second->idle()) {
+			delete w->second;
+			writers.erase(w++);
+		} else
+			++w;
+	}
+	if (!error.empty())
+		throw RuntimeError(error);
+#else
+	(void)wait;  // avoid an unused parameter warning
+#endif
+}
+
+
+bool asyncOutputActive()
+{
+#ifdef ASYNC_OUTPUT
+	return g_asyncBufferSize > 0 && g_asyncSessions > 0;
+#else
+	return false;
+#endif
+}
+
+
+AsyncOutputGuard::AsyncOutputGuard()
+{
+#ifdef ASYNC_OUTPUT
+	++g_asyncSessions;
+#endif
+}
+
+
+AsyncOutputGuard::~AsyncOutputGuard()
+{
+#ifdef ASYNC_OUTPUT
+	if (--g_asyncSessions == 0) {
+		// errors should have been reported by an explicit call to flushOutput
+		try {
+			flushOutput(true);
+		} catch (...) {
+		}
+	}
+#endif
+}
+
+
+// Stream element, can be of different types
+
+StreamElem::StreamElem(const string & name, bool readable, bool realAppend, bool useString)
+	: m_filename(name)
+{
+
+	DBG_DO(DBG_UTILITY, cerr << "creating " << name << " with parameter " <<
+		readable << " " << realAppend << " " << useString << " " << endl);
+
+	if (useString) {
+		// existing file will be truncated...
+		m_stream = new stringstream(std::ios::in | std::ios::out);
+		m_type = SSTREAM;
+		m_append = false;
+	} else {                                                                          // no string, usual file
+		m_append = realAppend;
+		m_type = FSTREAM;
+		if (readable) {
+			if (realAppend)     // readable , append
+				m_stream = new fstream(name.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
+			else                // readable, ! append
+				// existing file will be truncated...
+				m_stream = new fstream(name.c_str(),  std::ios::in | std::ios::trunc | std::ios::out);
+		} else {
+#ifdef ASYNC_OUTPUT
+			if (asyncOutputActive()) {
+				m_stream = new AsyncOstream(name, realAppend);
+				m_type = ASYNCSTREAM;
+			} else
+#endif
+			if (realAppend) {     // ! readable, append
+				m_stream = new ofstream(name.c_str(), std::ios::out | std::ios::app);
+				m_type = OFSTREAM;
+			} else                //  !readable, !append )
+				// existing file will be truncated...
+				m_stream = new fstream(name.c_str(),  std::ios::trunc | std::ios::out);
+		}
+	}
+
+	if (m_stream == NULL || !*m_stream)
+		throw ValueError("Can not open specified file:" + name);
+
+	DBG_DO(DBG_UTILITY, cerr << "New file info: " << info() << endl);
+
+}
+
+
+// copy constructor, we need to clear rhs.m_stream to avoid closing file too early
+// this is techniquely advanced (and dangerous)
+StreamElem::StreamElem(const StreamElem & rhs)
+{
+	m_filename = rhs.m_filename;
+	m_type = rhs.m_type;
+	m_append = rhs.m_append;
+	m_stream = rhs.m_stream;
+	const_cast<StreamElem &>(rhs).m_stream = NULL;
+}
+
+
+// destructor
+StreamElem::~StreamElem()
+{
+	// close file.
+	if (m_stream != NULL) {
+
+		DBG_DO(DBG_UTILITY, cerr << "Closing file " << m_filename << endl);
+
+		if (m_type == OFSTREAM)
+			static_cast<ofstream *>(m_stream)->close();
+		else if (m_type == FSTREAM)
+			static_cast<fstream *>(m_stream)->close();
+
+		// do not do anything for fstream (no close function
+
+		delete m_stream;
+	}
+}
+
+
+// the file was write-only, re-open it as read-write
+void StreamElem::makeReadable()
+{
+
+	DBG_DO(DBG_UTILITY, cerr << "File was opened write-only. Re-open it.  " << info() << endl);
+
+	if (m_type == OFSTREAM)
+		static_cast<ofstream *>(m_stream)->close();
+
+	// have to re-create a stream since pointer type is different.
+	delete m_stream;
+	m_stream = NULL;
+
+	// wait for the background writer to close the file
+	if (m_type == ASYNCSTREAM)
+		flushOutput(true);
+
+	// try to keep file content
+	m_stream = new fstream(m_filename.c_str(),  std::ios::in | std::ios::out | std::ios::ate);
+
+	if (m_stream == NULL || !*m_stream)
+		throw ValueError("Can not re-open specified file.");
+
+	m_type = FSTREAM;
+}
+
+
+// change the append status
+void StreamElem::makeAppend(bool append)
+{
+
+	DBG_DO(DBG_UTILITY, cerr << "File append status changes to " << append << endl);
+
+	DBG_FAILIF(m_type == SSTREAM, ValueError, "String stream can not be maded appendable. ");
+
+	m_append = append;
+
+	// if append = true: no problem, keep writing just do not close file. otherwise
+	// reopen file. Otherwise,
+	if (!append) {
+
+		DBG_DO(DBG_UTILITY, cerr << "Re-open the file " << endl);
+
+		// re-open the file.
+
+		if (m_type == FSTREAM) {
+			static_cast<fstream *>(m_stream)->close();
+			static_cast<fstream *>(m_stream)->open(m_filename.c_str(), std::ios::in | std::ios::out | std::ios::trunc);
+		} else if (m_type == OFSTREAM) {
+			static_cast< ofstream *>(m_stream)->close();
+			static_cast< ofstream *>(m_stream)->open(m_filename.c_str(), std::ios::out | std::ios::trunc);
+		}
+#ifdef ASYNC_OUTPUT
+		else if (m_type == ASYNCSTREAM)
+			static_cast<AsyncOstream *>(m_stream)->reopen(false);
+#endif
+	}
+}
+
+
+string StreamElem::info()
+{
+	ostringstream out;
+
+	switch (m_type) {
+	case OFSTREAM:
+		out << m_filename << " : write only file stream. " << endl;
 
 		DBG_DO(DBG_UTILITY, out << "(write pos: " << static_cast<ofstream *>(m_stream)->tellp() << ")");
 
@@ -2963,6 +4600,9 @@ string StreamElem::info()
 		DBG_DO(DBG_UTILITY, out << "(write pos: " << static_cast<fstream *>(m_stream)->tellp()
 			                    << ", read pos: " << static_cast<fstream *>(m_stream)->tellg() << ")");
 
+		break;
+	case ASYNCSTREAM:
+		out << m_filename << " : write only file stream written by a background thread. " << endl;
 		break;
 	case SSTREAM:
 		out << m_filename << " : string stream. " << endl;
@@ -3009,7 +4649,8 @@ ostream * OstreamManager::getOstream(const string & name, bool readable,  bool r
 			throw ValueError("file " + name + " has already opened as string file.");
 		else if (!useString && it->second.type() == StreamElem::SSTREAM)
 			throw ValueError("file " + name + " has already opened as normal file.");
-		else if (readable && it->second.type() == StreamElem::OFSTREAM)
+		else if (readable && (it->second.type() == StreamElem::OFSTREAM ||
+		                      it->second.type() == StreamElem::ASYNCSTREAM))
 			it->second.makeReadable();
 		else if (realAppend && !it->second.append())
 			it->second.makeAppend(true);
@@ -3138,6 +4779,13 @@ ostream & StreamProvider::getOstream(PyObject * dict, bool readable)
 
 			if (readable)
 				m_filePtr = new fstream(filename.c_str());
+#ifdef ASYNC_OUTPUT
+			else if (asyncOutputActive()) {
+				// errors such as failure to open the file are reported by flushOutput
+				m_filePtr = new AsyncOstream(filename, false);
+				return *m_filePtr;
+			}
+#endif
 			else
 				m_filePtr = new ofstream(filename.c_str());
 
@@ -3167,6 +4815,7 @@ void StreamProvider::closeOstream()
 			DBG_ASSERT(m_func.isValid(), SystemError,
 				"Passed function object is invalid");
 			string str = dynamic_cast<ostringstream *>(m_filePtr)->str();
+			PythonCallGuard guard;
 			// in swingpyrun.h, the PyString_Check is defined to PyBytes_Check
 #if PY_VERSION_HEX >= 0x03000000
 			PyObject * arglist = NULL;
@@ -3190,8 +4839,9 @@ void StreamProvider::closeOstream()
 				Py_DECREF(pyResult);
 		} else if (ISSETFLAG(m_flags, m_flagReadable))
 			dynamic_cast<fstream *>(m_filePtr)->close();
-		else
+		else if (dynamic_cast<ofstream *>(m_filePtr) != NULL)
 			dynamic_cast<ofstream *>(m_filePtr)->close();
+		// an asynchronous stream is closed by the background writer after it is deleted
 		delete m_filePtr;
 	}
 }
@@ -3261,17 +4911,216 @@ void closeOutput(const string & output)
 			"Output " + output + " does not exist or has already been closed.");
 		ostreamManager().closeOstream(output);
 	}
+	// make sure closed files are completely written
+	flushOutput(true);
+}
+
+
+// an empty BGZF block that marks the end of a BGZF file
+static const char bgzfEOF[28] = {
+	'\x1f', '\x8b', '\x08', '\x04', '\0', '\0', '\0', '\0', '\0', '\xff', '\x06', '\0',
+	'B', 'C', '\x02', '\0', '\x1b', '\0', '\x03', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0', '\0'
+};
+
+bool compressBgzfBlock(const char * data, size_t len, string & block)
+{
+	z_stream zs;
+
+	zs.zalloc = Z_NULL;
+	zs.zfree = Z_NULL;
+	zs.opaque = Z_NULL;
+	// raw deflate stream, gzip header and footer are written manually
+	if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+
+	block.resize(18 + deflateBound(&zs, static_cast<uLong>(len)) + 8);
+	zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	zs.avail_in = static_cast<uInt>(len);
+	zs.next_out = reinterpret_cast<Bytef *>(&block[18]);
+	zs.avail_out = static_cast<uInt>(block.size() - 26);
+	int ret = deflate(&zs, Z_FINISH);
+	size_t clen = zs.total_out;
+	deflateEnd(&zs);
+	if (ret != Z_STREAM_END)
+		return false;
+
+	size_t bsize = 18 + clen + 8;
+	block.resize(bsize);
+	// gzip header with a BC extra field that records block size - 1
+	const char header[16] = { '\x1f', '\x8b', '\x08', '\x04', '\0', '\0', '\0', '\0', '\0', '\xff', '\x06', '\0', 'B', 'C', '\x02', '\0' };
+	std::copy(header, header + 16, block.begin());
+	block[16] = static_cast<char>((bsize - 1) & 0xff);
+	block[17] = static_cast<char>((bsize - 1) >> 8);
+	// crc32 and uncompressed size, in little endian
+	unsigned long crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(data), static_cast<uInt>(len));
+	for (size_t i = 0; i < 4; ++i) {
+		block[bsize - 8 + i] = static_cast<char>((crc >> (8 * i)) & 0xff);
+		block[bsize - 4 + i] = static_cast<char>((len >> (8 * i)) & 0xff);
+	}
+	return true;
+}
+
+
+BgzfWriter::BgzfWriter(const string & filename, bool compress)
+	: m_file(filename.c_str(), std::ios::binary), m_filename(filename), m_compress(compress),
+	m_buffer()
+{
+	if (!m_file)
+		throw RuntimeError("Failed to create file " + filename);
+}
+
+
+BgzfWriter::~BgzfWriter()
+{
+	if (m_file.is_open()) {
+		try {
+			close();
+		} catch (...) {
+		}
+	}
+}
+
+
+void BgzfWriter::write(const string & text)
+{
+	m_buffer += text;
+	// compress a few blocks for each thread at a time
+	if (m_buffer.size() >= BGZF_BLOCK_SIZE * 4 * numThreads())
+		flushBlocks(false);
+}
+
+
+void BgzfWriter::flushBlocks(bool all)
+{
+	if (!m_compress) {
+		m_file.write(m_buffer.data(), m_buffer.size());
+		m_buffer.clear();
+		return;
+	}
+	size_t nBlocks = all ? (m_buffer.size() + BGZF_BLOCK_SIZE - 1) / BGZF_BLOCK_SIZE
+	                 : m_buffer.size() / BGZF_BLOCK_SIZE;
+	if (nBlocks == 0)
+		return;
+
+	vectorstr blocks(nBlocks);
+	int failed = 0;
+#pragma omp parallel for if(numThreads() > 1 && nBlocks > 1) reduction(+:failed)
+	for (ssize_t i = 0; i < static_cast<ssize_t>(nBlocks); ++i) {
+		size_t start = i * BGZF_BLOCK_SIZE;
+		if (!compressBgzfBlock(m_buffer.data() + start,
+				std::min(static_cast<size_t>(BGZF_BLOCK_SIZE), m_buffer.size() - start), blocks[i]))
+			++failed;
+	}
+	if (failed)
+		throw RuntimeError("Failed to compress data for file " + m_filename);
+	for (size_t i = 0; i < nBlocks; ++i)
+		m_file.write(blocks[i].data(), blocks[i].size());
+	m_buffer.erase(0, std::min(nBlocks * BGZF_BLOCK_SIZE, m_buffer.size()));
+	if (!m_file)
+		throw RuntimeError("Failed to write to file " + m_filename);
+}
+
+
+void BgzfWriter::close()
+{
+	if (!m_file.is_open())
+		return;
+	flushBlocks(true);
+	if (m_compress)
+		m_file.write(bgzfEOF, 28);
+	m_file.close();
+}
+
+
+// Native xoshiro256++ random number generator of Blackman and Vigna, with
+// four streams advanced together. The loops over streams are written so that
+// they can be vectorized by the compiler.
+static inline uint64_t rotl64(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+
+void xoshiroRefill(xoshiroState * state)
+{
+	uint64_t * s0 = state->s[0];
+	uint64_t * s1 = state->s[1];
+	uint64_t * s2 = state->s[2];
+	uint64_t * s3 = state->s[3];
+
+	for (size_t i = 0; i < NATIVE_RNG_BATCH; i += 4) {
+		for (size_t j = 0; j < 4; ++j) {
+			state->buf[i + j] = rotl64(s0[j] + s3[j], 23) + s0[j];
+			uint64_t t = s1[j] << 17;
+			s2[j] ^= s0[j];
+			s3[j] ^= s1[j];
+			s1[j] ^= s2[j];
+			s0[j] ^= s3[j];
+			s2[j] ^= t;
+			s3[j] = rotl64(s3[j], 45);
+		}
+	}
+	state->idx = 0;
+}
+
+
+static inline uint64_t xoshiroNext(xoshiroState * state)
+{
+	if (state->idx == NATIVE_RNG_BATCH)
+		xoshiroRefill(state);
+	return state->buf[state->idx++];
+}
+
+
+static void xoshiroSet(void * vstate, unsigned long int seed)
+{
+	xoshiroState * state = static_cast<xoshiroState *>(vstate);
+	// initialize the states of all streams with splitmix64
+	uint64_t x = seed;
+
+	for (size_t k = 0; k < 4; ++k) {
+		for (size_t j = 0; j < 4; ++j) {
+			uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			state->s[k][j] = z ^ (z >> 31);
+		}
+	}
+	state->idx = NATIVE_RNG_BATCH;
+}
+
+
+static unsigned long int xoshiroGet(void * vstate)
+{
+	return static_cast<unsigned long int>(xoshiroNext(static_cast<xoshiroState *>(vstate)) >> 32);
+}
+
+
+static double xoshiroGetDouble(void * vstate)
+{
+	return (xoshiroNext(static_cast<xoshiroState *>(vstate)) >> 11) * (1.0 / 9007199254740992.0);
 }
 
 
+static const gsl_rng_type xoshiroType = {
+	"xoshiro256++",
+	0xFFFFFFFFUL,
+	0,
+	sizeof(xoshiroState),
+	&xoshiroSet,
+	&xoshiroGet,
+	&xoshiroGetDouble
+};
+
+
 // Random number generator
-RNG::RNG(const char * rng, unsigned long seed) : m_RNG(NULL)
+RNG::RNG(const char * rng, unsigned long seed) : m_RNG(NULL), m_native(NULL)
 {
 	set(rng, seed);
 }
 
 
-RNG::RNG(const RNG & rhs) : m_RNG(NULL)
+RNG::RNG(const RNG & rhs) : m_RNG(NULL), m_native(NULL)
 {
 	// this will create a new instance of m_RNG.
 	set(rhs.name(), rhs.seed());
@@ -3393,29 +5242,37 @@ void RNG::set(const char * rng, unsigned long seed)
 
 		gsl_rng_default = 0;
 
-		// check GSL_RNG_TYPE against the names of all the generators
-
-		for (t = t0; *t != 0; t++) {
-			// require that a RNG can generate full range of integer from 0 to the max of unsigned long int
-			if (strcmp(rng_name, (*t)->name) == 0) {
-				// free current RNG
-				if (m_RNG != NULL)
-					gsl_rng_free(m_RNG);
-
-				m_RNG = gsl_rng_alloc(*t);
-
-				DBG_ASSERT(gsl_rng_max(m_RNG) >= MaxRandomNumber && gsl_rng_min(m_RNG) == 0,
-					ValueError, "You chosen random number generator can not generate full range of int.");
-				break;
+		// the native generator
+		if (strcmp(rng_name, xoshiroType.name) == 0) {
+			if (m_RNG != NULL)
+				gsl_rng_free(m_RNG);
+			m_RNG = gsl_rng_alloc(&xoshiroType);
+		} else {
+			// check GSL_RNG_TYPE against the names of all the generators
+			for (t = t0; *t != 0; t++) {
+				// require that a RNG can generate full range of integer from 0 to the max of unsigned long int
+				if (strcmp(rng_name, (*t)->name) == 0) {
+					// free current RNG
+					if (m_RNG != NULL)
+						gsl_rng_free(m_RNG);
+
+					m_RNG = gsl_rng_alloc(*t);
+
+					DBG_ASSERT(gsl_rng_max(m_RNG) >= MaxRandomNumber && gsl_rng_min(m_RNG) == 0,
+						ValueError, "You chosen random number generator can not generate full range of int.");
+					break;
+				}
 			}
-		}
 
-		if (*t == 0)
-			throw SystemError((boost::format("GSL_RNG_TYPE=%1% not recognized or can not generate full range (0-2^32-1) of integers.") % rng_name).str());
+			if (*t == 0)
+				throw SystemError((boost::format("GSL_RNG_TYPE=%1% not recognized or can not generate full range (0-2^32-1) of integers.") % rng_name).str());
+		}
 	} else if (m_RNG == NULL)
 		// no name is given so we use a default one (mt19937)
 		m_RNG = gsl_rng_alloc(gsl_rng_mt19937);
 
+	m_native = m_RNG->type == &xoshiroType ? static_cast<xoshiroState *>(m_RNG->state) : NULL;
+
 	// in the case that a name is not given, and m_RNG already exists, just set seed.
 
 	// generate seed
@@ -3443,6 +5300,137 @@ bool RNG::randBit()
 }
 
 
+void RNG::randUniforms(double * res, size_t count)
+{
+	if (m_native == NULL) {
+		for (size_t i = 0; i < count; ++i)
+			res[i] = gsl_rng_uniform(m_RNG);
+		return;
+	}
+	while (count > 0) {
+		if (m_native->idx == NATIVE_RNG_BATCH)
+			xoshiroRefill(m_native);
+		size_t n = std::min(count, static_cast<size_t>(NATIVE_RNG_BATCH - m_native->idx));
+		const uint64_t * buf = m_native->buf + m_native->idx;
+		for (size_t i = 0; i < n; ++i)
+			res[i] = (buf[i] >> 11) * (1.0 / 9007199254740992.0);
+		m_native->idx += n;
+		res += n;
+		count -= n;
+	}
+}
+
+
+void RNG::randInts(unsigned long int n, unsigned long int * res, size_t count)
+{
+	if (m_native == NULL || n == 0 || n > 0xFFFFFFFFUL) {
+		for (size_t i = 0; i < count; ++i)
+			res[i] = gsl_rng_uniform_int(m_RNG, n);
+		return;
+	}
+	for (size_t i = 0; i < count; ++i)
+		res[i] = nativeInt(static_cast<uint32_t>(n));
+}
+
+
+void RNG::randGeometrics(double p, long * res, size_t count)
+{
+	if (p == 1) {
+		std::fill(res, res + count, 1L);
+		return;
+	}
+	if (m_native == NULL) {
+		for (size_t i = 0; i < count; ++i)
+			res[i] = gsl_ran_geometric(m_RNG, p);
+		return;
+	}
+	// the same algorithm as gsl_ran_geometric, using a uniform (0, 1) number
+	double scale = 1. / log1p(-p);
+	for (size_t i = 0; i < count; ++i) {
+		uint64_t u;
+		do {
+			u = nativeNext() >> 11;
+		} while (u == 0);
+		res[i] = static_cast<long>(log(u * (1.0 / 9007199254740992.0)) * scale + 1);
+	}
+}
+
+
+void RNG::randBits(WORDTYPE * res, size_t count)
+{
+	const size_t wordBits = sizeof(WORDTYPE) * 8;
+
+	if (m_native == NULL) {
+		// 32 bits at a time for generators such as mt19937 that generate
+		// 32 random bits, and 16 bits at a time otherwise.
+		size_t bits = gsl_rng_min(m_RNG) == 0 && gsl_rng_max(m_RNG) == 0xFFFFFFFFUL ? 32 : 16;
+		for (size_t i = 0; i < count; ++i) {
+			WORDTYPE word = 0;
+			for (size_t b = 0; b < wordBits; b += bits)
+				word |= static_cast<WORDTYPE>(bits == 32 ? gsl_rng_get(m_RNG)
+				                              : gsl_rng_uniform_int(m_RNG, 0x10000)) << b;
+			res[i] = word;
+		}
+		return;
+	}
+	for (size_t i = 0; i < count; ++i) {
+		WORDTYPE word = 0;
+		for (size_t b = 0; b < wordBits; b += 64)
+			word |= static_cast<WORDTYPE>(nativeNext() >> (wordBits < 64 ? 64 - wordBits : 0)) << b;
+		res[i] = word;
+	}
+}
+
+
+// number of words processed together by randBernoulliBits, 256 bits for
+// 64-bit words
+#define BERNOULLI_LANES 4
+
+void RNG::randBernoulliBits(double p, WORDTYPE * res, size_t count)
+{
+	// binary expansion of p with 32 digits
+	uint64_t q = static_cast<uint64_t>(p * 4294967296.0 + 0.5);
+
+	if (q == 0) {
+		std::fill(res, res + count, WORDTYPE(0));
+		return;
+	} else if (q >= 0x100000000ULL) {
+		std::fill(res, res + count, ~WORDTYPE(0));
+		return;
+	}
+	// Starting from the lowest non-zero digit, a word x with bits that are 1
+	// with probability P becomes x | r (probability (1 + P) / 2) for digit 1
+	// and x & r (probability P / 2) for digit 0, where r is a random word.
+	// The result has probability q / 2^32 after the highest digit.
+	size_t low = 0;
+	while (((q >> low) & 1) == 0)
+		++low;
+	const size_t nDigits = 32 - low;
+	WORDTYPE rnd[32 * BERNOULLI_LANES];
+	WORDTYPE x[BERNOULLI_LANES];
+
+	for (size_t i = 0; i < count; i += BERNOULLI_LANES) {
+		randBits(rnd, nDigits * BERNOULLI_LANES);
+		const WORDTYPE * r = rnd;
+		for (size_t j = 0; j < BERNOULLI_LANES; ++j)
+			x[j] = r[j];
+		r += BERNOULLI_LANES;
+		for (size_t d = low + 1; d < 32; ++d, r += BERNOULLI_LANES) {
+			if ((q >> d) & 1) {
+				for (size_t j = 0; j < BERNOULLI_LANES; ++j)
+					x[j] |= r[j];
+			} else {
+				for (size_t j = 0; j < BERNOULLI_LANES; ++j)
+					x[j] &= r[j];
+			}
+		}
+		size_t n = std::min(static_cast<size_t>(BERNOULLI_LANES), count - i);
+		for (size_t j = 0; j < n; ++j)
+			res[i + j] = x[j];
+	}
+}
+
+
 ULONG RNG::search_poisson(UINT y, double * z, double p, double lambda)
 {
 	if (*z >= p) { // search to the left
@@ -3826,6 +5814,10 @@ string formatDescription(const string & text)
 }
 
 
+// alias tables of WeightedSampler with at least this number of weights are
+// built in parallel
+#define PARALLEL_ALIAS_MIN 100000
+
 size_t WeightedSampler::draw()
 {
 	DBG_FAILIF(m_algorithm == 0, ValueError,
@@ -3872,16 +5864,293 @@ size_t WeightedSampler::draw()
 }
 
 
+void WeightedSampler::update(const uintList & indexes, const vectorf & weights)
+{
+	PARAM_FAILIF(m_algorithm == 0 || m_algorithm == 4, ValueError,
+		"Weights can only be updated for samplers that are created from weights without N.");
+	const vectoru & idx = indexes.elems();
+	PARAM_FAILIF(idx.size() != weights.size(), ValueError,
+		"Please specify a weight for each index.");
+	vectorf newWeights = m_weights;
+	for (size_t i = 0; i < idx.size(); ++i) {
+		PARAM_FAILIF(idx[i] >= newWeights.size(), IndexError,
+			(boost::format("Index %1% out of range of 0 ~ %2%") % idx[i] % (newWeights.size() - 1)).str());
+		newWeights[idx[i]] = weights[i];
+	}
+	set(newWeights.begin(), newWeights.end());
+}
+
+
+size_t WeightedSampler::pairAliases(size_t * items, size_t n, size_t * HL)
+{
+	if (n == 0)
+		return 0;
+	// use two sets H and L
+	// for efficiency purpose, use a single vector.
+	size_t * L = HL;
+	size_t * H = HL + n - 1;                                 // point to the end.
+
+	for (size_t i = 0; i < n; ++i) {
+		if (m_q[items[i]] > 1)
+			*H-- = items[i];
+		else
+			*L++ = items[i];
+	}
+
+	//
+	size_t j, k;
+	while (L != HL && H != HL + n - 1) {
+		j = *(L - 1);
+		k = *(H + 1);
+		m_a[j] = k;
+		m_q[k] += m_q[j] - 1;
+
+		L--;                                                                    // remove j from L
+		if (m_q[k] < 1.) {
+			*L++ = k;                                                           // add k to L
+			++H;                                                                // remove k from H
+		}
+	}
+	// items that are left in L or H
+	size_t left = 0;
+	for (size_t * it = HL; it != L; ++it)
+		items[left++] = *it;
+	for (size_t * it = H + 1; it != HL + n; ++it)
+		items[left++] = *it;
+	return left;
+}
+
+
+void WeightedSampler::buildAliasTable()
+{
+	// sum of weight
+	double w = accumulate(m_weights.begin(), m_weights.end(), 0.0);
+
+	DBG_FAILIF(fcmp_le(w, 0), ValueError, "Sum of weight is <= 0.");
+
+	w = m_N / w;
+
+	// initialize p with N*p0,...N*p_k-1
+	m_q.resize(m_N);
+	// initialize Y with values
+	m_a.resize(m_N);
+	vectoru items(m_N);
+	vectoru HL(m_N);
+	size_t left = m_N;
+
+	int nBlocks = numThreads() > 1 && m_N >= PARALLEL_ALIAS_MIN ? static_cast<int>(numThreads()) : 1;
+	if (nBlocks > 1) {
+#ifdef _OPENMP
+		// pair items in each block in parallel, leaving items whose
+		// weights do not add up within the block, which are paired later.
+		vectoru blockLeft(nBlocks);
+#  pragma omp parallel for
+		for (int b = 0; b < nBlocks; ++b) {
+			size_t begin = m_N * b / nBlocks;
+			size_t end = m_N * (b + 1) / nBlocks;
+			for (size_t i = begin; i < end; ++i) {
+				m_q[i] = m_weights[i] * w;
+				m_a[i] = i;
+				items[i] = i;
+			}
+			blockLeft[b] = pairAliases(&items[begin], end - begin, &HL[begin]);
+		}
+		left = 0;
+		for (int b = 0; b < nBlocks; ++b) {
+			size_t begin = m_N * b / nBlocks;
+			std::copy(items.begin() + begin, items.begin() + begin + blockLeft[b],
+				items.begin() + left);
+			left += blockLeft[b];
+		}
+#endif
+	} else {
+		for (size_t i = 0; i < m_N; ++i) {
+			m_q[i] = m_weights[i] * w;
+			m_a[i] = i;
+			items[i] = i;
+		}
+	}
+	pairAliases(&items[0], left, &HL[0]);
+}
+
+
 vectoru WeightedSampler::drawSamples(ULONG num)
 {
 	vectoru res(num);
 
-	for (size_t i = 0; i < num; ++i)
-		res[i] = draw();
+	if (num == 0)
+		return res;
+	// draw random numbers in batches
+	if (m_algorithm == 2) {
+		vector<unsigned long int> values(num);
+		getRNG().randInts(static_cast<ULONG>(m_param), &values[0], num);
+		std::copy(values.begin(), values.end(), res.begin());
+	} else if (m_algorithm == 3) {
+		vectorf values(num);
+		getRNG().randUniforms(&values[0], num);
+		for (size_t i = 0; i < num; ++i) {
+			double rN = values[i] * m_N;
+			size_t K = static_cast<size_t>(rN);
+			res[i] = rN - K < m_q[K] ? K : m_a[K];
+		}
+	} else {
+		for (size_t i = 0; i < num; ++i)
+			res[i] = draw();
+	}
 	return res;
 }
 
 
+// number of set bits of a 64-bit word
+static inline size_t bitCount64(uint64_t x)
+{
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<size_t>((x * 0x0101010101010101ULL) >> 56);
+}
+
+
+void OccupancyIndex::reset(size_t beg, size_t end)
+{
+	DBG_FAILIF(end < beg, ValueError, "Invalid range of occupancy index");
+	m_beg = beg;
+	m_end = end;
+	m_blocks.clear();
+	vector<uint64_t>().swap(m_bits);
+	vector<size_t>().swap(m_tree);
+	m_count = 0;
+	m_numBlocks = 0;
+	m_dense = false;
+}
+
+
+void OccupancyIndex::setDense(bool dense)
+{
+	size_t nBlocks = (m_end - m_beg + 63) / 64;
+
+	if (dense) {
+		m_bits.assign(nBlocks, 0);
+		BlockMap::const_iterator it = m_blocks.begin();
+		BlockMap::const_iterator it_end = m_blocks.end();
+		for (; it != it_end; ++it)
+			m_bits[it->first] = it->second;
+		BlockMap().swap(m_blocks);
+		m_tree.assign(nBlocks + 1, 0);
+		for (size_t i = 0; i < nBlocks; ++i)
+			m_tree[i + 1] = bitCount64(m_bits[i]);
+		for (size_t i = 1; i <= nBlocks; ++i) {
+			size_t j = i + (i & (~i + 1));
+			if (j <= nBlocks)
+				m_tree[j] += m_tree[i];
+		}
+	} else {
+		m_blocks.clear();
+		for (size_t i = 0; i < nBlocks; ++i)
+			if (m_bits[i] != 0)
+				m_blocks[i] = m_bits[i];
+		vector<uint64_t>().swap(m_bits);
+		vector<size_t>().swap(m_tree);
+	}
+	m_dense = dense;
+}
+
+
+void OccupancyIndex::setBlock(size_t idx, uint64_t bits)
+{
+	uint64_t old = block(idx);
+
+	if (old == 0 && bits != 0)
+		++m_numBlocks;
+	else if (old != 0 && bits == 0)
+		--m_numBlocks;
+	if (m_dense) {
+		m_bits[idx] = bits;
+		updateTree(idx, static_cast<long>(bitCount64(bits)) - static_cast<long>(bitCount64(old)));
+	} else if (bits == 0)
+		m_blocks.erase(idx);
+	else
+		m_blocks[idx] = bits;
+	// storage is switched at different levels so that it is not switched
+	// back and forth when a few sites are occupied and released
+	size_t nBlocks = (m_end - m_beg + 63) / 64;
+	if (!m_dense && m_numBlocks * 4 > nBlocks)
+		setDense(true);
+	else if (m_dense && m_numBlocks * 16 < nBlocks)
+		setDense(false);
+}
+
+
+void OccupancyIndex::updateTree(size_t idx, long delta)
+{
+	for (size_t i = idx + 1; i < m_tree.size(); i += i & (~i + 1))
+		m_tree[i] += delta;
+}
+
+
+void OccupancyIndex::occupy(size_t loc)
+{
+	if (occupied(loc))
+		return;
+	size_t idx = (loc - m_beg) >> 6;
+	++m_count;
+	setBlock(idx, block(idx) | (uint64_t(1) << ((loc - m_beg) & 63)));
+}
+
+
+void OccupancyIndex::release(size_t loc)
+{
+	if (!occupied(loc))
+		return;
+	size_t idx = (loc - m_beg) >> 6;
+	--m_count;
+	setBlock(idx, block(idx) & ~(uint64_t(1) << ((loc - m_beg) & 63)));
+}
+
+
+size_t OccupancyIndex::vacantSite(size_t k) const
+{
+	DBG_FAILIF(k >= vacant(), IndexError, "Index out of range of vacant sites");
+	size_t nBlocks = m_bits.size();
+	size_t step = 1;
+	while (step * 2 <= nBlocks)
+		step *= 2;
+	// find the block with the k-th vacant site by descending the Fenwick tree.
+	// Unused bits after m_end are counted as vacant sites but they are after
+	// all vacant sites in the range.
+	size_t idx = 0;
+	for (; step > 0; step /= 2) {
+		if (idx + step > nBlocks)
+			continue;
+		size_t zeros = step * 64 - m_tree[idx + step];
+		if (k >= zeros) {
+			idx += step;
+			k -= zeros;
+		}
+	}
+	// the k-th unset bit of the block
+	uint64_t word = ~m_bits[idx];
+	for (; k > 0; --k)
+		word &= word - 1;
+	return m_beg + idx * 64 + bitCount64((word & (~word + 1)) - 1);
+}
+
+
+size_t OccupancyIndex::randVacantSite() const
+{
+	if (vacant() == 0)
+		return m_end;
+	if (m_dense)
+		return vacantSite(getRNG().randInt(static_cast<ULONG>(vacant())));
+	// at most a third of the sites are occupied if the storage is sparse
+	while (true) {
+		size_t loc = m_beg + getRNG().randInt(static_cast<ULONG>(m_end - m_beg));
+		if (!occupied(loc))
+			return loc;
+	}
+}
+
+
 // this is used for Bernullitrials and copyGenotype
 WORDTYPE g_bitMask[WORDBIT];
 
@@ -3983,6 +6252,17 @@ void Bernullitrials::setAll(size_t idx, bool v)
 // use a != 0 to avoid compiler warning
 #define getBit(ptr, i)    ((*((ptr) + (i) / WORDBIT) & (1UL << ((i) - ((i) / WORDBIT) * WORDBIT))) != 0)
 
+// number of geometric random numbers generated at a time by Bernullitrials
+#define GEOMETRIC_BATCH 64
+
+
+// Bernoulli trials with probability between BITSLICE_MIN_PROB and
+// 1 - BITSLICE_MIN_PROB are generated by RNG::randBernoulliBits, which
+// costs the same for all probabilities and is faster than generating the
+// trials with geometric skipping (for Bernullitrials) or a random number for
+// each trial (for Bernullitrials_T) for probabilities in this range.
+#define BITSLICE_MIN_PROB 0.2
+
 void Bernullitrials::doTrial()
 {
 	DBG_ASSERT(m_N != 0, ValueError, "number of trials should be positive");
@@ -3995,42 +6275,17 @@ void Bernullitrials::doTrial()
 		double prob = m_prob[cl];
 		if (prob == 0.) {
 			setAll(cl, false);
-		} else if (prob == 0.5) {                                 // random 0,1 bit, this will be quicker
-			// set to 0..
-			setAll(cl, false);
-			// treat a randInt as random bits and set them directly.
-			// I.e., we will call 1/16 or 1/32 times of rng for this specifal case.
-			// first several blocks
-			// WORDTYPE * ptr = BITPTR(succ.begin());
-			WORDTYPE tmp;
+		} else if (prob == 1.) {
+			setAll(cl, true);
+		} else if (prob >= BITSLICE_MIN_PROB && prob <= 1. - BITSLICE_MIN_PROB) {
+			// generate bits directly, which is faster than geometric skipping
+			// unless prob is small
 			size_t blk = m_N / WORDBIT;
 			size_t rest = m_N - blk * WORDBIT;
-			for (size_t i = 0; i < blk; ++i) {
-				// even if the block size is large (I can not set it to int16_t)
-				// I only take the last 16 bit of a rng
-				// for the quality of random bits.
-				*ptr = 0;
-				for (size_t b = 0; b < WORDBIT / 16; ++b) {
-					// blocks[i] = static_cast<int16_t>(getRNG().randGet());
-					tmp = getRNG().randInt(0xFFFF);
-					*ptr |= (0xFFFF & tmp) << (b * 16);
-				}
-				ptr++;
-			}
-			// last block
-			if (rest != 0) {
-				size_t b = 0;
-				for (b = 0; b < rest / 16; ++b) {
-					tmp = getRNG().randInt(0xFFFF);
-					*ptr |= (0xFFFF & tmp) << (b * 16);
-				}
-				// last bits
-				rest -= b * 16;
-				if (rest != 0) {
-					tmp = getRNG().randInt(0xFFFF);
-					*ptr |= (g_bitMask[rest] & tmp) << b * 16;
-				}
-			}
+			getRNG().randBernoulliBits(prob, ptr, blk + (rest != 0 ? 1 : 0));
+			// clear bits after the last trial
+			if (rest != 0)
+				*(ptr + blk) &= g_bitMask[rest];
 		}
 		// algorithm i Sheldon Ross' book simulation (4ed), page 54
 		else if (prob < 0.5) {
@@ -4038,10 +6293,21 @@ void Bernullitrials::doTrial()
 			setAll(cl, false);
 			// it may make sense to limit the use of this method to low p,
 			size_t i = 0;
+			// steps are generated in batches
+			long steps[GEOMETRIC_BATCH];
+			size_t nSteps = 0;
+			size_t curStep = 0;
 			while (true) {
+				if (curStep == nSteps) {
+					// expected number of steps, plus a few
+					nSteps = std::min(static_cast<size_t>(GEOMETRIC_BATCH),
+						static_cast<size_t>((m_N - i) * prob) + 4);
+					getRNG().randGeometrics(prob, steps, nSteps);
+					curStep = 0;
+				}
 				// i moves at least one. (# trails until the first success)
 				// 6,3 means (0 0 0 0 0 1) (0 0 1)
-				ULONG step = getRNG().randGeometric(prob);
+				ULONG step = steps[curStep++];
 				if (step == 0)
 					// gsl_ran_geometric sometimes return 0 when prob is really small.
 					break;
@@ -4053,16 +6319,23 @@ void Bernullitrials::doTrial()
 				else
 					break;
 			}
-		} else if (prob == 1.) {
-			setAll(cl, true);
 		} else {                                                                  // 1 > m_proc[cl] > 0.5
 			// set all to 1, and then unset some.
 			setAll(cl, true);
 			// it may make sense to limit the use of this method to low p,
 			size_t i = 0;
 			prob = 1. - prob;
+			long steps[GEOMETRIC_BATCH];
+			size_t nSteps = 0;
+			size_t curStep = 0;
 			while (true) {
-				ULONG step = getRNG().randGeometric(prob);
+				if (curStep == nSteps) {
+					nSteps = std::min(static_cast<size_t>(GEOMETRIC_BATCH),
+						static_cast<size_t>((m_N - i) * prob) + 4);
+					getRNG().randGeometrics(prob, steps, nSteps);
+					curStep = 0;
+				}
+				ULONG step = steps[curStep++];
 				if (step == 0)
 					// gsl_ran_geometric sometimes return 0 when prob is really small.
 					break;
@@ -4266,13 +6539,22 @@ void Bernullitrials_T::doTrial()
 		if (prob == 0.)
 			continue;
 		// algorithm i Sheldon Ross' book simulation (4ed), page 54
-		else if (prob > 0 && prob < 0.2) {
+		else if (prob > 0 && prob < BITSLICE_MIN_PROB) {
 			// it may make sense to limit the use of this method to low p,
 			size_t i = 0;
+			long steps[GEOMETRIC_BATCH];
+			size_t nSteps = 0;
+			size_t curStep = 0;
 			while (true) {
+				if (curStep == nSteps) {
+					nSteps = std::min(static_cast<size_t>(GEOMETRIC_BATCH),
+						static_cast<size_t>((m_N - i) * prob) + 4);
+					getRNG().randGeometrics(prob, steps, nSteps);
+					curStep = 0;
+				}
 				// i moves at least one. (# trails until the first success)
 				// 6,3 means (0 0 0 0 0 1) (0 0 1)
-				ULONG step = getRNG().randGeometric(prob);
+				ULONG step = steps[curStep++];
 				if (step == 0)
 					// gsl_ran_geometric sometimes return 0 when prob is really small.
 					break;
@@ -4286,10 +6568,17 @@ void Bernullitrials_T::doTrial()
 			}
 		} else if (prob == 1.) {
 			setAll(cl, true);
-		} else {                                                                  // 1 > m_proc[cl] > 0.5
-			for (size_t i = 0; i < m_N; ++i)
-				if (getRNG().randUniform() < prob)
-					setBit(m_pointer[i], cl);
+		} else {
+			// generate bits of trials for this probability, and set them to
+			// the rows of the table
+			WORDTYPE bits[GEOMETRIC_BATCH];
+			for (size_t i = 0; i < m_N; i += GEOMETRIC_BATCH * WORDBIT) {
+				size_t n = std::min(static_cast<size_t>(GEOMETRIC_BATCH * WORDBIT), m_N - i);
+				getRNG().randBernoulliBits(prob, bits, (n + WORDBIT - 1) / WORDBIT);
+				for (size_t k = 0; k < n; ++k)
+					if (getBit(bits, k))
+						setBit(m_pointer[i + k], cl);
+			}
 		}
 	}
 	m_cur = 0;
@@ -4670,9 +6959,33 @@ PyObject * moduleInfo()
 			PyList_Append(rngs, PyString_FromString((*t)->name));
 		gsl_rng_free(rng);
 	}
+	PyList_Append(rngs, PyString_FromString(xoshiroType.name));
 	PyDict_SetItem(dict, PyString_FromString("availableRNGs"), rngs);
 	Py_DECREF(rngs);
 
+	// asyncOutput
+	PyObject * async = PyDict_New();
+#ifdef ASYNC_OUTPUT
+	{
+		std::lock_guard<std::mutex> lock(g_asyncStatMutex);
+		PyDict_SetItem(async, PyString_FromString("bufferSize"), val = PyLong_FromSize_t(g_asyncBufferSize));
+		Py_DECREF(val);
+		PyDict_SetItem(async, PyString_FromString("bytesWritten"), val = PyLong_FromUnsignedLong(g_asyncBytesWritten));
+		Py_DECREF(val);
+		PyDict_SetItem(async, PyString_FromString("blockedTime"), val = PyFloat_FromDouble(g_asyncBlockedTime));
+		Py_DECREF(val);
+	}
+#else
+	PyDict_SetItem(async, PyString_FromString("bufferSize"), val = PyLong_FromLong(0));
+	Py_DECREF(val);
+	PyDict_SetItem(async, PyString_FromString("bytesWritten"), val = PyLong_FromLong(0));
+	Py_DECREF(val);
+	PyDict_SetItem(async, PyString_FromString("blockedTime"), val = PyFloat_FromDouble(0));
+	Py_DECREF(val);
+#endif
+	PyDict_SetItem(dict, PyString_FromString("asyncOutput"), async);
+	Py_DECREF(async);
+
 	//
 	return dict;
 }
@@ -4975,6 +7288,8 @@ bool initialize(PyObject * module)
 	// get population and Individual type pointer
 	g_swigPopType = SWIG_TypeQuery(PopSWIGType);
 	g_swigIndividual = SWIG_TypeQuery(IndSWIGType);
+	// optional, used only to look up native demographic models
+	g_swigDemographicModel = SWIG_TypeQuery(DemographicModelSWIGType);
 	//
 	// g_swigOperator = SWIG_TypeQuery(OperatorSWIGType);
 	if (g_swigPopType == NULL || g_swigIndividual == NULL)
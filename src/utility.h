@@ -68,8 +68,18 @@ using std::find;
 #include <iomanip>
 using std::setw;
 
+#include <fstream>
+
 #include <set>
 
+#if TR1_SUPPORT == 0
+#  include <map>
+#elif TR1_SUPPORT == 1
+#  include <unordered_map>
+#else
+#  include <tr1/unordered_map>
+#endif
+
 /// for ranr generator
 #include "gsl/gsl_sys.h"                                           // for floating point comparison
 #include "gsl/gsl_rng.h"
@@ -152,10 +162,16 @@ void checkRefCount();
  *  integer (number of threads) or 0, which implies all available cores, or
  *  a number set by environmental variable \c OMP_NUM_THREADS.
  *  Second and third argument is to set the type or seed of existing random number generator using RNG \e name
- *  with \e seed. If using openMP, it sets the type or seed of random number
- *  generator of each thread.
+ *  with \e seed (e.g. \c xoshiro256++ for a fast native generator). If using openMP, it sets the type or seed of random number
+ *  generator of each thread. If \e asyncOutput is set to a positive number,
+ *  files written by operators during <tt>Simulator.evolve()</tt> are written
+ *  by a background thread for each file, with at most \e asyncOutput bytes
+ *  queued for each file. Output is handed to these threads at the end of each
+ *  generation and all files are completely written when \c evolve returns.
+ *  Setting \e asyncOutput to \c 0 restores synchronous output.
  */
-void setOptions(const int numThreads = -1, const char * name = NULL, unsigned long seed = 0);
+void setOptions(const int numThreads = -1, const char * name = NULL, unsigned long seed = 0,
+                long asyncOutput = -1);
 
 /// CPPONLY get number of thread in openMP
 UINT numThreads();
@@ -318,6 +334,31 @@ private:
 	PyObject * m_object;
 };
 
+/** CPPONLY Return a counter that is increased each time individuals might
+ *  have been changed in ways that cannot be tracked, for example by a Python
+ *  function. Information derived from individuals (e.g. members of virtual
+ *  subpopulations) should be discarded when this counter changes.
+ */
+size_t indModificationCount();
+
+/// CPPONLY increase the counter returned by \c indModificationCount().
+void markIndModified();
+
+/// CPPONLY Return \c true if a Python function or expression is being called.
+bool inPythonCall();
+
+/** CPPONLY mark the call of a Python function or expression during the
+ *  lifetime of this object. Because the Python function can change
+ *  individuals, individuals are considered modified before and after the call.
+ */
+class PythonCallGuard
+{
+public:
+	PythonCallGuard();
+
+	~PythonCallGuard();
+};
+
 /** A wrapper to a python function
  *  CPPONLY
  */
@@ -372,6 +413,7 @@ public:
 		va_start(argptr, format);
 		PyObject * arglist = Py_VaBuildValue(const_cast<char *>(format), argptr);
 		va_end(argptr);
+		PythonCallGuard guard;
 		PyObject * pyResult = PyEval_CallObject(m_func.object(), arglist);
 
 		Py_XDECREF(arglist);
@@ -390,6 +432,7 @@ public:
 	template <typename T>
 	T operator()(void converter(PyObject *, T &), PyObject * arglist) const
 	{
+		PythonCallGuard guard;
 		PyObject * pyResult = PyEval_CallObject(m_func.object(), arglist);
 
 		if (pyResult == NULL) {
@@ -411,6 +454,7 @@ public:
 		va_start(argptr, format);
 		PyObject * arglist = Py_VaBuildValue(const_cast<char *>(format), argptr);
 		va_end(argptr);
+		PythonCallGuard guard;
 		PyObject * pyResult = PyEval_CallObject(m_func.object(), arglist);
 
 		Py_XDECREF(arglist);
@@ -425,6 +469,7 @@ public:
 
 	PyObject * operator()(PyObject * args) const
 	{
+		PythonCallGuard guard;
 		PyObject * pyResult = PyEval_CallObject(m_func.object(), args);
 
 		if (pyResult == NULL) {
@@ -815,6 +860,10 @@ protected:
 };
 
 
+/** A matrix of numbers, which can be specified as a list or nested list of
+ *  numbers, or as a list of dictionaries with column indexes as keys, in
+ *  which case the matrix is sparse and only non-zero elements are stored.
+ */
 class floatMatrix
 {
 public:
@@ -827,15 +876,35 @@ public:
 	}
 
 
-	/// CPPONLY
+	/** CPPONLY return elements of the matrix, or values of non-zero elements
+	 *  of each row if the matrix is sparse.
+	 */
 	const matrixf & elems() const
 	{
 		return m_elems;
 	}
 
 
+	/// CPPONLY if the matrix is specified as a list of dictionaries
+	bool isSparse() const
+	{
+		return m_sparse;
+	}
+
+
+	/// CPPONLY column indexes of non-zero elements of each row of a sparse matrix
+	const vector<vectoru> & columns() const
+	{
+		return m_columns;
+	}
+
+
 protected:
 	matrixf m_elems;
+
+	bool m_sparse;
+
+	vector<vectoru> m_columns;
 };
 
 
@@ -844,6 +913,12 @@ class stringMatrix
 public:
 	stringMatrix(PyObject * str = NULL);
 
+	/// CPPONLY
+	stringMatrix(const matrixstr & values) : m_elems(values)
+	{
+	}
+
+
 	/// CPPONLY
 	bool empty() const
 	{
@@ -1320,6 +1395,9 @@ void * pyIndPointer(PyObject * p);
 /// CPPONLY
 void * pyPopPointer(PyObject * p);
 
+/// CPPONLY
+void * pyDemographicModelPointer(PyObject * p);
+
 /// CPPONLY
 string shorten(const string & val, size_t length = 40);
 
@@ -1503,6 +1581,165 @@ private:
 	double m_value;
 };
 
+
+/** CPPONLY
+ *  A compiled form of simple Python expressions and statements that can be
+ *  evaluated for individuals without calling the Python interpreter. The
+ *  following syntax is supported: numbers, \c True and \c False, names of
+ *  information fields, numeric population variables (optionally indexed by
+ *  constant keys such as <tt>alleleFreq[0][1]</tt>), <tt>ind.sex()</tt> and
+ *  <tt>ind.affected()</tt> where \c ind is the name of the exposed
+ *  individual, arithmetic operators (<tt>+ - * / // % **</tt>), comparisons,
+ *  \c and, \c or, \c not, conditional expressions (<tt>a if c else b</tt>),
+ *  functions \c min, \c max and \c abs, functions \c exp, \c log and
+ *  \c sqrt if they are imported from module \c math to the namespace, and
+ *  statements that assign values (using <tt>= += -= *= /= //= %= **=</tt>)
+ *  to information fields. Expressions and statements with other syntax are
+ *  marked as invalid and should be evaluated by Python.
+ */
+class nativeExpr
+{
+public:
+	nativeExpr(const string & expr = string(), const string & stmts = string(),
+		const string & indVar = string());
+
+	/// return \c true if the expression and statements can be evaluated natively.
+	bool valid() const
+	{
+		return m_valid;
+	}
+
+
+	/** Bind names to information fields \e infoFields or to variables in
+	 *  dictionary \e dict. Return \c false if the expression or statements
+	 *  are invalid or if a name cannot be bound to a number, in which case
+	 *  they should be evaluated by Python.
+	 */
+	bool bind(const vectorstr & infoFields, PyObject * dict) const;
+
+	/// return \c true if sex or affection status of individuals are used.
+	bool usesInd() const
+	{
+		return m_usesInd;
+	}
+
+
+	/** Execute statements and evaluate the expression (\c 0 if there is no
+	 *  expression) for an individual with information fields \e info, sex
+	 *  \e sex and affection status \e affected. \e err is increased if an
+	 *  error (e.g. division by zero) happens. This function can be called
+	 *  by multiple threads after \c bind().
+	 */
+	double evaluate(InfoIterator info, double sex, double affected, int & err) const;
+
+	/// return \c true if the value of the bound expression has a fixed type.
+	bool hasFixedType() const
+	{
+		return m_type != TypeMixed;
+	}
+
+
+	/// convert a value returned by \c evaluate() to a string as Python does.
+	string valueAsString(double value) const;
+
+private:
+	enum valueType { TypeBool = 1, TypeInt = 2, TypeFloat = 3, TypeMixed = 4 };
+
+	enum opCode {
+		OpConst, OpName, OpSex, OpAffected, OpNeg, OpPos, OpNot,
+		OpAdd, OpSub, OpMul, OpDiv, OpFloorDiv, OpMod, OpPow,
+		OpCmp, OpAnd, OpOr, OpIfElse,
+		OpMin, OpMax, OpAbs, OpExp, OpLog, OpSqrt,
+		OpAssign
+	};
+
+	enum cmpCode { CmpLt, CmpLe, CmpGt, CmpGe, CmpEq, CmpNe };
+
+	struct exprNode
+	{
+		exprNode(int o = OpConst) : op(o), left(-1), right(-1), cond(-1), args(), cmps(),
+			name(), keys(), value(0), type(TypeFloat), infoIdx(InvalidValue)
+		{
+		}
+
+
+		int op;
+		/// operands of unary, binary and conditional operators
+		int left;
+		int right;
+		int cond;
+		/// arguments of functions and operands of chained comparisons
+		vectori args;
+		vectori cmps;
+		/// name of variable, and keys (string keys quoted) to index it
+		string name;
+		vectorstr keys;
+		/// value of constant or bound variable
+		mutable double value;
+		mutable int type;
+		/// index of bound information field
+		mutable size_t infoIdx;
+	};
+
+	struct exprStmt
+	{
+		string var;
+		int op;
+		int node;
+		mutable size_t infoIdx;
+	};
+
+	struct exprToken
+	{
+		int kind;
+		string text;
+	};
+
+	typedef std::vector<exprToken> exprTokens;
+
+	bool tokenize(const string & text, exprTokens & tokens) const;
+
+	int addNode(const exprNode & node);
+
+	int parseTest(const exprTokens & tokens, size_t & pos);
+
+	int parseOrTest(const exprTokens & tokens, size_t & pos);
+
+	int parseAndTest(const exprTokens & tokens, size_t & pos);
+
+	int parseNotTest(const exprTokens & tokens, size_t & pos);
+
+	int parseComparison(const exprTokens & tokens, size_t & pos);
+
+	int parseArith(const exprTokens & tokens, size_t & pos);
+
+	int parseTerm(const exprTokens & tokens, size_t & pos);
+
+	int parseFactor(const exprTokens & tokens, size_t & pos);
+
+	int parsePower(const exprTokens & tokens, size_t & pos);
+
+	int parseAtom(const exprTokens & tokens, size_t & pos);
+
+	double evalNode(int idx, InfoIterator info, double sex, double affected, int & err) const;
+
+	std::vector<exprNode> m_nodes;
+
+	std::vector<exprStmt> m_stmts;
+
+	/// root of the expression, -1 if there is no expression
+	int m_expr;
+
+	string m_indVar;
+
+	bool m_valid;
+
+	bool m_usesInd;
+
+	/// type of the expression after binding
+	mutable int m_type;
+};
+
 // ////////////////////////////////////////////////////////////
 // / Stream element, can be of different types
 // ////////////////////////////////////////////////////////////
@@ -1515,7 +1752,8 @@ public:
 	/// 1. output only file stream
 	/// 2. read/write file stream
 	/// 3. string stream for maximum performance.
-	enum streamType { OFSTREAM, FSTREAM, SSTREAM };
+	/// 4. output only file stream written by a background thread.
+	enum streamType { OFSTREAM, FSTREAM, SSTREAM, ASYNCSTREAM };
 
 	/** CPPONLY create a stream
 	 * \param name filename
@@ -1759,6 +1997,75 @@ private:
  */
 void closeOutput(const string & output = string());
 
+/** CPPONLY hand buffered asynchronous output to background writers, and wait
+ *  until everything is written to disk if \e wait is true. An exception is
+ *  raised if a background writer failed to write to its file.
+ */
+void flushOutput(bool wait);
+
+/// CPPONLY if newly opened output files should be written asynchronously
+bool asyncOutputActive();
+
+/** CPPONLY enable asynchronous output (if allowed by \c setOptions) during
+ *  the lifetime of this object. Pending output is written when the last
+ *  guard is destroyed.
+ */
+class AsyncOutputGuard
+{
+public:
+	AsyncOutputGuard();
+
+	~AsyncOutputGuard();
+};
+
+
+// maximum number of uncompressed bytes in a BGZF block, which leaves room for
+// incompressible data so that a compressed block never exceeds 64k.
+#define BGZF_BLOCK_SIZE 0xff00
+
+/** CPPONLY compress \e len bytes (at most \c BGZF_BLOCK_SIZE) from \e data
+ *  into a BGZF block, return \c false if zlib fails. This function does not
+ *  throw because it is called by multiple threads.
+ */
+bool compressBgzfBlock(const char * data, size_t len, string & block);
+
+/** CPPONLY
+ *  A writer that writes text to a plain file, or to a BGZF (blocked gzip)
+ *  file, a gzip file with a series of independently compressed members of
+ *  at most 64k bytes that can be read by any gzip decompressor and indexed
+ *  by tools such as tabix. Written text is buffered and buffered blocks are
+ *  compressed in parallel (using \c numThreads() threads) before they are
+ *  written sequentially, so the memory used by the writer is bounded by
+ *  the number of blocks compressed at a time.
+ */
+class BgzfWriter
+{
+public:
+	/// CPPONLY open file \e filename, which is compressed if \e compress is true.
+	BgzfWriter(const string & filename, bool compress);
+
+	/// close the file.
+	~BgzfWriter();
+
+	/// CPPONLY write \e text to the file
+	void write(const string & text);
+
+	/// CPPONLY compress and write all buffered text, add an EOF marker and close the file.
+	void close();
+
+private:
+	/// compress and write all full blocks, and the last partial block if \e all is true.
+	void flushBlocks(bool all);
+
+	std::ofstream m_file;
+
+	string m_filename;
+
+	bool m_compress;
+
+	string m_buffer;
+};
+
 // ////////////////////////////////////////////////////////////
 // / Random number generator
 // ////////////////////////////////////////////////////////////
@@ -1785,6 +2092,24 @@ private:
 };
 
 
+/// CPPONLY number of values generated at a time by the native generator
+#define NATIVE_RNG_BATCH 256
+
+/** CPPONLY State of the native \c xoshiro256++ random number generator. It
+ *  runs four independent streams side by side so that they can be advanced
+ *  together with SIMD instructions, and buffers a batch of their outputs.
+ */
+struct xoshiroState
+{
+	/// word k of the state of stream i is s[k][i]
+	uint64_t s[4][4];
+	uint64_t buf[NATIVE_RNG_BATCH];
+	size_t idx;
+};
+
+/// CPPONLY refill the output buffer of a native generator
+void xoshiroRefill(xoshiroState * state);
+
 /** This random number generator class wraps around a number of random number
  *  generators from GNU Scientific Library. You can obtain and change the
  *  RNG used by the current simuPOP module through the \c getRNG() function,
@@ -1801,7 +2126,9 @@ public:
 	 *  random number source will be used to guarantee that random seeds are
 	 *  used even if more than one simuPOP sessions are started simultaneously.
 	 *  Names of supported random number generators are available from
-	 *  <tt>moduleInfo()['availableRNGs']</tt>.
+	 *  <tt>moduleInfo()['availableRNGs']</tt>. In addition to generators
+	 *  from GSL, a native generator \c xoshiro256++ generates random numbers
+	 *  in batches and is much faster than others.
 	 */
 	RNG(const char * name = NULL, unsigned long seed = 0);
 
@@ -1847,6 +2174,8 @@ public:
 	 */
 	double randUniform()
 	{
+		if (m_native != NULL)
+			return (nativeNext() >> 11) * (1.0 / 9007199254740992.0);
 		return gsl_rng_uniform(m_RNG);
 	}
 
@@ -1861,10 +2190,41 @@ public:
 	 */
 	unsigned long int randInt(unsigned long int n)
 	{
+		if (m_native != NULL && n != 0 && n <= 0xFFFFFFFFUL)
+			return nativeInt(static_cast<uint32_t>(n));
 		return gsl_rng_uniform_int(m_RNG, n);
 	}
 
 
+	/** CPPONLY Fill \e res with \e count random numbers following a uniform
+	 *  [0, 1) distribution.
+	 */
+	void randUniforms(double * res, size_t count);
+
+	/** CPPONLY Fill \e res with \e count random numbers in the range of
+	 *  <tt>[0, 1, 2, ... n-1]</tt>.
+	 */
+	void randInts(unsigned long int n, unsigned long int * res, size_t count);
+
+	/** CPPONLY Fill \e res with \e count random numbers following a
+	 *  geometric distribution with parameter \e p, namely the number of
+	 *  trials until the first success.
+	 */
+	void randGeometrics(double p, long * res, size_t count);
+
+	/** CPPONLY Fill \e count words starting from \e res with random bits.
+	 */
+	void randBits(WORDTYPE * res, size_t count);
+
+	/** CPPONLY Fill \e count words starting from \e res with bits that are
+	 *  \c 1 with probability \e p (with a precision of 2^-32). Bits are
+	 *  generated 256 at a time by combining random words according to the
+	 *  binary expansion of \e p, which is efficient unless \e p is close
+	 *  to \c 0 or \c 1.
+	 */
+	void randBernoulliBits(double p, WORDTYPE * res, size_t count);
+
+
 	/** Generate a random number following a normal distribution with mean
 	 *  \e mu and standard deviation \e sigma.
 	 *  <group>4-distribution</group>
@@ -1979,6 +2339,32 @@ public:
 
 
 private:
+	/// next 64 random bits from the native generator
+	uint64_t nativeNext()
+	{
+		if (m_native->idx == NATIVE_RNG_BATCH)
+			xoshiroRefill(m_native);
+		return m_native->buf[m_native->idx++];
+	}
+
+
+	/// a random number in [0, n) using Lemire's multiply and shift method
+	unsigned long int nativeInt(uint32_t n)
+	{
+		uint64_t m = (nativeNext() >> 32) * static_cast<uint64_t>(n);
+		uint32_t l = static_cast<uint32_t>(m);
+
+		if (l < n) {
+			uint32_t t = (0U - n) % n;
+			while (l < t) {
+				m = (nativeNext() >> 32) * static_cast<uint64_t>(n);
+				l = static_cast<uint32_t>(m);
+			}
+		}
+		return static_cast<unsigned long int>(m >> 32);
+	}
+
+
 	ULONG search_poisson(UINT y, double * z, double p, double lambda);
 
 	ULONG search_binomial(UINT y, double * z, double p, UINT n, double pr);
@@ -1987,6 +2373,9 @@ private:
 	/// global random number generator
 	gsl_rng * m_RNG;
 
+	/// state of m_RNG if it is the native generator, NULL otherwise
+	xoshiroState * m_native;
+
 	/// seed used
 	unsigned long m_seed;
 
@@ -2063,7 +2452,7 @@ public:
 	 *  numbers will be returned in \e N returned numbers.
 	 */
 	WeightedSampler(const vectorf & weights = vectorf(), ULONG N = 0)
-		: m_algorithm(0), m_q(0), m_a(0), m_param(0),
+		: m_algorithm(0), m_weights(0), m_q(0), m_a(0), m_param(0),
 		m_sequence(0), m_index(0)
 	{
 
@@ -2087,6 +2476,12 @@ public:
 
 		// this is the case with unknown number of outputs
 		if (N == 0) {
+			// reuse the sampler if weights are unchanged, which is common
+			// for samplers that are set every generation
+			if (m_algorithm != 0 && m_algorithm != 4 && sz == m_weights.size() &&
+			    std::equal(first, last, m_weights.begin()))
+				return;
+			m_weights.assign(first, last);
 			m_N = sz;
 			// no weight (wrong case)
 			if (m_N == 0) {
@@ -2136,53 +2531,10 @@ public:
 			}
 			// the mos difficult case
 			m_algorithm = 3;
-			// sum of weight
-			double w = accumulate(first, last, 0.0);
-
-			DBG_FAILIF(fcmp_le(w, 0), ValueError, "Sum of weight is <= 0.");
-
-			w = m_N / w;
-
-			// initialize p with N*p0,...N*p_k-1
-			m_q.resize(m_N);
-
-			for (size_t i = 0; i < m_N; ++i)
-				m_q[i] = *(first + i) * w;
-
-			// initialize Y with values
-			m_a.resize(m_N);
-			for (size_t i = 0; i < m_N; ++i)
-				m_a[i] = i;
-			// use two sets H and L
-			// for efficiency purpose, use a single vector.
-			size_t * HL = new size_t[m_N];
-			size_t * L = HL;
-			size_t * H = HL + m_N - 1;                                 // point to the end.
-
-			for (size_t i = 0; i < m_N; ++i) {
-				if (m_q[i] > 1)
-					*H-- = i;
-				else
-					*L++ = i;
-			}
-
-			//
-			size_t j, k;
-			while (L != HL && H != HL + m_N - 1) {
-				j = *(L - 1);
-				k = *(H + 1);
-				m_a[j] = k;
-				m_q[k] += m_q[j] - 1;
-
-				L--;                                                                    // remove j from L
-				if (m_q[k] < 1.) {
-					*L++ = k;                                                           // add k to L
-					++H;                                                                // remove k from H
-				}
-			}
-			delete[] HL;
+			buildAliasTable();
 		} else {
 			m_algorithm = 4;
+			m_weights.clear();
 			for (size_t i = 0; i < sz; ++i) {
 				DBG_FAILIF(*(first + i) < 0 || *(first + i) > 1, ValueError,
 					"Proportions should be between 0 and 1");
@@ -2219,10 +2571,26 @@ public:
 	 */
 	vectoru drawSamples(ULONG n = 1);
 
+	/** Change weights at \e indexes to \e weights and update the sampler,
+	 *  without passing all weights again. This function can only be called
+	 *  for samplers that are created without \e N.
+	 */
+	void update(const uintList & indexes, const vectorf & weights);
+
 private:
+	/// build alias table from weights in m_weights
+	void buildAliasTable();
+
+	/// pair \e n items with alias, return number of unpaired items, which
+	/// are moved to the beginning of \e items.
+	size_t pairAliases(size_t * items, size_t n, size_t * HL);
+
 	/// which algorithm to use
 	int m_algorithm;
 
+	/// weights of the sampler (algorithms 1, 2 and 3)
+	vectorf m_weights;
+
 	/// length of weight.
 	size_t m_N;
 
@@ -2242,6 +2610,133 @@ private:
 };
 
 
+/** CPPONLY This class records occupied sites in a range <tt>[beg, end)</tt>
+ *  of a mutational space in blocks of 64 sites. If few sites are occupied,
+ *  only blocks with occupied sites are saved in a hash table and random
+ *  vacant sites are located by rejection, which needs at most 1.5 trials
+ *  on average. If more than a quarter of the blocks have occupied sites,
+ *  all blocks are saved in a bitmap and a Fenwick tree counts occupied sites
+ *  of blocks, so that random vacant sites are located in <tt>O(log n)</tt>
+ *  time. Memory usage is therefore proportional to the number of occupied
+ *  sites, not the size of the range.
+ */
+class OccupancyIndex
+{
+public:
+	OccupancyIndex() : m_beg(0), m_end(0), m_blocks(), m_bits(), m_tree(),
+		m_count(0), m_numBlocks(0), m_dense(false)
+	{
+	}
+
+
+	/// clear the index and set its range to <tt>[beg, end)</tt>
+	void reset(size_t beg, size_t end);
+
+	/// mark sites in <tt>[begin, end)</tt> that are in the range of the index as occupied
+	template<typename IT>
+	void markOccupied(IT begin, IT end)
+	{
+		for (; begin != end; ++begin) {
+			size_t loc = static_cast<size_t>(*begin);
+			if (loc >= m_beg && loc < m_end)
+				occupy(loc);
+		}
+	}
+
+
+	size_t begin() const
+	{
+		return m_beg;
+	}
+
+
+	size_t end() const
+	{
+		return m_end;
+	}
+
+
+	/// number of occupied sites
+	size_t count() const
+	{
+		return m_count;
+	}
+
+
+	/// number of vacant sites
+	size_t vacant() const
+	{
+		return m_end - m_beg - m_count;
+	}
+
+
+	bool occupied(size_t loc) const
+	{
+		DBG_FAILIF(loc < m_beg || loc >= m_end, IndexError, "Site out of range of occupancy index");
+		return (block((loc - m_beg) >> 6) & (uint64_t(1) << ((loc - m_beg) & 63))) != 0;
+	}
+
+
+	/// mark \e loc as occupied
+	void occupy(size_t loc);
+
+	/// mark \e loc as vacant
+	void release(size_t loc);
+
+	/// return a random vacant site, or \c end() if all sites are occupied
+	size_t randVacantSite() const;
+
+private:
+#if TR1_SUPPORT == 0
+	typedef std::map<size_t, uint64_t> BlockMap;
+#else
+	typedef std::tr1::unordered_map<size_t, uint64_t> BlockMap;
+#endif
+
+	/// occupied sites of block \e idx
+	uint64_t block(size_t idx) const
+	{
+		if (m_dense)
+			return m_bits[idx];
+		BlockMap::const_iterator it = m_blocks.find(idx);
+		return it == m_blocks.end() ? 0 : it->second;
+	}
+
+
+	/// set occupied sites of block \e idx, switch storage if needed
+	void setBlock(size_t idx, uint64_t bits);
+
+	/// save all blocks in a bitmap if \e dense is true, or in a hash table
+	void setDense(bool dense);
+
+	/// add \e delta to the count of block \e idx
+	void updateTree(size_t idx, long delta);
+
+	/// the \e k-th (starting from 0) vacant site, only for dense storage
+	size_t vacantSite(size_t k) const;
+
+	size_t m_beg;
+
+	size_t m_end;
+
+	/// blocks with occupied sites if the storage is sparse
+	BlockMap m_blocks;
+
+	/// bitmap of sites if the storage is dense, bits after m_end are not used
+	vector<uint64_t> m_bits;
+
+	/// Fenwick tree of number of occupied sites (1-based) if the storage is dense
+	vector<size_t> m_tree;
+
+	size_t m_count;
+
+	/// number of blocks with occupied sites
+	size_t m_numBlocks;
+
+	bool m_dense;
+};
+
+
 /** this class encapsulate behavior of a sequence of Bernulli trial.
  *  the main idea is that when doing a sequence of Bernulli trials
  *  of the same probability, we can use much quicker algorithms
@@ -2505,6 +3000,10 @@ private:
  *  \li \c maxIndex: maximum index size (limits population size * total number of marker).
  *  \li \c debug: A dictionary with debugging codes as keys and the status of each
  *       debugging code (\c True or \c False) as their values.
+ *  \li \c asyncOutput: A dictionary with the maximum number of bytes queued
+ *       for each file (\c bufferSize, \c 0 for synchronous output), number
+ *       of bytes written by background writers (\c bytesWritten), and time
+ *       in seconds the simulation was blocked waiting for them (\c blockedTime).
  */
 PyObject * moduleInfo();
 
@@ -56,7 +56,7 @@ import time
 from simuOpt import simuOptions
 
 from simuPOP import moduleInfo, MALE, FEMALE, Population, PointMutator, getRNG,\
-    ALL_AVAIL, PyOperator, stat
+    ALL_AVAIL, PyOperator, stat, SavePlink, SaveVCF, loadVCF
 
 def viewVars(var, gui=None):
     '''
@@ -190,7 +190,7 @@ def migrHierarchicalIslandRates(r1, r2, n):
     return m
 
 
-def migrSteppingStoneRates(r, n, circular=False):
+def migrSteppingStoneRates(r, n, circular=False, sparse=False):
     '''migration rate matrix for circular stepping stone model (X=1-m)
 
 ::
@@ -211,8 +211,22 @@ or non-circular
            ...
            ...              m   X
 
-    This function returns [[1]] when there is only one subpopulation.
+    This function returns [[1]] when there is only one subpopulation. If
+    ``sparse`` is set to ``True``, a sparse matrix in the form of a list of
+    dictionaries with non-zero migration rates to other subpopulations is
+    returned.
     '''
+    if sparse:
+        if n < 2:
+            return [{}]
+        m = []
+        for i in range(n):
+            if circular:
+                neighbors = set([(i + 1) % n, (i + n - 1) % n]) - set([i])
+            else:
+                neighbors = [x for x in [i - 1, i + 1] if x >= 0 and x < n]
+            m.append(dict([(x, r * 1.0 / len(neighbors)) for x in neighbors]))
+        return m
     if n < 2:
         return [[1]]
     elif n == 2:
@@ -2123,6 +2137,61 @@ class PEDExporter:
                 raise ValueError('Exporting non-diploid population in PED format is not currently supported.')
             self._exportPedigree(pop, output, subPops, gui)
 
+#
+# Format PLINK binary (bed/bim/fam)
+#
+class PlinkExporter:
+    '''An exporter to export given population in PLINK binary format. The
+    genotypes are written by operator ``SavePlink`` directly from the genotype
+    storage of the population, so this exporter only works with filenames.'''
+    def __init__(self, idField = 'ind_id', fatherField = 'father_id',
+        motherField = 'mother_id', phenoField = None, adjust = 1,
+        posMultiplier = 1, blockSize = 4096):
+        self.idField = idField
+        self.fatherField = fatherField
+        self.motherField = motherField
+        self.phenoField = phenoField
+        self.adjust = adjust
+        self.posMultiplier = posMultiplier
+        self.blockSize = blockSize
+
+    def export(self, pop, output, subPops, infoFields, gui):
+        raise ValueError('PLINK binary format can only be exported to files.')
+
+    def exportToFile(self, pop, filename, subPops, infoFields, gui):
+        '''Export in PLINK binary format to filename.bed, filename.bim and
+        filename.fam. An extension .bed, .bim or .fam is ignored.'''
+        prefix = filename.lstrip('>')
+        if prefix[-4:] in ['.bed', '.bim', '.fam']:
+            prefix = prefix[:-4]
+        SavePlink(output=prefix, idField=self.idField,
+            fatherField=self.fatherField, motherField=self.motherField,
+            phenoField='' if self.phenoField is None else self.phenoField,
+            adjust=self.adjust, posMultiplier=self.posMultiplier,
+            blockSize=self.blockSize, subPops=list(subPops)).apply(pop)
+
+#
+# Format VCF
+#
+class VCFExporter:
+    '''An exporter to export given population in Variant Call Format. The
+    genotypes are written by operator ``SaveVCF`` directly from the genotype
+    storage of the population, so this exporter only works with filenames.'''
+    def __init__(self, idField = 'ind_id', posMultiplier = 1, blockSize = 1024):
+        self.idField = idField
+        self.posMultiplier = posMultiplier
+        self.blockSize = blockSize
+
+    def export(self, pop, output, subPops, infoFields, gui):
+        raise ValueError('VCF format can only be exported to files.')
+
+    def exportToFile(self, pop, filename, subPops, infoFields, gui):
+        '''Export in VCF format to filename, which is compressed in BGZF
+        format if it ends with .gz'''
+        SaveVCF(output=filename.lstrip('>'), idField=self.idField,
+            posMultiplier=self.posMultiplier, blockSize=self.blockSize,
+            subPops=list(subPops)).apply(pop)
+
 #
 # Format Phylip
 #
@@ -2648,6 +2717,17 @@ class MSExporter:
                 'subPop, and chrom')
 
 
+class VCFImporter:
+    def __init__(self, samples=ALL_AVAIL, regions=ALL_AVAIL, infoFields=[]):
+        self.samples = samples
+        self.regions = regions
+        self.infoFields = infoFields
+
+    def importFrom(self, filename):
+        return loadVCF(filename, samples=self.samples, regions=self.regions,
+            infoFields=self.infoFields)
+
+
 class MSImporter:
     def __init__(self, ploidy=1, mergeBy='subPop'):
         self.ploidy = ploidy
@@ -2923,6 +3003,69 @@ class Exporter(PyOperator):
         which genotypes on different chromosomes will be outputted separately.
 
 
+    PLINK (binary PED format of PLINK), which consists of a ``.bed`` file with
+    SNP-major genotypes, a ``.bim`` file with marker information, and a ``.fam``
+    file with individual information. Genotypes are written in C++ directly
+    from the genotype storage of the population, so this format is much faster
+    than the PED format for large populations. Parameter ``output`` should be
+    a filename (prefix) because three files will be written, with extension
+    ``.bed``, ``.bim`` or ``.fam`` removed. Because the ``.bed`` format only
+    stores biallelic markers, all non-zero alleles are exported as allele
+    ``1+adjust``, and allele 0 is exported as ``0+adjust``. Chromosome X of
+    male individuals are outputted as homozygous and chromosome Y of female
+    individuals are outputted as missing. Individuals are outputted as
+    unrelated individuals with incremental family IDs, and with individual
+    and parental IDs from information fields ``idField``, ``fatherField`` and
+    ``motherField`` if these fields exist (0 otherwise). This format accepts
+    the following parameters:
+
+    idField, fatherField, motherField
+        Information fields for individual and parental IDs, default to
+        ``ind_id``, ``father_id`` and ``mother_id``.
+
+    phenoField
+        A field for individual phenotype that will be outputted as the sixth
+        column of the ``.fam`` file. If ``None`` is specified (default),
+        individual affection status will be outputted (1 for unaffected and
+        2 for affected).
+
+    adjust
+        Adjust names of alleles by specified value (1 as default) because
+        PLINK treats allele 0 as missing value.
+
+    posMultiplier
+        A number that will be multiplied to loci positions (default to 1).
+        The result will be rounded and outputted as base-pair positions of
+        markers in the ``.bim`` file.
+
+    blockSize
+        Number of loci that are transposed and written at a time (default
+        to 4096).
+
+    VCF (Variant Call Format, version 4.2), with one line for each locus and
+    phased genotypes of individuals in the present generation. Genotypes are
+    formatted in C++ directly from the genotype storage of the population,
+    and the output is compressed in BGZF format (readable by ``bgzip`` and
+    ``tabix``) using multiple threads if ``output`` ends with ``.gz``. Names
+    of allele 0 are outputted as reference alleles and names of non-zero
+    alleles that appear in the exported individuals are outputted as
+    alternative alleles. Chromosome X of males and mitochondrial DNA are
+    outputted as haploid genotypes, and chromosome Y of females are outputted
+    as missing. This format accepts the following parameters:
+
+    idField
+        An information field with IDs of individuals, which are used as sample
+        names (default to ``ind_id``). Individuals are named ``S1``, ``S2``, ...
+        if the population does not have this field.
+
+    posMultiplier
+        A number that will be multiplied to loci positions (default to 1).
+        The result will be rounded and outputted as positions of sites.
+
+    blockSize
+        Number of loci that are formatted and compressed at a time (default
+        to 1024).
+
     CSV (comma separated values). This is a general format that output genotypes in
     comma (or tab etc) separated formats. The function form of this operator 
     ``export(format='csv')`` is similar to the now-deprecated ``saveCSV`` function,
@@ -2996,6 +3139,10 @@ class Exporter(PyOperator):
             self.exporter = MapExporter(*args, **kwargs)
         elif format.lower() == 'ped':
             self.exporter = PEDExporter(*args, **kwargs)
+        elif format.lower() == 'plink':
+            self.exporter = PlinkExporter(*args, **kwargs)
+        elif format.lower() == 'vcf':
+            self.exporter = VCFExporter(*args, **kwargs)
         elif format.lower() == 'phylip':
             self.exporter = PhylipExporter(*args, **kwargs)
         elif format.lower() == 'csv':
@@ -3069,6 +3216,11 @@ class Exporter(PyOperator):
                 mode = 'w'
             if bin_mode:
                 mode += 'b'
+            if hasattr(self.exporter, 'exportToFile'):
+                # exporters that write one or more files by themselves
+                self.exporter.exportToFile(pop, output,
+                    self._determineSubPops(pop), self.infoFields, gui=self.gui)
+                return True
             with open(output.lstrip('>'), mode) as out:
                 self.exporter.export(pop, out.write,
                     self._determineSubPops(pop), self.infoFields, gui=self.gui)
@@ -3160,6 +3312,24 @@ def importPopulation(format, filename, *args, **kwargs):
         subpopulations have different segregating sites. If ``mergeBy`` is set
         to ``"chrom"``, the replicates will be presented as separate chromosomes,
         each with a different set of loci determined by segregating sites.
+
+    VCF (Variant Call Format), which can be plain text or compressed by
+    ``gzip`` or ``bgzip``. Genotypes are parsed in C++ by function ``loadVCF``
+    and stored directly in the returned population, which has a single
+    subpopulation, one chromosome for each contig, and reference and
+    alternative alleles as alleles 0, 1, ... with their names as allele names.
+    Missing alleles are imported as allele 0. This format accepts the
+    following parameters:
+
+    samples
+        Names of samples to import (default to all samples).
+
+    regions
+        A list of regions in the format of ``chr`` or ``chr:begin-end`` with
+        1-based inclusive positions (default to all sites).
+
+    infoFields
+        Information fields of the returned population.
     '''
     if format.lower() == 'genepop':
         importer = GenePopImporter(*args, **kwargs)
@@ -3169,6 +3339,8 @@ def importPopulation(format, filename, *args, **kwargs):
         importer = PhylipImporter(*args, **kwargs)
     elif format.lower() == 'ms':
         importer = MSImporter(*args, **kwargs)
+    elif format.lower() == 'vcf':
+        importer = VCFImporter(*args, **kwargs)
     else:
         raise ValueError('Importing genotypes in format %s is currently not supported' % format)
     return importer.importFrom(filename)
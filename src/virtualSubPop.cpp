@@ -307,6 +307,52 @@ size_t BaseVspSplitter::countVisibleInds(const Population & pop, size_t subPop)
 }
 
 
+const vectoru * BaseVspSplitter::cachedIndexes(size_t subPop, size_t virtualSubPop) const
+{
+	if (m_cacheCount != indModificationCount())
+		return NULL;
+	std::map<std::pair<size_t, size_t>, vectoru>::const_iterator it =
+		m_cache.find(std::make_pair(subPop, virtualSubPop));
+	return it == m_cache.end() ? NULL : &it->second;
+}
+
+
+void BaseVspSplitter::cacheIndexes(const Population & pop, size_t subPop, size_t virtualSubPop)
+{
+	DBG_ASSERT(activatedSubPop() == subPop, SystemError,
+		"Only activated virtual subpopulation can be cached");
+	if (m_cacheCount != indModificationCount()) {
+		m_cache.clear();
+		m_cacheCount = indModificationCount();
+	}
+	vectoru & indexes = m_cache[std::make_pair(subPop, virtualSubPop)];
+	indexes.clear();
+	ConstRawIndIterator begin = pop.rawIndBegin(subPop);
+	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
+	for (ConstRawIndIterator it = begin; it != it_end; ++it)
+		if (it->visible())
+			indexes.push_back(it - begin);
+}
+
+
+void BaseVspSplitter::activateIndexes(const Population & pop, size_t subPop, const vectoru & indexes)
+{
+	// indexes are sorted so visibility of all individuals is set in one pass,
+	// without evaluating the condition of the virtual subpopulation
+	ConstRawIndIterator it = pop.rawIndBegin(subPop);
+	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
+	vectoru::const_iterator idx = indexes.begin();
+	vectoru::const_iterator idx_end = indexes.end();
+	for (size_t i = 0; it != it_end; ++it, ++i) {
+		bool visible = idx != idx_end && *idx == i;
+		it->setVisible(visible);
+		if (visible)
+			++idx;
+	}
+	m_activated = subPop;
+}
+
+
 size_t BaseVspSplitter::vspByName(const string & vspName) const
 {
 	if (!m_names.empty()) {
@@ -607,15 +653,8 @@ size_t SexSplitter::size(const Population & pop, size_t subPop, size_t virtualSu
 {
 	if (virtualSubPop == InvalidValue)
 		return countVisibleInds(pop, subPop);
-	ConstRawIndIterator it = pop.rawIndBegin(subPop);
-	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
-	size_t count = 0;
-	Sex s = virtualSubPop == 0 ? MALE : FEMALE;
-
-	for (; it != it_end; ++it)
-		if (it->sex() == s)
-			++count;
-	return count;
+	size_t numMales = Population::countBits(pop.maleBits(subPop), pop.subPopBegin(subPop), pop.subPopEnd(subPop));
+	return virtualSubPop == 0 ? numMales : pop.subPopSize(subPop) - numMales;
 }
 
 
@@ -656,16 +695,9 @@ size_t AffectionSplitter::size(const Population & pop, size_t subPop, size_t vir
 {
 	if (virtualSubPop == InvalidValue)
 		return countVisibleInds(pop, subPop);
-	ConstRawIndIterator it = pop.rawIndBegin(subPop);
-	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
-	size_t count = 0;
+	size_t numAffected = Population::countBits(pop.affectedBits(subPop), pop.subPopBegin(subPop), pop.subPopEnd(subPop));
 	// 0 is unaffected
-	bool aff = virtualSubPop == 0 ? false : true;
-
-	for (; it != it_end; ++it)
-		if (it->affected() == aff)
-			++count;
-	return count;
+	return virtualSubPop == 0 ? pop.subPopSize(subPop) - numAffected : numAffected;
 }
 
 
@@ -707,6 +739,7 @@ InfoSplitter::InfoSplitter(string info, const floatList & values,
 	: BaseVspSplitter(names),
 	m_info(info), m_values(values.elems()), m_cutoff(cutoff.elems()), m_ranges(ranges.elems())
 {
+	PARAM_FAILIF(ranges.isSparse(), ValueError, "A list of [lower, upper] ranges is expected.");
 	DBG_FAILIF(m_values.empty() && m_cutoff.empty() && m_ranges.empty(),
 		ValueError, "Please specify either a list of values, a set of cutoff values or ranges");
 	DBG_FAILIF(m_values.empty() + m_cutoff.empty() + m_ranges.empty() != 2,
@@ -730,65 +763,86 @@ InfoSplitter::InfoSplitter(string info, const floatList & values,
 }
 
 
+// values v of an information field that belong to a virtual subpopulation
+// defined by an InfoSplitter, namely lower <= v < upper, or v == value
+struct infoRange
+{
+	bool byValue;
+	double value;
+	bool hasLower;
+	double lower;
+	bool hasUpper;
+	double upper;
+
+	bool contains(double v) const
+	{
+		if (byValue)
+			return fcmp_eq(v, value);
+		return (!hasLower || v >= lower) && (!hasUpper || v < upper);
+	}
+
+};
+
+static infoRange vspInfoRange(const vectorf & cutoff, const vectorf & values,
+                              const matrixf & ranges, size_t virtualSubPop)
+{
+	infoRange range = { false, 0, false, 0, false, 0 };
+
+	if (!cutoff.empty()) {
+		DBG_FAILIF(static_cast<UINT>(virtualSubPop) > cutoff.size(), IndexError,
+			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % cutoff.size()).str());
+		// using cutoff, below, in between, or above
+		if (virtualSubPop > 0) {
+			range.hasLower = true;
+			range.lower = cutoff[virtualSubPop - 1];
+		}
+		if (virtualSubPop < cutoff.size()) {
+			range.hasUpper = true;
+			range.upper = cutoff[virtualSubPop];
+		}
+	} else if (!values.empty()) {
+		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= values.size(), IndexError,
+			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % (values.size() - 1)).str());
+		range.byValue = true;
+		range.value = values[virtualSubPop];
+	} else {
+		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= ranges.size(), IndexError,
+			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % (ranges.size() - 1)).str());
+		range.hasLower = true;
+		range.lower = ranges[virtualSubPop][0];
+		range.hasUpper = true;
+		range.upper = ranges[virtualSubPop][1];
+	}
+	return range;
+}
+
+
 size_t InfoSplitter::size(const Population & pop, size_t subPop, size_t virtualSubPop) const
 {
 	if (virtualSubPop == InvalidValue)
 		return countVisibleInds(pop, subPop);
 	size_t idx = pop.infoIdx(m_info);
-
-	size_t count = 0;
+	infoRange range = vspInfoRange(m_cutoff, m_values, m_ranges, virtualSubPop);
 
 	ConstRawIndIterator it = pop.rawIndBegin(subPop);
-	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
-
-	if (!m_cutoff.empty()) {
-		DBG_FAILIF(static_cast<UINT>(virtualSubPop) > m_cutoff.size(), IndexError,
-			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_cutoff.size()).str());
+	ssize_t numInds = pop.rawIndEnd(subPop) - it;
+	size_t count = 0;
 
-		// using cutoff, below
-		if (virtualSubPop == 0) {
-			for (; it != it_end; ++it)
-				if (it->info(idx) < m_cutoff[0])
-					count++;
-			return count;
-		} else if (static_cast<UINT>(virtualSubPop) == m_cutoff.size()) {
-			double v = m_cutoff.back();
-			for (; it != it_end; ++it)
-				if (it->info(idx) >= v)
-					count++;
-			return count;
-		} else {         // in between
-			double v1 = m_cutoff[virtualSubPop - 1];
-			double v2 = m_cutoff[virtualSubPop];
-			for (; it != it_end; ++it) {
-				double v = it->info(idx);
-				if (v >= v1 && v < v2)
-					count++;
-			}
-			return count;
-		}
-	} else if (!m_values.empty()) {
-		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_values.size(), IndexError,
-			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % (m_values.size() - 1)).str());
-		double v = m_values[virtualSubPop];
-		for (; it != it_end; ++it)
-			if (fcmp_eq(it->info(idx), v))
-				count++;
-		return count;
+	// scan the field directly if it is stored in the order of individuals
+	const double * column = pop.infoColumn(idx, subPop);
+	if (column) {
+		size_t step = pop.infoSize();
+#pragma omp parallel for reduction(+ : count) if(numThreads() > 1)
+		for (ssize_t i = 0; i < numInds; ++i)
+			if (range.contains(column[i * step]))
+				++count;
 	} else {
-		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_ranges.size(), IndexError,
-			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % (m_ranges.size() - 1)).str());
-		double v1 = m_ranges[virtualSubPop][0];
-		double v2 = m_ranges[virtualSubPop][1];
-		for (; it != it_end; ++it) {
-			double v = it->info(idx);
-			if (v >= v1 && v < v2)
-				count++;
-		}
-		return count;
+#pragma omp parallel for reduction(+ : count) if(numThreads() > 1)
+		for (ssize_t i = 0; i < numInds; ++i)
+			if (range.contains((it + i)->info(idx)))
+				++count;
 	}
-	// should never reach here.
-	return 0;
+	return count;
 }
 
 
@@ -841,45 +895,21 @@ bool InfoSplitter::contains(const Population & pop, size_t ind, vspID vsp) const
 void InfoSplitter::activate(const Population & pop, size_t subPop, size_t virtualSubPop)
 {
 	size_t idx = pop.infoIdx(m_info);
+	infoRange range = vspInfoRange(m_cutoff, m_values, m_ranges, virtualSubPop);
 
 	ConstRawIndIterator it = pop.rawIndBegin(subPop);
-	ConstRawIndIterator it_end = pop.rawIndEnd(subPop);
-
-	if (!m_cutoff.empty()) {
-		DBG_FAILIF(static_cast<UINT>(virtualSubPop) > m_cutoff.size(), IndexError,
-			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_cutoff.size()).str());
-
-		// using cutoff, below
-		if (virtualSubPop == 0) {
-			for (; it != it_end; ++it)
-				it->setVisible(it->info(idx) < m_cutoff[0]);
-		} else if (static_cast<size_t>(virtualSubPop) == m_cutoff.size()) {
-			double v = m_cutoff.back();
-			for (; it != it_end; ++it)
-				it->setVisible(it->info(idx) >= v);
-		} else {         // in between
-			double v1 = m_cutoff[virtualSubPop - 1];
-			double v2 = m_cutoff[virtualSubPop];
-			for (; it != it_end; ++it) {
-				double v = it->info(idx);
-				it->setVisible(v >= v1 && v < v2);
-			}
-		}
-	} else if (!m_values.empty()) {
-		DBG_FAILIF(static_cast<UINT>(virtualSubPop) >= m_values.size(), IndexError,
-			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_values.size()).str());
-		double v = m_values[virtualSubPop];
-		for (; it != it_end; ++it)
-			it->setVisible(fcmp_eq(it->info(idx), v));
+	ssize_t numInds = pop.rawIndEnd(subPop) - it;
+
+	const double * column = pop.infoColumn(idx, subPop);
+	if (column) {
+		size_t step = pop.infoSize();
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = 0; i < numInds; ++i)
+			(it + i)->setVisible(range.contains(column[i * step]));
 	} else {
-		DBG_FAILIF(static_cast<size_t>(virtualSubPop) >= m_ranges.size(), IndexError,
-			(boost::format("Virtual Subpoplation index out of range of 0 ~ %1%") % m_ranges.size()).str());
-		double v1 = m_ranges[virtualSubPop][0];
-		double v2 = m_ranges[virtualSubPop][1];
-		for (; it != it_end; ++it) {
-			double v = it->info(idx);
-			it->setVisible(v >= v1 && v < v2);
-		}
+#pragma omp parallel for if(numThreads() > 1)
+		for (ssize_t i = 0; i < numInds; ++i)
+			(it + i)->setVisible(range.contains((it + i)->info(idx)));
 	}
 	m_activated = subPop;
 }
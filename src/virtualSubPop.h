@@ -298,7 +298,8 @@ public:
 	/** This is a virtual class that cannot be instantiated.
 	 */
 	BaseVspSplitter(const stringList & names = vectorstr()) :
-		m_names(names.elems()), m_activated(InvalidValue)
+		m_names(names.elems()), m_activated(InvalidValue),
+		m_cache(), m_cacheCount(0)
 	{
 	}
 
@@ -349,6 +350,33 @@ public:
 	}
 
 
+	/** Return indexes (relative to subpopulation \e subPop) of individuals
+	 *  in virtual subpopulation \e virtualSubPop, if they have been cached
+	 *  and no individual has been changed since then. Return \c NULL
+	 *  otherwise.
+	 *  CPPONLY
+	 */
+	const vectoru * cachedIndexes(size_t subPop, size_t virtualSubPop) const;
+
+	/** Save indexes of visible individuals in activated subpopulation
+	 *  \e subPop as members of virtual subpopulation \e virtualSubPop.
+	 *  CPPONLY
+	 */
+	void cacheIndexes(const Population & pop, size_t subPop, size_t virtualSubPop);
+
+	/** Activate subpopulation \e subPop so that only individuals at cached
+	 *  \e indexes are visible.
+	 *  CPPONLY
+	 */
+	void activateIndexes(const Population & pop, size_t subPop, const vectoru & indexes);
+
+	/// CPPONLY discard all cached indexes
+	void clearCache()
+	{
+		m_cache.clear();
+	}
+
+
 	/** Return the name of VSP \e vsp (an index between \c 0 and
 	 *  <tt>numVirtualSubPop()</tt>).
 	 */
@@ -365,6 +393,13 @@ protected:
 	vectorstr m_names;
 
 	size_t m_activated;
+
+private:
+	/// indexes of individuals in each (subPop, virtualSubPop)
+	std::map<std::pair<size_t, size_t>, vectoru> m_cache;
+
+	/// indModificationCount() when the cache was filled
+	size_t m_cacheCount;
 };
 
 typedef std::vector<BaseVspSplitter *> vectorsplitter;
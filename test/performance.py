@@ -1072,6 +1072,33 @@ class TestSortIndividuals(PerformanceTest):
             stmt = "pop.sortIndividuals('a')")
         return t.timeit(number=self.repeats)
 
+class TestWeightedSampler(PerformanceTest):
+    
+    def __init__(self, logger, repeats=10):
+        PerformanceTest.__init__(self, 'WeightedSampler, results are time (not processor time) to create a sampler, '
+            'to update 1%% of its weights, and to draw as many samples as weights, for %d times.' % int(repeats),
+            logger)
+        self.repeats = repeats
+
+    def run(self):
+        # overall running case
+        results = []
+        for size in [100000, 1000000, 10000000]:
+            results.extend(self._run(size))
+        return results
+
+    def _run(self, size):
+        # single test case
+        setup = 'from __main__ import WeightedSampler, random\n' \
+            "weights = [random.random() for x in range(%d)]\n" \
+            "indexes = random.sample(range(%d), %d)\n" \
+            "newWeights = [random.random() for x in indexes]\n" \
+            "ws = WeightedSampler(weights)\n" % (size, size, size // 100)
+        return [timeit.Timer(setup=setup, stmt=stmt).timeit(number=self.repeats) for stmt in [
+                'WeightedSampler(weights)',
+                'ws.update(indexes, newWeights)',
+                'ws.drawSamples(%d)' % size]]
+
 class TestMutator(PerformanceTest):
     
     def __init__(self, logger, repeats=10):
@@ -10,7 +10,7 @@
 # $LastChangedDate$
 #
   
-import unittest, os, sys, random, copy
+import unittest, os, sys, random, copy, gc
 from simuOpt import setOptions
 setOptions(quiet=True)
 new_argv = []
@@ -167,7 +167,74 @@ class TestPopulation(unittest.TestCase):
         self.assertEqual(len(arr), pop.genoSize()*pop.subPopSize(1))
         self.assertRaises(IndexError, pop.genotype, 2)
 
-
+    def testGenotypeBuffer(self):
+        'Testing buffer interface of Population::genotype() and infoArray()'
+        if sys.version_info[0] < 3:
+            return
+        pop = Population(loci=[1, 2], size=[1, 2], infoFields=['a', 'b'])
+        if moduleInfo()['alleleType'] in ['binary', 'mutant']:
+            self.assertRaises(BufferError, memoryview, pop.genotype())
+        else:
+            pop.setGenotype([1, 2, 3])
+            view = memoryview(pop.genotype(1))
+            self.assertEqual(view.shape, (12,))
+            self.assertEqual(view.tolist(), [1, 2, 3] * 4)
+            # the view is not a copy
+            view[0] = 4
+            self.assertEqual(pop.individual(1).allele(0), 4)
+            view = memoryview(pop.individual(2).genotype())
+            self.assertEqual(view.tolist(), [1, 2, 3, 1, 2, 3])
+        info = pop.infoArray()
+        self.assertEqual(info.shape, (3, 2))
+        self.assertEqual(info.format, 'd')
+        info[1, 1] = 5
+        self.assertEqual(pop.individual(1).info('b'), 5)
+        info = pop.infoArray(1)
+        self.assertEqual(info.shape, (2, 2))
+        info[1, 0] = 3
+        self.assertEqual(pop.individual(2).info('a'), 3)
+        self.assertEqual(pop.infoArray().tolist(), [[0, 0], [0, 5], [3, 0]])
+        self.assertRaises(IndexError, pop.infoArray, 2)
+        # the view refers to the population
+        info = pop.infoArray()
+        self.assertEqual(info.strides, (16, 8))
+        pop = None
+        gc.collect()
+        self.assertEqual(info.tolist(), [[0, 0], [0, 5], [3, 0]])
+        info[2, 1] = 1
+        self.assertEqual(info[2, 1], 1)
+
+
+    def testSetGenotypeFromArray(self):
+        'Testing Population::setGenotype() and setIndInfo() with arrays'
+        if sys.version_info[0] < 3:
+            return
+        import array
+        pop = Population(loci=[1, 2], size=[1, 2], infoFields='x')
+        # a 2-d array is flattened
+        geno = memoryview(array.array('l', [1, 0] * 9)).cast('B').cast('l', [3, 6])
+        pop.setGenotype(geno)
+        self.assertEqual(pop.individual(0).genotype(), [1, 0, 1, 0, 1, 0])
+        # strided array
+        geno = memoryview(array.array('h', [0, 1] * 6))[1::2]
+        pop.setGenotype(geno, 1)
+        self.assertEqual(pop.individual(0).genotype(), [1, 0, 1, 0, 1, 0])
+        self.assertEqual(pop.individual(1).genotype(), [1] * 6)
+        # floating point numbers are not accepted as alleles
+        self.assertRaises(ValueError, pop.setGenotype, array.array('d', [1]))
+        # loci
+        pop.setGenotype(array.array('B', [0, 0]), loci=[0, 2])
+        self.assertEqual(pop.individual(0).genotype(), [0, 0, 0, 0, 0, 0])
+        self.assertEqual(pop.individual(1).genotype(), [0, 1, 0, 0, 1, 0])
+        pop.setGenotype([1, 0, 1, 0], subPop=1, loci=1)
+        self.assertEqual(pop.individual(0).genotype(), [0, 0, 0, 0, 0, 0])
+        self.assertEqual(pop.individual(1).genotype(), [0, 1, 0, 0, 0, 0])
+        self.assertEqual(pop.individual(2).genotype(), [0, 1, 0, 0, 0, 0])
+        # information fields
+        pop.setIndInfo(array.array('d', [1.5, 2.5, 3.5]), 'x')
+        self.assertEqual(pop.indInfo('x'), (1.5, 2.5, 3.5))
+        pop.setIndInfo(array.array('i', [4]), 'x', 1)
+        self.assertEqual(pop.indInfo('x'), (1.5, 4, 4))
 
     def testSetGenotype(self):
         'Testing Population::setGenotype(geno), setGenotype(geno, subPop)'
@@ -1165,6 +1232,23 @@ class TestPopulation(unittest.TestCase):
         self.assertEqual(pop.subPopName(1), 'B')
         for i in range(2, 6):
             self.assertEqual(pop.subPopName(i), '')
+        # individuals keep their order and genotypes
+        pop = Population(size=[3000, 2000], loci=[5], infoFields=['x', 'y'])
+        initGenotype(pop, freq=[0.5, 0.5])
+        pop.setIndInfo(range(pop.popSize()), 'y')
+        geno = {}
+        for ind in pop.individuals():
+            ind.x = random.randint(-1, 3)
+            geno[ind.y] = list(ind.genotype())
+        counts = [len([x for x in pop.indInfo('x') if x == sp]) for sp in range(4)]
+        pop.setSubPopByIndInfo('x')
+        self.assertEqual(pop.subPopSizes(), tuple(counts))
+        for sp in range(4):
+            ids = pop.indInfo('y', subPop=sp)
+            self.assertEqual(list(ids), sorted(ids))
+            for ind in pop.individuals(sp):
+                self.assertEqual(ind.x, sp)
+                self.assertEqual(list(ind.genotype()), geno[ind.y])
 
     def testSortIndividuals(self):
         'Testing Population::sortIndividuals(infoFields)'
@@ -1182,9 +1266,21 @@ class TestPopulation(unittest.TestCase):
             for i in range(1, pop.subPopSize(sp)):
                 self.assertTrue(pop.individual(i-1, sp).a >= pop.individual(i, sp).a)
         self.assertTrue(pop.individual(999).a < pop.individual(0, 1).a)
+        # sorting by multiple fields with negative values
+        initInfo(pop, lambda: random.randint(1, 5), infoFields='a')
+        initInfo(pop, lambda: random.normalvariate(0, 1), infoFields='b')
+        for ind in pop.individuals():
+            ind.setAllele(int(ind.a) % 2, 0)
+        pop.sortIndividuals(['a', 'b'])
+        for sp in range(2):
+            for i in range(1, pop.subPopSize(sp)):
+                self.assertTrue((pop.individual(i-1, sp).a, pop.individual(i-1, sp).b) <=
+                    (pop.individual(i, sp).a, pop.individual(i, sp).b))
+        for ind in pop.individuals():
+            self.assertEqual(ind.allele(0), int(ind.a) % 2)
+
 
 
-            
     def testAddInfoFields(self):
         'Testing Population::addInfoFields(fields, init=0)'
         pop = self.getPop()
@@ -1264,6 +1360,43 @@ class TestPopulation(unittest.TestCase):
         pop1 = pop.setInfoFields(['fitness', 'fitness'],  1)
         self.assertEqual(pop.infoSize(), 1)
 
+    def testIntInfoFields(self):
+        'Testing information fields of type INFO_INT64'
+        pop = Population(100, loci=2, infoFields='x')
+        pop.addInfoFields(['ind_id', 'father_id', 'mother_id'], -1, type=INFO_INT64)
+        self.assertEqual(pop.infoType('ind_id'), INFO_INT64)
+        self.assertEqual(pop.infoType('x'), INFO_FLOAT64)
+        self.assertEqual(pop.indInfo('father_id'), tuple([-1]*100))
+        # values are rounded to integers
+        pop.setIndInfo([2.6], 'mother_id')
+        self.assertEqual(pop.indInfo('mother_id'), tuple([3]*100))
+        # IDs larger than 2^53 are kept exactly
+        IdTagger().reset(2**60 + 1)
+        pop.evolve(
+            initOps=[InitSex(), IdTagger()],
+            matingScheme=RandomMating(ops=[IdTagger(),
+                PedigreeTagger(output='>int.ped')]),
+            gen=1
+        )
+        IdTagger().reset(1)
+        with open('int.ped') as ped:
+            ids = [int(line.split()[0]) for line in ped]
+        self.assertEqual(ids, list(range(2**60 + 101, 2**60 + 201)))
+        # types are saved, and kept when other fields are removed
+        pop.save('int.pop')
+        pop1 = loadPopulation('int.pop')
+        self.assertEqual(pop1.infoType('ind_id'), INFO_INT64)
+        self.assertEqual(pop, pop1)
+        pop1.removeInfoFields('x')
+        self.assertEqual(pop1.infoType('mother_id'), INFO_INT64)
+        self.assertRaises(ValueError, pop1.infoArray)
+        # existing fields change their types
+        pop1.addInfoFields('ind_id', 0.5)
+        self.assertEqual(pop1.infoType('ind_id'), INFO_FLOAT64)
+        self.assertEqual(pop1.indInfo('ind_id'), tuple([0.5]*100))
+        for file in ['int.ped', 'int.pop']:
+            os.remove(file)
+
     def testClone(self):
         'Testing Population::clone()'
         pop = self.getPop(ancGen = 5)
@@ -1425,6 +1558,52 @@ class TestPopulation(unittest.TestCase):
         self.assertEqual(numAffected == 0, False)
         self.assertEqual(numUnaffected == 0, False)
 
+    def testSexAffectionBits(self):
+        'Testing counting of males and affected individuals from packed bits'
+        statVars = ['numOfMales_sp', 'numOfAffected_sp']
+        def checkVars(pop):
+            for sp in range(pop.numSubPop()):
+                inds = list(pop.individuals(sp))
+                numMales = len([x for x in inds if x.sex() == MALE])
+                numAffected = len([x for x in inds if x.affected()])
+                self.assertEqual(pop.dvars(sp).numOfMales, numMales)
+                self.assertEqual(pop.dvars(sp).numOfAffected, numAffected)
+                self.assertEqual(pop.subPopSize([sp, 0]), numMales)
+                self.assertEqual(pop.subPopSize([sp, 3]), numAffected)
+            return True
+        # subpopulations that do not start at multiples of 64 individuals
+        pop = Population(size=[100, 37, 250], loci=1)
+        pop.setVirtualSplitter(CombinedSplitter([SexSplitter(), AffectionSplitter()]))
+        initSex(pop)
+        initGenotype(pop, freq=[0.5, 0.5])
+        maPenetrance(pop, loci=0, penetrance=[0, 0.5, 1])
+        stat(pop, numOfMales=True, numOfAffected=True, vars=statVars)
+        checkVars(pop)
+        # changes to individuals are seen by the next call
+        for ind in pop.individuals(1):
+            ind.setSex(MALE)
+            ind.setAffected(True)
+        stat(pop, numOfMales=True, numOfAffected=True, vars=statVars)
+        checkVars(pop)
+        self.assertEqual(pop.dvars(1).numOfMales, 37)
+        self.assertEqual(pop.dvars(1).numOfAffected, 37)
+        # during evolution, changes by operators are seen by later operators
+        pop.evolve(
+            preOps=[
+                Stat(numOfMales=True, numOfAffected=True, vars=statVars),
+                InitSex(),
+                MaPenetrance(loci=0, penetrance=[0, 0.5, 1]),
+                Stat(numOfMales=True, numOfAffected=True, vars=statVars),
+                PyOperator(checkVars),
+            ],
+            matingScheme=RandomMating(),
+            postOps=[
+                Stat(numOfMales=True, numOfAffected=True, vars=statVars),
+                PyOperator(checkVars),
+            ],
+            gen=3
+        )
+
     def testInfoSplitter(self):
         'Testing InfoSplitter::InfoSplitter(field, values=[], cutoff=[])'
         pop = Population(1000, infoFields=['x'])
@@ -1470,6 +1649,22 @@ class TestPopulation(unittest.TestCase):
             self.assertEqual(ind.info('x') >= 11.5 and ind.info('x') < 13.5, True)
         for ind in pop.individuals([0, 1]):
             self.assertEqual(9.5 <= ind.info('x') < 12.5, True)
+        # ranges given as a sparse matrix are rejected
+        self.assertRaises(ValueError, InfoSplitter, 'x', ranges=[{0: 11.5, 1: 13.5}])
+        # individuals out of order
+        pop.sortIndividuals('x', reverse=True)
+        self.assertEqual(pop.subPopSize([0, 1]), infos.count(10) + infos.count(11) + infos.count(12))
+        for ind in pop.individuals([0, 1]):
+            self.assertEqual(9.5 <= ind.info('x') < 12.5, True)
+        # 64-bit integer fields
+        pop.addInfoFields('ind_id', type=INFO_INT64)
+        ids = [random.randint(1, 3) for x in range(1000)]
+        pop.setIndInfo(ids, 'ind_id')
+        pop.setVirtualSplitter(InfoSplitter('ind_id', values=[1, 3]))
+        self.assertEqual(pop.subPopSize([0, 0]), ids.count(1))
+        self.assertEqual(pop.subPopSize([0, 1]), ids.count(3))
+        pop.setVirtualSplitter(InfoSplitter('ind_id', cutoff=[2]))
+        self.assertEqual(pop.subPopSize([0, 1]), ids.count(2) + ids.count(3))
 
     def testProportionSplitter(self):
         'Testing ProportionSplitter::ProportionSplitter(proportions=[])'
@@ -1928,6 +2123,105 @@ class TestPopulation(unittest.TestCase):
         for file in ['test.ped', 'test1.ped', 'test2.ped']:
             os.remove(file)
 
+    def testBinaryPedigree(self):
+        'Testing binary output of PedigreeTagger'
+        pop = Population(500, loci=[2, 3], ancGen=-1, infoFields=['ind_id', 'father_id', 'mother_id', 'x'])
+        tagID(pop, reset=True)
+        pop.evolve(
+            initOps = [
+                InitSex(),
+                InitGenotype(freq=[0.3, 0.3, 0.4]),
+                InitInfo(lambda: random.randint(0, 10), infoFields='x'),
+                PedigreeTagger(output='>>test.ped', outputFields='x', outputLoci=ALL_AVAIL),
+                PedigreeTagger(output='>>test_bin.ped', outputFields='x', outputLoci=ALL_AVAIL,
+                    binary=True),
+            ],
+            matingScheme=RandomMating(ops=[
+                MendelianGenoTransmitter(),
+                IdTagger(),
+                PedigreeTagger(output='>>test.ped', outputFields='x', outputLoci=ALL_AVAIL),
+                PedigreeTagger(output='>>test_bin.ped', outputFields='x', outputLoci=ALL_AVAIL,
+                    binary=True)]),
+            gen = 10
+        )
+        ped1 = loadPedigree('test.ped', infoFields='x', loci=[2, 3])
+        ped2 = loadPedigree('test_bin.ped', infoFields='x', loci=[2, 3])
+        self.assertEqual(ped2.ancestralGens(), 10)
+        self.assertEqual(ped1, ped2)
+        # binary file is compressed in gzip format
+        import gzip
+        with gzip.open('test_bin.ped') as ped:
+            self.assertEqual(ped.read(4), b'SPED')
+        for file in ['test.ped', 'test_bin.ped']:
+            os.remove(file)
+        # records are written even if the last offspring is not recorded
+        pop = Population([200, 300], loci=2, ancGen=-1, infoFields=['ind_id', 'father_id', 'mother_id'])
+        tagID(pop, reset=True)
+        pop.evolve(
+            initOps=[
+                InitSex(),
+                InitGenotype(freq=[0.5, 0.5]),
+                PedigreeTagger(output='>>test.ped', outputLoci=ALL_AVAIL),
+                PedigreeTagger(output='>>test_bin.ped', outputLoci=ALL_AVAIL, binary=True),
+            ],
+            matingScheme=HeteroMating([
+                RandomMating(subPops=0, ops=[
+                    MendelianGenoTransmitter(),
+                    IdTagger(),
+                    PedigreeTagger(output='>>test.ped', outputLoci=ALL_AVAIL),
+                    PedigreeTagger(output='>>test_bin.ped', outputLoci=ALL_AVAIL, binary=True)]),
+                RandomMating(subPops=1, ops=[
+                    MendelianGenoTransmitter(),
+                    IdTagger(),
+                    PedigreeTagger(output='>>test.ped', outputLoci=ALL_AVAIL, subPops=0),
+                    PedigreeTagger(output='>>test_bin.ped', outputLoci=ALL_AVAIL, subPops=0,
+                        binary=True)])]),
+            gen = 5
+        )
+        with open('test.ped') as ped:
+            self.assertEqual(len(ped.readlines()), 1500)
+        ped1 = loadPedigree('test.ped', loci=2)
+        ped2 = loadPedigree('test_bin.ped', loci=2)
+        self.assertEqual(ped1, ped2)
+        for file in ['test.ped', 'test_bin.ped']:
+            os.remove(file)
+
+    def testPedigreeReader(self):
+        'Testing reading pedigrees generation by generation'
+        pop = Population(500, loci=[2], ancGen=-1, infoFields=['ind_id', 'father_id', 'mother_id'])
+        tagID(pop, reset=True)
+        pop.evolve(
+            initOps = [
+                InitSex(),
+                InitGenotype(freq=[0.5, 0.5]),
+                PedigreeTagger(output='>>test.ped'),
+                PedigreeTagger(output='>>test_bin.ped', binary=True),
+            ],
+            matingScheme=RandomMating(ops=[
+                MendelianGenoTransmitter(),
+                IdTagger(),
+                PedigreeTagger(output='>>test.ped'),
+                PedigreeTagger(output='>>test_bin.ped', binary=True)]),
+            gen = 10
+        )
+        ped = loadPedigree('test.ped')
+        for file in ['test.ped', 'test_bin.ped']:
+            gen = 0
+            for window in PedigreeReader(file, ancGen=1):
+                if gen == 0:
+                    window.addInfoFields(['off1', 'off2'])
+                self.assertEqual(window.ancestralGens(), min(gen, 1))
+                ped.useAncestralGen(10 - gen)
+                self.assertEqual(window.indInfo('ind_id'), ped.indInfo('ind_id'))
+                self.assertEqual(window.indInfo('father_id'), ped.indInfo('father_id'))
+                # offspring of the parental generation are in the window
+                if gen > 0:
+                    window.locateRelatives(OFFSPRING, ['off1', 'off2'])
+                    self.assertTrue(any([x.off1 > 0 for x in window.allIndividuals(ancGens=1)]))
+                gen += 1
+            self.assertEqual(gen, 11)
+            os.remove(file)
+
     def testDiscardIf(self):
         'Testing operator DiscardIf'
         pop = Population(1000, loci=2, infoFields=['a', 'b'])
@@ -1991,7 +2285,50 @@ class TestPopulation(unittest.TestCase):
         arr = list(pop.mutants(1))
         self.assertEqual(len(arr), 4)
         #
-        
+
+    def testVspCaching(self):
+        'Testing reuse of VSP members during evolution'
+        def checkSize(pop):
+            n = len([x for x in pop.indInfo('x', 0) if x < 0.5])
+            self.assertEqual(pop.dvars((0, 0)).popSize, n)
+            self.assertEqual(pop.subPopSize((0, 0)), n)
+            self.assertEqual(len(list(pop.individuals((0, 0)))), n)
+            return True
+        pop = Population(1000, infoFields='x')
+        pop.setVirtualSplitter(InfoSplitter('x', cutoff=[0.5]))
+        pop.evolve(
+            initOps=InitSex(),
+            preOps=[
+                InitInfo(random.random, infoFields='x'),
+                Stat(popSize=True, subPops=[(0, 0), (0, 1)], vars='popSize_sp'),
+                Stat(popSize=True, subPops=[(0, 0), (0, 1)], vars='popSize_sp'),
+                PyOperator(checkSize),
+                InfoExec('x = 1 - x'),
+                Stat(popSize=True, subPops=[(0, 0), (0, 1)], vars='popSize_sp'),
+                PyOperator(checkSize),
+            ],
+            matingScheme=RandomMating(),
+            postOps=[
+                Stat(popSize=True, subPops=[(0, 0), (0, 1)], vars='popSize_sp'),
+                PyOperator(checkSize),
+            ],
+            gen=5
+        )
+        # parents are chosen from cached members of a VSP
+        def checkParents(pop):
+            self.assertEqual(max(pop.indInfo('x')) < 0.5, True)
+            return True
+        pop.evolve(
+            preOps=[
+                InitInfo(random.random, infoFields='x'),
+                Stat(popSize=True, subPops=[(0, 0), (0, 1)], vars='popSize_sp'),
+            ],
+            matingScheme=HeteroMating([RandomSelection(subPops=[(0, 0)],
+                ops=[CloneGenoTransmitter(), InheritTagger(infoFields='x')])]),
+            postOps=PyOperator(checkParents),
+            gen=5
+        )
+
 if __name__ == '__main__':
     unittest.main()
 
@@ -8,7 +8,7 @@
 # $LastChangedDate$
 #
 
-import unittest, os, sys
+import unittest, os, sys, math
 from simuOpt import setOptions
 setOptions(quiet=True)
 new_argv = []
@@ -154,6 +154,23 @@ class TestOperator(unittest.TestCase):
         self.assertFileContent("a.txt", 'a'*10)
         os.remove('a.txt')
 
+    def testAsyncOutput(self):
+        'Testing asynchronous output'
+        setOptions(asyncOutput=100)
+        simu = Simulator(Population(), rep=5)
+        simu.evolve(postOps = [PyOutput("a", output=">>a.txt"),
+            PyOutput("b", output=">b.txt")],
+            matingScheme=CloneMating(),
+            gen=10)
+        setOptions(asyncOutput=0)
+        self.assertFileContent("a.txt", 'a'*50)
+        self.assertFileContent("b.txt", 'b')
+        info = moduleInfo()['asyncOutput']
+        self.assertEqual(info['bufferSize'], 0)
+        self.assertTrue(info['bytesWritten'] >= 50)
+        os.remove('a.txt')
+        os.remove('b.txt')
+
     def testOutputExpr(self):
         'Testing the usage of output expression'
         simu = Simulator( Population(), rep=5)
@@ -386,6 +403,103 @@ class TestOperator(unittest.TestCase):
             gen = 4
         )
 
+    def testInfoExecNative(self):
+        '''Testing expressions and statements that are evaluated natively'''
+        pop = Population(100, infoFields=['a', 'b', 'c'])
+        pop.setIndInfo(range(100), 'a')
+        pop.vars()['x'] = 3
+        pop.vars()['y'] = [0.5, {'k': 2}]
+        infoExec(pop, 'b = a * x + y[1]["k"]; c = min(a, 10) // 3 - (a % 7) ** 2')
+        self.assertEqual(pop.indInfo('b'), tuple([a * 3 + 2 for a in range(100)]))
+        self.assertEqual(pop.indInfo('c'), tuple([min(a, 10) // 3 - (a % 7) ** 2 for a in range(100)]))
+        # Python semantics of conditional and boolean expressions
+        infoExec(pop, 'c = 1 if 3 < a <= 50 and not a == 20 else (y[0] or -1)')
+        self.assertEqual(pop.indInfo('c'), tuple([1 if 3 < a <= 50 and not a == 20 else 0.5 for a in range(100)]))
+        initSex(pop)
+        # exp, log and sqrt are not builtin functions and have to be imported
+        # from module math to the namespace, as Python requires
+        self.assertRaises(RuntimeError, infoExec, pop, 'c = exp(a / 100.)')
+        pop.vars().update({'exp': math.exp, 'log': math.log, 'sqrt': math.sqrt})
+        infoExec(pop, 'c = exp(a / 100.) + ind.sex()', exposeInd='ind')
+        for ind in pop.individuals():
+            self.assertAlmostEqual(ind.c, math.exp(ind.a / 100.) + ind.sex())
+        # statements are evaluated by Python if there is an INFO_INT64 field
+        pyPop = pop.clone()
+        pyPop.addInfoFields('ind_id', type=INFO_INT64)
+        pyPop.vars().update(pop.vars())
+        for stmt in ['c = exp(a / 100.) + ind.sex()', 'c = sqrt(a) if a > 4 else -a',
+                'c = log(a + 1) * abs(a - 50) // 7', 'c = max(a, x) % 4']:
+            infoExec(pop, stmt, exposeInd='ind')
+            infoExec(pyPop, stmt, exposeInd='ind')
+            for x, y in zip(pop.indInfo('c'), pyPop.indInfo('c')):
+                self.assertAlmostEqual(x, y)
+        pop1 = Population(10, infoFields='c')
+        pop1.addInfoFields('ind_id', type=INFO_INT64)
+        for p in [Population(10, infoFields='c'), pop1]:
+            self.assertRaises(RuntimeError, infoExec, p, 'c = sqrt(2)')
+        # errors are reported as in Python
+        self.assertRaises(RuntimeError, infoExec, pop, 'c = 1 / (a - 5)')
+        self.assertRaises(RuntimeError, infoExec, pop, 'c = log(a)')
+        # the output of InfoEval is the same as that of Python
+        infoEval(pop, 'a > 97', output='a.txt')
+        with open('a.txt') as out:
+            self.assertEqual(out.read(), 'False' * 98 + 'True' * 2)
+        infoEval(pop, 'a // 50 + x', output='a.txt')
+        with open('a.txt') as out:
+            self.assertEqual(out.read(), '3.0' * 50 + '4.0' * 50)
+        os.remove('a.txt')
+        # functions defined by users are called by Python
+        pop.vars()['min'] = lambda x, y: x + y
+        infoExec(pop, 'c = min(a, 1)')
+        self.assertEqual(pop.indInfo('c'), tuple([a + 1 for a in range(100)]))
+        # IfElse conditions
+        pop.vars()['z'] = 5
+        pop.evolve(
+            matingScheme=CloneMating(),
+            postOps=IfElse('z > 4 and gen < 2', ifOps=InfoExec('b = -1'),
+                elseOps=InfoExec('b = z')),
+            gen=3
+        )
+        self.assertEqual(pop.indInfo('b'), tuple([5] * 100))
+        # variables changed between generations are seen during mating
+        pop.evolve(
+            preOps=PyExec('z = gen * 2'),
+            matingScheme=CloneMating(ops=[CloneGenoTransmitter(), InfoExec('b = z + 1')]),
+            postOps=InfoEval('b == z + 1', output='a.txt'),
+            gen=3
+        )
+        with open('a.txt') as out:
+            self.assertEqual(out.read(), 'True' * 100)
+        os.remove('a.txt')
+        self.assertEqual(pop.indInfo('b'), tuple([pop.dvars().z + 1] * 100))
+
+    def testFusedOperators(self):
+        '''Testing operators applied to individuals in a single pass'''
+        pop = Population([500, 500], loci=1, infoFields=['a', 'b', 'fitness'])
+        initGenotype(pop, genotype=[0, 1])
+        pop.evolve(
+            initOps=InfoExec('a = 0'),
+            matingScheme=CloneMating(),
+            postOps=[
+                InfoExec('a += 1'),
+                InfoExec('b = a * 2 + 1'),
+                # not active, does not stop fusion
+                InfoExec('b = 0', at=10),
+                MaSelector(loci=0, fitness=[1, 0.9, 0.8]),
+                MaPenetrance(loci=0, penetrance=[0, 1, 1]),
+            ],
+            gen=5
+        )
+        self.assertEqual(pop.indInfo('b'), tuple([11] * 1000))
+        self.assertEqual(pop.indInfo('fitness'), tuple([0.9] * 1000))
+        self.assertEqual(pop.indInfo('a'), tuple([5] * 1000))
+        for ind in pop.individuals():
+            self.assertTrue(ind.affected())
+        # errors are reported after the pass
+        self.assertRaises(RuntimeError, pop.evolve,
+            postOps=[InfoExec('a += 1'), InfoExec('b = 1 / (a - 8)')],
+            matingScheme=CloneMating(), gen=5)
+
 
     def testDumper(self):
         '''Testing operator Dumper'''
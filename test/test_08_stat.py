@@ -451,6 +451,29 @@ class TestStat(unittest.TestCase):
         self.assertEqual(pop.dvars().maxOfInfo['y'], 10)
         self.assertEqual(pop.dvars().minOfInfo['y'], 4)
         #
+        # individuals out of order and populations with 64-bit integer
+        # fields are summarized individual by individual
+        pop = Population(size=[300, 200], infoFields=['x', 'y'])
+        pop.setIndInfo([random.random() for x in range(500)], 'x')
+        pop.setIndInfo(list(range(500)), 'y')
+        x = [pop.indInfo('x', subPop=sp) for sp in range(2)]
+        pop.sortIndividuals('x', reverse=True)
+        for intField in [False, True]:
+            if intField:
+                pop.addInfoFields('ind_id', -1, type=INFO_INT64)
+            stat(pop, meanOfInfo='x', varOfInfo='x', maxOfInfo='x', minOfInfo='x',
+                sumOfInfo='y', subPops=[0, 1], vars=['meanOfInfo_sp', 'varOfInfo_sp',
+                'maxOfInfo_sp', 'minOfInfo_sp', 'sumOfInfo_sp'])
+            for sp in range(2):
+                mean = sum(x[sp]) / len(x[sp])
+                var = sum([(v - mean)**2 for v in x[sp]]) / (len(x[sp]) - 1)
+                self.assertAlmostEqual(pop.dvars(sp).meanOfInfo['x'], mean)
+                self.assertAlmostEqual(pop.dvars(sp).varOfInfo['x'], var)
+                self.assertEqual(pop.dvars(sp).maxOfInfo['x'], max(x[sp]))
+                self.assertEqual(pop.dvars(sp).minOfInfo['x'], min(x[sp]))
+            self.assertEqual(pop.dvars(0).sumOfInfo['y'], sum(range(300)))
+            self.assertEqual(pop.dvars(1).sumOfInfo['y'], sum(range(300, 500)))
+        #
         # test cases with NO item, so mean, min, max etc should return None
         # 
         # Before 1.1.3, this results in seg dump
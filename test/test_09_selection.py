@@ -1060,6 +1060,71 @@ class TestSelector(unittest.TestCase):
         self.assertLess(pop.dvars().alleleFreq[0][1], 0.9)
         self.assertGreater(pop.dvars().alleleFreq[0][1], 0.8)
 
+    def testMutSpaceSelector(self):
+        'Testing mutants of MutSpaceSelector in multiple replicates'
+        if moduleInfo()['alleleType'] != 'long':
+            return
+        import random
+        from simuPOP.sandbox import MutSpaceSelector
+        sim = Simulator(Population(size=500, loci=10, infoFields='fitness'), rep=2)
+        pop0 = sim.population(0)
+        pop1 = sim.population(1)
+        # mutant 7 only exists in the second replicate
+        pop1.setGenotype([7] + [0] * 9)
+        sel = MutSpaceSelector(selDist=[GAMMA_DISTRIBUTION, 0.01, 1])
+        sel.apply(pop1)
+        fitness = pop1.indInfo('fitness')
+        for i in range(5):
+            # new mutants in the first replicate so that lost mutants are removed
+            pop0.setGenotype([random.randint(100, 1000000) for x in range(10000)])
+            sel.apply(pop0)
+            sel.apply(pop1)
+            self.assertEqual(pop1.indInfo('fitness'), fitness)
+        mutants = sel.mutants(pop1)
+        self.assertEqual(list(mutants.keys()), [7])
+        s, h, gen, count = mutants[7]
+        self.assertEqual(h, 0.5)
+        self.assertEqual(gen, 0)
+        self.assertEqual(count, 1000)
+        self.assertAlmostEqual(fitness[0], math.exp(-s))
+        #
+        mutants = sel.mutants(pop0)
+        self.assertFalse(7 in mutants)
+        self.assertEqual(sum([x[3] for x in mutants.values()]),
+            sum([len(set(ind.genotype(p))) for ind in pop0.individuals() for p in range(2)]))
+        for ind in pop0.individuals():
+            self.assertAlmostEqual(ind.fitness,
+                math.exp(-sum([mutants[x][0] / 2. for x in ind.genotype()])))
+
+    def testMutSpaceSelectorCache(self):
+        'Testing cached fitness of haplotypes in MutSpaceSelector'
+        if moduleInfo()['alleleType'] != 'long':
+            return
+        from simuPOP.sandbox import MutSpaceSelector, MutSpaceMutator, MutSpaceRecombinator
+        def selCoef(loc):
+            return (loc % 100) * 0.001
+        def checkFitness(pop, mode):
+            # fitness calculated from all mutants of individuals
+            for ind in pop.individuals():
+                s = sum([selCoef(x) / 2. for x in ind.genotype() if x != 0])
+                if mode == ADDITIVE:
+                    self.assertAlmostEqual(ind.fitness, max(1 - s, 0))
+                else:
+                    self.assertAlmostEqual(ind.fitness, math.exp(-s))
+            return True
+        for mode in [ADDITIVE, EXPONENTIAL]:
+            pop = Population(size=[200, 300], loci=[20], infoFields='fitness')
+            pop.evolve(
+                initOps=InitSex(),
+                preOps=[
+                    MutSpaceMutator(1e-5, ranges=[[1, 10000]], model=2),
+                    MutSpaceSelector(selDist=selCoef, mode=mode),
+                    PyOperator(func=lambda pop: checkFitness(pop, mode)),
+                ],
+                matingScheme=RandomMating(ops=MutSpaceRecombinator(1e-4, ranges=[[1, 10000]])),
+                gen=20
+            )
+
 
 
 if __name__ == '__main__':
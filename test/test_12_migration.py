@@ -196,6 +196,22 @@ class TestMigrator(unittest.TestCase):
         self.assertTrue(abs(pop.subPopSize(2) - 3500) < 100, 
             "Expression abs(pop.subPopSize(2) - 3500) (test value %f) be less than 100. This test may occasionally fail due to the randomness of outcome." % (abs(pop.subPopSize(2) - 3500)))
 
+    def testmigrateByLowProbability(self):
+        'Testing migrate by low probability in large populations'
+        pop = Population(size=[100000, 100000], loci=[1], infoFields=['migrate_to', 'origin'])
+        pop.setIndInfo(0, 'origin', subPop=0)
+        pop.setIndInfo(1, 'origin', subPop=1)
+        migrate(pop, mode=BY_PROBABILITY, rate = [[0, 0.001], [0.002, 0]])
+        self.assertEqual(pop.popSize(), 200000)
+        # immigrants are recorded in information field origin
+        imm0 = len([x for x in pop.indInfo('origin', subPop=0) if x == 1])
+        imm1 = len([x for x in pop.indInfo('origin', subPop=1) if x == 0])
+        self.assertTrue(abs(imm0 - 200) < 60, 
+            "Expression abs(imm0 - 200) (test value %f) be less than 60. This test may occasionally fail due to the randomness of outcome." % (abs(imm0 - 200)))
+        self.assertTrue(abs(imm1 - 100) < 40, 
+            "Expression abs(imm1 - 100) (test value %f) be less than 40. This test may occasionally fail due to the randomness of outcome." % (abs(imm1 - 100)))
+        self.assertEqual(pop.subPopSize(0), 100000 - imm1 + imm0)
+
     def testmigrateFromTo(self):
         'Testing parameter from and to of Migrators'
         pop = Population(size=[2000,4000,4000], loci=[2], infoFields=['migrate_to'])
@@ -471,6 +487,33 @@ class TestMigrator(unittest.TestCase):
         self.assertEqual(pop.subPopSizes(), (2002, 4498, 3500))
 
 
+    def testSparseMigrationMatrix(self):
+        'Testing migration with sparse migration matrices'
+        from simuPOP.utils import migrSteppingStoneRates
+        from simuPOP.demography import migr2DSteppingStoneRates
+        self.assertEqual(migrSteppingStoneRates(0.1, 3, sparse=True),
+            [{1: 0.1}, {0: 0.05, 2: 0.05}, {1: 0.1}])
+        rates = migr2DSteppingStoneRates(0.2, 3, 3, sparse=True)
+        self.assertEqual(len(rates), 9)
+        self.assertEqual(rates[4], {1: 0.05, 3: 0.05, 5: 0.05, 7: 0.05})
+        # sparse and dense matrices move the same number of migrants
+        dense = migrSteppingStoneRates(0.1, 5)
+        pop = Population(size=[1000, 2000, 1000, 2000, 1000], infoFields='migrate_to')
+        pop1 = pop.clone()
+        migrate(pop, rate=dense, mode=BY_PROPORTION)
+        migrate(pop1, rate=migrSteppingStoneRates(0.1, 5, sparse=True), mode=BY_PROPORTION)
+        self.assertEqual(pop.subPopSizes(), pop1.subPopSizes())
+        # migrate to a new subpopulation
+        pop = Population(size=[1000, 2000], infoFields='migrate_to')
+        migrate(pop, rate=[{3: 0.5}, {}], mode=BY_PROPORTION)
+        self.assertEqual(pop.subPopSizes(), (500, 2000, 0, 500))
+        # backward migration
+        pop = Population(size=[2000,4000,4000], loci=[2], infoFields=['migrate_to'])
+        backwardMigrate(pop, mode=BY_PROPORTION,
+            rate = [{1: 0.5}, {0: 0.11111111, 2: 0.22222222}, {0: 0.14285714}])
+        for x, y in zip(pop.subPopSizes(), (2002, 4498, 3500)):
+            self.assertTrue(abs(x - y) <= 3)
+
     def testMigrateByBackwardProbability(self):
         'Testing migrate by probability'
         pop = Population(size=[2000,4000,4000], loci=[2], infoFields=['migrate_to'])
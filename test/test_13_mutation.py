@@ -487,6 +487,76 @@ class TestMutator(unittest.TestCase):
             self.assertEqual(ind.lineage(0), [ind.ind_id] * 10)
             self.assertEqual(ind.lineage(1), [-ind.ind_id] * 10)
 
+    def testMutSpaceMutator(self):
+        'Testing infinite-sites model of MutSpaceMutator'
+        if moduleInfo()['alleleType'] != 'long':
+            return
+        from simuPOP.sandbox import MutSpaceMutator, MutSpaceRecombinator
+        def existingMutants(pop):
+            pop.dvars().existing = set(pop.genotype()) - set([0])
+            return True
+        def checkMutants(pop):
+            with open('mutants.txt') as out:
+                events = [[int(x) for x in line.split()] for line in out]
+            new = [x[1] for x in events if x[3] == 0]
+            # new mutants are introduced at vacant sites
+            self.assertEqual(len(new), len(set(new)))
+            self.assertEqual(set(new) & pop.dvars().existing, set())
+            # mutations are ignored only if all sites are occupied
+            if len(ranges) == 1 and 3 in [x[3] for x in events]:
+                self.assertEqual(len(pop.dvars().existing | set(new)), sum([y - x for x, y in ranges]))
+            return True
+        for ranges, rate in [([[1, 2001]], 1e-4), ([[1, 101], [1001, 1501]], 1e-4),
+            ([[1, 100000001]], 1e-9), ([[1, 41]], 1e-3)]:
+            pop = Population(size=[200, 300], loci=[10] * len(ranges))
+            pop.evolve(
+                initOps=InitSex(),
+                preOps=[
+                    PyOperator(func=existingMutants),
+                    MutSpaceMutator(rate, ranges=ranges, model=2, output='>mutants.txt'),
+                    PyOperator(func=checkMutants),
+                ],
+                matingScheme=RandomMating(ops=MutSpaceRecombinator(rate, ranges=ranges)),
+                gen=20
+            )
+        os.remove('mutants.txt')
+
+    def testRevertFixedSites(self):
+        'Testing operator RevertFixedSites'
+        if moduleInfo()['alleleType'] != 'long':
+            return
+        from simuPOP.sandbox import RevertFixedSites
+        pop = Population(size=[100, 200], loci=10)
+        # mutants 5 and 8 are fixed, 3 and 9 are not
+        pop.setGenotype([8, 3, 5, 3, 0, 0, 0, 0, 0, 0, 5, 9, 8, 8, 0, 0, 0, 0, 0, 0])
+        RevertFixedSites(output='>fixed.txt').apply(pop)
+        with open('fixed.txt') as fixed:
+            self.assertEqual(fixed.read(), '0\t5\t8\n')
+        # remaining mutants are sorted without duplicates
+        for ind in pop.individuals():
+            self.assertEqual(ind.genotype(0), (3, ) + (0, ) * 9)
+            self.assertEqual(ind.genotype(1), (9, ) + (0, ) * 9)
+        # genotypes are unchanged if no mutant is fixed
+        pop.setGenotype([9, 3, 0, 0, 0, 0, 0, 0, 0, 0, 3, 2, 2, 0, 0, 0, 0, 0, 0, 0])
+        pop.individual(150).setGenotype([9, 0, 0, 0, 0, 0, 0, 0, 0, 0], 1)
+        RevertFixedSites(output='>fixed.txt').apply(pop)
+        self.assertEqual(pop.individual(0).genotype(), (9, 3) + (0, ) * 8 + (3, 2, 2) + (0, ) * 7)
+        # the second homologous copy of chromosome X of males is ignored
+        pop = Population(size=[100, 200], loci=10, chromTypes=CHROMOSOME_X)
+        initSex(pop)
+        pop.setGenotype([4, 6, 0, 0, 0, 0, 0, 0, 0, 0])
+        for ind in pop.individuals():
+            if ind.sex() == MALE:
+                ind.setGenotype([7, 0, 0, 0, 0, 0, 0, 0, 0, 0], 1)
+        RevertFixedSites().apply(pop)
+        for ind in pop.individuals():
+            self.assertEqual(ind.genotype(0), (0, ) * 10)
+            if ind.sex() == MALE:
+                self.assertEqual(ind.genotype(1), (7, ) + (0, ) * 9)
+            else:
+                self.assertEqual(ind.genotype(1), (0, ) * 10)
+        os.remove('fixed.txt')
+
 
 if __name__ == '__main__':
     unittest.main()
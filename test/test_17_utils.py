@@ -129,6 +129,38 @@ class TestUtils(unittest.TestCase):
         self.assertTrue(sum < 5100)
         self.assertTrue(sum > 4900)
 
+    def testNativeRNG(self):
+        'Testing the native random number generator'
+        self.assertTrue('xoshiro256++' in moduleInfo()['availableRNGs'])
+        rg = RNG('xoshiro256++', 1234)
+        self.assertEqual(rg.name(), 'xoshiro256++')
+        self.assertEqual(rg.seed(), 1234)
+        seq = [rg.randInt(1000) for x in range(1000)]
+        rg1 = RNG('xoshiro256++', 1234)
+        self.assertEqual(seq, [rg1.randInt(1000) for x in range(1000)])
+        self.assertTrue(min(seq) >= 0 and max(seq) < 1000)
+        self.assertTrue(abs(sum(seq) / 1000. - 499.5) < 30)
+        uni = [rg.randUniform() for x in range(10000)]
+        self.assertTrue(min(uni) >= 0 and max(uni) < 1)
+        self.assertTrue(abs(sum(uni) / 10000. - 0.5) < 0.02)
+        geo = [rg.randGeometric(0.2) for x in range(10000)]
+        self.assertTrue(min(geo) >= 1)
+        self.assertTrue(abs(sum(geo) / 10000. - 5) < 0.3)
+        # batch generation of Bernulli trials and weighted samples
+        old_rng = getRNG().name()
+        getRNG().set('xoshiro256++', 4321)
+        N = 100000
+        bt = Bernullitrials(getRNG(), [0.001, 0.5, 0.9], N)
+        bt.doTrial()
+        for i, p in enumerate([0.001, 0.5, 0.9]):
+            std = (p * (1 - p) / N) ** 0.5
+            self.assertTrue(abs(bt.trialSuccRate(i) - p) < 4 * std)
+        ws = WeightedSampler([1, 2, 3, 4])
+        samples = ws.drawSamples(N)
+        for i in range(4):
+            self.assertTrue(abs(samples.count(i) / float(N) - (i + 1) / 10.) < 0.01)
+        setRNG(name=old_rng)
+
 
     def testBernullitrials(self):
         'Testing bernullitrials'
@@ -176,6 +208,29 @@ class TestUtils(unittest.TestCase):
                 for j in range(pos+1, N):
                     self.assertFalse(bt.trialSucc(i, j))
 
+    def testBernullitrialsModerateProb(self):
+        'Testing bernullitrials with probabilities generated bit by bit'
+        import math
+        rg = getRNG()
+        p = [0.2, 0.3, 0.5, 0.7, 0.8]
+        # number of trials is not a multiple of word size
+        N = 100003
+        for BT in [Bernullitrials, Bernullitrials_T]:
+            bt = BT(rg, p, N)
+            bt.doTrial()
+            for i in range(len(p)):
+                prop = bt.trialSuccRate(i)
+                std = math.sqrt(p[i]*(1.-p[i])/N)
+                self.assertTrue(prop > p[i] - 4*std and prop < p[i] + 4*std)
+        # trials after the last one are not set
+        bt = Bernullitrials(rg, [0.5], 65)
+        for i in range(100):
+            bt.doTrial()
+            pos = bt.trialFirstSucc(0)
+            while pos != bt.npos:
+                self.assertTrue(pos < 65)
+                pos = bt.trialNextSucc(0, pos)
+
     def testBernullitrials_T(self):
         'Testing bernullitrials_T'
         import math
@@ -281,6 +336,30 @@ class TestUtils(unittest.TestCase):
             # the count must be exact
             self.assertEqual(num.count(i), 10000 * (i+1))
 
+    def testWeightedSamplerUpdate(self):
+        'Testing updating weights of weighted sampler'
+        sampler = WeightedSampler([1, 2, 3, 4])
+        sampler.update([0, 3], [4, 1])
+        num = sampler.drawSamples(100000)
+        for i, p in enumerate([0.4, 0.2, 0.3, 0.1]):
+            self.assertAlmostEqual(num.count(i) / 100000., p, places=1)
+        # update to special cases (all equal, only one non-zero)
+        sampler.update([0, 2, 3], [2, 2, 2])
+        num = sampler.drawSamples(100000)
+        for i in range(4):
+            self.assertAlmostEqual(num.count(i) / 100000., 0.25, places=1)
+        sampler.update([0, 1, 2], [0, 0, 0])
+        self.assertEqual(sampler.drawSamples(100), [3] * 100)
+        self.assertRaises(IndexError, sampler.update, [4], [1])
+        self.assertRaises(ValueError, sampler.update, [1, 2], [1])
+        # large number of weights, which are paired in parallel
+        sampler = WeightedSampler([1] * 100000 + [3] * 100000)
+        num = sampler.drawSamples(100000)
+        self.assertAlmostEqual(len([x for x in num if x >= 100000]) / 100000., 0.75, places=2)
+        # proportions cannot be updated
+        sampler = WeightedSampler([0.1, 0.2, 0.3, 0.4], 100000)
+        self.assertRaises(ValueError, sampler.update, [0], [0.2])
+
     def testWeightedSamplerWithZero(self):
         'Testing weighted sampler with Zero'
         sampler = WeightedSampler([0, 1, 2, 0, 0, 3, 4, 0])
@@ -1134,6 +1213,104 @@ class TestUtils(unittest.TestCase):
         # cleanup
         os.remove('pop.map')
 
+    def testExportPlink(self):
+        'Testing export genotype in PLINK binary format'''
+        pop = Population(size=[4, 5], loci=[2, 4], ploidy=2,
+            lociNames=['a', 'b', 'c', 'd', 'e', 'f'], infoFields='ind_id')
+        initGenotype(pop, haplotypes=[0,1])
+        initSex(pop, sex=[MALE, FEMALE])
+        tagID(pop, reset=True)
+        pop.individual(2).setAllele(1, 0, 0)
+        export(pop, format='plink', output='pop.bed')
+        self.assertEqual(self.lineOfFile('pop.fam', 1), '1 1 0 0 1 1\n')
+        self.assertEqual(self.lineOfFile('pop.fam', 2), '2 2 0 0 2 1\n')
+        self.assertEqual(self.lineOfFile('pop.bim', 1), '1\ta\t0\t1\t2\t1\n')
+        self.assertEqual(self.lineOfFile('pop.bim', 6), '2\tf\t0\t4\t2\t1\n')
+        with open('pop.bed', 'rb') as bed:
+            geno = bytearray(bed.read())
+        # magic number, 6 loci with 3 bytes for 9 individuals each
+        self.assertEqual(len(geno), 3 + 6 * 3)
+        self.assertEqual(list(geno[:3]), [0x6c, 0x1b, 0x01])
+        # first locus, homozygous of allele 0 except for a heterozygote
+        self.assertEqual(list(geno[3:6]), [0xEF, 0xFF, 0x03])
+        # second locus, homozygous of allele 1
+        self.assertEqual(list(geno[6:9]), [0, 0, 0])
+        # test parameter subPops
+        pop.setVirtualSplitter(SexSplitter())
+        export(pop, format='plink', output='pop', subPops=[(0,0)])
+        self.assertEqual(self.lineOfFile('pop.fam', 2), '2 3 0 0 1 1\n')
+        with open('pop.bed', 'rb') as bed:
+            geno = bytearray(bed.read())
+        self.assertEqual(len(geno), 3 + 6)
+        self.assertEqual(list(geno[3:5]), [0x0B, 0])
+        # export during evolution
+        pop.evolve(
+            matingScheme=RandomMating(),
+            postOps=Exporter(format='plink', output='!"pop_%d" % gen', at=1),
+            gen=2)
+        self.assertEqual(len(open('pop_1.fam').readlines()), 9)
+        # cleanup
+        for f in ['pop.bed', 'pop.bim', 'pop.fam', 'pop_1.bed', 'pop_1.bim', 'pop_1.fam']:
+            os.remove(f)
+
+    def testExportImportVCF(self):
+        'Testing export and import genotype in VCF format'''
+        pop = Population(size=[4, 5], loci=[2, 4], ploidy=2,
+            lociNames=['a', 'b', 'c', 'd', 'e', 'f'], infoFields='ind_id',
+            alleleNames=['A', 'C', 'G'])
+        initGenotype(pop, haplotypes=[0,1])
+        tagID(pop, reset=True)
+        pop.individual(2).setAllele(2, 0, 0)
+        export(pop, format='vcf', output='pop.vcf')
+        self.assertEqual(self.lineOfFile('pop.vcf', 6).split('\t')[9:12], ['1', '2', '3'])
+        self.assertEqual(self.lineOfFile('pop.vcf', 7), '1\t1\ta\tA\tG\t.\tPASS\t.\tGT'
+            + '\t0|0' * 2 + '\t1|0' + '\t0|0' * 6 + '\n')
+        self.assertEqual(self.lineOfFile('pop.vcf', 8), '1\t2\tb\tA\tC\t.\tPASS\t.\tGT'
+            + '\t1|1' * 9 + '\n')
+        # compressed output should have the same content
+        export(pop, format='vcf', output='pop.vcf.gz', blockSize=2)
+        with gzip.open('pop.vcf.gz', 'rb') as vcf:
+            self.assertEqual(vcf.read().decode(), open('pop.vcf').read())
+        # import
+        for filename in ['pop.vcf', 'pop.vcf.gz']:
+            pop1 = importPopulation(format='vcf', filename=filename)
+            self.assertEqual(pop1.popSize(), 9)
+            self.assertEqual(pop1.numLoci(), (2, 4))
+            self.assertEqual(pop1.lociNames(), pop.lociNames())
+            self.assertEqual(pop1.alleleNames(0), ('A', 'G'))
+            self.assertEqual(pop1.alleleNames(1), ('A', 'C'))
+            self.assertEqual(pop1.individual(2).allele(0, 0), 1)
+            self.assertEqual(pop1.individual(3).allele(0, 0), 0)
+        # import selected samples and regions
+        pop1 = loadVCF('pop.vcf.gz', samples=['3', '4'], regions=['1:1-1', '2'],
+            infoFields='a')
+        self.assertEqual(pop1.popSize(), 2)
+        self.assertEqual(pop1.numLoci(), (1, 4))
+        self.assertEqual(pop1.infoFields(), ('a',))
+        self.assertEqual(pop1.individual(0).genotype(), [1, 0, 1, 0, 1, 0, 0, 1, 0, 1])
+        self.assertEqual(pop1.individual(1).genotype(), [0, 0, 1, 0, 1] * 2)
+        self.assertRaises(ValueError, loadVCF, 'pop.vcf', samples=['10'])
+        # alleles without names of bases
+        pop = Population(size=3, loci=2, infoFields='ind_id')
+        initGenotype(pop, haplotypes=[0, 1])
+        tagID(pop, reset=True)
+        export(pop, format='vcf', output='pop.vcf')
+        self.assertEqual(self.lineOfFile('pop.vcf', 6).split('\t')[3:5], ['N', '.'])
+        self.assertEqual(self.lineOfFile('pop.vcf', 7).split('\t')[3:5], ['N', '<A1>'])
+        # ploidy is not determined by the first sample, which is a haploid male
+        with open('pop.vcf', 'w') as vcf:
+            vcf.write('##fileformat=VCFv4.2\n'
+                '#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tS1\tS2\n'
+                'X\t10\t.\tA\tG\t.\tPASS\t.\tGT\t1\t0|1\n'
+                'X\t20\t.\tA\tG\t.\tPASS\t.\tGT\t0\t1|1\n')
+        pop1 = loadVCF('pop.vcf')
+        self.assertEqual(pop1.ploidy(), 2)
+        self.assertEqual(pop1.individual(0).genotype(), [1, 0, 0, 0])
+        self.assertEqual(pop1.individual(1).genotype(), [0, 1, 1, 1])
+        # cleanup
+        for f in ['pop.vcf', 'pop.vcf.gz']:
+            os.remove(f)
+
     def testExportPhylip(self):
         'Testing export genotype in phylip format'''
         pop = Population(size=[4,5], loci=[20, 90], ploidy=2)
@@ -871,6 +871,44 @@ class TestDemography(unittest.TestCase):
         ), 10)
 
 
+    def testNativeModels(self):
+        'Test native evaluation of demographic models during mating'
+        def models():
+            return [
+                ExponentialGrowthModel(T=20, N0=[200, 300], NT=[400, 1000]),
+                LinearGrowthModel(T=20, N0=200, r=0.05),
+                InstantChangeModel(T=20, N0=200, G=[5, 10], NG=[[100, 100], 300]),
+                MultiStageModel([
+                    InstantChangeModel(T=5, N0=200),
+                    ExponentialGrowthModel(T=10, NT=500),
+                    InstantChangeModel(T=5, N0=[100, 200])]),
+                EventBasedModel(T=20, N0=[(200, 'A'), (200, 'B')],
+                    events=[ExpansionEvent(slopes=5, subPops='B', begin=3),
+                        ResizeEvent(sizes=[300], subPops='A', at=[10])]),
+            ]
+        def record(pop, sizes):
+            sizes.append(pop.subPopSizes())
+            return True
+        for native, python in zip(models(), models()):
+            # evaluated natively after the first generation
+            pop = Population(size=native.init_size, infoFields=native.info_fields)
+            nativeSizes = []
+            pop.evolve(matingScheme=RandomSelection(subPopSize=native),
+                postOps=PyOperator(record, param=nativeSizes),
+                gen=native.num_gens)
+            # evaluated in Python
+            pop = Population(size=python.init_size, infoFields=python.info_fields)
+            pythonSizes = []
+            for gen in range(python.num_gens):
+                pop.dvars().gen = gen
+                sz = python(pop)
+                python._native = None
+                if not sz:
+                    break
+                pop.resize(sz, propagate=True)
+                pythonSizes.append(pop.subPopSizes())
+            self.assertEqual(nativeSizes, pythonSizes)
+
     def testStockModels(self):
         'Test stock demographic models'
         OutOfAfricaModel(20000).plot()